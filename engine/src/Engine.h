@@ -15,11 +15,64 @@
 #include "core/Layer.h"
 #include "core/Log.h"
 #include "core/MouseButtonCodes.h"
+#include "core/World.h"
+#include "core/WorldHost.h"
+#include "core/assets/AssetArchive.h"
+#include "core/assets/AssetCooker.h"
+#include "core/assets/BlockCompression.h"
+#include "core/assets/ContentCache.h"
+#include "core/assets/ContentHash.h"
+#include "core/assets/Cookers.h"
+#include "core/assets/TextureCache.h"
+#include "core/assets/TextureCompression.h"
+#include "core/compression/Lz.h"
+#include "core/cpu/CpuFeatures.h"
+#include "core/cpu/Dispatch.h"
+#include "core/cpu/Topology.h"
+#include "core/cvars/ConsoleVariable.h"
+#include "core/ecs/Archetype.h"
+#include "core/ecs/Registry.h"
 #include "core/events/Event.h"
+#include "core/events/EventQueue.h"
 #include "core/imgui/ImGuiLayer.h"
+#include "core/jobs/JobSystem.h"
+#include "core/lockstep/DeterministicRandom.h"
+#include "core/lockstep/Fixed.h"
+#include "core/lockstep/FixedVector.h"
+#include "core/lockstep/Lockstep.h"
+#include "core/lockstep/StateHasher.h"
+#include "core/math/SimdMath.h"
+#include "core/math/Wide.h"
+#include "core/memory/VirtualArena.h"
+#include "core/physics/BroadPhase.h"
+#include "core/physics/CharacterController.h"
+#include "core/physics/Collision.h"
+#include "core/physics/CollisionWorld.h"
+#include "core/physics/Fluid.h"
+#include "core/physics/PhysicsTypes.h"
+#include "core/physics/RayPacket.h"
+#include "core/physics/SoftBody.h"
+#include "core/projectiles/ProjectileEmitter.h"
+#include "core/projectiles/ProjectileSystem.h"
+#include "core/random/BulkRandom.h"
+#include "core/random/Random.h"
+#include "core/reflection/Reflection.h"
+#include "core/reflection/Serializer.h"
 #include "core/renderer/Buffer.h"
+#include "core/renderer/Framebuffer.h"
+#include "core/renderer/GpuTimer.h"
+#include "core/renderer/QuadBatch.h"
 #include "core/renderer/Renderer.h"
+#include "core/renderer/RenderScene.h"
+#include "core/renderer/ResolutionScaler.h"
 #include "core/renderer/Shader.h"
+#include "core/snapshot/ForkSnapshotter.h"
+#include "core/snapshot/Snapshot.h"
+#include "core/sort/RadixSort.h"
+#include "core/sprites/SpriteSystem.h"
+#include "core/timers/TimerWheel.h"
+#include "core/tweens/TweenEngine.h"
+#include "core/ui/UiTree.h"
 
 #include "core/Entrypoint.h"
 
@@ -1,8 +1,11 @@
 #include "core/Application.h"
 
+#include <algorithm>
+#include <chrono>
 #include <functional>
 #include <initializer_list>
 #include <memory>
+#include <thread>
 
 #include <glad/glad.h>
 
@@ -11,8 +14,12 @@
 #include "core/Layer.h"
 #include "core/Log.h"
 #include "core/Window.h"
+#include "core/cpu/CpuFeatures.h"
+#include "core/cvars/ConsoleVariable.h"
 #include "core/events/ApplicationEvent.h"
 #include "core/events/Event.h"
+#include "core/jobs/JobSystem.h"
+#include "core/math/SimdMath.h"
 
 #include "core/renderer/Shader.h"
 
@@ -20,20 +27,100 @@ namespace engine {
 
 Application* Application::kApplication_ = nullptr;
 
+namespace {
+
+cvars::ConsoleVariable<bool> kVerticalSync(
+    "r.vsync", true, "Synchronize buffer swaps with the display refresh.");
+
+cvars::ConsoleVariable<bool> kDynamicResolution(
+    "r.dynamic_resolution",
+    true,
+    "Lower the resolution of the scene when frames run over budget.");
+
+cvars::ConsoleVariable<int32_t> kDynamicResolutionTargetRate(
+    "r.dynamic_resolution_target_fps",
+    60,
+    "The frame rate that dynamic resolution tries to hold.");
+
+cvars::ConsoleVariable<float> kDynamicResolutionMinScale(
+    "r.dynamic_resolution_min_scale",
+    0.5f,
+    "The lowest fraction of the window's width and height that dynamic "
+    "resolution renders the scene at.");
+
+cvars::ConsoleVariable<int32_t> kUpscaleFilter(
+    "r.upscale_filter",
+    1,
+    "How the scene is upscaled to the window: 0 for bilinear, 1 for "
+    "sharpened.");
+
+cvars::ConsoleVariable<float> kUpscaleSharpness(
+    "r.upscale_sharpness",
+    0.5f,
+    "How strongly the sharpened upscale filter sharpens, from 0 to 1.");
+
+cvars::ConsoleVariable<int32_t> kHeadlessTickRate(
+    "app.headless_tick_rate",
+    60,
+    "Updates per second of applications running without a window, or 0 to "
+    "update as fast as possible.");
+
+}  // namespace
+
 /**
  * TODO(C3NZ): This should not carry as much of a load as it currently does
  * and should instead be delegated to applications attempting to use the engine.
  */
-Application::Application() {
+Application::Application(const ApplicationSettings& settings)
+    : settings_(settings) {
   ENGINE_CORE_ASSERT(!kApplication_, "Application already exists.");
   kApplication_ = this;
 
+  // Publish the values staged from the config file and command line before
+  // anything reads them.
+  cvars::ConsoleVariables::ApplyChanges();
+
+  const cpu::CpuInfo& cpu_info = cpu::GetCpuInfo();
+  ENGINE_CORE_INFO(
+      "CPU: {} ({}).",
+      cpu_info.Brand,
+      cpu::GetCpuFeatureString(cpu_info.Features));
+  ENGINE_CORE_INFO(
+      "Using {} math kernels.",
+      math::GetInstructionSetName(math::GetInstructionSet()));
+
+  jobs::JobSystem::Init();
+
+  // The main world renders with the window's context, so it has to stay on
+  // the main thread.
+  WorldSettings world_settings;
+  world_settings.Name = "Main";
+  world_settings.MainThread = true;
+  main_world_ = world_host_.CreateWorld(world_settings);
+
+  if (!settings_.Headless) {
+    InitWindow();
+  }
+}
+
+void Application::InitWindow() {
   window_ = std::unique_ptr<Window>(Window::Create());
   window_->SetEventCallback(BIND_EVENT_FN(Application::OnEvent));
+  window_->SetVerticalSync(kVerticalSync.Get());
+  vertical_sync_callback_ = kVerticalSync.AddCallback([this](bool enabled) {
+    window_->SetVerticalSync(enabled);
+  });
+  Input::SetWindow(window_.get());
 
-  imgui_layer_ = new imgui::ImGuiLayer();
+  imgui_layer_ = new imgui::ImGuiLayer(*window_, &resolution_scaler_);
   PushLayer(imgui_layer_);
 
+  // Layers render the scene into this, and the UI is drawn at the window's
+  // resolution after it is upscaled.
+  scene_framebuffer_.reset(renderer::Framebuffer::Create(
+      std::max(window_->GetWidth(), 1u), std::max(window_->GetHeight(), 1u)));
+  scene_timer_.reset(renderer::GpuTimer::Create());
+
   // Generate and bind the vertex array.
   glGenVertexArrays(1, &vertex_array_);
   glBindVertexArray(vertex_array_);
@@ -106,66 +193,140 @@ Application::Application() {
   shader_.reset(new renderer::Shader(vertex_source, fragment_source));
 }
 
-Application::~Application() {}
+Application::~Application() {
+  if (window_) {
+    kVerticalSync.RemoveCallback(vertical_sync_callback_);
+    Input::SetWindow(nullptr);
+  }
+  jobs::JobSystem::Shutdown();
+}
 
 /**
- * This currently does a lot of custom rendering when in reality it should
- * be implemented by a child project that is running the game. This will change
- * in the future, but at the moment implements a lot of specific rendering
- * tests that are for ensuring that the renderer currently works.
+ * Hosted worlds are updated on the workers while the main world updates on
+ * this thread, and the frame is only rendered once all of them are done.
  */
 void Application::Run() {
+  using Clock = std::chrono::steady_clock;
+  Clock::time_point last_frame = Clock::now();
   while (running_) {
-    glClearColor(0.2f, 0.2f, 0.2f, 1);
-    glClear(GL_COLOR_BUFFER_BIT);
-
-    shader_->Bind();
-
-    // Bind the vertex array and then draw all of it's elements.
-    glBindVertexArray(vertex_array_);
-    glDrawElements(
-        GL_TRIANGLES, index_buffer_->GetCount(), GL_UNSIGNED_INT, nullptr);
+    Clock::time_point frame_start = Clock::now();
+    double delta_time =
+        std::chrono::duration<double>(frame_start - last_frame).count();
+    last_frame = frame_start;
+
+    // Layers of the main world draw on top of the cleared frame.
+    if (!settings_.Headless) {
+      BeginFrame();
+    }
 
-    for (Layer* layer : layer_stack_) {
-      layer->OnUpdate();
+    world_host_.Update(delta_time);
+    if (main_world_->IsStopRequested()) {
+      running_ = false;
+    } else {
+      world_host_.DestroyStoppedWorlds();
     }
 
-    imgui_layer_->Begin();
-    for (Layer* layer : layer_stack_) {
-      layer->OnImGuiRender();
+    if (!settings_.Headless) {
+      EndFrame();
+
+      // Waiting for the display in the buffer swap isn't work the scale can
+      // reduce, so it's left out of the frame time.
+      UpdateResolutionScale(
+          std::chrono::duration<double>(Clock::now() - frame_start).count());
+      window_->OnUpdate();
+    } else if (kHeadlessTickRate.Get() > 0) {
+      std::this_thread::sleep_until(
+          frame_start + std::chrono::duration_cast<Clock::duration>(
+              std::chrono::duration<double>(1.0 / kHeadlessTickRate.Get())));
     }
-    imgui_layer_->End();
 
-    window_->OnUpdate();
+    cvars::ConsoleVariables::ApplyChanges();
+  }
+}
+
+/**
+ * This currently does a lot of custom rendering when in reality it should
+ * be implemented by a child project that is running the game. This will change
+ * in the future, but at the moment implements a lot of specific rendering
+ * tests that are for ensuring that the renderer currently works.
+ */
+void Application::BeginFrame() {
+  // The framebuffer keeps its size while the scale changes and only renders
+  // into a smaller part of itself.
+  uint32_t width = std::max(window_->GetWidth(), 1u);
+  uint32_t height = std::max(window_->GetHeight(), 1u);
+  uint32_t render_width, render_height;
+  resolution_scaler_.GetRenderSize(
+      width, height, &render_width, &render_height);
+  scene_framebuffer_->Resize(width, height);
+  scene_framebuffer_->SetRenderSize(render_width, render_height);
+  scene_framebuffer_->Bind();
+  scene_timer_->Begin();
+
+  glClearColor(0.2f, 0.2f, 0.2f, 1);
+  glClear(GL_COLOR_BUFFER_BIT);
+
+  shader_->Bind();
+
+  // Bind the vertex array and then draw all of it's elements.
+  glBindVertexArray(vertex_array_);
+  glDrawElements(
+      GL_TRIANGLES, index_buffer_->GetCount(), GL_UNSIGNED_INT, nullptr);
+}
+
+void Application::EndFrame() {
+  scene_timer_->End();
+  scene_framebuffer_->Unbind();
+  glViewport(0, 0, window_->GetWidth(), window_->GetHeight());
+  scene_framebuffer_->Upscale(
+      window_->GetWidth(),
+      window_->GetHeight(),
+      kUpscaleFilter.Get() == 0
+          ? renderer::UpscaleFilter::Bilinear
+          : renderer::UpscaleFilter::Sharpened,
+      kUpscaleSharpness.Get());
+
+  imgui_layer_->Begin();
+  for (Layer* layer : main_world_->GetLayerStack()) {
+    layer->OnImGuiRender();
   }
+  imgui_layer_->End();
+}
+
+/**
+ * The settings are read from the console variables every frame, so that
+ * changes to them take effect right away.
+ */
+void Application::UpdateResolutionScale(double frame_time) {
+  renderer::ResolutionScalerSettings settings =
+      resolution_scaler_.GetSettings();
+  settings.Enabled = kDynamicResolution.Get();
+  settings.TargetFrameTime =
+      1.0 / std::max(kDynamicResolutionTargetRate.Get(), 1);
+  settings.MinScale = std::min(
+      std::max(kDynamicResolutionMinScale.Get(), 0.25f), settings.MaxScale);
+  resolution_scaler_.SetSettings(settings);
+  resolution_scaler_.Update(frame_time, scene_timer_->GetElapsedTime());
 }
 
 /**
  * This function only specifically listens for when the window is requested to
- * close before passing the event to layers on the LayerStack.
+ * close before passing the event to layers of the main world.
  */
 void Application::OnEvent(events::Event* event) {
   events::EventDispatcher dispatcher(event);
   dispatcher.Dispatch<events::WindowCloseEvent>
       (BIND_EVENT_FN(Application::OnWindowClosed));
 
-  // Pass the event to all needed layers on the stack.
-  for (auto it = layer_stack_.end(); it != layer_stack_.begin();) {
-    (*--it)->OnEvent(event);
-    if (event->HasBeenHandled()) {
-      break;
-    }
-  }
+  main_world_->OnEvent(event);
 }
 
 void Application::PushLayer(Layer* layer) {
-  layer_stack_.PushLayer(layer);
-  layer->OnAttach();
+  main_world_->PushLayer(layer);
 }
 
 void Application::PushOverlay(Layer* layer) {
-  layer_stack_.PushOverlay(layer);
-  layer->OnAttach();
+  main_world_->PushOverlay(layer);
 }
 
 bool Application::OnWindowClosed(const events::WindowCloseEvent& event) {
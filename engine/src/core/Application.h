@@ -11,20 +11,36 @@
 #ifndef ENGINE_SRC_CORE_APPLICATION_H_
 #define ENGINE_SRC_CORE_APPLICATION_H_
 
+#include <cstdint>
 #include <memory>
 
 #include "core/Core.h"
 #include "core/Layer.h"
 #include "core/LayerStack.h"
 #include "core/Window.h"
+#include "core/World.h"
+#include "core/WorldHost.h"
 #include "core/events/ApplicationEvent.h"
 #include "core/events/Event.h"
 #include "core/imgui/ImGuiLayer.h"
 #include "core/renderer/Buffer.h"
+#include "core/renderer/Framebuffer.h"
+#include "core/renderer/GpuTimer.h"
+#include "core/renderer/ResolutionScaler.h"
 #include "core/renderer/Shader.h"
 
 namespace engine {
 
+/**
+ * @struct ApplicationSettings
+ * @brief How an application is created.
+ */
+struct ApplicationSettings {
+  // Run without a window, renderer or ImGui, e.g. for dedicated servers.
+  // Updates are paced by the app.headless_tick_rate console variable.
+  bool Headless = false;
+};
+
 /**
  * @class Application
  * @brief The primary driver of all applications extending this engine.
@@ -32,10 +48,16 @@ namespace engine {
  * The engine implements the application runner as an individual platform
  * independent application instance that manages the lifecycle of the core and
  * lower level components of the engine.
+ *
+ * The application owns what is shared by the whole process: the window, the
+ * job system and the WorldHost. Simulations live in worlds. The main world is
+ * updated on the main thread and receives the window's events, and servers
+ * can host any number of further worlds next to it through GetWorldHost.
  */
 class ENGINE_API Application {
  public:
-  Application();
+  explicit Application(
+      const ApplicationSettings& settings = ApplicationSettings());
   virtual ~Application();
 
   /**
@@ -44,15 +66,20 @@ class ENGINE_API Application {
    */
   void Run();
 
+  /**
+   * @brief Stops running after the current frame.
+   */
+  inline void Quit() { running_ = false; }
+
   /**
    * @param event An event pointer generated to be handled by the application.
-   * @brief Passes events to all the layers.
+   * @brief Passes events to all the layers of the main world.
    */
   void OnEvent(events::Event* event);
 
   /**
    * @param layer
-   * @brief Attaches a layer to the application instance.
+   * @brief Attaches a layer to the main world.
    *
    * This allows the application instance to propage events, rendering, and any
    * desired pieces of data into the layer.
@@ -60,7 +87,7 @@ class ENGINE_API Application {
   void PushLayer(Layer* layer);
 
   /**
-   * Attaches an overlay to the application instance. This allows the
+   * Attaches an overlay to the main world. This allows the
    * application instance to propage events, renderine, and any desired
    * pieces of data into the layer.
    */
@@ -73,22 +100,53 @@ class ENGINE_API Application {
    */
   inline const Window& GetWindow() const { return *window_; }
 
+  /**
+   * Returns true if the application runs without a window.
+   */
+  inline bool IsHeadless() const { return settings_.Headless; }
+
+  /**
+   * Gets the world that layers pushed into the application live in.
+   */
+  inline World& GetMainWorld() { return *main_world_; }
+
+  /**
+   * Gets the host of every world in the process, including the main world.
+   */
+  inline WorldHost& GetWorldHost() { return world_host_; }
+
+  /**
+   * Gets the controller that picks the resolution the main world's scene is
+   * rendered at, configured through the r.dynamic_resolution console
+   * variables.
+   */
+  inline const renderer::ResolutionScaler& GetResolutionScaler() const {
+    return resolution_scaler_;
+  }
+
   /**
    * The application is instantiated at runtime and this function is independent
-   * of any single application instance (There can currently only be one
-   * instance running, anyways.)
+   * of any single application instance. There is one application per process,
+   * while independent simulations are separate worlds, so engine code reaches
+   * its world through Layer::GetWorld instead of this.
    */
   inline static Application& GetApplication() {return *kApplication_; }
 
  private:
-  LayerStack layer_stack_;
+  ApplicationSettings settings_;
+  WorldHost world_host_;
+  World* main_world_;
   bool running_ = true;
-  imgui::ImGuiLayer* imgui_layer_;
+  imgui::ImGuiLayer* imgui_layer_ = nullptr;
   std::unique_ptr<Window> window_;
   std::unique_ptr<renderer::Shader> shader_;
   std::unique_ptr<renderer::VertexBuffer> vertex_buffer_;
   std::unique_ptr<renderer::IndexBuffer> index_buffer_;
-  unsigned int vertex_array_;
+  std::unique_ptr<renderer::Framebuffer> scene_framebuffer_;
+  std::unique_ptr<renderer::GpuTimer> scene_timer_;
+  renderer::ResolutionScaler resolution_scaler_;
+  unsigned int vertex_array_ = 0;
+  uint32_t vertical_sync_callback_ = 0;
 
   static Application* kApplication_;
 
@@ -97,6 +155,28 @@ class ENGINE_API Application {
    * application.
    */
   bool OnWindowClosed(const events::WindowCloseEvent& event);
+
+  /**
+   * Creates the window, the ImGui layer and the test triangle.
+   */
+  void InitWindow();
+
+  /**
+   * Binds the scene framebuffer at the current render scale, clears it and
+   * draws the test triangle.
+   */
+  void BeginFrame();
+
+  /**
+   * Upscales the scene to the window and draws the ImGui windows of the main
+   * world over it at native resolution.
+   */
+  void EndFrame();
+
+  /**
+   * Feeds the timings of the frame to the resolution scaler.
+   */
+  void UpdateResolutionScale(double frame_time);
 };
 
 /**
@@ -10,16 +10,21 @@
 
 #include "core/Application.h"
 #include "core/Log.h"
+#include "core/cvars/ConsoleVariable.h"
 
 #ifdef ENGINE_PLATFORM_LINUX
 
 extern engine::Application* engine::CreateApplication();
 
-int main() {
+int main(int argc, char** argv) {
   engine::logging::Log::Init();
   ENGINE_CORE_WARN("Initialized core log");
   ENGINE_CLIENT_INFO("Initialized client log");
 
+  // Arguments override the config file, so they have to be staged last.
+  engine::cvars::ConsoleVariables::LoadFile("engine.cfg");
+  engine::cvars::ConsoleVariables::ParseCommandLine(argc, argv);
+
   auto app = engine::CreateApplication();
   app->Run();
   delete app;
@@ -8,6 +8,7 @@
 #include <utility>
 
 #include "core/Core.h"
+#include "core/Window.h"
 
 namespace engine {
 
@@ -20,6 +21,12 @@ namespace engine {
  */
 class ENGINE_API Input {
  public:
+  /**
+   * @brief Set the window input is read from. Set by the application when it
+   * creates its window.
+   */
+  inline static void SetWindow(const Window* window) { kWindow_ = window; }
+
   // -------------------------------- Key input --------------------------------
 
   /**
@@ -53,6 +60,9 @@ class ENGINE_API Input {
       return kInput_->IsMouseButtonPressedImpl(button); }
 
  protected:
+  inline static void* GetNativeWindow()
+      { return kWindow_->GetNativeWindow(); }
+
   virtual bool IsKeyPressedImpl(int key_code) = 0;
 
   virtual float GetMouseXImpl() = 0;
@@ -62,6 +72,7 @@ class ENGINE_API Input {
 
  private:
   static Input* kInput_;
+  static const Window* kWindow_;
 };
 
 }  // namespace engine
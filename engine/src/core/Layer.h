@@ -14,6 +14,13 @@
 
 namespace engine {
 
+class World;
+
+namespace snapshot {
+class SnapshotReader;
+class SnapshotWriter;
+}  // namespace snapshot
+
 class ENGINE_API Layer {
  public:
   explicit Layer(const std::string& name = "Layer");
@@ -64,6 +71,29 @@ class ENGINE_API Layer {
    */
   virtual void OnImGuiRender() {}
 
+  /**
+   * @fn OnSaveSnapshot
+   * @param writer - The snapshot being written.
+   * @brief Writes the state of the layer that should survive a restart.
+   *
+   * May run in a forked process (Check
+   * `engine/src/core/snapshot/ForkSnapshotter.h`), so it must not queue jobs
+   * or log. Returns false to fail the snapshot.
+   */
+  virtual bool OnSaveSnapshot(snapshot::SnapshotWriter* writer) {
+    return true;
+  }
+
+  /**
+   * @fn OnLoadSnapshot
+   * @param reader - The snapshot being read.
+   * @brief Restores the state written by OnSaveSnapshot. Returns false if the
+   * state is invalid.
+   */
+  virtual bool OnLoadSnapshot(snapshot::SnapshotReader* reader) {
+    return true;
+  }
+
   /**
    * @fn GetName
    * @brief Gets the name of the layer.
@@ -72,8 +102,22 @@ class ENGINE_API Layer {
    */
   inline const std::string& GetName() const { return debug_name_; }
 
+  /**
+   * @fn GetWorld
+   * @brief Gets the world the layer was pushed into.
+   *
+   * Every world updates its own layers, so this is how a layer reaches its
+   * clock, allocators and events.
+   */
+  inline World* GetWorld() const { return world_; }
+
  protected:
   std::string debug_name_;
+
+ private:
+  World* world_ = nullptr;
+
+  friend class World;
 };
 
 }  // namespace engine
@@ -0,0 +1,180 @@
+#include "core/World.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "core/Log.h"
+#include "core/jobs/JobSystem.h"
+
+namespace engine {
+
+namespace {
+
+memory::ArenaSettings MakeArenaSettings(size_t size, int32_t home_node) {
+  memory::ArenaSettings settings;
+  settings.ReserveSize = size;
+  settings.NumaNode = home_node;
+  return settings;
+}
+
+}  // namespace
+
+World::World(
+    const WorldSettings& settings,
+    std::shared_ptr<const assets::AssetArchive> assets)
+    : settings_(settings),
+      timers_(
+          settings.TimerResolution,
+          [this](events::Event* event) { OnEvent(event); }),
+      tweens_([this](events::Event* event) { OnEvent(event); }),
+      frame_arena_([&] {
+        // Frame arenas are reset every update, so keep what a typical frame
+        // uses committed instead of faulting it back in every time.
+        memory::ArenaSettings arena = MakeArenaSettings(
+            settings.FrameArenaSize, settings.HomeNode);
+        arena.RetainSize = std::min<size_t>(
+            settings.FrameArenaSize, 4 * 1024 * 1024);
+        return arena;
+      }()),
+      persistent_arena_([&] {
+        memory::ArenaSettings arena = MakeArenaSettings(
+            settings.PersistentArenaSize, settings.HomeNode);
+        arena.CommitSize = memory::kHugePageSize;
+        arena.HugePages = true;
+        return arena;
+      }()),
+      registry_([&] {
+        memory::ArenaSettings arena = MakeArenaSettings(
+            settings.EntityArenaSize, settings.HomeNode);
+        arena.CommitSize = memory::kHugePageSize;
+        arena.HugePages = true;
+        return arena;
+      }()),
+      assets_(std::move(assets)) {}
+
+World::~World() {}
+
+void World::Update(double real_delta_time) {
+  int previous_home_node = jobs::JobSystem::GetHomeNode();
+  jobs::JobSystem::SetHomeNode(settings_.HomeNode);
+
+  frame_arena_.Reset();
+
+  double delta_time = std::min(real_delta_time, settings_.MaxDeltaTime);
+  clock_.DeltaTime = clock_.Paused ? 0.0 : delta_time * clock_.TimeScale;
+  clock_.Time += clock_.DeltaTime;
+
+  DeliverQueuedEvents();
+  timers_.Advance(clock_.Time);
+  tweens_.Advance(static_cast<float>(clock_.DeltaTime));
+  for (Layer* layer : layer_stack_) {
+    layer->OnUpdate();
+  }
+  registry_.EndFrame();
+  ++clock_.Frame;
+
+  jobs::JobSystem::SetHomeNode(previous_home_node);
+}
+
+void World::OnEvent(events::Event* event) {
+  for (auto it = layer_stack_.end(); it != layer_stack_.begin();) {
+    (*--it)->OnEvent(event);
+    if (event->HasBeenHandled()) {
+      break;
+    }
+  }
+}
+
+void World::QueueEvent(std::unique_ptr<events::Event> event) {
+  queued_events_.Post(std::move(event));
+}
+
+void World::PushLayer(Layer* layer) {
+  layer->world_ = this;
+  layer_stack_.PushLayer(layer);
+  layer->OnAttach();
+}
+
+void World::PushOverlay(Layer* layer) {
+  layer->world_ = this;
+  layer_stack_.PushOverlay(layer);
+  layer->OnAttach();
+}
+
+bool World::TakeSnapshotRequest(std::string* path) {
+  if (snapshot_path_.empty()) {
+    return false;
+  }
+  *path = std::move(snapshot_path_);
+  snapshot_path_.clear();
+  return true;
+}
+
+// Every layer's state is preceded by its name, so that loading into a world
+// with different layers fails instead of handing a layer another's state.
+// The clock is written field by field, which keeps its padding out of the
+// file.
+bool World::WriteSnapshot(snapshot::SnapshotWriter* writer) {
+  writer->WriteValue(clock_.Time);
+  writer->WriteValue(clock_.DeltaTime);
+  writer->WriteValue(clock_.Frame);
+  writer->WriteValue(clock_.TimeScale);
+  writer->WriteValue(static_cast<uint8_t>(clock_.Paused ? 1 : 0));
+  writer->WriteValue(static_cast<uint32_t>(layer_stack_.end()
+                                           - layer_stack_.begin()));
+  for (Layer* layer : layer_stack_) {
+    const std::string& name = layer->GetName();
+    writer->WriteBytes(std::vector<uint8_t>(name.begin(), name.end()));
+    if (!layer->OnSaveSnapshot(writer)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool World::LoadSnapshot(const std::string& path) {
+  snapshot::SnapshotReader reader;
+  if (!reader.Open(path)) {
+    return false;
+  }
+
+  WorldClock clock;
+  uint8_t paused;
+  uint32_t layer_count;
+  if (!reader.ReadValue(&clock.Time) || !reader.ReadValue(&clock.DeltaTime)
+      || !reader.ReadValue(&clock.Frame) || !reader.ReadValue(&clock.TimeScale)
+      || !reader.ReadValue(&paused) || !reader.ReadValue(&layer_count)
+      || layer_count != layer_stack_.end() - layer_stack_.begin()) {
+    ENGINE_CORE_ERROR(
+        "Snapshot {} doesn't match the layers of world {}.", path, GetName());
+    return false;
+  }
+  clock.Paused = paused != 0;
+
+  std::vector<uint8_t> name;
+  for (Layer* layer : layer_stack_) {
+    if (!reader.ReadBytes(&name)
+        || std::string(name.begin(), name.end()) != layer->GetName()) {
+      ENGINE_CORE_ERROR(
+          "Snapshot {} doesn't match the layers of world {}.", path,
+          GetName());
+      return false;
+    }
+    if (!layer->OnLoadSnapshot(&reader)) {
+      ENGINE_CORE_ERROR(
+          "Layer {} couldn't load its state from snapshot {}.",
+          layer->GetName(), path);
+      return false;
+    }
+  }
+
+  // Only a snapshot that loaded completely moves the world's time.
+  clock_ = clock;
+  return true;
+}
+
+void World::DeliverQueuedEvents() {
+  queued_events_.Drain([this](events::Event* event) { OnEvent(event); });
+}
+
+}  // namespace engine
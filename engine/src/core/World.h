@@ -0,0 +1,244 @@
+/**
+ * @file engine/src/core/World.h
+ * @brief An independent simulation with its own layers, clock, events and
+ * memory.
+ *
+ * A process can host any number of worlds, such as one per match on a
+ * dedicated server. Worlds don't share any mutable state with each other, so
+ * the WorldHost updates them in parallel on the job system. What they do
+ * share is everything that is expensive to duplicate and read only while the
+ * worlds run: the job system, the cooked assets and the loggers.
+ */
+#ifndef ENGINE_SRC_CORE_WORLD_H_
+#define ENGINE_SRC_CORE_WORLD_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/Core.h"
+#include "core/Layer.h"
+#include "core/LayerStack.h"
+#include "core/assets/AssetArchive.h"
+#include "core/ecs/Registry.h"
+#include "core/events/Event.h"
+#include "core/events/EventQueue.h"
+#include "core/memory/VirtualArena.h"
+#include "core/snapshot/Snapshot.h"
+#include "core/timers/TimerWheel.h"
+#include "core/tweens/TweenEngine.h"
+
+namespace engine {
+
+/**
+ * @struct WorldSettings
+ * @brief How a world is created.
+ */
+struct WorldSettings {
+  std::string Name = "World";
+
+  // The NUMA node the world's jobs and memory are placed on, as an index into
+  // cpu::CpuTopology::Nodes, or -1 for any node.
+  int32_t HomeNode = -1;
+
+  // Update the world on the thread calling WorldHost::Update rather than on a
+  // worker, e.g. because its layers render with the window's GL context.
+  bool MainThread = false;
+
+  // The largest step the clock takes in a single update, so that a world that
+  // stalled doesn't try to catch up all at once.
+  double MaxDeltaTime = 0.25;
+
+  // The capacity of the arena that is reset every update, and of the arena
+  // that lives as long as the world.
+  size_t FrameArenaSize = 64 * 1024 * 1024;
+  size_t PersistentArenaSize = 1024 * 1024 * 1024;
+
+  // The capacity of the arena the world's entity chunks are allocated from.
+  size_t EntityArenaSize = 1024 * 1024 * 1024;
+
+  // Seconds per tick of the world's timers.
+  double TimerResolution = 0.001;
+};
+
+/**
+ * @struct WorldClock
+ * @brief The time of a world, which can be scaled or paused independently of
+ * every other world.
+ */
+struct WorldClock {
+  // Seconds of simulated time since the world was created.
+  double Time = 0.0;
+
+  // Seconds of simulated time the current update advances by.
+  double DeltaTime = 0.0;
+
+  // The number of completed updates.
+  uint64_t Frame = 0;
+
+  float TimeScale = 1.0f;
+  bool Paused = false;
+};
+
+/**
+ * @class World
+ * @brief A single independent simulation.
+ *
+ * Layers pushed into a world can find it through Layer::GetWorld, which
+ * replaces reaching for a process wide singleton.
+ */
+class ENGINE_API World {
+ public:
+  World(
+      const WorldSettings& settings,
+      std::shared_ptr<const assets::AssetArchive> assets = nullptr);
+  ~World();
+
+  World(const World&) = delete;
+  World& operator=(const World&) = delete;
+
+  /**
+   * @fn Update
+   * @param real_delta_time Seconds of real time since the last update.
+   * @brief Advances the clock, delivers the queued events and updates every
+   * layer. Jobs queued by the layers go to the world's home node.
+   */
+  void Update(double real_delta_time);
+
+  /**
+   * @fn OnEvent
+   * @brief Passes an event to the layers, from the top of the stack down,
+   * until one of them handles it. Must be called from the thread updating the
+   * world, or while it isn't being updated.
+   */
+  void OnEvent(events::Event* event);
+
+  /**
+   * @fn QueueEvent
+   * @brief Queues an event from any thread, without locking, to be passed to
+   * the layers at the start of the next update. Events from the same thread
+   * arrive in the order they were queued.
+   */
+  void QueueEvent(std::unique_ptr<events::Event> event);
+
+  void PushLayer(Layer* layer);
+  void PushOverlay(Layer* layer);
+
+  /**
+   * @fn RequestStop
+   * @brief Asks the host to destroy the world after its current update. Safe
+   * to call from the world's own layers.
+   */
+  inline void RequestStop() { stop_requested_ = true; }
+  inline bool IsStopRequested() const { return stop_requested_; }
+
+  /**
+   * @fn RequestSnapshot
+   * @brief Asks the host to snapshot the world to a file after its current
+   * update. Safe to call from the world's own layers. The snapshot is written
+   * in the background, and a later request for the same world replaces one
+   * that hasn't started yet.
+   */
+  inline void RequestSnapshot(const std::string& path) {
+    snapshot_path_ = path;
+  }
+
+  /**
+   * @fn TakeSnapshotRequest
+   * @brief Used by the host to collect the path passed to RequestSnapshot.
+   * @return false if no snapshot was requested.
+   */
+  bool TakeSnapshotRequest(std::string* path);
+
+  /**
+   * @fn WriteSnapshot
+   * @brief Writes the clock and the state of every layer. Must not be called
+   * while the world is being updated.
+   */
+  bool WriteSnapshot(snapshot::SnapshotWriter* writer);
+
+  /**
+   * @fn LoadSnapshot
+   * @brief Restores a snapshot written by WriteSnapshot into a world with the
+   * same layers. The clock is only restored once every layer has loaded.
+   * @return false and logs an error if the snapshot is corrupt or was taken
+   * of a world with different layers.
+   */
+  bool LoadSnapshot(const std::string& path);
+
+  inline const std::string& GetName() const { return settings_.Name; }
+  inline const WorldSettings& GetSettings() const { return settings_; }
+  inline WorldClock& GetClock() { return clock_; }
+  inline const WorldClock& GetClock() const { return clock_; }
+  inline LayerStack& GetLayerStack() { return layer_stack_; }
+
+  /**
+   * @fn GetRegistry
+   * @brief Get the entities of the world. Every update ends the registry's
+   * frame, so recorded additions and removals of components stay visible
+   * until the end of the update after the one they happened in.
+   */
+  inline ecs::Registry& GetRegistry() { return registry_; }
+
+  /**
+   * @fn GetTimers
+   * @brief Get the world's timers. They're advanced by the world's clock
+   * after the queued events are delivered and before the layers update, and
+   * timer events are passed to the layers like any other event.
+   */
+  inline timers::TimerWheel& GetTimers() { return timers_; }
+
+  /**
+   * @fn GetTweens
+   * @brief Get the world's tweens. They're advanced by the world's clock
+   * right after the timers, so a tween's target already holds its new value
+   * when the layers update.
+   */
+  inline tweens::TweenEngine& GetTweens() { return tweens_; }
+
+  /**
+   * @fn GetFrameArena
+   * @brief Get the arena for allocations that only live until the next
+   * update.
+   */
+  inline memory::VirtualArena& GetFrameArena() { return frame_arena_; }
+
+  /**
+   * @fn GetPersistentArena
+   * @brief Get the arena for allocations that live as long as the world.
+   */
+  inline memory::VirtualArena& GetPersistentArena() {
+    return persistent_arena_;
+  }
+
+  /**
+   * @fn GetAssets
+   * @brief Get the cooked assets shared by every world of the host, or
+   * nullptr if none were loaded.
+   */
+  inline const assets::AssetArchive* GetAssets() const {
+    return assets_.get();
+  }
+
+ private:
+  void DeliverQueuedEvents();
+
+  WorldSettings settings_;
+  WorldClock clock_;
+  LayerStack layer_stack_;
+  timers::TimerWheel timers_;
+  tweens::TweenEngine tweens_;
+  memory::VirtualArena frame_arena_;
+  memory::VirtualArena persistent_arena_;
+  ecs::Registry registry_;
+  std::shared_ptr<const assets::AssetArchive> assets_;
+  bool stop_requested_ = false;
+  std::string snapshot_path_;
+
+  events::EventQueue queued_events_;
+};
+
+}  // namespace engine
+
+#endif  // ENGINE_SRC_CORE_WORLD_H_
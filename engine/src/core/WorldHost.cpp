@@ -0,0 +1,113 @@
+#include "core/WorldHost.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "core/Log.h"
+#include "core/jobs/JobSystem.h"
+
+namespace engine {
+
+bool WorldHost::LoadAssets(const std::string& archive_path) {
+  auto archive = std::make_shared<assets::AssetArchive>();
+  if (!archive->Open(archive_path)) {
+    return false;
+  }
+  assets_ = std::move(archive);
+  ENGINE_CORE_INFO(
+      "Loaded {} assets from {} for all worlds.",
+      assets_->GetAssetCount(), archive_path);
+  return true;
+}
+
+World* WorldHost::CreateWorld(const WorldSettings& settings) {
+  worlds_.push_back(std::make_unique<World>(settings, assets_));
+  ENGINE_CORE_INFO(
+      "Created world {} on NUMA node {}.", settings.Name, settings.HomeNode);
+  return worlds_.back().get();
+}
+
+void WorldHost::DestroyWorld(World* world) {
+  auto it = std::find_if(
+      worlds_.begin(), worlds_.end(),
+      [world](const std::unique_ptr<World>& owned) {
+        return owned.get() == world;
+      });
+  if (it != worlds_.end()) {
+    ENGINE_CORE_INFO("Destroyed world {}.", world->GetName());
+    worlds_.erase(it);
+  }
+}
+
+void WorldHost::Update(double real_delta_time) {
+  // Queueing every world on its home node keeps the world and the jobs it
+  // spawns on that node's workers.
+  jobs::JobCounter counter;
+  int home_node = jobs::JobSystem::GetHomeNode();
+  for (const std::unique_ptr<World>& world : worlds_) {
+    if (!world->GetSettings().MainThread) {
+      World* hosted = world.get();
+      jobs::JobSystem::SetHomeNode(hosted->GetSettings().HomeNode);
+      jobs::JobSystem::Execute(
+          [hosted, real_delta_time] { hosted->Update(real_delta_time); },
+          &counter);
+    }
+  }
+  jobs::JobSystem::SetHomeNode(home_node);
+
+  for (const std::unique_ptr<World>& world : worlds_) {
+    if (world->GetSettings().MainThread) {
+      world->Update(real_delta_time);
+    }
+  }
+  jobs::JobSystem::Wait(counter);
+
+  UpdateSnapshots();
+}
+
+void WorldHost::DestroyStoppedWorlds() {
+  for (size_t i = worlds_.size(); i-- > 0;) {
+    if (worlds_[i]->IsStopRequested()) {
+      DestroyWorld(worlds_[i].get());
+    }
+  }
+}
+
+// Every world is between updates here, so this is where the worlds can be
+// forked. Requests made while a snapshot is still being written stay with
+// their world until the next update after it finishes.
+void WorldHost::UpdateSnapshots() {
+  std::vector<snapshot::SnapshotResult> results;
+  snapshotter_.Poll(&results);
+  for (const snapshot::SnapshotResult& result : results) {
+    for (const std::string& path : result.Paths) {
+      if (result.Succeeded) {
+        ENGINE_CORE_INFO(
+            "Wrote snapshot {} in {:.2f}s.", path, result.Seconds);
+      } else {
+        ENGINE_CORE_ERROR("Couldn't write snapshot {}.", path);
+      }
+    }
+  }
+
+  if (snapshotter_.IsBusy()) {
+    return;
+  }
+
+  std::vector<snapshot::SnapshotRequest> requests;
+  std::string path;
+  for (const std::unique_ptr<World>& world : worlds_) {
+    if (world->TakeSnapshotRequest(&path)) {
+      World* snapshotted = world.get();
+      requests.push_back({path, [snapshotted](
+          snapshot::SnapshotWriter* writer) {
+        return snapshotted->WriteSnapshot(writer);
+      }});
+    }
+  }
+  if (!requests.empty()) {
+    snapshotter_.Begin(requests);
+  }
+}
+
+}  // namespace engine
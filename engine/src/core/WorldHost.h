@@ -0,0 +1,85 @@
+/**
+ * @file engine/src/core/WorldHost.h
+ * @brief Owns the worlds of a process and updates them together.
+ */
+#ifndef ENGINE_SRC_CORE_WORLDHOST_H_
+#define ENGINE_SRC_CORE_WORLDHOST_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/Core.h"
+#include "core/World.h"
+#include "core/assets/AssetArchive.h"
+#include "core/snapshot/ForkSnapshotter.h"
+
+namespace engine {
+
+/**
+ * @class WorldHost
+ * @brief The worlds hosted by a process.
+ *
+ * Every update runs each world as a single job, so independent worlds use
+ * all workers without any locking between them, and jobs inside a world nest
+ * underneath. Worlds created with WorldSettings::MainThread are updated on
+ * the calling thread instead, after the other worlds have been queued.
+ */
+class ENGINE_API WorldHost {
+ public:
+  WorldHost() = default;
+  ~WorldHost() = default;
+
+  WorldHost(const WorldHost&) = delete;
+  WorldHost& operator=(const WorldHost&) = delete;
+
+  /**
+   * @fn LoadAssets
+   * @brief Loads the archive shared by every world created afterwards.
+   * @return false if the archive couldn't be opened.
+   */
+  bool LoadAssets(const std::string& archive_path);
+
+  /**
+   * @fn CreateWorld
+   * @brief Creates a world, which is updated from the next update on. The
+   * world is owned by the host.
+   */
+  World* CreateWorld(const WorldSettings& settings);
+
+  /**
+   * @fn DestroyWorld
+   * @brief Destroys a world and its layers. Must not be called during an
+   * update; use World::RequestStop from inside one instead.
+   */
+  void DestroyWorld(World* world);
+
+  /**
+   * @fn DestroyStoppedWorlds
+   * @brief Destroys every world that requested to stop.
+   */
+  void DestroyStoppedWorlds();
+
+  /**
+   * @fn Update
+   * @param real_delta_time Seconds of real time since the last update.
+   * @brief Updates every world and blocks until all of them are done, then
+   * starts the snapshots the worlds requested and collects finished ones.
+   */
+  void Update(double real_delta_time);
+
+  inline const std::vector<std::unique_ptr<World>>& GetWorlds() const {
+    return worlds_;
+  }
+
+ private:
+  void UpdateSnapshots();
+
+  std::vector<std::unique_ptr<World>> worlds_;
+  std::shared_ptr<const assets::AssetArchive> assets_;
+  snapshot::ForkSnapshotter snapshotter_;
+};
+
+}  // namespace engine
+
+#endif  // ENGINE_SRC_CORE_WORLDHOST_H_
@@ -0,0 +1,201 @@
+#include "core/assets/AssetArchive.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "core/Log.h"
+#include "core/assets/ContentHash.h"
+
+namespace engine {
+namespace assets {
+
+namespace {
+
+/**
+ * The header is the magic, version, entry count, a reserved word and the
+ * offset of the table of contents. The table holds the offset, size, path
+ * length and path of every entry. All values are little endian.
+ */
+constexpr uint32_t kArchiveMagic = 0x4b415043;  // "CPAK"
+constexpr uint32_t kArchiveVersion = 1;
+constexpr uint64_t kHeaderSize = 24;
+
+// Data is aligned so that it can be used in place, e.g. by memory mapping.
+constexpr uint64_t kDataAlignment = 16;
+
+template<typename T>
+void Append(T value, std::vector<uint8_t>* out) {
+  for (size_t byte = 0; byte < sizeof(T); ++byte) {
+    out->push_back(static_cast<uint8_t>(value >> (byte * 8)));
+  }
+}
+
+template<typename T>
+bool Read(const uint8_t* data, uint64_t size, uint64_t* offset, T* value) {
+  if (*offset > size || size - *offset < sizeof(T)) {
+    return false;
+  }
+  *value = 0;
+  for (size_t byte = 0; byte < sizeof(T); ++byte) {
+    *value |= static_cast<T>(data[*offset + byte]) << (byte * 8);
+  }
+  *offset += sizeof(T);
+  return true;
+}
+
+}  // namespace
+
+// ---------------------------------- WRITER -----------------------------------
+
+ArchiveWriter::~ArchiveWriter() {
+  if (file_.is_open()) {
+    file_.close();
+  }
+}
+
+bool ArchiveWriter::Open(const std::string& path) {
+  file_.open(path, std::ios::binary | std::ios::trunc);
+  if (!file_) {
+    ENGINE_CORE_ERROR("Couldn't create archive {}.", path);
+    return false;
+  }
+
+  // Left zeroed until Finish, so an interrupted write is never mistaken for
+  // a valid archive.
+  std::vector<uint8_t> header(kHeaderSize, 0);
+  file_.write(reinterpret_cast<const char*>(header.data()), header.size());
+  offset_ = kHeaderSize;
+  entries_.clear();
+  entries_by_content_.clear();
+  return static_cast<bool>(file_);
+}
+
+bool ArchiveWriter::Add(
+    const std::string& asset_path, const std::vector<uint8_t>& data) {
+  uint64_t content = HashBytes(data.data(), data.size());
+  auto existing = entries_by_content_.find(content);
+  if (existing != entries_by_content_.end()
+      && entries_[existing->second].Size == data.size()) {
+    const Entry& original = entries_[existing->second];
+    entries_.push_back({ asset_path, original.Offset, original.Size });
+    return true;
+  }
+
+  uint64_t padding = (kDataAlignment - offset_ % kDataAlignment)
+      % kDataAlignment;
+  static const char kZeros[kDataAlignment] = {};
+  file_.write(kZeros, static_cast<std::streamsize>(padding));
+  offset_ += padding;
+
+  entries_by_content_[content] = entries_.size();
+  entries_.push_back({ asset_path, offset_, data.size() });
+  file_.write(
+      reinterpret_cast<const char*>(data.data()),
+      static_cast<std::streamsize>(data.size()));
+  offset_ += data.size();
+  return static_cast<bool>(file_);
+}
+
+bool ArchiveWriter::Finish() {
+  std::vector<uint8_t> table;
+  for (const Entry& entry : entries_) {
+    Append(entry.Offset, &table);
+    Append(entry.Size, &table);
+    Append(static_cast<uint32_t>(entry.Path.size()), &table);
+    table.insert(table.end(), entry.Path.begin(), entry.Path.end());
+  }
+  file_.write(
+      reinterpret_cast<const char*>(table.data()),
+      static_cast<std::streamsize>(table.size()));
+
+  std::vector<uint8_t> header;
+  Append(kArchiveMagic, &header);
+  Append(kArchiveVersion, &header);
+  Append(static_cast<uint32_t>(entries_.size()), &header);
+  Append(static_cast<uint32_t>(0), &header);
+  Append(offset_, &header);
+  file_.seekp(0);
+  file_.write(reinterpret_cast<const char*>(header.data()), header.size());
+
+  bool written = static_cast<bool>(file_);
+  file_.close();
+  return written;
+}
+
+// ---------------------------------- READER -----------------------------------
+
+bool AssetArchive::Open(const std::string& path) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    ENGINE_CORE_ERROR("Couldn't open archive {}.", path);
+    return false;
+  }
+  file.seekg(0, std::ios::end);
+  uint64_t size = static_cast<uint64_t>(file.tellg());
+  file.seekg(0);
+  entries_.clear();
+  data_ = nullptr;
+  size_ = 0;
+
+  memory::ArenaSettings settings;
+  settings.ReserveSize = std::max<uint64_t>(size, 1);
+  settings.CommitSize = settings.ReserveSize;
+  settings.HugePages = size >= memory::kHugePageSize;
+  arena_ = memory::VirtualArena(settings);
+  uint8_t* data = arena_.Allocate<uint8_t>(size);
+  if (data == nullptr
+      || !file.read(
+          reinterpret_cast<char*>(data), static_cast<std::streamsize>(size))) {
+    ENGINE_CORE_ERROR("Couldn't read archive {}.", path);
+    return false;
+  }
+  data_ = data;
+  size_ = size;
+
+  uint64_t offset = 0;
+  uint32_t magic, version, entry_count, reserved;
+  uint64_t table_offset;
+  if (!Read(data_, size_, &offset, &magic) || magic != kArchiveMagic
+      || !Read(data_, size_, &offset, &version) || version != kArchiveVersion
+      || !Read(data_, size_, &offset, &entry_count)
+      || !Read(data_, size_, &offset, &reserved)
+      || !Read(data_, size_, &offset, &table_offset)) {
+    ENGINE_CORE_ERROR("{} isn't a valid archive.", path);
+    return false;
+  }
+
+  offset = table_offset;
+  for (uint32_t i = 0; i < entry_count; ++i) {
+    Entry entry;
+    uint32_t path_size;
+    if (!Read(data_, size_, &offset, &entry.Offset)
+        || !Read(data_, size_, &offset, &entry.Size)
+        || !Read(data_, size_, &offset, &path_size)
+        || size_ - offset < path_size
+        || entry.Offset > table_offset
+        || table_offset - entry.Offset < entry.Size) {
+      ENGINE_CORE_ERROR("The table of contents of {} is corrupt.", path);
+      entries_.clear();
+      return false;
+    }
+
+    std::string asset_path(
+        reinterpret_cast<const char*>(&data_[offset]), path_size);
+    offset += path_size;
+    entries_[asset_path] = entry;
+  }
+  return true;
+}
+
+const uint8_t* AssetArchive::Find(
+    const std::string& asset_path, size_t* size) const {
+  auto entry = entries_.find(asset_path);
+  if (entry == entries_.end()) {
+    return nullptr;
+  }
+  *size = static_cast<size_t>(entry->second.Size);
+  return data_ + entry->second.Offset;
+}
+
+}  // namespace assets
+}  // namespace engine
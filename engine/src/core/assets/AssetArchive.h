@@ -0,0 +1,104 @@
+/**
+ * @file engine/src/core/assets/AssetArchive.h
+ * @brief The packed file that cooked assets ship in.
+ *
+ * An archive holds the cooked data of every asset followed by a table of
+ * contents mapping asset paths to their data. Assets whose cooked data is
+ * identical share a single copy.
+ */
+#ifndef ENGINE_SRC_CORE_ASSETS_ASSETARCHIVE_H_
+#define ENGINE_SRC_CORE_ASSETS_ASSETARCHIVE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "core/Core.h"
+#include "core/memory/VirtualArena.h"
+
+namespace engine {
+namespace assets {
+
+/**
+ * @class ArchiveWriter
+ * @brief Streams assets into an archive file, so that the whole archive never
+ * has to be held in memory.
+ */
+class ENGINE_API ArchiveWriter {
+ public:
+  ArchiveWriter() = default;
+  ~ArchiveWriter();
+
+  ArchiveWriter(const ArchiveWriter&) = delete;
+  ArchiveWriter& operator=(const ArchiveWriter&) = delete;
+
+  bool Open(const std::string& path);
+
+  /**
+   * @fn Add
+   * @brief Appends the data of an asset. Paths must be unique.
+   */
+  bool Add(const std::string& asset_path, const std::vector<uint8_t>& data);
+
+  /**
+   * @fn Finish
+   * @brief Writes the table of contents and closes the file. Archives that
+   * aren't finished are left without a valid header.
+   */
+  bool Finish();
+
+ private:
+  struct Entry {
+    std::string Path;
+    uint64_t Offset;
+    uint64_t Size;
+  };
+
+  std::ofstream file_;
+  std::vector<Entry> entries_;
+  std::unordered_map<uint64_t, size_t> entries_by_content_;
+  uint64_t offset_ = 0;
+};
+
+/**
+ * @class AssetArchive
+ * @brief A loaded archive. Its contents live in a virtual memory arena, backed
+ * by huge pages once the archive is large enough to fill one.
+ */
+class ENGINE_API AssetArchive {
+ public:
+  /**
+   * @fn Open
+   * @brief Reads an archive and its table of contents.
+   * @return false if the file can't be read or isn't a valid archive.
+   */
+  bool Open(const std::string& path);
+
+  /**
+   * @fn Find
+   * @brief Get the cooked data of an asset, or nullptr if the archive doesn't
+   * contain it. The data stays valid for the lifetime of the archive.
+   */
+  const uint8_t* Find(const std::string& asset_path, size_t* size) const;
+
+  inline size_t GetAssetCount() const { return entries_.size(); }
+
+ private:
+  struct Entry {
+    uint64_t Offset;
+    uint64_t Size;
+  };
+
+  memory::VirtualArena arena_;
+  const uint8_t* data_ = nullptr;
+  uint64_t size_ = 0;
+  std::unordered_map<std::string, Entry> entries_;
+};
+
+}  // namespace assets
+}  // namespace engine
+
+#endif  // ENGINE_SRC_CORE_ASSETS_ASSETARCHIVE_H_
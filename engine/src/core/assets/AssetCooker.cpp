@@ -0,0 +1,470 @@
+#include "core/assets/AssetCooker.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <system_error>
+#include <utility>
+
+#include "core/Log.h"
+#include "core/assets/AssetArchive.h"
+#include "core/assets/ContentHash.h"
+#include "core/jobs/JobSystem.h"
+
+namespace engine {
+namespace assets {
+
+namespace {
+
+constexpr const char* kFileRecordsName = "file_records.txt";
+
+/**
+ * Files written this recently may still change without their size or write
+ * time changing, within the resolution of the file system clock. Their
+ * records aren't saved so that they are hashed again next time.
+ */
+constexpr std::chrono::seconds kRacyWriteWindow(2);
+
+std::vector<std::string> Split(const std::string& line, char separator) {
+  std::vector<std::string> fields;
+  std::string field;
+  std::istringstream stream(line);
+  while (std::getline(stream, field, separator)) {
+    fields.push_back(field);
+  }
+  return fields;
+}
+
+}  // namespace
+
+// ---------------------------------- CONTEXT ----------------------------------
+
+CookContext::CookContext(
+    const AssetCooker& cooker,
+    const std::string& path,
+    const CookParameters& parameters,
+    const std::set<std::string>& dependencies)
+    : cooker_(cooker),
+      path_(path),
+      parameters_(parameters),
+      dependencies_(dependencies) {}
+
+std::string CookContext::GetParameter(
+    const std::string& name, const std::string& fallback) const {
+  auto parameter = parameters_.find(name);
+  return parameter != parameters_.end() ? parameter->second : fallback;
+}
+
+bool CookContext::ReadFile(
+    const std::string& path, std::vector<uint8_t>* contents) const {
+  if (dependencies_.count(path) == 0) {
+    ENGINE_CORE_ERROR(
+        "Cooking {} read {}, which isn't one of its dependencies.",
+        path_,
+        path);
+    return false;
+  }
+  return cooker_.ReadSource(path, contents);
+}
+
+// ----------------------------------- PATHS -----------------------------------
+
+std::string ResolveAssetPath(
+    const std::string& from, const std::string& reference) {
+  std::filesystem::path resolved;
+  if (!reference.empty() && reference[0] == '/') {
+    resolved = std::filesystem::path(reference.substr(1));
+  } else {
+    resolved = std::filesystem::path(from).parent_path() / reference;
+  }
+  return resolved.lexically_normal().generic_string();
+}
+
+// ---------------------------------- COOKER -----------------------------------
+
+AssetCooker::AssetCooker(
+    const std::string& source_directory, const std::string& cache_directory)
+    : source_directory_(source_directory), cache_(cache_directory) {}
+
+void AssetCooker::RegisterCooker(
+    const std::string& extension, std::unique_ptr<Cooker> cooker) {
+  cookers_[extension] = std::move(cooker);
+}
+
+void AssetCooker::AddAsset(
+    const std::string& path, const CookParameters& parameters) {
+  std::string normalized =
+      std::filesystem::path(path).lexically_normal().generic_string();
+  for (Asset& asset : assets_) {
+    if (asset.Path == normalized) {
+      ENGINE_CORE_WARN(
+          "{} was added twice, using the last parameters.", normalized);
+      asset.Parameters = parameters;
+      return;
+    }
+  }
+  assets_.push_back({ normalized, parameters });
+}
+
+bool AssetCooker::LoadAssetList(const std::string& path) {
+  std::ifstream file(path);
+  if (!file) {
+    ENGINE_CORE_ERROR("Couldn't open asset list {}.", path);
+    return false;
+  }
+
+  bool valid = true;
+  std::string line;
+  for (uint32_t number = 1; std::getline(file, line); ++number) {
+    size_t comment = line.find('#');
+    if (comment != std::string::npos) {
+      line.erase(comment);
+    }
+
+    std::istringstream tokens(line);
+    std::string asset_path, token;
+    if (!(tokens >> asset_path)) {
+      continue;
+    }
+
+    CookParameters parameters;
+    while (tokens >> token) {
+      size_t separator = token.find('=');
+      if (separator == std::string::npos || separator == 0) {
+        ENGINE_CORE_WARN(
+            "{}:{}: expected name=value but got \"{}\".", path, number, token);
+        valid = false;
+        continue;
+      }
+      parameters[token.substr(0, separator)] = token.substr(separator + 1);
+    }
+    AddAsset(asset_path, parameters);
+  }
+  return valid;
+}
+
+const Cooker* AssetCooker::FindCooker(const std::string& path) const {
+  auto cooker =
+      cookers_.find(std::filesystem::path(path).extension().string());
+  return cooker != cookers_.end() ? cooker->second.get() : nullptr;
+}
+
+std::string AssetCooker::GetScannerTag(const std::string& path) const {
+  const Cooker* cooker = FindCooker(path);
+  if (!cooker) {
+    return "";
+  }
+  return std::string(cooker->GetName()) + ":"
+      + std::to_string(cooker->GetVersion());
+}
+
+std::string AssetCooker::GetFullPath(const std::string& path) const {
+  return (std::filesystem::path(source_directory_) / path).string();
+}
+
+bool AssetCooker::ReadSource(
+    const std::string& path, std::vector<uint8_t>* data) const {
+  std::ifstream file(GetFullPath(path), std::ios::binary);
+  if (!file) {
+    return false;
+  }
+  data->assign(
+      std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+  return !file.bad();
+}
+
+/**
+ * Reuses the record of the previous cook when the file looks unchanged, which
+ * avoids reading it at all.
+ */
+AssetCooker::FileRecord AssetCooker::ScanFile(const std::string& path) const {
+  FileRecord record;
+  std::string full_path = GetFullPath(path);
+  std::error_code error;
+  if (!std::filesystem::is_regular_file(full_path, error)) {
+    return record;
+  }
+
+  record.Size = std::filesystem::file_size(full_path, error);
+  record.WriteTime = static_cast<int64_t>(
+      std::filesystem::last_write_time(full_path, error)
+          .time_since_epoch()
+          .count());
+  record.Scanner = GetScannerTag(path);
+  if (error) {
+    return record;
+  }
+
+  auto previous = previous_records_.find(path);
+  if (previous != previous_records_.end()
+      && previous->second.Size == record.Size
+      && previous->second.WriteTime == record.WriteTime
+      && previous->second.Scanner == record.Scanner) {
+    return previous->second;
+  }
+
+  std::vector<uint8_t> contents;
+  if (!ReadSource(path, &contents)) {
+    return record;
+  }
+  record.Exists = true;
+  record.Hash = HashBytes(contents.data(), contents.size());
+
+  if (const Cooker* cooker = FindCooker(path)) {
+    cooker->ScanDependencies(path, contents, &record.Dependencies);
+    for (std::string& dependency : record.Dependencies) {
+      dependency = std::filesystem::path(dependency)
+          .lexically_normal()
+          .generic_string();
+    }
+  }
+  return record;
+}
+
+/**
+ * Scans the graph breadth first, scanning every level in parallel since
+ * hashing large sources dominates.
+ */
+void AssetCooker::BuildGraph() {
+  records_.clear();
+  std::vector<std::string> frontier;
+  for (const Asset& asset : assets_) {
+    if (records_.emplace(asset.Path, FileRecord()).second) {
+      frontier.push_back(asset.Path);
+    }
+  }
+
+  while (!frontier.empty()) {
+    std::vector<FileRecord> scanned(frontier.size());
+    jobs::JobSystem::ParallelFor(
+        static_cast<uint32_t>(frontier.size()), 1,
+        [&](uint32_t begin, uint32_t end) {
+          for (uint32_t i = begin; i < end; ++i) {
+            scanned[i] = ScanFile(frontier[i]);
+          }
+        });
+
+    std::vector<std::string> next;
+    for (size_t i = 0; i < frontier.size(); ++i) {
+      for (const std::string& dependency : scanned[i].Dependencies) {
+        if (records_.emplace(dependency, FileRecord()).second) {
+          next.push_back(dependency);
+        }
+      }
+      records_[frontier[i]] = std::move(scanned[i]);
+    }
+    frontier.swap(next);
+  }
+}
+
+/**
+ * Collects every file reachable from path, including path itself. Cycles,
+ * such as includes guarded against double inclusion, are visited once.
+ */
+std::set<std::string> AssetCooker::CollectDependencies(
+    const std::string& path) const {
+  std::set<std::string> visited = { path };
+  std::vector<const std::string*> stack = { &path };
+  while (!stack.empty()) {
+    const FileRecord& record = records_.at(*stack.back());
+    stack.pop_back();
+    for (const std::string& dependency : record.Dependencies) {
+      if (visited.insert(dependency).second) {
+        stack.push_back(&dependency);
+      }
+    }
+  }
+  return visited;
+}
+
+uint64_t AssetCooker::ComputeKey(
+    const Asset& asset, const std::set<std::string>& dependencies) const {
+  const Cooker* cooker = FindCooker(asset.Path);
+  ContentHasher hasher;
+  hasher.AddString(cooker->GetName());
+  hasher.Add(cooker->GetVersion());
+  hasher.AddString(asset.Path);
+
+  hasher.Add(static_cast<uint64_t>(asset.Parameters.size()));
+  for (const auto& parameter : asset.Parameters) {
+    hasher.AddString(parameter.first);
+    hasher.AddString(parameter.second);
+  }
+
+  hasher.Add(static_cast<uint64_t>(dependencies.size()));
+  for (const std::string& dependency : dependencies) {
+    hasher.AddString(dependency);
+    hasher.Add(records_.at(dependency).Hash);
+  }
+  return hasher.Finish();
+}
+
+bool AssetCooker::Cook(
+    const std::string& archive_path, CookStatistics* statistics) {
+  LoadFileRecords();
+  BuildGraph();
+
+  std::vector<uint64_t> keys(assets_.size());
+  std::atomic<uint32_t> cooked(0), cached(0), failed(0);
+  auto cook_assets = [&](uint32_t begin, uint32_t end) {
+    for (uint32_t i = begin; i < end; ++i) {
+      const Asset& asset = assets_[i];
+      const Cooker* cooker = FindCooker(asset.Path);
+      if (!cooker) {
+        ENGINE_CORE_ERROR("There is no cooker for {}.", asset.Path);
+        ++failed;
+        continue;
+      }
+
+      std::set<std::string> dependencies = CollectDependencies(asset.Path);
+      bool missing = false;
+      for (const std::string& dependency : dependencies) {
+        if (!records_.at(dependency).Exists) {
+          ENGINE_CORE_ERROR(
+              "{} needs {}, which doesn't exist.", asset.Path, dependency);
+          missing = true;
+        }
+      }
+      if (missing) {
+        ++failed;
+        continue;
+      }
+
+      keys[i] = ComputeKey(asset, dependencies);
+      if (cache_.Contains(keys[i])) {
+        ++cached;
+        continue;
+      }
+
+      CookContext context(*this, asset.Path, asset.Parameters, dependencies);
+      std::vector<uint8_t> output;
+      if (!cooker->Cook(context, &output) || !cache_.Store(keys[i], output)) {
+        ENGINE_CORE_ERROR("Failed to cook {}.", asset.Path);
+        ++failed;
+        continue;
+      }
+      ++cooked;
+    }
+  };
+  jobs::JobSystem::ParallelFor(
+      static_cast<uint32_t>(assets_.size()), 1, cook_assets);
+
+  SaveFileRecords();
+
+  if (statistics) {
+    statistics->Cooked = cooked;
+    statistics->Cached = cached;
+    statistics->Failed = failed;
+  }
+
+  if (failed > 0) {
+    ENGINE_CORE_ERROR(
+        "{} of {} assets failed to cook, not writing {}.",
+        failed.load(),
+        assets_.size(),
+        archive_path);
+    return false;
+  }
+
+  ArchiveWriter archive;
+  if (!archive.Open(archive_path)) {
+    return false;
+  }
+  std::vector<uint8_t> data;
+  for (size_t i = 0; i < assets_.size(); ++i) {
+    if (!cache_.Load(keys[i], &data) || !archive.Add(assets_[i].Path, data)) {
+      ENGINE_CORE_ERROR(
+          "Couldn't pack {} into {}.", assets_[i].Path, archive_path);
+      return false;
+    }
+  }
+  if (!archive.Finish()) {
+    ENGINE_CORE_ERROR("Couldn't write {}.", archive_path);
+    return false;
+  }
+
+  ENGINE_CORE_INFO(
+      "Packed {} assets into {}, {} cooked and {} from the cache.",
+      assets_.size(),
+      archive_path,
+      cooked.load(),
+      cached.load());
+  return true;
+}
+
+// ---------------------------------- RECORDS ----------------------------------
+
+/**
+ * Every line holds the tab separated path, size, write time, hash and scanner
+ * of a file followed by its dependencies.
+ */
+void AssetCooker::LoadFileRecords() {
+  previous_records_.clear();
+  std::ifstream file(
+      (std::filesystem::path(cache_.GetDirectory()) / kFileRecordsName)
+          .string());
+
+  std::string line;
+  while (std::getline(file, line)) {
+    std::vector<std::string> fields = Split(line, '\t');
+    if (fields.size() < 4) {
+      continue;
+    }
+
+    FileRecord record;
+    record.Exists = true;
+    record.Size = std::strtoull(fields[1].c_str(), nullptr, 10);
+    record.WriteTime = std::strtoll(fields[2].c_str(), nullptr, 10);
+    record.Hash = std::strtoull(fields[3].c_str(), nullptr, 16);
+    if (fields.size() > 4) {
+      record.Scanner = fields[4];
+      record.Dependencies.assign(fields.begin() + 5, fields.end());
+    }
+    previous_records_[fields[0]] = std::move(record);
+  }
+}
+
+void AssetCooker::SaveFileRecords() const {
+  std::filesystem::path path =
+      std::filesystem::path(cache_.GetDirectory()) / kFileRecordsName;
+  std::filesystem::path temporary = path;
+  temporary += ".tmp";
+
+  int64_t racy_after = static_cast<int64_t>(
+      (std::filesystem::file_time_type::clock::now() - kRacyWriteWindow)
+          .time_since_epoch()
+          .count());
+  {
+    std::ofstream file(temporary.string(), std::ios::trunc);
+    for (const auto& entry : records_) {
+      const FileRecord& record = entry.second;
+      if (!record.Exists || record.WriteTime >= racy_after) {
+        continue;
+      }
+
+      file << entry.first << '\t' << record.Size << '\t' << record.WriteTime
+           << '\t' << FormatHash(record.Hash) << '\t' << record.Scanner;
+      for (const std::string& dependency : record.Dependencies) {
+        file << '\t' << dependency;
+      }
+      file << '\n';
+    }
+    if (!file) {
+      ENGINE_CORE_WARN("Couldn't write {}.", temporary.string());
+      return;
+    }
+  }
+
+  std::error_code error;
+  std::filesystem::rename(temporary, path, error);
+  if (error) {
+    ENGINE_CORE_WARN("Couldn't write {}: {}", path.string(), error.message());
+  }
+}
+
+}  // namespace assets
+}  // namespace engine
@@ -0,0 +1,244 @@
+/**
+ * @file engine/src/core/assets/AssetCooker.h
+ * @brief Incremental cooking of source assets into a packed archive.
+ *
+ * Every asset is cooked by the Cooker registered for its extension. Cookers
+ * also report which files an asset depends on, such as the shader of a
+ * material or the includes of a shader, and the cooker follows those edges to
+ * build the full dependency graph.
+ *
+ * The cooked data of an asset is stored in a ContentCache under the hash of
+ * everything that can affect it: the cooker and its version, the cook
+ * parameters, and the contents of the asset and every file it transitively
+ * depends on. Cooking an asset whose key is already in the cache is skipped,
+ * so editing a single texture only recooks that texture, and editing a shader
+ * include only recooks the shaders and materials that reach it.
+ *
+ * Hashing every source on every cook would still read the whole project, so
+ * file hashes and scanned dependencies are remembered between cooks and only
+ * recomputed for files whose size or modification time changed.
+ */
+#ifndef ENGINE_SRC_CORE_ASSETS_ASSETCOOKER_H_
+#define ENGINE_SRC_CORE_ASSETS_ASSETCOOKER_H_
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "core/Core.h"
+#include "core/assets/ContentCache.h"
+
+namespace engine {
+namespace assets {
+
+/**
+ * @typedef CookParameters
+ * @brief Named settings for cooking an asset, such as the texture format.
+ * Ordered so that they hash the same regardless of insertion order.
+ */
+typedef std::map<std::string, std::string> CookParameters;
+
+class AssetCooker;
+
+/**
+ * @class CookContext
+ * @brief What a cooker gets to see of the asset it cooks.
+ */
+class ENGINE_API CookContext {
+ public:
+  inline const std::string& GetPath() const { return path_; }
+  inline const CookParameters& GetParameters() const { return parameters_; }
+
+  /**
+   * @fn GetParameter
+   * @brief Get the value of a parameter, or fallback if it isn't set.
+   */
+  std::string GetParameter(
+      const std::string& name, const std::string& fallback) const;
+
+  /**
+   * @fn ReadFile
+   * @param path A path relative to the source directory.
+   * @brief Reads the asset itself or one of the files it depends on. Reading
+   * any other file fails, since changes to it wouldn't cause a recook.
+   */
+  bool ReadFile(const std::string& path, std::vector<uint8_t>* contents) const;
+
+ private:
+  CookContext(
+      const AssetCooker& cooker,
+      const std::string& path,
+      const CookParameters& parameters,
+      const std::set<std::string>& dependencies);
+
+  const AssetCooker& cooker_;
+  const std::string& path_;
+  const CookParameters& parameters_;
+  const std::set<std::string>& dependencies_;
+
+  friend class AssetCooker;
+};
+
+/**
+ * @class Cooker
+ * @brief Turns source assets of one kind into their runtime format.
+ *
+ * Cookers are called from multiple threads at once and must not keep state
+ * between calls.
+ */
+class ENGINE_API Cooker {
+ public:
+  virtual ~Cooker() = default;
+
+  virtual const char* GetName() const = 0;
+
+  /**
+   * @fn GetVersion
+   * @brief Must be bumped whenever the cooked output changes, which makes
+   * every asset of this kind cook again.
+   */
+  virtual uint32_t GetVersion() const = 0;
+
+  /**
+   * @fn ScanDependencies
+   * @param path The path of the file relative to the source directory.
+   * @param source The contents of the file.
+   * @param dependencies Receives the paths of the files it depends on,
+   * relative to the source directory.
+   * @brief Finds the direct dependencies of a file. Also called for
+   * dependencies of other assets that have this cookers extension, such as
+   * includes of includes.
+   */
+  virtual void ScanDependencies(
+      const std::string& path,
+      const std::vector<uint8_t>& source,
+      std::vector<std::string>* dependencies) const {}
+
+  /**
+   * @fn Cook
+   * @brief Produces the cooked data of an asset. Errors should be logged
+   * before returning false.
+   */
+  virtual bool Cook(
+      const CookContext& context, std::vector<uint8_t>* output) const = 0;
+};
+
+/**
+ * @struct CookStatistics
+ * @brief What happened to the assets in a cook.
+ */
+struct CookStatistics {
+  uint32_t Cooked = 0;
+  uint32_t Cached = 0;
+  uint32_t Failed = 0;
+};
+
+/**
+ * @fn ResolveAssetPath
+ * @param from The path of the file containing the reference.
+ * @param reference A path relative to the directory of from.
+ * @brief Get the path of the reference relative to the source directory.
+ */
+ENGINE_API std::string ResolveAssetPath(
+    const std::string& from, const std::string& reference);
+
+/**
+ * @class AssetCooker
+ * @brief Cooks a list of assets into an archive.
+ */
+class ENGINE_API AssetCooker {
+ public:
+  AssetCooker(
+      const std::string& source_directory, const std::string& cache_directory);
+
+  /**
+   * @fn RegisterCooker
+   * @param extension The extension including the dot, e.g. ".glsl".
+   */
+  void RegisterCooker(const std::string& extension, std::unique_ptr<Cooker>);
+
+  /**
+   * @fn AddAsset
+   * @param path A path relative to the source directory.
+   * @brief Adds an asset to be cooked and packed into the archive.
+   */
+  void AddAsset(
+      const std::string& path, const CookParameters& parameters = {});
+
+  /**
+   * @fn LoadAssetList
+   * @brief Adds every asset listed in a file. Every line holds a path
+   * followed by any number of name=value parameters, and everything after a
+   * # is a comment:
+   *
+   *   textures/stone.tga format=bc7 quality=high
+   *   materials/stone.mat
+   *
+   * @return false if the file couldn't be opened or has invalid lines.
+   */
+  bool LoadAssetList(const std::string& path);
+
+  /**
+   * @fn Cook
+   * @param archive_path Where to write the archive.
+   * @param statistics Receives what happened to each asset, or nullptr.
+   * @brief Cooks every asset that isn't cached in parallel and then packs
+   * all of them into the archive.
+   * @return false if any asset failed, in which case no archive is written.
+   */
+  bool Cook(
+      const std::string& archive_path, CookStatistics* statistics = nullptr);
+
+ private:
+  /**
+   * A source file in the dependency graph, along with the size and write
+   * time its hash was computed for.
+   */
+  struct FileRecord {
+    bool Exists = false;
+    uint64_t Size = 0;
+    int64_t WriteTime = 0;
+    uint64_t Hash = 0;
+    std::string Scanner;
+    std::vector<std::string> Dependencies;
+  };
+
+  struct Asset {
+    std::string Path;
+    CookParameters Parameters;
+  };
+
+  const Cooker* FindCooker(const std::string& path) const;
+  std::string GetScannerTag(const std::string& path) const;
+  std::string GetFullPath(const std::string& path) const;
+  bool ReadSource(const std::string& path, std::vector<uint8_t>* data) const;
+
+  FileRecord ScanFile(const std::string& path) const;
+  void BuildGraph();
+  std::set<std::string> CollectDependencies(const std::string& path) const;
+  uint64_t ComputeKey(
+      const Asset& asset, const std::set<std::string>& dependencies) const;
+
+  void LoadFileRecords();
+  void SaveFileRecords() const;
+
+  std::string source_directory_;
+  ContentCache cache_;
+  std::unordered_map<std::string, std::unique_ptr<Cooker>> cookers_;
+  std::vector<Asset> assets_;
+
+  // Records from the previous cook, and the graph of the current one.
+  std::unordered_map<std::string, FileRecord> previous_records_;
+  std::unordered_map<std::string, FileRecord> records_;
+
+  friend class CookContext;
+};
+
+}  // namespace assets
+}  // namespace engine
+
+#endif  // ENGINE_SRC_CORE_ASSETS_ASSETCOOKER_H_
@@ -0,0 +1,655 @@
+#include "core/assets/BlockCompression.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace engine {
+namespace assets {
+
+namespace {
+
+/**
+ * A block with the pixels of every channel stored contiguously, so that four
+ * pixels of a channel can be loaded into a single register.
+ */
+struct Block {
+  alignas(16) float Channels[4][kBlockPixels];
+};
+
+void LoadBlock(const uint8_t* rgba, Block* block) {
+  for (uint32_t pixel = 0; pixel < kBlockPixels; ++pixel) {
+    for (uint32_t channel = 0; channel < 4; ++channel) {
+      block->Channels[channel][pixel] = rgba[pixel * 4 + channel];
+    }
+  }
+}
+
+typedef float Palette[16][4];
+
+/**
+ * Chooses the palette entry nearest to every pixel in the first channel_count
+ * channels and returns the summed squared error of the block.
+ */
+float SelectIndices(
+    const Block& block,
+    uint32_t channel_count,
+    const Palette& palette,
+    uint32_t palette_size,
+    uint8_t* indices) {
+  float total = 0.0f;
+#if defined(__SSE2__)
+  for (uint32_t pixel = 0; pixel < kBlockPixels; pixel += 4) {
+    __m128 values[4];
+    for (uint32_t channel = 0; channel < channel_count; ++channel) {
+      values[channel] = _mm_load_ps(&block.Channels[channel][pixel]);
+    }
+
+    __m128 best_error = _mm_set1_ps(FLT_MAX);
+    __m128i best_index = _mm_setzero_si128();
+    for (uint32_t entry = 0; entry < palette_size; ++entry) {
+      __m128 error = _mm_setzero_ps();
+      for (uint32_t channel = 0; channel < channel_count; ++channel) {
+        __m128 difference = _mm_sub_ps(
+            values[channel], _mm_set1_ps(palette[entry][channel]));
+        error = _mm_add_ps(error, _mm_mul_ps(difference, difference));
+      }
+
+      __m128i closer = _mm_castps_si128(_mm_cmplt_ps(error, best_error));
+      best_error = _mm_min_ps(error, best_error);
+      best_index = _mm_or_si128(
+          _mm_andnot_si128(closer, best_index),
+          _mm_and_si128(closer, _mm_set1_epi32(static_cast<int>(entry))));
+    }
+
+    alignas(16) int32_t lane_indices[4];
+    alignas(16) float lane_errors[4];
+    _mm_store_si128(reinterpret_cast<__m128i*>(lane_indices), best_index);
+    _mm_store_ps(lane_errors, best_error);
+    for (uint32_t lane = 0; lane < 4; ++lane) {
+      indices[pixel + lane] = static_cast<uint8_t>(lane_indices[lane]);
+      total += lane_errors[lane];
+    }
+  }
+#else
+  for (uint32_t pixel = 0; pixel < kBlockPixels; ++pixel) {
+    float best_error = FLT_MAX;
+    uint8_t best_index = 0;
+    for (uint32_t entry = 0; entry < palette_size; ++entry) {
+      float error = 0.0f;
+      for (uint32_t channel = 0; channel < channel_count; ++channel) {
+        float difference =
+            block.Channels[channel][pixel] - palette[entry][channel];
+        error += difference * difference;
+      }
+      if (error < best_error) {
+        best_error = error;
+        best_index = static_cast<uint8_t>(entry);
+      }
+    }
+    indices[pixel] = best_index;
+    total += best_error;
+  }
+#endif
+  return total;
+}
+
+/**
+ * Fits endpoints to the principal axis of the pixels, found by power
+ * iteration on their covariance, and places them at the extreme projections.
+ */
+void FitPrincipalAxis(
+    const Block& block, uint32_t channel_count, float* low, float* high) {
+  float mean[4] = {};
+  for (uint32_t channel = 0; channel < channel_count; ++channel) {
+    for (uint32_t pixel = 0; pixel < kBlockPixels; ++pixel) {
+      mean[channel] += block.Channels[channel][pixel];
+    }
+    mean[channel] /= kBlockPixels;
+  }
+
+  float covariance[4][4] = {};
+  for (uint32_t pixel = 0; pixel < kBlockPixels; ++pixel) {
+    for (uint32_t row = 0; row < channel_count; ++row) {
+      float a = block.Channels[row][pixel] - mean[row];
+      for (uint32_t column = 0; column < channel_count; ++column) {
+        float b = block.Channels[column][pixel] - mean[column];
+        covariance[row][column] += a * b;
+      }
+    }
+  }
+
+  // Starting from the row with the largest variance avoids starting
+  // orthogonal to the principal axis.
+  uint32_t start = 0;
+  for (uint32_t channel = 1; channel < channel_count; ++channel) {
+    if (covariance[channel][channel] > covariance[start][start]) {
+      start = channel;
+    }
+  }
+
+  float axis[4] = {};
+  for (uint32_t channel = 0; channel < channel_count; ++channel) {
+    axis[channel] = covariance[start][channel];
+  }
+  for (int iteration = 0; iteration < 8; ++iteration) {
+    float next[4] = {};
+    float length = 0.0f;
+    for (uint32_t row = 0; row < channel_count; ++row) {
+      for (uint32_t column = 0; column < channel_count; ++column) {
+        next[row] += covariance[row][column] * axis[column];
+      }
+      length = std::max(length, std::abs(next[row]));
+    }
+    if (length < FLT_EPSILON) {
+      break;
+    }
+    for (uint32_t channel = 0; channel < channel_count; ++channel) {
+      axis[channel] = next[channel] / length;
+    }
+  }
+
+  float length_squared = 0.0f;
+  for (uint32_t channel = 0; channel < channel_count; ++channel) {
+    length_squared += axis[channel] * axis[channel];
+  }
+
+  float min_projection = 0.0f, max_projection = 0.0f;
+  if (length_squared > FLT_EPSILON) {
+    min_projection = FLT_MAX;
+    max_projection = -FLT_MAX;
+    for (uint32_t pixel = 0; pixel < kBlockPixels; ++pixel) {
+      float projection = 0.0f;
+      for (uint32_t channel = 0; channel < channel_count; ++channel) {
+        projection +=
+            (block.Channels[channel][pixel] - mean[channel]) * axis[channel];
+      }
+      min_projection = std::min(min_projection, projection);
+      max_projection = std::max(max_projection, projection);
+    }
+    min_projection /= length_squared;
+    max_projection /= length_squared;
+  }
+
+  for (uint32_t channel = 0; channel < channel_count; ++channel) {
+    low[channel] = std::min(
+        std::max(mean[channel] + axis[channel] * min_projection, 0.0f),
+        255.0f);
+    high[channel] = std::min(
+        std::max(mean[channel] + axis[channel] * max_projection, 0.0f),
+        255.0f);
+  }
+}
+
+/**
+ * Solves for the endpoints that minimize the squared error of the block for
+ * fixed indices, where weights maps every index to its position between the
+ * endpoints. Returns false when every pixel uses the same weight and the
+ * system has no unique solution.
+ */
+bool FitEndpoints(
+    const Block& block,
+    uint32_t channel_count,
+    const uint8_t* indices,
+    const float* weights,
+    float* endpoint0,
+    float* endpoint1) {
+  float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+  float ax[4] = {}, bx[4] = {};
+  for (uint32_t pixel = 0; pixel < kBlockPixels; ++pixel) {
+    float b = weights[indices[pixel]];
+    float a = 1.0f - b;
+    aa += a * a;
+    ab += a * b;
+    bb += b * b;
+    for (uint32_t channel = 0; channel < channel_count; ++channel) {
+      ax[channel] += a * block.Channels[channel][pixel];
+      bx[channel] += b * block.Channels[channel][pixel];
+    }
+  }
+
+  float determinant = aa * bb - ab * ab;
+  if (std::abs(determinant) < 1e-6f) {
+    return false;
+  }
+
+  float inverse = 1.0f / determinant;
+  for (uint32_t channel = 0; channel < channel_count; ++channel) {
+    float a = (ax[channel] * bb - bx[channel] * ab) * inverse;
+    float b = (bx[channel] * aa - ax[channel] * ab) * inverse;
+    endpoint0[channel] = std::min(std::max(a, 0.0f), 255.0f);
+    endpoint1[channel] = std::min(std::max(b, 0.0f), 255.0f);
+  }
+  return true;
+}
+
+int RefinementIterations(CompressionQuality quality) {
+  switch (quality) {
+    case CompressionQuality::kFast:
+      return 0;
+    case CompressionQuality::kNormal:
+      return 2;
+    case CompressionQuality::kHigh:
+      return 4;
+  }
+  return 0;
+}
+
+// ------------------------------------ BC1 ------------------------------------
+
+// Indices 2 and 3 lie a third and two thirds of the way from c0 to c1.
+const float kBc1Weights[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+
+uint16_t PackColor565(const float* color) {
+  auto quantize = [](float value, float max) {
+    return static_cast<uint16_t>(std::lround(value * max / 255.0f));
+  };
+  return static_cast<uint16_t>(
+      (quantize(color[0], 31.0f) << 11) | (quantize(color[1], 63.0f) << 5)
+      | quantize(color[2], 31.0f));
+}
+
+void UnpackColor565(uint16_t packed, float* color) {
+  uint32_t red = (packed >> 11) & 31, green = (packed >> 5) & 63;
+  uint32_t blue = packed & 31;
+  color[0] = static_cast<float>((red << 3) | (red >> 2));
+  color[1] = static_cast<float>((green << 2) | (green >> 4));
+  color[2] = static_cast<float>((blue << 3) | (blue >> 2));
+  color[3] = 0.0f;
+}
+
+void BuildBc1Palette(uint16_t color0, uint16_t color1, Palette* palette) {
+  UnpackColor565(color0, (*palette)[0]);
+  UnpackColor565(color1, (*palette)[1]);
+  for (uint32_t channel = 0; channel < 3; ++channel) {
+    float a = (*palette)[0][channel], b = (*palette)[1][channel];
+    (*palette)[2][channel] = (2.0f * a + b) / 3.0f;
+    (*palette)[3][channel] = (a + 2.0f * b) / 3.0f;
+  }
+}
+
+/**
+ * The four color mode is selected by color0 > color1, so the endpoints are
+ * swapped if necessary. Swapping exchanges indices 0 with 1 and 2 with 3.
+ */
+void WriteBc1Block(
+    uint16_t color0, uint16_t color1, uint8_t* indices, uint8_t* out) {
+  if (color0 < color1) {
+    std::swap(color0, color1);
+    for (uint32_t pixel = 0; pixel < kBlockPixels; ++pixel) {
+      indices[pixel] ^= 1;
+    }
+  } else if (color0 == color1) {
+    std::fill(indices, indices + kBlockPixels, 0);
+  }
+
+  uint32_t bits = 0;
+  for (uint32_t pixel = 0; pixel < kBlockPixels; ++pixel) {
+    bits |= static_cast<uint32_t>(indices[pixel]) << (pixel * 2);
+  }
+
+  out[0] = static_cast<uint8_t>(color0);
+  out[1] = static_cast<uint8_t>(color0 >> 8);
+  out[2] = static_cast<uint8_t>(color1);
+  out[3] = static_cast<uint8_t>(color1 >> 8);
+  for (uint32_t byte = 0; byte < 4; ++byte) {
+    out[4 + byte] = static_cast<uint8_t>(bits >> (byte * 8));
+  }
+}
+
+// ------------------------------------ BC4 ------------------------------------
+
+// With endpoint0 > endpoint1 the six remaining indices interpolate in sevenths.
+const float kBc4Weights[8] = {
+    0.0f, 1.0f, 1.0f / 7.0f, 2.0f / 7.0f,
+    3.0f / 7.0f, 4.0f / 7.0f, 5.0f / 7.0f, 6.0f / 7.0f };
+
+void BuildBc4Palette(uint8_t endpoint0, uint8_t endpoint1, Palette* palette) {
+  for (uint32_t entry = 0; entry < 8; ++entry) {
+    float weight = kBc4Weights[entry];
+    (*palette)[entry][0] = endpoint0 * (1.0f - weight) + endpoint1 * weight;
+  }
+}
+
+// ------------------------------------ BC7 ------------------------------------
+
+const uint32_t kBc7Weights[16] = {
+    0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+/**
+ * A mode 6 endpoint. Every channel decodes to its 7 bit value followed by the
+ * endpoint's p-bit.
+ */
+struct Bc7Endpoint {
+  uint8_t Values[4];
+  uint8_t PBit;
+
+  inline uint32_t Decode(uint32_t channel) const {
+    return (static_cast<uint32_t>(Values[channel]) << 1) | PBit;
+  }
+};
+
+Bc7Endpoint QuantizeBc7Endpoint(const float* color, uint8_t p_bit) {
+  Bc7Endpoint endpoint;
+  endpoint.PBit = p_bit;
+  for (uint32_t channel = 0; channel < 4; ++channel) {
+    long value = std::lround((color[channel] - p_bit) * 0.5f);
+    endpoint.Values[channel] =
+        static_cast<uint8_t>(std::min(std::max(value, 0l), 127l));
+  }
+  return endpoint;
+}
+
+/**
+ * Chooses the p-bit that reproduces the unquantized endpoint most closely.
+ */
+Bc7Endpoint QuantizeBc7Endpoint(const float* color) {
+  Bc7Endpoint best;
+  float best_error = FLT_MAX;
+  for (uint8_t p_bit = 0; p_bit < 2; ++p_bit) {
+    Bc7Endpoint endpoint = QuantizeBc7Endpoint(color, p_bit);
+    float error = 0.0f;
+    for (uint32_t channel = 0; channel < 4; ++channel) {
+      float difference = color[channel] - endpoint.Decode(channel);
+      error += difference * difference;
+    }
+    if (error < best_error) {
+      best_error = error;
+      best = endpoint;
+    }
+  }
+  return best;
+}
+
+/**
+ * Decodes the palette exactly as the hardware does and selects the indices.
+ */
+float EvaluateBc7(
+    const Block& block,
+    const Bc7Endpoint& endpoint0,
+    const Bc7Endpoint& endpoint1,
+    uint8_t* indices) {
+  Palette palette;
+  for (uint32_t entry = 0; entry < 16; ++entry) {
+    uint32_t weight = kBc7Weights[entry];
+    for (uint32_t channel = 0; channel < 4; ++channel) {
+      uint32_t value = ((64 - weight) * endpoint0.Decode(channel)
+          + weight * endpoint1.Decode(channel) + 32) >> 6;
+      palette[entry][channel] = static_cast<float>(value);
+    }
+  }
+  return SelectIndices(block, 4, palette, 16, indices);
+}
+
+struct Bc7Candidate {
+  Bc7Endpoint Endpoints[2];
+  uint8_t Indices[kBlockPixels];
+  float Error = FLT_MAX;
+};
+
+/**
+ * Quantizes a pair of endpoints and keeps them if they beat the best
+ * candidate so far. At high quality every combination of p-bits is
+ * evaluated instead of choosing them per endpoint.
+ */
+bool TryBc7Endpoints(
+    const Block& block,
+    const float* low,
+    const float* high,
+    bool search_p_bits,
+    Bc7Candidate* best) {
+  bool improved = false;
+  if (search_p_bits) {
+    for (uint8_t p_bits = 0; p_bits < 4; ++p_bits) {
+      Bc7Candidate candidate;
+      candidate.Endpoints[0] = QuantizeBc7Endpoint(low, p_bits & 1);
+      candidate.Endpoints[1] = QuantizeBc7Endpoint(high, p_bits >> 1);
+      candidate.Error = EvaluateBc7(
+          block, candidate.Endpoints[0], candidate.Endpoints[1],
+          candidate.Indices);
+      if (candidate.Error < best->Error) {
+        *best = candidate;
+        improved = true;
+      }
+    }
+    return improved;
+  }
+
+  Bc7Candidate candidate;
+  candidate.Endpoints[0] = QuantizeBc7Endpoint(low);
+  candidate.Endpoints[1] = QuantizeBc7Endpoint(high);
+  candidate.Error = EvaluateBc7(
+      block, candidate.Endpoints[0], candidate.Endpoints[1],
+      candidate.Indices);
+  if (candidate.Error < best->Error) {
+    *best = candidate;
+    improved = true;
+  }
+  return improved;
+}
+
+/**
+ * Moves single quantized endpoint channels by one step for as long as that
+ * lowers the error. This recovers error lost to rounding the least squares
+ * solution.
+ */
+void NudgeBc7Endpoints(const Block& block, Bc7Candidate* best) {
+  for (int pass = 0; pass < 2; ++pass) {
+    bool improved = false;
+    for (uint32_t endpoint = 0; endpoint < 2; ++endpoint) {
+      for (uint32_t channel = 0; channel < 4; ++channel) {
+        for (int step = -1; step <= 1; step += 2) {
+          int value = best->Endpoints[endpoint].Values[channel] + step;
+          if (value < 0 || value > 127) {
+            continue;
+          }
+
+          Bc7Candidate candidate = *best;
+          candidate.Endpoints[endpoint].Values[channel] =
+              static_cast<uint8_t>(value);
+          candidate.Error = EvaluateBc7(
+              block, candidate.Endpoints[0], candidate.Endpoints[1],
+              candidate.Indices);
+          if (candidate.Error < best->Error) {
+            *best = candidate;
+            improved = true;
+          }
+        }
+      }
+    }
+    if (!improved) {
+      return;
+    }
+  }
+}
+
+/**
+ * Writes bits least significant first, as every BCn format is laid out.
+ */
+class BitWriter {
+ public:
+  explicit BitWriter(uint8_t* out) : out_(out) {}
+
+  void Write(uint32_t value, uint32_t bit_count) {
+    for (uint32_t bit = 0; bit < bit_count; ++bit, ++position_) {
+      out_[position_ >> 3] |=
+          static_cast<uint8_t>(((value >> bit) & 1) << (position_ & 7));
+    }
+  }
+
+ private:
+  uint8_t* out_;
+  uint32_t position_ = 0;
+};
+
+/**
+ * The most significant index bit of the first pixel is implied to be zero,
+ * so the endpoints are swapped and the indices mirrored if it is set. The
+ * weights are symmetric, so this decodes to the same colors.
+ */
+void WriteBc7Block(Bc7Candidate* candidate, uint8_t* out) {
+  if (candidate->Indices[0] & 8) {
+    std::swap(candidate->Endpoints[0], candidate->Endpoints[1]);
+    for (uint32_t pixel = 0; pixel < kBlockPixels; ++pixel) {
+      candidate->Indices[pixel] =
+          static_cast<uint8_t>(15 - candidate->Indices[pixel]);
+    }
+  }
+
+  std::memset(out, 0, 16);
+  BitWriter writer(out);
+  writer.Write(1 << 6, 7);
+  for (uint32_t channel = 0; channel < 4; ++channel) {
+    writer.Write(candidate->Endpoints[0].Values[channel], 7);
+    writer.Write(candidate->Endpoints[1].Values[channel], 7);
+  }
+  writer.Write(candidate->Endpoints[0].PBit, 1);
+  writer.Write(candidate->Endpoints[1].PBit, 1);
+  writer.Write(candidate->Indices[0], 3);
+  for (uint32_t pixel = 1; pixel < kBlockPixels; ++pixel) {
+    writer.Write(candidate->Indices[pixel], 4);
+  }
+}
+
+}  // namespace
+
+void EncodeBc1Block(
+    const uint8_t* rgba, uint8_t* out, CompressionQuality quality) {
+  Block block;
+  LoadBlock(rgba, &block);
+
+  float low[4], high[4];
+  FitPrincipalAxis(block, 3, low, high);
+
+  uint16_t color0 = PackColor565(high), color1 = PackColor565(low);
+  uint8_t indices[kBlockPixels];
+  Palette palette;
+  BuildBc1Palette(color0, color1, &palette);
+  float error = SelectIndices(block, 3, palette, 4, indices);
+
+  for (int i = 0; i < RefinementIterations(quality); ++i) {
+    if (!FitEndpoints(block, 3, indices, kBc1Weights, high, low)) {
+      break;
+    }
+
+    uint16_t refined0 = PackColor565(high), refined1 = PackColor565(low);
+    if (refined0 == color0 && refined1 == color1) {
+      break;
+    }
+
+    uint8_t refined_indices[kBlockPixels];
+    BuildBc1Palette(refined0, refined1, &palette);
+    float refined_error =
+        SelectIndices(block, 3, palette, 4, refined_indices);
+    if (refined_error >= error) {
+      break;
+    }
+
+    color0 = refined0;
+    color1 = refined1;
+    error = refined_error;
+    std::copy(refined_indices, refined_indices + kBlockPixels, indices);
+  }
+
+  WriteBc1Block(color0, color1, indices, out);
+}
+
+void EncodeBc3Block(
+    const uint8_t* rgba, uint8_t* out, CompressionQuality quality) {
+  EncodeBc4Block(rgba, out, 3);
+  EncodeBc1Block(rgba, out + 8, quality);
+}
+
+/**
+ * Always uses the eight value mode. The six value mode only helps blocks that
+ * contain both exact 0 and 255 alongside intermediate values, which the
+ * least squares refinement handles well enough.
+ */
+void EncodeBc4Block(const uint8_t* rgba, uint8_t* out, uint32_t channel) {
+  Block block;
+  uint8_t min = 255, max = 0;
+  for (uint32_t pixel = 0; pixel < kBlockPixels; ++pixel) {
+    uint8_t value = rgba[pixel * 4 + channel];
+    block.Channels[0][pixel] = value;
+    min = std::min(min, value);
+    max = std::max(max, value);
+  }
+
+  uint8_t indices[kBlockPixels] = {};
+  uint8_t endpoint0 = max, endpoint1 = min;
+  if (max > min) {
+    Palette palette;
+    BuildBc4Palette(endpoint0, endpoint1, &palette);
+    float error = SelectIndices(block, 1, palette, 8, indices);
+
+    float fit0, fit1;
+    if (FitEndpoints(block, 1, indices, kBc4Weights, &fit0, &fit1)) {
+      long refined0 = std::lround(fit0), refined1 = std::lround(fit1);
+      if (refined0 > refined1) {
+        uint8_t refined_indices[kBlockPixels];
+        BuildBc4Palette(
+            static_cast<uint8_t>(refined0), static_cast<uint8_t>(refined1),
+            &palette);
+        if (SelectIndices(block, 1, palette, 8, refined_indices) < error) {
+          endpoint0 = static_cast<uint8_t>(refined0);
+          endpoint1 = static_cast<uint8_t>(refined1);
+          std::copy(refined_indices, refined_indices + kBlockPixels, indices);
+        }
+      }
+    }
+  }
+
+  uint64_t bits = 0;
+  for (uint32_t pixel = 0; pixel < kBlockPixels; ++pixel) {
+    bits |= static_cast<uint64_t>(indices[pixel]) << (pixel * 3);
+  }
+
+  out[0] = endpoint0;
+  out[1] = endpoint1;
+  for (uint32_t byte = 0; byte < 6; ++byte) {
+    out[2 + byte] = static_cast<uint8_t>(bits >> (byte * 8));
+  }
+}
+
+void EncodeBc5Block(const uint8_t* rgba, uint8_t* out) {
+  EncodeBc4Block(rgba, out, 0);
+  EncodeBc4Block(rgba, out + 8, 1);
+}
+
+void EncodeBc7Block(
+    const uint8_t* rgba, uint8_t* out, CompressionQuality quality) {
+  Block block;
+  LoadBlock(rgba, &block);
+
+  bool high_quality = quality == CompressionQuality::kHigh;
+  float low[4], high[4];
+  FitPrincipalAxis(block, 4, low, high);
+
+  Bc7Candidate best;
+  TryBc7Endpoints(block, low, high, high_quality, &best);
+
+  for (int i = 0; i < RefinementIterations(quality); ++i) {
+    float weights[16];
+    for (uint32_t entry = 0; entry < 16; ++entry) {
+      weights[entry] = kBc7Weights[entry] / 64.0f;
+    }
+    if (!FitEndpoints(block, 4, best.Indices, weights, low, high)
+        || !TryBc7Endpoints(block, low, high, high_quality, &best)) {
+      break;
+    }
+  }
+
+  if (high_quality) {
+    NudgeBc7Endpoints(block, &best);
+  }
+
+  WriteBc7Block(&best, out);
+}
+
+}  // namespace assets
+}  // namespace engine
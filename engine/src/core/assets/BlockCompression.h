@@ -0,0 +1,101 @@
+/**
+ * @file engine/src/core/assets/BlockCompression.h
+ * @brief Encoders for the BCn block compressed texture formats.
+ *
+ * Every format stores a 4x4 block of pixels in a fixed number of bytes as a
+ * pair of endpoints and an index per pixel into a palette interpolated between
+ * them. Encoding is therefore a search for the endpoints that minimize the
+ * error of the whole block, and the encoders here trade search effort for
+ * quality:
+ *
+ *   BC1  8 bytes   RGB, for opaque color.
+ *   BC3  16 bytes  RGBA, BC1 color with a BC4 alpha block.
+ *   BC4  8 bytes   A single channel, for masks and roughness.
+ *   BC5  16 bytes  Two channels, for tangent space normal maps.
+ *   BC7  16 bytes  RGBA at high quality, for everything else.
+ *
+ * The encoders work on a single block and are meant to run offline, with
+ * blocks distributed over the job system by CompressImage in Texture.h.
+ */
+#ifndef ENGINE_SRC_CORE_ASSETS_BLOCKCOMPRESSION_H_
+#define ENGINE_SRC_CORE_ASSETS_BLOCKCOMPRESSION_H_
+
+#include <cstdint>
+
+#include "core/Core.h"
+
+namespace engine {
+namespace assets {
+
+/**
+ * @var kBlockDimension
+ * @brief The width and height of a block in pixels.
+ */
+constexpr uint32_t kBlockDimension = 4;
+
+/**
+ * @var kBlockPixels
+ * @brief The number of pixels in a block. Blocks are passed to the encoders
+ * as kBlockPixels RGBA8 pixels in row major order.
+ */
+constexpr uint32_t kBlockPixels = kBlockDimension * kBlockDimension;
+
+/**
+ * @enum CompressionQuality
+ * @brief How much effort the encoders spend searching for endpoints.
+ *
+ * kFast fits the endpoints to the principal axis of the block, kNormal refines
+ * them with least squares, and kHigh refines them further. For BC7, kHigh
+ * also tries every p-bit combination and nudges the quantized endpoints toward
+ * a lower error.
+ */
+enum class CompressionQuality : uint32_t {
+  kFast,
+  kNormal,
+  kHigh
+};
+
+/**
+ * @fn EncodeBc1Block
+ * @brief Encodes the RGB channels of a block into 8 bytes. Always uses the
+ * four color mode, so alpha is ignored rather than thresholded.
+ */
+ENGINE_API void EncodeBc1Block(
+    const uint8_t* rgba, uint8_t* out,
+    CompressionQuality quality = CompressionQuality::kNormal);
+
+/**
+ * @fn EncodeBc3Block
+ * @brief Encodes a block into 16 bytes of BC4 alpha followed by BC1 color.
+ */
+ENGINE_API void EncodeBc3Block(
+    const uint8_t* rgba, uint8_t* out,
+    CompressionQuality quality = CompressionQuality::kNormal);
+
+/**
+ * @fn EncodeBc4Block
+ * @param channel The channel of the pixels to encode, 0 for red.
+ * @brief Encodes a single channel of a block into 8 bytes.
+ */
+ENGINE_API void EncodeBc4Block(
+    const uint8_t* rgba, uint8_t* out, uint32_t channel = 0);
+
+/**
+ * @fn EncodeBc5Block
+ * @brief Encodes the red and green channels of a block into two BC4 blocks.
+ */
+ENGINE_API void EncodeBc5Block(const uint8_t* rgba, uint8_t* out);
+
+/**
+ * @fn EncodeBc7Block
+ * @brief Encodes a block into 16 bytes using BC7 mode 6, which stores RGBA
+ * endpoints with 7 bits and a p-bit per channel and 4 bit indices.
+ */
+ENGINE_API void EncodeBc7Block(
+    const uint8_t* rgba, uint8_t* out,
+    CompressionQuality quality = CompressionQuality::kNormal);
+
+}  // namespace assets
+}  // namespace engine
+
+#endif  // ENGINE_SRC_CORE_ASSETS_BLOCKCOMPRESSION_H_
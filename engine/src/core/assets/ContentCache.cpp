@@ -0,0 +1,82 @@
+#include "core/assets/ContentCache.h"
+
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <system_error>
+#include <thread>
+
+#include "core/Log.h"
+#include "core/assets/ContentHash.h"
+
+namespace engine {
+namespace assets {
+
+ContentCache::ContentCache(
+    const std::string& directory, const std::string& extension)
+    : directory_(directory), extension_(extension) {
+  std::error_code error;
+  std::filesystem::create_directories(directory_, error);
+  if (error) {
+    ENGINE_CORE_WARN(
+        "Couldn't create cache directory {}: {}", directory_, error.message());
+  }
+}
+
+bool ContentCache::Contains(uint64_t key) const {
+  std::error_code error;
+  return std::filesystem::is_regular_file(GetPath(key), error);
+}
+
+bool ContentCache::Load(uint64_t key, std::vector<uint8_t>* data) const {
+  std::ifstream file(GetPath(key), std::ios::binary);
+  if (!file) {
+    return false;
+  }
+
+  data->assign(
+      std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+  return !file.bad();
+}
+
+/**
+ * The temporary name is unique per thread so that two threads storing the
+ * same key don't write into the same file. Whichever rename lands last wins,
+ * which is harmless since both wrote the same contents.
+ */
+bool ContentCache::Store(
+    uint64_t key, const std::vector<uint8_t>& data) const {
+  std::string path = GetPath(key);
+  std::string temporary = path + "."
+      + std::to_string(std::hash<std::thread::id>()(
+          std::this_thread::get_id())) + ".tmp";
+  {
+    std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+    file.write(
+        reinterpret_cast<const char*>(data.data()),
+        static_cast<std::streamsize>(data.size()));
+    if (!file) {
+      ENGINE_CORE_WARN("Couldn't write cache entry {}.", temporary);
+      return false;
+    }
+  }
+
+  std::error_code error;
+  std::filesystem::rename(temporary, path, error);
+  if (error) {
+    ENGINE_CORE_WARN(
+        "Couldn't move cache entry to {}: {}", path, error.message());
+    std::filesystem::remove(temporary, error);
+    return false;
+  }
+  return true;
+}
+
+std::string ContentCache::GetPath(uint64_t key) const {
+  return (std::filesystem::path(directory_) / (FormatHash(key) + extension_))
+      .string();
+}
+
+}  // namespace assets
+}  // namespace engine
@@ -0,0 +1,65 @@
+/**
+ * @file engine/src/core/assets/ContentCache.h
+ * @brief A directory of blobs addressed by the hash of the inputs that
+ * produced them.
+ *
+ * Because keys are derived from everything that went into a blob, entries
+ * never go stale and never need to be invalidated. A changed input simply
+ * produces a different key, and the same directory can be shared between
+ * branches and machines.
+ */
+#ifndef ENGINE_SRC_CORE_ASSETS_CONTENTCACHE_H_
+#define ENGINE_SRC_CORE_ASSETS_CONTENTCACHE_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "core/Core.h"
+
+namespace engine {
+namespace assets {
+
+/**
+ * @class ContentCache
+ * @brief Stores and loads blobs by key. Safe to use from multiple threads and
+ * processes at once.
+ */
+class ENGINE_API ContentCache {
+ public:
+  /**
+   * @fn ContentCache
+   * @param extension Appended to the file names of entries.
+   * @brief Creates the directory if it doesn't exist yet.
+   */
+  explicit ContentCache(
+      const std::string& directory, const std::string& extension = ".bin");
+
+  bool Contains(uint64_t key) const;
+
+  /**
+   * @fn Load
+   * @return false if there is no entry for key or it can't be read.
+   */
+  bool Load(uint64_t key, std::vector<uint8_t>* data) const;
+
+  /**
+   * @fn Store
+   * @brief Writes an entry under a temporary name and renames it into place,
+   * so readers never see partially written entries.
+   */
+  bool Store(uint64_t key, const std::vector<uint8_t>& data) const;
+
+  inline const std::string& GetDirectory() const { return directory_; }
+
+  std::string GetPath(uint64_t key) const;
+
+ private:
+  std::string directory_;
+  std::string extension_;
+};
+
+}  // namespace assets
+}  // namespace engine
+
+#endif  // ENGINE_SRC_CORE_ASSETS_CONTENTCACHE_H_
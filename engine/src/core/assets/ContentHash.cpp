@@ -0,0 +1,162 @@
+#include "core/assets/ContentHash.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+namespace engine {
+namespace assets {
+
+namespace {
+
+constexpr uint64_t kPrime1 = 11400714785074694791ull;
+constexpr uint64_t kPrime2 = 14029467366897019727ull;
+constexpr uint64_t kPrime3 = 1609587929392839161ull;
+constexpr uint64_t kPrime4 = 9650029242287828579ull;
+constexpr uint64_t kPrime5 = 2870177450012600261ull;
+
+inline uint64_t RotateLeft(uint64_t value, int count) {
+  return (value << count) | (value >> (64 - count));
+}
+
+// Reads are little endian on every platform the engine supports.
+inline uint64_t Read64(const uint8_t* bytes) {
+  uint64_t value;
+  std::memcpy(&value, bytes, sizeof(value));
+  return value;
+}
+
+inline uint32_t Read32(const uint8_t* bytes) {
+  uint32_t value;
+  std::memcpy(&value, bytes, sizeof(value));
+  return value;
+}
+
+inline uint64_t Round(uint64_t accumulator, uint64_t input) {
+  accumulator += input * kPrime2;
+  return RotateLeft(accumulator, 31) * kPrime1;
+}
+
+inline uint64_t MergeRound(uint64_t accumulator, uint64_t value) {
+  accumulator ^= Round(0, value);
+  return accumulator * kPrime1 + kPrime4;
+}
+
+}  // namespace
+
+ContentHasher::ContentHasher(uint64_t seed) : seed_(seed) {
+  accumulators_[0] = seed + kPrime1 + kPrime2;
+  accumulators_[1] = seed + kPrime2;
+  accumulators_[2] = seed;
+  accumulators_[3] = seed - kPrime1;
+}
+
+void ContentHasher::Update(const void* data, size_t size) {
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+  total_size_ += size;
+
+  if (buffered_ + size < 32) {
+    std::memcpy(buffer_ + buffered_, bytes, size);
+    buffered_ += static_cast<uint32_t>(size);
+    return;
+  }
+
+  if (buffered_ > 0) {
+    size_t fill = 32 - buffered_;
+    std::memcpy(buffer_ + buffered_, bytes, fill);
+    for (int lane = 0; lane < 4; ++lane) {
+      accumulators_[lane] = Round(
+          accumulators_[lane], Read64(buffer_ + lane * 8));
+    }
+    bytes += fill;
+    size -= fill;
+    buffered_ = 0;
+  }
+
+  while (size >= 32) {
+    for (int lane = 0; lane < 4; ++lane) {
+      accumulators_[lane] = Round(
+          accumulators_[lane], Read64(bytes + lane * 8));
+    }
+    bytes += 32;
+    size -= 32;
+  }
+
+  std::memcpy(buffer_, bytes, size);
+  buffered_ = static_cast<uint32_t>(size);
+}
+
+uint64_t ContentHasher::Finish() const {
+  uint64_t hash;
+  if (total_size_ >= 32) {
+    hash = RotateLeft(accumulators_[0], 1) + RotateLeft(accumulators_[1], 7)
+        + RotateLeft(accumulators_[2], 12) + RotateLeft(accumulators_[3], 18);
+    for (uint64_t accumulator : accumulators_) {
+      hash = MergeRound(hash, accumulator);
+    }
+  } else {
+    hash = seed_ + kPrime5;
+  }
+  hash += total_size_;
+
+  const uint8_t* bytes = buffer_;
+  uint32_t remaining = buffered_;
+  for (; remaining >= 8; remaining -= 8, bytes += 8) {
+    hash ^= Round(0, Read64(bytes));
+    hash = RotateLeft(hash, 27) * kPrime1 + kPrime4;
+  }
+  if (remaining >= 4) {
+    hash ^= static_cast<uint64_t>(Read32(bytes)) * kPrime1;
+    hash = RotateLeft(hash, 23) * kPrime2 + kPrime3;
+    bytes += 4;
+    remaining -= 4;
+  }
+  for (; remaining > 0; --remaining, ++bytes) {
+    hash ^= *bytes * kPrime5;
+    hash = RotateLeft(hash, 11) * kPrime1;
+  }
+
+  hash ^= hash >> 33;
+  hash *= kPrime2;
+  hash ^= hash >> 29;
+  hash *= kPrime3;
+  hash ^= hash >> 32;
+  return hash;
+}
+
+uint64_t HashBytes(const void* data, size_t size, uint64_t seed) {
+  ContentHasher hasher(seed);
+  hasher.Update(data, size);
+  return hasher.Finish();
+}
+
+bool HashFile(const std::string& path, uint64_t* hash) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    return false;
+  }
+
+  ContentHasher hasher;
+  std::vector<char> chunk(1 << 16);
+  while (file) {
+    file.read(chunk.data(), chunk.size());
+    hasher.Update(chunk.data(), static_cast<size_t>(file.gcount()));
+  }
+
+  if (file.bad()) {
+    return false;
+  }
+  *hash = hasher.Finish();
+  return true;
+}
+
+std::string FormatHash(uint64_t hash) {
+  char digits[17];
+  std::snprintf(
+      digits, sizeof(digits), "%016llx", static_cast<unsigned long long>(hash));
+  return digits;
+}
+
+}  // namespace assets
+}  // namespace engine
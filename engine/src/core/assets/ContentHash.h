@@ -0,0 +1,88 @@
+/**
+ * @file engine/src/core/assets/ContentHash.h
+ * @brief Hashing of asset contents for caching.
+ *
+ * Cooked assets are cached under the hash of everything that went into them,
+ * so the hash needs to be fast on large inputs and stable across platforms and
+ * runs. ContentHasher implements XXH64 and can be fed incrementally.
+ */
+#ifndef ENGINE_SRC_CORE_ASSETS_CONTENTHASH_H_
+#define ENGINE_SRC_CORE_ASSETS_CONTENTHASH_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+#include "core/Core.h"
+
+namespace engine {
+namespace assets {
+
+/**
+ * @class ContentHasher
+ * @brief Streaming XXH64.
+ */
+class ENGINE_API ContentHasher {
+ public:
+  explicit ContentHasher(uint64_t seed = 0);
+
+  void Update(const void* data, size_t size);
+
+  /**
+   * @fn Add
+   * @brief Hashes the bytes of a trivially copyable value. Values should have
+   * no padding, which would make the hash depend on uninitialized bytes.
+   */
+  template<typename T>
+  inline void Add(const T& value) {
+    static_assert(
+        std::is_trivially_copyable<T>::value,
+        "Only trivially copyable values can be hashed as bytes.");
+    Update(&value, sizeof(T));
+  }
+
+  /**
+   * @fn AddString
+   * @brief Hashes a string along with its length, so that consecutive
+   * strings can't run into each other.
+   */
+  inline void AddString(const std::string& text) {
+    Add(static_cast<uint64_t>(text.size()));
+    Update(text.data(), text.size());
+  }
+
+  /**
+   * @fn Finish
+   * @brief Get the hash of everything added so far. More data can still be
+   * added afterwards.
+   */
+  uint64_t Finish() const;
+
+ private:
+  uint64_t accumulators_[4];
+  uint8_t buffer_[32];
+  uint32_t buffered_ = 0;
+  uint64_t total_size_ = 0;
+  uint64_t seed_;
+};
+
+ENGINE_API uint64_t HashBytes(const void* data, size_t size, uint64_t seed = 0);
+
+/**
+ * @fn HashFile
+ * @brief Hashes the contents of a file.
+ * @return false if the file couldn't be read.
+ */
+ENGINE_API bool HashFile(const std::string& path, uint64_t* hash);
+
+/**
+ * @fn FormatHash
+ * @brief Get the hash as 16 hexadecimal digits, for use in file names.
+ */
+ENGINE_API std::string FormatHash(uint64_t hash);
+
+}  // namespace assets
+}  // namespace engine
+
+#endif  // ENGINE_SRC_CORE_ASSETS_CONTENTHASH_H_
@@ -0,0 +1,376 @@
+#include "core/assets/Cookers.h"
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <set>
+#include <sstream>
+
+#include "core/Log.h"
+#include "core/assets/TextureCompression.h"
+#include "core/cvars/ConsoleVariable.h"
+
+namespace engine {
+namespace assets {
+
+namespace {
+
+std::string Trim(const std::string& text) {
+  size_t begin = text.find_first_not_of(" \t\r");
+  if (begin == std::string::npos) {
+    return "";
+  }
+  size_t end = text.find_last_not_of(" \t\r");
+  return text.substr(begin, end - begin + 1);
+}
+
+std::vector<std::string> SplitLines(const std::vector<uint8_t>& source) {
+  std::vector<std::string> lines;
+  std::istringstream stream(std::string(source.begin(), source.end()));
+  std::string line;
+  while (std::getline(stream, line)) {
+    lines.push_back(line);
+  }
+  return lines;
+}
+
+// ----------------------------------- SHADERS ---------------------------------
+
+/**
+ * Returns true if line is an include directive and stores its path.
+ */
+bool ParseInclude(const std::string& line, std::string* path) {
+  std::string trimmed = Trim(line);
+  if (trimmed.compare(0, 1, "#") != 0) {
+    return false;
+  }
+
+  std::string directive = Trim(trimmed.substr(1));
+  if (directive.compare(0, 7, "include") != 0) {
+    return false;
+  }
+
+  size_t open = directive.find('"', 7);
+  size_t close = open == std::string::npos
+      ? std::string::npos
+      : directive.find('"', open + 1);
+  if (close == std::string::npos) {
+    return false;
+  }
+  *path = directive.substr(open + 1, close - open - 1);
+  return true;
+}
+
+bool ExpandIncludes(
+    const CookContext& context,
+    const std::string& path,
+    std::set<std::string>* included,
+    std::string* output) {
+  if (!included->insert(path).second) {
+    return true;
+  }
+
+  std::vector<uint8_t> source;
+  if (!context.ReadFile(path, &source)) {
+    ENGINE_CORE_ERROR("Couldn't read shader source {}.", path);
+    return false;
+  }
+
+  for (const std::string& line : SplitLines(source)) {
+    std::string include;
+    if (ParseInclude(line, &include)) {
+      if (!ExpandIncludes(
+              context, ResolveAssetPath(path, include), included, output)) {
+        return false;
+      }
+      continue;
+    }
+    *output += line;
+    *output += '\n';
+  }
+  return true;
+}
+
+// ---------------------------------- MATERIALS --------------------------------
+
+bool IsReference(const std::string& name) {
+  return name == "shader" || name.compare(0, 8, "texture.") == 0;
+}
+
+/**
+ * Parses name = value lines, skipping blank lines and # comments. Returns
+ * false and logs the line if one is malformed.
+ */
+bool ParseProperties(
+    const std::string& path,
+    const std::vector<uint8_t>& source,
+    std::map<std::string, std::string>* properties) {
+  std::vector<std::string> lines = SplitLines(source);
+  for (size_t number = 0; number < lines.size(); ++number) {
+    std::string line = lines[number];
+    size_t comment = line.find('#');
+    if (comment != std::string::npos) {
+      line.erase(comment);
+    }
+    if (Trim(line).empty()) {
+      continue;
+    }
+
+    size_t separator = line.find('=');
+    std::string name = separator == std::string::npos
+        ? ""
+        : Trim(line.substr(0, separator));
+    if (name.empty()) {
+      ENGINE_CORE_ERROR("{}:{}: expected name = value.", path, number + 1);
+      return false;
+    }
+    (*properties)[name] = Trim(line.substr(separator + 1));
+  }
+  return true;
+}
+
+// ---------------------------------- TEXTURES ---------------------------------
+
+constexpr uint32_t kTgaReaderVersion = 1;
+
+/**
+ * Decodes uncompressed and run length encoded true color TGA images with 24
+ * or 32 bits per pixel.
+ */
+bool DecodeTga(
+    const std::string& path, const std::vector<uint8_t>& data, Image* image) {
+  if (data.size() < 18) {
+    ENGINE_CORE_ERROR("{} is too small to be a TGA image.", path);
+    return false;
+  }
+
+  uint32_t id_length = data[0];
+  uint32_t color_map_type = data[1];
+  uint32_t image_type = data[2];
+  uint32_t width = data[12] | (data[13] << 8);
+  uint32_t height = data[14] | (data[15] << 8);
+  uint32_t bytes_per_pixel = data[16] / 8;
+  uint32_t descriptor = data[17];
+  bool run_length_encoded = image_type == 10;
+  if (color_map_type != 0 || (image_type != 2 && !run_length_encoded)
+      || (bytes_per_pixel != 3 && bytes_per_pixel != 4)
+      || (descriptor & 0x10) || width == 0 || height == 0) {
+    ENGINE_CORE_ERROR("{} isn't a 24 or 32 bit true color TGA image.", path);
+    return false;
+  }
+
+  image->Width = width;
+  image->Height = height;
+  image->Pixels.assign(static_cast<size_t>(width) * height * 4, 255);
+
+  size_t offset = 18 + id_length;
+  size_t pixel_count = static_cast<size_t>(width) * height;
+  auto read_pixel = [&](size_t pixel) {
+    // Rows are stored bottom up unless bit 5 of the descriptor is set.
+    size_t x = pixel % width, y = pixel / width;
+    if (!(descriptor & 0x20)) {
+      y = height - 1 - y;
+    }
+    uint8_t* out = &image->Pixels[(y * width + x) * 4];
+    out[0] = data[offset + 2];
+    out[1] = data[offset + 1];
+    out[2] = data[offset];
+    if (bytes_per_pixel == 4) {
+      out[3] = data[offset + 3];
+    }
+  };
+
+  for (size_t pixel = 0; pixel < pixel_count;) {
+    size_t count = 1;
+    bool repeat = false;
+    if (run_length_encoded) {
+      if (offset >= data.size()) {
+        break;
+      }
+      count = std::min<size_t>((data[offset] & 0x7f) + 1, pixel_count - pixel);
+      repeat = (data[offset] & 0x80) != 0;
+      ++offset;
+    }
+
+    size_t needed = (repeat ? 1 : count) * bytes_per_pixel;
+    if (data.size() - std::min(offset, data.size()) < needed) {
+      ENGINE_CORE_ERROR("{} is truncated.", path);
+      return false;
+    }
+
+    for (size_t i = 0; i < count; ++i, ++pixel) {
+      read_pixel(pixel);
+      if (!repeat) {
+        offset += bytes_per_pixel;
+      }
+    }
+    if (repeat) {
+      offset += bytes_per_pixel;
+    }
+  }
+  return true;
+}
+
+bool ParseTextureSettings(
+    const CookContext& context, TextureSettings* settings) {
+  static const struct {
+    const char* Name;
+    TextureFormat Format;
+  } kFormats[] = {
+      { "rgba8", TextureFormat::kRgba8 },
+      { "bc1", TextureFormat::kBc1 },
+      { "bc3", TextureFormat::kBc3 },
+      { "bc4", TextureFormat::kBc4 },
+      { "bc5", TextureFormat::kBc5 },
+      { "bc7", TextureFormat::kBc7 } };
+  static const struct {
+    const char* Name;
+    CompressionQuality Quality;
+  } kQualities[] = {
+      { "fast", CompressionQuality::kFast },
+      { "normal", CompressionQuality::kNormal },
+      { "high", CompressionQuality::kHigh } };
+
+  bool valid = true;
+  std::string format = context.GetParameter("format", "");
+  if (!format.empty()) {
+    bool found = false;
+    for (const auto& entry : kFormats) {
+      if (format == entry.Name) {
+        settings->Format = entry.Format;
+        found = true;
+      }
+    }
+    if (!found) {
+      ENGINE_CORE_ERROR(
+          "Unknown texture format {} for {}.", format, context.GetPath());
+      valid = false;
+    }
+  }
+
+  std::string quality = context.GetParameter("quality", "");
+  if (!quality.empty()) {
+    bool found = false;
+    for (const auto& entry : kQualities) {
+      if (quality == entry.Name) {
+        settings->Quality = entry.Quality;
+        found = true;
+      }
+    }
+    if (!found) {
+      ENGINE_CORE_ERROR(
+          "Unknown texture quality {} for {}.", quality, context.GetPath());
+      valid = false;
+    }
+  }
+
+  std::string srgb = context.GetParameter("srgb", "");
+  if (!srgb.empty() && !cvars::ParseValue(srgb, &settings->Srgb)) {
+    ENGINE_CORE_ERROR("Invalid srgb {} for {}.", srgb, context.GetPath());
+    valid = false;
+  }
+
+  std::string mips = context.GetParameter("mips", "");
+  if (!mips.empty() && !cvars::ParseValue(mips, &settings->GenerateMips)) {
+    ENGINE_CORE_ERROR("Invalid mips {} for {}.", mips, context.GetPath());
+    valid = false;
+  }
+  return valid;
+}
+
+}  // namespace
+
+// ----------------------------------- SHADERS ---------------------------------
+
+void ShaderCooker::ScanDependencies(
+    const std::string& path,
+    const std::vector<uint8_t>& source,
+    std::vector<std::string>* dependencies) const {
+  for (const std::string& line : SplitLines(source)) {
+    std::string include;
+    if (ParseInclude(line, &include)) {
+      dependencies->push_back(ResolveAssetPath(path, include));
+    }
+  }
+}
+
+bool ShaderCooker::Cook(
+    const CookContext& context, std::vector<uint8_t>* output) const {
+  std::set<std::string> included;
+  std::string expanded;
+  if (!ExpandIncludes(context, context.GetPath(), &included, &expanded)) {
+    return false;
+  }
+  output->assign(expanded.begin(), expanded.end());
+  return true;
+}
+
+// ---------------------------------- MATERIALS --------------------------------
+
+void MaterialCooker::ScanDependencies(
+    const std::string& path,
+    const std::vector<uint8_t>& source,
+    std::vector<std::string>* dependencies) const {
+  std::map<std::string, std::string> properties;
+  ParseProperties(path, source, &properties);
+  for (const auto& property : properties) {
+    if (IsReference(property.first)) {
+      dependencies->push_back(ResolveAssetPath(path, property.second));
+    }
+  }
+}
+
+bool MaterialCooker::Cook(
+    const CookContext& context, std::vector<uint8_t>* output) const {
+  std::vector<uint8_t> source;
+  std::map<std::string, std::string> properties;
+  if (!context.ReadFile(context.GetPath(), &source)
+      || !ParseProperties(context.GetPath(), source, &properties)) {
+    return false;
+  }
+
+  if (properties.count("shader") == 0) {
+    ENGINE_CORE_ERROR("Material {} has no shader.", context.GetPath());
+    return false;
+  }
+
+  std::string cooked;
+  for (const auto& property : properties) {
+    std::string value = IsReference(property.first)
+        ? ResolveAssetPath(context.GetPath(), property.second)
+        : property.second;
+    cooked += property.first + "=" + value + "\n";
+  }
+  output->assign(cooked.begin(), cooked.end());
+  return true;
+}
+
+// ---------------------------------- TEXTURES ---------------------------------
+
+uint32_t TextureCooker::GetVersion() const {
+  return (kTextureEncoderVersion << 16) | kTgaReaderVersion;
+}
+
+bool TextureCooker::Cook(
+    const CookContext& context, std::vector<uint8_t>* output) const {
+  TextureSettings settings;
+  std::vector<uint8_t> source;
+  Image image;
+  if (!ParseTextureSettings(context, &settings)
+      || !context.ReadFile(context.GetPath(), &source)
+      || !DecodeTga(context.GetPath(), source, &image)) {
+    return false;
+  }
+
+  *output = SerializeTexture(CompressTexture(image, settings));
+  return true;
+}
+
+void RegisterDefaultCookers(AssetCooker* cooker) {
+  cooker->RegisterCooker(".glsl", std::make_unique<ShaderCooker>());
+  cooker->RegisterCooker(".mat", std::make_unique<MaterialCooker>());
+  cooker->RegisterCooker(".tga", std::make_unique<TextureCooker>());
+}
+
+}  // namespace assets
+}  // namespace engine
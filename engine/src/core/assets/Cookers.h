@@ -0,0 +1,93 @@
+/**
+ * @file engine/src/core/assets/Cookers.h
+ * @brief The cookers for the asset kinds the engine knows about.
+ */
+#ifndef ENGINE_SRC_CORE_ASSETS_COOKERS_H_
+#define ENGINE_SRC_CORE_ASSETS_COOKERS_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "core/Core.h"
+#include "core/assets/AssetCooker.h"
+
+namespace engine {
+namespace assets {
+
+/**
+ * @class ShaderCooker
+ * @brief Cooks GLSL sources by expanding their #include "path" directives.
+ *
+ * Include paths are relative to the including file, or to the source
+ * directory when they start with a slash. Every file is included at most
+ * once, which makes include guards unnecessary and cycles harmless.
+ */
+class ENGINE_API ShaderCooker : public Cooker {
+ public:
+  const char* GetName() const override { return "shader"; }
+  uint32_t GetVersion() const override { return 1; }
+
+  void ScanDependencies(
+      const std::string& path,
+      const std::vector<uint8_t>& source,
+      std::vector<std::string>* dependencies) const override;
+
+  bool Cook(
+      const CookContext& context, std::vector<uint8_t>* output) const override;
+};
+
+/**
+ * @class MaterialCooker
+ * @brief Cooks materials, which are text files of name = value properties.
+ *
+ *   shader = ../shaders/lit.glsl
+ *   texture.albedo = ../textures/stone.tga
+ *   roughness = 0.8
+ *
+ * The shader and every property starting with texture. reference other assets
+ * relative to the material. The cooked material holds the properties sorted
+ * by name with references resolved to paths relative to the source directory,
+ * which is how assets are found in the archive.
+ */
+class ENGINE_API MaterialCooker : public Cooker {
+ public:
+  const char* GetName() const override { return "material"; }
+  uint32_t GetVersion() const override { return 1; }
+
+  void ScanDependencies(
+      const std::string& path,
+      const std::vector<uint8_t>& source,
+      std::vector<std::string>* dependencies) const override;
+
+  bool Cook(
+      const CookContext& context, std::vector<uint8_t>* output) const override;
+};
+
+/**
+ * @class TextureCooker
+ * @brief Cooks uncompressed TGA images into block compressed textures.
+ *
+ * Accepts the parameters format (rgba8, bc1, bc3, bc4, bc5 or bc7), quality
+ * (fast, normal or high), srgb and mips, which default to the defaults of
+ * TextureSettings.
+ */
+class ENGINE_API TextureCooker : public Cooker {
+ public:
+  const char* GetName() const override { return "texture"; }
+  uint32_t GetVersion() const override;
+
+  bool Cook(
+      const CookContext& context, std::vector<uint8_t>* output) const override;
+};
+
+/**
+ * @fn RegisterDefaultCookers
+ * @brief Registers the cookers above for their extensions.
+ */
+ENGINE_API void RegisterDefaultCookers(AssetCooker* cooker);
+
+}  // namespace assets
+}  // namespace engine
+
+#endif  // ENGINE_SRC_CORE_ASSETS_COOKERS_H_
@@ -0,0 +1,64 @@
+#include "core/assets/TextureCache.h"
+
+#include <vector>
+
+#include "core/Log.h"
+#include "core/assets/ContentHash.h"
+
+namespace engine {
+namespace assets {
+
+TextureCache::TextureCache(const std::string& directory)
+    : cache_(directory, ".ctex") {}
+
+uint64_t TextureCache::ComputeKey(
+    const Image& image, const TextureSettings& settings) {
+  ContentHasher hasher;
+  hasher.Add(kTextureEncoderVersion);
+  hasher.Add(image.Width);
+  hasher.Add(image.Height);
+  hasher.Update(image.Pixels.data(), image.Pixels.size());
+  hasher.Add(static_cast<uint32_t>(settings.Format));
+  hasher.Add(static_cast<uint32_t>(settings.Quality));
+  hasher.Add(static_cast<uint8_t>(settings.Srgb));
+  hasher.Add(static_cast<uint8_t>(settings.GenerateMips));
+  return hasher.Finish();
+}
+
+bool TextureCache::Load(uint64_t key, CookedTexture* texture) const {
+  std::vector<uint8_t> data;
+  return cache_.Load(key, &data)
+      && DeserializeTexture(data.data(), data.size(), texture);
+}
+
+bool TextureCache::Store(uint64_t key, const CookedTexture& texture) const {
+  return cache_.Store(key, SerializeTexture(texture));
+}
+
+CookedTexture CookTexture(
+    const Image& image, const TextureSettings& settings, TextureCache* cache) {
+  uint64_t key = 0;
+  CookedTexture texture;
+  if (cache) {
+    key = TextureCache::ComputeKey(image, settings);
+    if (cache->Load(key, &texture)) {
+      return texture;
+    }
+  }
+
+  texture = CompressTexture(image, settings);
+  ENGINE_CORE_INFO(
+      "Compressed {}x{} texture to {} with {} mips.",
+      image.Width,
+      image.Height,
+      GetTextureFormatName(settings.Format),
+      texture.Mips.size());
+
+  if (cache) {
+    cache->Store(key, texture);
+  }
+  return texture;
+}
+
+}  // namespace assets
+}  // namespace engine
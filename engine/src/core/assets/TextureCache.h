@@ -0,0 +1,66 @@
+/**
+ * @file engine/src/core/assets/TextureCache.h
+ * @brief Caches cooked textures on disk keyed by the hash of their inputs.
+ *
+ * Compressing a large texture to BC7 takes seconds, so the cooker only does it
+ * once for every distinct combination of source pixels, cook settings and
+ * encoder version, and keeps the result in a ContentCache under that key.
+ */
+#ifndef ENGINE_SRC_CORE_ASSETS_TEXTURECACHE_H_
+#define ENGINE_SRC_CORE_ASSETS_TEXTURECACHE_H_
+
+#include <cstdint>
+#include <string>
+
+#include "core/Core.h"
+#include "core/assets/ContentCache.h"
+#include "core/assets/TextureCompression.h"
+
+namespace engine {
+namespace assets {
+
+/**
+ * @class TextureCache
+ * @brief A directory of cooked textures.
+ */
+class ENGINE_API TextureCache {
+ public:
+  explicit TextureCache(const std::string& directory);
+
+  /**
+   * @fn ComputeKey
+   * @brief Get the cache key of a texture cooked from image with settings.
+   */
+  static uint64_t ComputeKey(
+      const Image& image, const TextureSettings& settings);
+
+  /**
+   * @fn Load
+   * @brief Reads the texture cached under key.
+   * @return false if there is none or it can't be read.
+   */
+  bool Load(uint64_t key, CookedTexture* texture) const;
+
+  bool Store(uint64_t key, const CookedTexture& texture) const;
+
+  inline const std::string& GetDirectory() const {
+    return cache_.GetDirectory();
+  }
+
+ private:
+  ContentCache cache_;
+};
+
+/**
+ * @fn CookTexture
+ * @param cache The cache to reuse earlier results from, or nullptr.
+ * @brief Compresses an image, or loads the result from the cache if the same
+ * image was already cooked with the same settings.
+ */
+ENGINE_API CookedTexture CookTexture(
+    const Image& image, const TextureSettings& settings, TextureCache* cache);
+
+}  // namespace assets
+}  // namespace engine
+
+#endif  // ENGINE_SRC_CORE_ASSETS_TEXTURECACHE_H_
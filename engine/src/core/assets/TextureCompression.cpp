@@ -0,0 +1,345 @@
+#include "core/assets/TextureCompression.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "core/jobs/JobSystem.h"
+
+namespace engine {
+namespace assets {
+
+namespace {
+
+constexpr uint32_t kTextureMagic = 0x58455443;  // "CTEX"
+constexpr uint32_t kTextureVersion = 1;
+
+// Enough for a chain down from 2^31 texels on a side.
+constexpr uint32_t kMaxMipCount = 32;
+
+// ------------------------------------ MIPS -----------------------------------
+
+/**
+ * Decoding sRGB only ever sees 256 distinct values, so it is tabulated.
+ */
+struct SrgbTable {
+  float ToLinear[256];
+
+  SrgbTable() {
+    for (uint32_t value = 0; value < 256; ++value) {
+      float srgb = value / 255.0f;
+      ToLinear[value] = srgb <= 0.04045f
+          ? srgb / 12.92f
+          : std::pow((srgb + 0.055f) / 1.055f, 2.4f);
+    }
+  }
+};
+
+const SrgbTable& GetSrgbTable() {
+  static const SrgbTable kTable;
+  return kTable;
+}
+
+uint8_t LinearToSrgb(float linear) {
+  float srgb = linear <= 0.0031308f
+      ? linear * 12.92f
+      : 1.055f * std::pow(linear, 1.0f / 2.4f) - 0.055f;
+  return static_cast<uint8_t>(
+      std::lround(std::min(std::max(srgb, 0.0f), 1.0f) * 255.0f));
+}
+
+inline const uint8_t* GetPixel(const Image& image, uint32_t x, uint32_t y) {
+  return &image.Pixels[(static_cast<size_t>(y) * image.Width + x) * 4];
+}
+
+/**
+ * Halves both dimensions, rounding down but never below 1. Odd rows and
+ * columns are folded into the last destination pixel by clamping the source
+ * coordinates.
+ */
+Image Downsample(const Image& source, bool srgb) {
+  const SrgbTable& table = GetSrgbTable();
+
+  Image target;
+  target.Width = std::max(source.Width / 2, 1u);
+  target.Height = std::max(source.Height / 2, 1u);
+  target.Pixels.resize(static_cast<size_t>(target.Width) * target.Height * 4);
+
+  for (uint32_t y = 0; y < target.Height; ++y) {
+    uint32_t rows[2] = {
+        std::min(y * 2, source.Height - 1),
+        std::min(y * 2 + 1, source.Height - 1) };
+    for (uint32_t x = 0; x < target.Width; ++x) {
+      uint32_t columns[2] = {
+          std::min(x * 2, source.Width - 1),
+          std::min(x * 2 + 1, source.Width - 1) };
+
+      float sum[4] = {};
+      for (uint32_t row : rows) {
+        for (uint32_t column : columns) {
+          const uint8_t* pixel = GetPixel(source, column, row);
+          for (uint32_t channel = 0; channel < 4; ++channel) {
+            sum[channel] += srgb && channel < 3
+                ? table.ToLinear[pixel[channel]]
+                : pixel[channel];
+          }
+        }
+      }
+
+      uint8_t* pixel =
+          &target.Pixels[(static_cast<size_t>(y) * target.Width + x) * 4];
+      for (uint32_t channel = 0; channel < 4; ++channel) {
+        float average = sum[channel] * 0.25f;
+        pixel[channel] = srgb && channel < 3
+            ? LinearToSrgb(average)
+            : static_cast<uint8_t>(std::lround(average));
+      }
+    }
+  }
+  return target;
+}
+
+// --------------------------------- ENCODING ----------------------------------
+
+uint32_t GetBlockSize(TextureFormat format) {
+  switch (format) {
+    case TextureFormat::kBc1:
+    case TextureFormat::kBc4:
+      return 8;
+    case TextureFormat::kBc3:
+    case TextureFormat::kBc5:
+    case TextureFormat::kBc7:
+      return 16;
+    case TextureFormat::kRgba8:
+      return 0;
+  }
+  return 0;
+}
+
+void EncodeBlock(
+    TextureFormat format,
+    CompressionQuality quality,
+    const uint8_t* rgba,
+    uint8_t* out) {
+  switch (format) {
+    case TextureFormat::kBc1:
+      EncodeBc1Block(rgba, out, quality);
+      break;
+    case TextureFormat::kBc3:
+      EncodeBc3Block(rgba, out, quality);
+      break;
+    case TextureFormat::kBc4:
+      EncodeBc4Block(rgba, out);
+      break;
+    case TextureFormat::kBc5:
+      EncodeBc5Block(rgba, out);
+      break;
+    case TextureFormat::kBc7:
+      EncodeBc7Block(rgba, out, quality);
+      break;
+    case TextureFormat::kRgba8:
+      break;
+  }
+}
+
+// ------------------------------- SERIALIZATION -------------------------------
+
+void WriteUInt32(uint32_t value, std::vector<uint8_t>* out) {
+  for (uint32_t byte = 0; byte < 4; ++byte) {
+    out->push_back(static_cast<uint8_t>(value >> (byte * 8)));
+  }
+}
+
+bool ReadUInt32(
+    const uint8_t* data, size_t size, size_t* offset, uint32_t* value) {
+  if (size - *offset < 4) {
+    return false;
+  }
+  *value = 0;
+  for (uint32_t byte = 0; byte < 4; ++byte) {
+    *value |= static_cast<uint32_t>(data[*offset + byte]) << (byte * 8);
+  }
+  *offset += 4;
+  return true;
+}
+
+}  // namespace
+
+const char* GetTextureFormatName(TextureFormat format) {
+  switch (format) {
+    case TextureFormat::kRgba8:
+      return "RGBA8";
+    case TextureFormat::kBc1:
+      return "BC1";
+    case TextureFormat::kBc3:
+      return "BC3";
+    case TextureFormat::kBc4:
+      return "BC4";
+    case TextureFormat::kBc5:
+      return "BC5";
+    case TextureFormat::kBc7:
+      return "BC7";
+  }
+  return "Unknown";
+}
+
+size_t GetTextureDataSize(
+    TextureFormat format, uint32_t width, uint32_t height) {
+  if (format == TextureFormat::kRgba8) {
+    return static_cast<size_t>(width) * height * 4;
+  }
+
+  size_t blocks_x = (width + kBlockDimension - 1) / kBlockDimension;
+  size_t blocks_y = (height + kBlockDimension - 1) / kBlockDimension;
+  return blocks_x * blocks_y * GetBlockSize(format);
+}
+
+std::vector<Image> GenerateMipChain(const Image& image, bool srgb) {
+  std::vector<Image> mips;
+  mips.push_back(image);
+  while (mips.back().Width > 1 || mips.back().Height > 1) {
+    Image next = Downsample(mips.back(), srgb);
+    mips.push_back(std::move(next));
+  }
+  return mips;
+}
+
+std::vector<uint8_t> CompressImage(
+    const Image& image, TextureFormat format, CompressionQuality quality) {
+  if (format == TextureFormat::kRgba8) {
+    return image.Pixels;
+  }
+
+  uint32_t block_size = GetBlockSize(format);
+  uint32_t blocks_x = (image.Width + kBlockDimension - 1) / kBlockDimension;
+  uint32_t blocks_y = (image.Height + kBlockDimension - 1) / kBlockDimension;
+  std::vector<uint8_t> data(
+      static_cast<size_t>(blocks_x) * blocks_y * block_size);
+
+  auto encode_rows = [&](uint32_t begin, uint32_t end) {
+    uint8_t pixels[kBlockPixels * 4];
+    for (uint32_t block_y = begin; block_y < end; ++block_y) {
+      for (uint32_t block_x = 0; block_x < blocks_x; ++block_x) {
+        for (uint32_t y = 0; y < kBlockDimension; ++y) {
+          uint32_t row = std::min(
+              block_y * kBlockDimension + y, image.Height - 1);
+          for (uint32_t x = 0; x < kBlockDimension; ++x) {
+            uint32_t column = std::min(
+                block_x * kBlockDimension + x, image.Width - 1);
+            std::memcpy(
+                &pixels[(y * kBlockDimension + x) * 4],
+                GetPixel(image, column, row),
+                4);
+          }
+        }
+
+        size_t block = static_cast<size_t>(block_y) * blocks_x + block_x;
+        EncodeBlock(format, quality, pixels, &data[block * block_size]);
+      }
+    }
+  };
+
+  jobs::JobSystem::ParallelFor(blocks_y, 1, encode_rows);
+
+  return data;
+}
+
+CookedTexture CompressTexture(
+    const Image& image, const TextureSettings& settings) {
+  CookedTexture texture;
+  texture.Format = settings.Format;
+  texture.Srgb = settings.Srgb;
+
+  std::vector<Image> mips;
+  if (settings.GenerateMips) {
+    mips = GenerateMipChain(image, settings.Srgb);
+  } else {
+    mips.push_back(image);
+  }
+
+  for (const Image& mip : mips) {
+    TextureMip compressed;
+    compressed.Width = mip.Width;
+    compressed.Height = mip.Height;
+    compressed.Data = CompressImage(mip, settings.Format, settings.Quality);
+    texture.Mips.push_back(std::move(compressed));
+  }
+  return texture;
+}
+
+/**
+ * The header is the magic, version, format, sRGB flag and mip count,
+ * followed by the width, height and data size of every mip, and then the
+ * data of every mip. All values are 32 bit little endian.
+ */
+std::vector<uint8_t> SerializeTexture(const CookedTexture& texture) {
+  std::vector<uint8_t> out;
+  WriteUInt32(kTextureMagic, &out);
+  WriteUInt32(kTextureVersion, &out);
+  WriteUInt32(static_cast<uint32_t>(texture.Format), &out);
+  WriteUInt32(texture.Srgb ? 1 : 0, &out);
+  WriteUInt32(static_cast<uint32_t>(texture.Mips.size()), &out);
+  for (const TextureMip& mip : texture.Mips) {
+    WriteUInt32(mip.Width, &out);
+    WriteUInt32(mip.Height, &out);
+    WriteUInt32(static_cast<uint32_t>(mip.Data.size()), &out);
+  }
+  for (const TextureMip& mip : texture.Mips) {
+    out.insert(out.end(), mip.Data.begin(), mip.Data.end());
+  }
+  return out;
+}
+
+bool DeserializeTexture(
+    const uint8_t* data, size_t size, CookedTexture* texture) {
+  size_t offset = 0;
+  uint32_t magic, version, format, srgb, mip_count;
+  if (!ReadUInt32(data, size, &offset, &magic) || magic != kTextureMagic
+      || !ReadUInt32(data, size, &offset, &version)
+      || version != kTextureVersion
+      || !ReadUInt32(data, size, &offset, &format)
+      || format > static_cast<uint32_t>(TextureFormat::kBc7)
+      || !ReadUInt32(data, size, &offset, &srgb)
+      || !ReadUInt32(data, size, &offset, &mip_count)) {
+    return false;
+  }
+
+  // Nothing is allocated until the mip headers have been checked against
+  // the size of the file, since they come straight from it.
+  constexpr uint32_t kMipHeaderSize = 3 * sizeof(uint32_t);
+  if (mip_count == 0 || mip_count > kMaxMipCount
+      || (size - offset) / kMipHeaderSize < mip_count) {
+    return false;
+  }
+
+  CookedTexture result;
+  result.Format = static_cast<TextureFormat>(format);
+  result.Srgb = srgb != 0;
+  result.Mips.resize(mip_count);
+  size_t data_left = size - offset - mip_count * kMipHeaderSize;
+  for (TextureMip& mip : result.Mips) {
+    uint32_t data_size;
+    if (!ReadUInt32(data, size, &offset, &mip.Width)
+        || !ReadUInt32(data, size, &offset, &mip.Height)
+        || !ReadUInt32(data, size, &offset, &data_size)
+        || mip.Width == 0 || mip.Height == 0
+        || data_size != GetTextureDataSize(
+            result.Format, mip.Width, mip.Height)
+        || data_size > data_left) {
+      return false;
+    }
+    data_left -= data_size;
+    mip.Data.resize(data_size);
+  }
+
+  for (TextureMip& mip : result.Mips) {
+    std::memcpy(mip.Data.data(), data + offset, mip.Data.size());
+    offset += mip.Data.size();
+  }
+
+  *texture = std::move(result);
+  return true;
+}
+
+}  // namespace assets
+}  // namespace engine
@@ -0,0 +1,147 @@
+/**
+ * @file engine/src/core/assets/TextureCompression.h
+ * @brief Converts RGBA8 images into block compressed textures with mipmaps.
+ *
+ * This is the texture stage of the asset cooker. It runs on the CPU so that
+ * build machines don't need a GPU, and distributes blocks over the job system
+ * since BC7 in particular is expensive to search.
+ */
+#ifndef ENGINE_SRC_CORE_ASSETS_TEXTURECOMPRESSION_H_
+#define ENGINE_SRC_CORE_ASSETS_TEXTURECOMPRESSION_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "core/Core.h"
+#include "core/assets/BlockCompression.h"
+
+namespace engine {
+namespace assets {
+
+/**
+ * @var kTextureEncoderVersion
+ * @brief Bumped whenever the encoders change their output, so that caches
+ * stop returning textures cooked by an older encoder.
+ */
+constexpr uint32_t kTextureEncoderVersion = 1;
+
+/**
+ * @enum TextureFormat
+ * @brief The pixel formats of cooked textures. The values are stored in
+ * cooked files and must not change.
+ */
+enum class TextureFormat : uint32_t {
+  kRgba8 = 0,
+  kBc1 = 1,
+  kBc3 = 2,
+  kBc4 = 3,
+  kBc5 = 4,
+  kBc7 = 5
+};
+
+/**
+ * @fn GetTextureFormatName
+ * @brief Get the name of the format for logging.
+ */
+ENGINE_API const char* GetTextureFormatName(TextureFormat format);
+
+/**
+ * @fn GetTextureDataSize
+ * @brief Get the number of bytes an image of the given size occupies in the
+ * given format. Block compressed images are padded to whole blocks.
+ */
+ENGINE_API size_t GetTextureDataSize(
+    TextureFormat format, uint32_t width, uint32_t height);
+
+/**
+ * @struct Image
+ * @brief An uncompressed image of RGBA8 pixels in row major order.
+ */
+struct Image {
+  uint32_t Width = 0;
+  uint32_t Height = 0;
+  std::vector<uint8_t> Pixels;
+};
+
+/**
+ * @struct TextureSettings
+ * @brief How a texture is cooked.
+ */
+struct TextureSettings {
+  TextureFormat Format = TextureFormat::kBc7;
+  CompressionQuality Quality = CompressionQuality::kNormal;
+
+  /**
+   * @var Srgb
+   * @brief Whether the color channels hold sRGB encoded values, which are
+   * filtered in linear space when generating mips. Should be false for data
+   * such as normal maps and masks.
+   */
+  bool Srgb = true;
+  bool GenerateMips = true;
+};
+
+/**
+ * @struct TextureMip
+ * @brief A single mip level of a cooked texture in the texture's format.
+ */
+struct TextureMip {
+  uint32_t Width = 0;
+  uint32_t Height = 0;
+  std::vector<uint8_t> Data;
+};
+
+/**
+ * @struct CookedTexture
+ * @brief A texture ready to be uploaded, with its largest mip first.
+ */
+struct CookedTexture {
+  TextureFormat Format = TextureFormat::kRgba8;
+  bool Srgb = false;
+  std::vector<TextureMip> Mips;
+};
+
+/**
+ * @fn GenerateMipChain
+ * @brief Get every mip level of an image down to 1x1, starting with the image
+ * itself. Each level averages 2x2 pixels of the previous one, in linear space
+ * when srgb is set. Alpha is always averaged linearly.
+ */
+ENGINE_API std::vector<Image> GenerateMipChain(const Image& image, bool srgb);
+
+/**
+ * @fn CompressImage
+ * @brief Encodes an image into the given format, spreading rows of blocks
+ * over the job system. Blocks on the right and bottom edges of images that
+ * aren't a multiple of 4 in size repeat the edge pixels.
+ */
+ENGINE_API std::vector<uint8_t> CompressImage(
+    const Image& image, TextureFormat format, CompressionQuality quality);
+
+/**
+ * @fn CompressTexture
+ * @brief Generates the mips of an image if requested and compresses all of
+ * them.
+ */
+ENGINE_API CookedTexture CompressTexture(
+    const Image& image, const TextureSettings& settings);
+
+/**
+ * @fn SerializeTexture
+ * @brief Get the cooked file contents for a texture.
+ */
+ENGINE_API std::vector<uint8_t> SerializeTexture(const CookedTexture& texture);
+
+/**
+ * @fn DeserializeTexture
+ * @brief Reads a texture written by SerializeTexture.
+ * @return false if the data is truncated or has a different version.
+ */
+ENGINE_API bool DeserializeTexture(
+    const uint8_t* data, size_t size, CookedTexture* texture);
+
+}  // namespace assets
+}  // namespace engine
+
+#endif  // ENGINE_SRC_CORE_ASSETS_TEXTURECOMPRESSION_H_
@@ -0,0 +1,206 @@
+#include "core/compression/Lz.h"
+
+#include <cstring>
+#include <vector>
+
+namespace engine {
+namespace compression {
+
+namespace {
+
+constexpr size_t kMinMatch = 4;
+constexpr size_t kMaxDistance = 65535;
+constexpr uint32_t kHashBits = 14;
+
+// The format requires the last five bytes to be literals and the last match
+// to start at least twelve bytes before the end.
+constexpr size_t kLastLiterals = 5;
+constexpr size_t kMatchStartLimit = 12;
+
+// Every 64 bytes without a match the compressor takes larger steps.
+constexpr uint32_t kSkipShift = 6;
+
+inline uint32_t Read32(const uint8_t* data) {
+  uint32_t value;
+  std::memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+inline uint32_t Hash(uint32_t sequence) {
+  return (sequence * 2654435761u) >> (32 - kHashBits);
+}
+
+inline uint8_t* WriteLength(size_t length, uint8_t* out) {
+  for (; length >= 255; length -= 255) {
+    *out++ = 255;
+  }
+  *out++ = static_cast<uint8_t>(length);
+  return out;
+}
+
+uint8_t* WriteSequence(
+    const uint8_t* literals,
+    size_t literal_length,
+    size_t distance,
+    size_t match_length,
+    uint8_t* out) {
+  uint8_t* token = out++;
+  size_t literal_nibble = literal_length < 15 ? literal_length : 15;
+  *token = static_cast<uint8_t>(literal_nibble << 4);
+  if (literal_length >= 15) {
+    out = WriteLength(literal_length - 15, out);
+  }
+  if (literal_length > 0) {
+    std::memcpy(out, literals, literal_length);
+    out += literal_length;
+  }
+
+  // The final sequence only holds literals.
+  if (match_length == 0) {
+    return out;
+  }
+
+  *out++ = static_cast<uint8_t>(distance);
+  *out++ = static_cast<uint8_t>(distance >> 8);
+  size_t extra = match_length - kMinMatch;
+  *token |= static_cast<uint8_t>(extra < 15 ? extra : 15);
+  if (extra >= 15) {
+    out = WriteLength(extra - 15, out);
+  }
+  return out;
+}
+
+bool ReadLength(
+    const uint8_t** in, const uint8_t* end, size_t* length) {
+  uint8_t byte;
+  do {
+    if (*in >= end) {
+      return false;
+    }
+    byte = *(*in)++;
+    *length += byte;
+  } while (byte == 255);
+  return true;
+}
+
+}  // namespace
+
+size_t CompressLz(const uint8_t* source, size_t size, uint8_t* destination) {
+  uint8_t* out = destination;
+  size_t anchor = 0;
+
+  if (size > kMatchStartLimit) {
+    // Positions are stored plus one so that zero marks an empty slot.
+    std::vector<uint32_t> table(size_t(1) << kHashBits, 0);
+    size_t match_start_limit = size - kMatchStartLimit;
+    size_t match_end_limit = size - kLastLiterals;
+
+    size_t position = 0;
+    uint32_t misses = 0;
+    while (position < match_start_limit) {
+      uint32_t& slot = table[Hash(Read32(source + position))];
+      size_t candidate = slot;
+      slot = static_cast<uint32_t>(position + 1);
+
+      if (candidate == 0 || position - (candidate - 1) > kMaxDistance
+          || Read32(source + candidate - 1) != Read32(source + position)) {
+        position += 1 + (misses++ >> kSkipShift);
+        continue;
+      }
+      misses = 0;
+
+      size_t reference = candidate - 1;
+      while (position > anchor && reference > 0
+             && source[position - 1] == source[reference - 1]) {
+        --position;
+        --reference;
+      }
+
+      size_t length = kMinMatch;
+      while (position + length < match_end_limit
+             && source[position + length] == source[reference + length]) {
+        ++length;
+      }
+
+      out = WriteSequence(
+          source + anchor, position - anchor, position - reference, length,
+          out);
+      position += length;
+      anchor = position;
+
+      if (position - 2 < match_start_limit) {
+        table[Hash(Read32(source + position - 2))] =
+            static_cast<uint32_t>(position - 1);
+      }
+    }
+  }
+
+  out = WriteSequence(source + anchor, size - anchor, 0, 0, out);
+  return static_cast<size_t>(out - destination);
+}
+
+bool DecompressLz(
+    const uint8_t* source,
+    size_t size,
+    uint8_t* destination,
+    size_t decompressed_size) {
+  const uint8_t* in = source;
+  const uint8_t* end = source + size;
+  size_t written = 0;
+
+  while (in < end) {
+    uint8_t token = *in++;
+
+    size_t literal_length = token >> 4;
+    if (literal_length == 15 && !ReadLength(&in, end, &literal_length)) {
+      return false;
+    }
+    if (literal_length > static_cast<size_t>(end - in)
+        || literal_length > decompressed_size - written) {
+      return false;
+    }
+    if (literal_length > 0) {
+      std::memcpy(destination + written, in, literal_length);
+      in += literal_length;
+      written += literal_length;
+    }
+
+    if (in == end) {
+      break;
+    }
+
+    if (end - in < 2) {
+      return false;
+    }
+    size_t distance = in[0] | (in[1] << 8);
+    in += 2;
+    if (distance == 0 || distance > written) {
+      return false;
+    }
+
+    size_t match_length = token & 15;
+    if (match_length == 15 && !ReadLength(&in, end, &match_length)) {
+      return false;
+    }
+    match_length += kMinMatch;
+    if (match_length > decompressed_size - written) {
+      return false;
+    }
+
+    // Matches may overlap the bytes they produce, which repeats them.
+    uint8_t* match = destination + written;
+    const uint8_t* reference = match - distance;
+    if (distance >= match_length) {
+      std::memcpy(match, reference, match_length);
+    } else {
+      for (size_t i = 0; i < match_length; ++i) {
+        match[i] = reference[i];
+      }
+    }
+    written += match_length;
+  }
+  return written == decompressed_size;
+}
+
+}  // namespace compression
+}  // namespace engine
@@ -0,0 +1,64 @@
+/**
+ * @file engine/src/core/compression/Lz.h
+ * @brief Fast general purpose LZ77 compression.
+ *
+ * Blocks use the LZ4 block format: sequences of literals followed by a match
+ * of at least four bytes up to 64 KB back. Compression finds matches through
+ * a single hash probe and skips ahead faster the longer it goes without one,
+ * so incompressible data passes through at close to memcpy speed. It trades
+ * ratio for speed, which suits snapshots and other data that is written far
+ * more often than it is kept.
+ */
+#ifndef ENGINE_SRC_CORE_COMPRESSION_LZ_H_
+#define ENGINE_SRC_CORE_COMPRESSION_LZ_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "core/Core.h"
+
+namespace engine {
+namespace compression {
+
+/**
+ * @fn GetMaxCompressedSize
+ * @brief Get the size of the largest block CompressLz can produce for size
+ * bytes of input.
+ */
+inline size_t GetMaxCompressedSize(size_t size) {
+  return size + size / 255 + 16;
+}
+
+/**
+ * @fn CompressLz
+ * @param source The data to compress.
+ * @param size The number of bytes to compress, less than 4 GB.
+ * @param destination Receives the block. Must hold at least
+ * GetMaxCompressedSize(size) bytes.
+ * @brief Compresses data into a single block.
+ * @return The size of the block.
+ */
+ENGINE_API size_t CompressLz(
+    const uint8_t* source, size_t size, uint8_t* destination);
+
+/**
+ * @fn DecompressLz
+ * @param source A block written by CompressLz.
+ * @param size The size of the block.
+ * @param destination Receives the decompressed data.
+ * @param decompressed_size The exact size of the decompressed data.
+ * @brief Decompresses a block. Never reads or writes out of bounds, even for
+ * corrupt blocks.
+ * @return false if the block is corrupt or doesn't decompress to exactly
+ * decompressed_size bytes.
+ */
+ENGINE_API bool DecompressLz(
+    const uint8_t* source,
+    size_t size,
+    uint8_t* destination,
+    size_t decompressed_size);
+
+}  // namespace compression
+}  // namespace engine
+
+#endif  // ENGINE_SRC_CORE_COMPRESSION_LZ_H_
@@ -0,0 +1,198 @@
+#include "core/cpu/CpuFeatures.h"
+
+#include <atomic>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) \
+    || defined(_M_IX86)
+  #define ENGINE_CPU_X86
+  #if defined(_MSC_VER)
+    #include <intrin.h>
+    #include <immintrin.h>
+  #else
+    #include <cpuid.h>
+  #endif
+#endif
+
+namespace engine {
+namespace cpu {
+
+namespace {
+
+std::atomic<uint32_t> kFeatureMask(~0u);
+
+#if defined(ENGINE_CPU_X86)
+
+struct Registers {
+  uint32_t Eax, Ebx, Ecx, Edx;
+};
+
+Registers Cpuid(uint32_t leaf, uint32_t subleaf = 0) {
+  Registers registers;
+#if defined(_MSC_VER)
+  int values[4];
+  __cpuidex(values, static_cast<int>(leaf), static_cast<int>(subleaf));
+  registers = {
+      static_cast<uint32_t>(values[0]), static_cast<uint32_t>(values[1]),
+      static_cast<uint32_t>(values[2]), static_cast<uint32_t>(values[3]) };
+#else
+  __cpuid_count(
+      leaf, subleaf, registers.Eax, registers.Ebx, registers.Ecx,
+      registers.Edx);
+#endif
+  return registers;
+}
+
+// The register state the operating system saves on context switches.
+uint64_t ReadXcr0() {
+#if defined(_MSC_VER)
+  return _xgetbv(0);
+#else
+  uint32_t low, high;
+  __asm__ volatile("xgetbv" : "=a"(low), "=d"(high) : "c"(0));
+  return (static_cast<uint64_t>(high) << 32) | low;
+#endif
+}
+
+inline bool IsSet(uint32_t value, int bit) {
+  return (value >> bit) & 1;
+}
+
+inline uint32_t FeatureIf(uint32_t value, int bit, uint32_t feature) {
+  return IsSet(value, bit) ? feature : kCpuFeatureNone;
+}
+
+CpuInfo Detect() {
+  CpuInfo info;
+
+  Registers vendor = Cpuid(0);
+  uint32_t max_leaf = vendor.Eax;
+  char name[13] = {};
+  std::memcpy(name, &vendor.Ebx, 4);
+  std::memcpy(name + 4, &vendor.Edx, 4);
+  std::memcpy(name + 8, &vendor.Ecx, 4);
+  info.Vendor = name;
+
+  uint32_t max_extended_leaf = Cpuid(0x80000000).Eax;
+  if (max_extended_leaf >= 0x80000004) {
+    char brand[49] = {};
+    for (uint32_t leaf = 0; leaf < 3; ++leaf) {
+      Registers registers = Cpuid(0x80000002 + leaf);
+      std::memcpy(brand + leaf * 16, &registers, 16);
+    }
+    info.Brand = brand;
+    info.Brand.erase(0, info.Brand.find_first_not_of(' '));
+  }
+
+  if (max_leaf < 1) {
+    return info;
+  }
+
+  Registers basic = Cpuid(1);
+  uint32_t features = kCpuFeatureNone;
+  features |= FeatureIf(basic.Edx, 26, kCpuFeatureSse2);
+  features |= FeatureIf(basic.Ecx, 0, kCpuFeatureSse3);
+  features |= FeatureIf(basic.Ecx, 9, kCpuFeatureSsse3);
+  features |= FeatureIf(basic.Ecx, 19, kCpuFeatureSse41);
+  features |= FeatureIf(basic.Ecx, 20, kCpuFeatureSse42);
+  features |= FeatureIf(basic.Ecx, 23, kCpuFeaturePopcnt);
+
+  // Without OSXSAVE the operating system doesn't preserve the AVX registers
+  // and executing AVX instructions would corrupt other threads.
+  bool avx_state = false, avx512_state = false;
+  if (IsSet(basic.Ecx, 27)) {
+    uint64_t xcr0 = ReadXcr0();
+    avx_state = (xcr0 & 0x6) == 0x6;
+    avx512_state = avx_state && (xcr0 & 0xe0) == 0xe0;
+  }
+
+  if (avx_state) {
+    features |= FeatureIf(basic.Ecx, 28, kCpuFeatureAvx);
+    features |= FeatureIf(basic.Ecx, 12, kCpuFeatureFma);
+    features |= FeatureIf(basic.Ecx, 29, kCpuFeatureF16c);
+  }
+
+  if (max_leaf >= 7) {
+    Registers extended = Cpuid(7, 0);
+    features |= FeatureIf(extended.Ebx, 3, kCpuFeatureBmi1);
+    features |= FeatureIf(extended.Ebx, 8, kCpuFeatureBmi2);
+    if (avx_state) {
+      features |= FeatureIf(extended.Ebx, 5, kCpuFeatureAvx2);
+    }
+    if (avx512_state) {
+      features |= FeatureIf(extended.Ebx, 16, kCpuFeatureAvx512F);
+      features |= FeatureIf(extended.Ebx, 17, kCpuFeatureAvx512Dq);
+      features |= FeatureIf(extended.Ebx, 30, kCpuFeatureAvx512Bw);
+      features |= FeatureIf(extended.Ebx, 31, kCpuFeatureAvx512Vl);
+    }
+  }
+
+  info.Features = features;
+  return info;
+}
+
+#else
+
+CpuInfo Detect() {
+  CpuInfo info;
+  info.Vendor = "Unknown";
+  return info;
+}
+
+#endif
+
+}  // namespace
+
+const CpuInfo& GetCpuInfo() {
+  static const CpuInfo kInfo = Detect();
+  return kInfo;
+}
+
+uint32_t GetCpuFeatures() {
+  return GetCpuInfo().Features & kFeatureMask.load(std::memory_order_relaxed);
+}
+
+bool HasCpuFeatures(uint32_t features) {
+  return (GetCpuFeatures() & features) == features;
+}
+
+void SetCpuFeatureMask(uint32_t mask) {
+  kFeatureMask.store(mask, std::memory_order_relaxed);
+}
+
+std::string GetCpuFeatureString(uint32_t features) {
+  static const struct {
+    uint32_t Feature;
+    const char* Name;
+  } kNames[] = {
+      { kCpuFeatureSse2, "SSE2" },
+      { kCpuFeatureSse3, "SSE3" },
+      { kCpuFeatureSsse3, "SSSE3" },
+      { kCpuFeatureSse41, "SSE4.1" },
+      { kCpuFeatureSse42, "SSE4.2" },
+      { kCpuFeaturePopcnt, "POPCNT" },
+      { kCpuFeatureAvx, "AVX" },
+      { kCpuFeatureAvx2, "AVX2" },
+      { kCpuFeatureFma, "FMA" },
+      { kCpuFeatureF16c, "F16C" },
+      { kCpuFeatureBmi1, "BMI1" },
+      { kCpuFeatureBmi2, "BMI2" },
+      { kCpuFeatureAvx512F, "AVX512F" },
+      { kCpuFeatureAvx512Dq, "AVX512DQ" },
+      { kCpuFeatureAvx512Bw, "AVX512BW" },
+      { kCpuFeatureAvx512Vl, "AVX512VL" } };
+
+  std::string names;
+  for (const auto& entry : kNames) {
+    if (features & entry.Feature) {
+      if (!names.empty()) {
+        names += ' ';
+      }
+      names += entry.Name;
+    }
+  }
+  return names;
+}
+
+}  // namespace cpu
+}  // namespace engine
@@ -0,0 +1,97 @@
+/**
+ * @file engine/src/core/cpu/CpuFeatures.h
+ * @brief Detects the instruction set extensions of the processor at runtime.
+ *
+ * The engine is built for the baseline of its target architecture so that a
+ * single binary runs on every machine it is deployed to. Code that benefits
+ * from newer extensions is compiled separately for them and selected with the
+ * features reported here (Check `engine/src/core/cpu/Dispatch.h`).
+ *
+ * A feature is only reported when both the processor and the operating system
+ * support it. AVX and AVX-512 additionally require the operating system to
+ * save the wider registers on context switches, which is checked through
+ * XGETBV.
+ */
+#ifndef ENGINE_SRC_CORE_CPU_CPUFEATURES_H_
+#define ENGINE_SRC_CORE_CPU_CPUFEATURES_H_
+
+#include <cstdint>
+#include <string>
+
+#include "core/Core.h"
+
+namespace engine {
+namespace cpu {
+
+/**
+ * @enum CpuFeatureFlags
+ * @brief Instruction set extensions that kernels can be compiled for.
+ */
+enum CpuFeatureFlags : uint32_t {
+  kCpuFeatureNone = 0,
+  kCpuFeatureSse2 = BIT(0),
+  kCpuFeatureSse3 = BIT(1),
+  kCpuFeatureSsse3 = BIT(2),
+  kCpuFeatureSse41 = BIT(3),
+  kCpuFeatureSse42 = BIT(4),
+  kCpuFeaturePopcnt = BIT(5),
+  kCpuFeatureAvx = BIT(6),
+  kCpuFeatureAvx2 = BIT(7),
+  kCpuFeatureFma = BIT(8),
+  kCpuFeatureF16c = BIT(9),
+  kCpuFeatureBmi1 = BIT(10),
+  kCpuFeatureBmi2 = BIT(11),
+  kCpuFeatureAvx512F = BIT(12),
+  kCpuFeatureAvx512Dq = BIT(13),
+  kCpuFeatureAvx512Bw = BIT(14),
+  kCpuFeatureAvx512Vl = BIT(15)
+};
+
+/**
+ * @struct CpuInfo
+ * @brief What the processor reported about itself.
+ */
+struct CpuInfo {
+  std::string Vendor;
+  std::string Brand;
+  uint32_t Features = kCpuFeatureNone;
+};
+
+/**
+ * @fn GetCpuInfo
+ * @brief Get the processor information, detecting it on the first call.
+ */
+ENGINE_API const CpuInfo& GetCpuInfo();
+
+/**
+ * @fn GetCpuFeatures
+ * @brief Get the detected features that haven't been masked out.
+ */
+ENGINE_API uint32_t GetCpuFeatures();
+
+/**
+ * @fn HasCpuFeatures
+ * @brief Check if every feature in features is available.
+ */
+ENGINE_API bool HasCpuFeatures(uint32_t features);
+
+/**
+ * @fn SetCpuFeatureMask
+ * @brief Hides every feature not in mask from GetCpuFeatures.
+ *
+ * Used to test the fallback paths of kernels on a machine that supports the
+ * faster ones. Kernels that have already been selected are not affected, so
+ * this should be called before anything dispatches.
+ */
+ENGINE_API void SetCpuFeatureMask(uint32_t mask);
+
+/**
+ * @fn GetCpuFeatureString
+ * @brief Get the names of the features as a space separated list.
+ */
+ENGINE_API std::string GetCpuFeatureString(uint32_t features);
+
+}  // namespace cpu
+}  // namespace engine
+
+#endif  // ENGINE_SRC_CORE_CPU_CPUFEATURES_H_
@@ -0,0 +1,62 @@
+/**
+ * @file engine/src/core/cpu/Dispatch.h
+ * @brief Selects between versions of a kernel compiled for different
+ * instruction sets.
+ *
+ * Hot kernels are compiled several times, once per translation unit with the
+ * flags of an instruction set set in CMakeLists.txt (Check
+ * `engine/src/core/math/SimdKernels.h`). A translation unit that can't be
+ * compiled for its instruction set, for example on another architecture,
+ * provides a null kernel instead. The best version is then picked once at
+ * startup:
+ *
+ *   static Kernel* const kKernel = engine::cpu::SelectKernel<Kernel>({
+ *       { kCpuFeatureAvx2 | kCpuFeatureFma, GetAvx2Kernel() },
+ *       { kCpuFeatureSse42, GetSse42Kernel() },
+ *       { kCpuFeatureNone, &BaselineKernel } });
+ */
+#ifndef ENGINE_SRC_CORE_CPU_DISPATCH_H_
+#define ENGINE_SRC_CORE_CPU_DISPATCH_H_
+
+#include <cstdint>
+#include <initializer_list>
+
+#include "core/Assert.h"
+#include "core/cpu/CpuFeatures.h"
+
+namespace engine {
+namespace cpu {
+
+/**
+ * @struct KernelVariant
+ * @brief A version of a kernel and the features it was compiled for. Kernel
+ * may be a function type or a table of functions.
+ */
+template<typename Kernel>
+struct KernelVariant {
+  uint32_t RequiredFeatures;
+  Kernel* Implementation;
+};
+
+/**
+ * @fn SelectKernel
+ * @brief Get the first variant that exists and whose features are all
+ * available. Variants should be ordered from the fastest to the slowest and
+ * end with one that requires no features.
+ */
+template<typename Kernel>
+Kernel* SelectKernel(std::initializer_list<KernelVariant<Kernel>> variants) {
+  for (const KernelVariant<Kernel>& variant : variants) {
+    if (variant.Implementation && HasCpuFeatures(variant.RequiredFeatures)) {
+      return variant.Implementation;
+    }
+  }
+
+  ENGINE_CORE_ASSERT(false, "No kernel variant runs on this processor.");
+  return nullptr;
+}
+
+}  // namespace cpu
+}  // namespace engine
+
+#endif  // ENGINE_SRC_CORE_CPU_DISPATCH_H_
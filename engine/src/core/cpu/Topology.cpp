@@ -0,0 +1,187 @@
+#include "core/cpu/Topology.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <thread>
+
+#if defined(ENGINE_PLATFORM_WINDOWS)
+  // Keeps windows.h from defining min and max macros, which would break
+  // std::min and std::max.
+  #ifndef NOMINMAX
+    #define NOMINMAX
+  #endif
+  #include <windows.h>
+#elif defined(__linux__)
+  #include <dirent.h>
+  #include <pthread.h>
+  #include <sched.h>
+#endif
+
+namespace engine {
+namespace cpu {
+
+namespace {
+
+#if defined(__linux__) && !defined(ENGINE_PLATFORM_WINDOWS)
+
+/**
+ * Parses a kernel cpu list such as "0-7,16-23".
+ */
+std::vector<uint32_t> ParseCpuList(const std::string& text) {
+  std::vector<uint32_t> processors;
+  const char* position = text.c_str();
+  while (*position) {
+    char* end;
+    unsigned long first = std::strtoul(position, &end, 10);
+    if (end == position) {
+      break;
+    }
+    unsigned long last = first;
+    if (*end == '-') {
+      position = end + 1;
+      last = std::strtoul(position, &end, 10);
+    }
+    for (unsigned long processor = first; processor <= last; ++processor) {
+      processors.push_back(static_cast<uint32_t>(processor));
+    }
+    position = *end == ',' ? end + 1 : end;
+  }
+  return processors;
+}
+
+CpuTopology Detect() {
+  CpuTopology topology;
+
+  cpu_set_t allowed;
+  CPU_ZERO(&allowed);
+  bool have_affinity = sched_getaffinity(0, sizeof(allowed), &allowed) == 0;
+  auto is_allowed = [&](uint32_t processor) {
+    return !have_affinity
+        || (processor < CPU_SETSIZE && CPU_ISSET(processor, &allowed));
+  };
+
+  const char* kNodeDirectory = "/sys/devices/system/node";
+  if (DIR* directory = opendir(kNodeDirectory)) {
+    while (dirent* entry = readdir(directory)) {
+      std::string name = entry->d_name;
+      if (name.compare(0, 4, "node") != 0 || name.size() == 4
+          || name.find_first_not_of("0123456789", 4) != std::string::npos) {
+        continue;
+      }
+
+      std::ifstream file(
+          std::string(kNodeDirectory) + "/" + name + "/cpulist");
+      std::string list;
+      std::getline(file, list);
+
+      NumaNode node;
+      node.Id = static_cast<uint32_t>(
+          std::strtoul(name.c_str() + 4, nullptr, 10));
+      for (uint32_t processor : ParseCpuList(list)) {
+        if (is_allowed(processor)) {
+          node.Processors.push_back(processor);
+        }
+      }
+      if (!node.Processors.empty()) {
+        topology.Nodes.push_back(node);
+      }
+    }
+    closedir(directory);
+  }
+
+  std::sort(
+      topology.Nodes.begin(), topology.Nodes.end(),
+      [](const NumaNode& a, const NumaNode& b) { return a.Id < b.Id; });
+
+  if (topology.Nodes.empty()) {
+    NumaNode node;
+    for (uint32_t processor = 0; processor < CPU_SETSIZE; ++processor) {
+      if (have_affinity && CPU_ISSET(processor, &allowed)) {
+        node.Processors.push_back(processor);
+      }
+    }
+    topology.Nodes.push_back(node);
+  }
+  return topology;
+}
+
+#else
+
+CpuTopology Detect() {
+  return CpuTopology();
+}
+
+#endif
+
+}  // namespace
+
+uint32_t CpuTopology::GetProcessorCount() const {
+  uint32_t count = 0;
+  for (const NumaNode& node : Nodes) {
+    count += static_cast<uint32_t>(node.Processors.size());
+  }
+  return count;
+}
+
+const CpuTopology& GetCpuTopology() {
+  static const CpuTopology kTopology = [] {
+    CpuTopology topology = Detect();
+    if (topology.Nodes.empty()) {
+      topology.Nodes.emplace_back();
+    }
+
+    // Without affinity information assume every hardware thread is usable.
+    NumaNode& first = topology.Nodes.front();
+    if (topology.Nodes.size() == 1 && first.Processors.empty()) {
+      uint32_t count = std::max(std::thread::hardware_concurrency(), 1u);
+      for (uint32_t processor = 0; processor < count; ++processor) {
+        first.Processors.push_back(processor);
+      }
+    }
+    return topology;
+  }();
+  return kTopology;
+}
+
+uint32_t GetCurrentNumaNode() {
+  const CpuTopology& topology = GetCpuTopology();
+  if (topology.Nodes.size() == 1) {
+    return 0;
+  }
+
+#if defined(__linux__) && !defined(ENGINE_PLATFORM_WINDOWS)
+  int current = sched_getcpu();
+  for (size_t node = 0; node < topology.Nodes.size(); ++node) {
+    const std::vector<uint32_t>& processors = topology.Nodes[node].Processors;
+    if (std::find(processors.begin(), processors.end(),
+                  static_cast<uint32_t>(current)) != processors.end()) {
+      return static_cast<uint32_t>(node);
+    }
+  }
+#endif
+  return 0;
+}
+
+bool PinCurrentThread(uint32_t processor) {
+#if defined(ENGINE_PLATFORM_WINDOWS)
+  if (processor >= 64) {
+    return false;
+  }
+  return SetThreadAffinityMask(GetCurrentThread(), 1ull << processor) != 0;
+#elif defined(__linux__)
+  if (processor >= CPU_SETSIZE) {
+    return false;
+  }
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(processor, &set);
+  return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+  return false;
+#endif
+}
+
+}  // namespace cpu
+}  // namespace engine
@@ -0,0 +1,77 @@
+/**
+ * @file engine/src/core/cpu/Topology.h
+ * @brief Detects which logical processors share a NUMA node.
+ *
+ * On machines with multiple sockets every socket has its own memory, and
+ * reading memory attached to another socket is considerably slower than
+ * reading local memory. The job system uses the topology to keep workers on
+ * their node, and arenas use it to place their pages next to the threads
+ * that use them.
+ *
+ * The topology is read from /sys/devices/system/node on Linux and limited to
+ * the processors the process is allowed to run on. Everywhere else, and on
+ * machines without NUMA, every processor is reported on a single node 0.
+ */
+#ifndef ENGINE_SRC_CORE_CPU_TOPOLOGY_H_
+#define ENGINE_SRC_CORE_CPU_TOPOLOGY_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "core/Core.h"
+
+namespace engine {
+namespace cpu {
+
+/**
+ * @struct NumaNode
+ * @brief A memory node and the logical processors attached to it.
+ */
+struct NumaNode {
+  // The operating system's id of the node, used for binding memory.
+  uint32_t Id = 0;
+  std::vector<uint32_t> Processors;
+};
+
+/**
+ * @struct CpuTopology
+ * @brief The NUMA nodes of the machine that have usable processors, ordered
+ * by id.
+ */
+struct ENGINE_API CpuTopology {
+  std::vector<NumaNode> Nodes;
+
+  /**
+   * @fn GetProcessorCount
+   * @brief Get the number of usable logical processors on all nodes.
+   */
+  uint32_t GetProcessorCount() const;
+};
+
+/**
+ * @fn GetCpuTopology
+ * @brief Get the topology, detecting it on the first call. Always holds at
+ * least one node with at least one processor.
+ */
+ENGINE_API const CpuTopology& GetCpuTopology();
+
+/**
+ * @fn GetCurrentNumaNode
+ * @brief Get the index into CpuTopology::Nodes of the node the calling thread
+ * is running on. Threads that aren't pinned can move between nodes at any
+ * time, so this is only a hint for them.
+ */
+ENGINE_API uint32_t GetCurrentNumaNode();
+
+/**
+ * @fn PinCurrentThread
+ * @param processor The logical processor to run on.
+ * @brief Restricts the calling thread to a single logical processor.
+ * @return false if the operating system refused or doesn't support it.
+ */
+ENGINE_API bool PinCurrentThread(uint32_t processor);
+
+}  // namespace cpu
+}  // namespace engine
+
+#endif  // ENGINE_SRC_CORE_CPU_TOPOLOGY_H_
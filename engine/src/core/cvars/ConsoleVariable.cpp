@@ -0,0 +1,275 @@
+#include "core/cvars/ConsoleVariable.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+
+#include "core/Log.h"
+
+namespace engine {
+namespace cvars {
+
+namespace {
+
+/**
+ * Variables register during static initialization, in an order that can't be
+ * controlled, so the registry is constructed on first use.
+ */
+struct Registry {
+  std::mutex Mutex;
+  std::map<std::string, ConsoleVariableBase*> Variables;
+  std::vector<ConsoleVariableBase*> Pending;
+};
+
+Registry& GetRegistry() {
+  static Registry kRegistry;
+  return kRegistry;
+}
+
+std::string Trim(const std::string& text) {
+  size_t begin = 0, end = text.size();
+  auto is_space = [](char c) {
+    return std::isspace(static_cast<unsigned char>(c)) != 0;
+  };
+  while (begin < end && is_space(text[begin])) {
+    ++begin;
+  }
+  while (end > begin && is_space(text[end - 1])) {
+    --end;
+  }
+  return text.substr(begin, end - begin);
+}
+
+}  // namespace
+
+// ----------------------------------- VALUES ----------------------------------
+
+bool ParseValue(const std::string& text, bool* value) {
+  std::string lower = Trim(text);
+  std::transform(lower.begin(), lower.end(), lower.begin(), [](char c) {
+    return static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+  });
+
+  if (lower == "1" || lower == "true" || lower == "on") {
+    *value = true;
+    return true;
+  }
+  if (lower == "0" || lower == "false" || lower == "off") {
+    *value = false;
+    return true;
+  }
+  return false;
+}
+
+bool ParseValue(const std::string& text, int32_t* value) {
+  std::string trimmed = Trim(text);
+  char* end = nullptr;
+  errno = 0;
+  long parsed = std::strtol(trimmed.c_str(), &end, 0);
+  if (trimmed.empty() || *end != '\0' || errno == ERANGE
+      || parsed < INT32_MIN || parsed > INT32_MAX) {
+    return false;
+  }
+  *value = static_cast<int32_t>(parsed);
+  return true;
+}
+
+bool ParseValue(const std::string& text, float* value) {
+  std::string trimmed = Trim(text);
+  char* end = nullptr;
+  float parsed = std::strtof(trimmed.c_str(), &end);
+  if (trimmed.empty() || *end != '\0' || !std::isfinite(parsed)) {
+    return false;
+  }
+  *value = parsed;
+  return true;
+}
+
+std::string FormatValue(bool value) {
+  return value ? "true" : "false";
+}
+
+std::string FormatValue(int32_t value) {
+  return std::to_string(value);
+}
+
+std::string FormatValue(float value) {
+  char buffer[32];
+  // Nine significant digits are enough for every float to parse back to
+  // itself.
+  std::snprintf(buffer, sizeof(buffer), "%.9g", value);
+  return buffer;
+}
+
+// ---------------------------------- VARIABLES --------------------------------
+
+ConsoleVariableBase::ConsoleVariableBase(
+    const char* name, const char* description, ConsoleVariableType type)
+    : name_(name), description_(description), type_(type) {
+  ConsoleVariables::Register(this);
+}
+
+ConsoleVariableBase::~ConsoleVariableBase() {
+  ConsoleVariables::Unregister(this);
+}
+
+void ConsoleVariableBase::QueueChange() {
+  if (!queued_.exchange(true, std::memory_order_acq_rel)) {
+    ConsoleVariables::QueueChange(this);
+  }
+}
+
+// ---------------------------------- REGISTRY ---------------------------------
+
+/**
+ * Logging isn't initialized during static initialization, so duplicate names
+ * can't be reported here. The first variable registered under a name wins.
+ */
+void ConsoleVariables::Register(ConsoleVariableBase* variable) {
+  Registry& registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.Mutex);
+  registry.Variables.insert({ variable->GetName(), variable });
+}
+
+void ConsoleVariables::Unregister(ConsoleVariableBase* variable) {
+  Registry& registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.Mutex);
+
+  auto entry = registry.Variables.find(variable->GetName());
+  if (entry != registry.Variables.end() && entry->second == variable) {
+    registry.Variables.erase(entry);
+  }
+
+  registry.Pending.erase(
+      std::remove(registry.Pending.begin(), registry.Pending.end(), variable),
+      registry.Pending.end());
+}
+
+void ConsoleVariables::QueueChange(ConsoleVariableBase* variable) {
+  Registry& registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.Mutex);
+  registry.Pending.push_back(variable);
+}
+
+ConsoleVariableBase* ConsoleVariables::Find(const std::string& name) {
+  Registry& registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.Mutex);
+  auto entry = registry.Variables.find(name);
+  return entry != registry.Variables.end() ? entry->second : nullptr;
+}
+
+bool ConsoleVariables::Set(const std::string& name, const std::string& value) {
+  ConsoleVariableBase* variable = Find(name);
+  if (!variable) {
+    ENGINE_CORE_WARN("Unknown console variable {}.", name);
+    return false;
+  }
+
+  if (!variable->SetFromString(value)) {
+    ENGINE_CORE_WARN(
+        "Invalid value \"{}\" for console variable {}.", value, name);
+    return false;
+  }
+  return true;
+}
+
+bool ConsoleVariables::Execute(const std::string& command) {
+  std::string trimmed = Trim(command);
+  if (trimmed.empty()) {
+    return false;
+  }
+
+  size_t separator = trimmed.find_first_of("= \t");
+  std::string name = trimmed.substr(0, separator);
+  if (separator == std::string::npos) {
+    ConsoleVariableBase* variable = Find(name);
+    if (!variable) {
+      ENGINE_CORE_WARN("Unknown console variable {}.", name);
+      return false;
+    }
+    ENGINE_CORE_INFO(
+        "{} = {} ({})",
+        name,
+        variable->ToString(),
+        variable->GetDescription());
+    return true;
+  }
+
+  std::string value = Trim(trimmed.substr(separator + 1));
+  if (!value.empty() && value[0] == '=') {
+    value = Trim(value.substr(1));
+  }
+  return Set(name, value);
+}
+
+void ConsoleVariables::ParseCommandLine(int argc, char** argv) {
+  for (int i = 1; i < argc; ++i) {
+    if (argv[i][0] == '+') {
+      Execute(argv[i] + 1);
+    }
+  }
+}
+
+bool ConsoleVariables::LoadFile(const std::string& path) {
+  std::ifstream file(path);
+  if (!file) {
+    return false;
+  }
+
+  std::string line;
+  while (std::getline(file, line)) {
+    size_t comment = line.find('#');
+    if (comment != std::string::npos) {
+      line.erase(comment);
+    }
+    if (!Trim(line).empty()) {
+      Execute(line);
+    }
+  }
+  return true;
+}
+
+/**
+ * Callbacks may stage new values themselves, which are applied at the next
+ * boundary rather than recursively.
+ */
+void ConsoleVariables::ApplyChanges() {
+  Registry& registry = GetRegistry();
+  std::vector<ConsoleVariableBase*> pending;
+  {
+    std::lock_guard<std::mutex> lock(registry.Mutex);
+    pending.swap(registry.Pending);
+  }
+
+  for (ConsoleVariableBase* variable : pending) {
+    // A read-modify-write, so that it either sees the exchange of a setter
+    // racing with it, which makes that setter's staged value visible to the
+    // Apply below, or makes the setter queue the variable again. A plain
+    // store followed by the load in Apply could miss both.
+    variable->queued_.exchange(false, std::memory_order_acq_rel);
+    if (variable->Apply()) {
+      variable->NotifyChanged();
+    }
+  }
+}
+
+std::vector<ConsoleVariableBase*> ConsoleVariables::GetAll() {
+  Registry& registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.Mutex);
+
+  std::vector<ConsoleVariableBase*> variables;
+  variables.reserve(registry.Variables.size());
+  for (const auto& entry : registry.Variables) {
+    variables.push_back(entry.second);
+  }
+  return variables;
+}
+
+}  // namespace cvars
+}  // namespace engine
@@ -0,0 +1,321 @@
+/**
+ * @file engine/src/core/cvars/ConsoleVariable.h
+ * @brief Named engine settings that can be changed while the engine runs.
+ *
+ * Console variables are declared as globals next to the code that reads them
+ * and register themselves before main runs:
+ *
+ *   engine::cvars::ConsoleVariable<float> kLodDistance(
+ *       "r.lod_distance", 50.0f, "Distance at which meshes switch LOD.");
+ *
+ *   float distance = kLodDistance.Get();
+ *
+ * Get is a single relaxed atomic load, so it is safe to call on any thread on
+ * the hot path. Variables that are declared elsewhere can be found by name
+ * once and the pointer cached.
+ *
+ * New values can come from the command line, a config file, or the ImGui
+ * console, on any thread. They are staged and only become visible at the next
+ * frame boundary, when ConsoleVariables::ApplyChanges publishes them and runs
+ * the change callbacks on the main thread. A frame therefore never observes a
+ * variable changing halfway through.
+ */
+#ifndef ENGINE_SRC_CORE_CVARS_CONSOLEVARIABLE_H_
+#define ENGINE_SRC_CORE_CVARS_CONSOLEVARIABLE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "core/Core.h"
+
+namespace engine {
+namespace cvars {
+
+/**
+ * @enum ConsoleVariableType
+ * @brief The value types console variables can hold. Only types that fit in a
+ * lock free atomic are supported, which keeps reads free of locks.
+ */
+enum class ConsoleVariableType {
+  kBool,
+  kInt,
+  kFloat
+};
+
+template<typename T>
+struct ConsoleVariableTraits;
+
+template<>
+struct ConsoleVariableTraits<bool> {
+  static constexpr ConsoleVariableType kType = ConsoleVariableType::kBool;
+};
+
+template<>
+struct ConsoleVariableTraits<int32_t> {
+  static constexpr ConsoleVariableType kType = ConsoleVariableType::kInt;
+};
+
+template<>
+struct ConsoleVariableTraits<float> {
+  static constexpr ConsoleVariableType kType = ConsoleVariableType::kFloat;
+};
+
+ENGINE_API bool ParseValue(const std::string& text, bool* value);
+ENGINE_API bool ParseValue(const std::string& text, int32_t* value);
+ENGINE_API bool ParseValue(const std::string& text, float* value);
+
+ENGINE_API std::string FormatValue(bool value);
+ENGINE_API std::string FormatValue(int32_t value);
+ENGINE_API std::string FormatValue(float value);
+
+// ---------------------------------- VARIABLES --------------------------------
+
+/**
+ * @class ConsoleVariableBase
+ * @brief The type independent part of a console variable, used by the
+ * registry and by tools that list every variable.
+ */
+class ENGINE_API ConsoleVariableBase {
+ public:
+  ConsoleVariableBase(
+      const char* name, const char* description, ConsoleVariableType type);
+  virtual ~ConsoleVariableBase();
+
+  ConsoleVariableBase(const ConsoleVariableBase&) = delete;
+  ConsoleVariableBase& operator=(const ConsoleVariableBase&) = delete;
+
+  inline const char* GetName() const { return name_; }
+  inline const char* GetDescription() const { return description_; }
+  inline ConsoleVariableType GetType() const { return type_; }
+
+  /**
+   * @fn ToString
+   * @brief Get the current value formatted the same way SetFromString parses
+   * it.
+   */
+  virtual std::string ToString() const = 0;
+
+  /**
+   * @fn SetFromString
+   * @brief Stages a new value parsed from text. Returns false when the text
+   * isn't a valid value of the variables type.
+   */
+  virtual bool SetFromString(const std::string& text) = 0;
+
+ protected:
+  /**
+   * @fn QueueChange
+   * @brief Schedules the variable to be applied at the next frame boundary.
+   */
+  void QueueChange();
+
+  /**
+   * @fn Apply
+   * @brief Publishes the staged value. Returns true if the value changed.
+   */
+  virtual bool Apply() = 0;
+
+  /**
+   * @fn NotifyChanged
+   * @brief Runs the change callbacks with the current value.
+   */
+  virtual void NotifyChanged() = 0;
+
+  std::mutex callback_mutex_;
+
+ private:
+  const char* name_;
+  const char* description_;
+  ConsoleVariableType type_;
+  std::atomic<bool> queued_{false};
+
+  friend class ConsoleVariables;
+};
+
+/**
+ * @class ConsoleVariable
+ * @brief A console variable holding a bool, int32_t or float.
+ */
+template<typename T>
+class ConsoleVariable : public ConsoleVariableBase {
+ public:
+  typedef std::function<void(T value)> ChangeCallback;
+
+  ConsoleVariable(const char* name, T default_value, const char* description)
+      : ConsoleVariableBase(
+            name, description, ConsoleVariableTraits<T>::kType),
+        default_value_(default_value),
+        value_(default_value),
+        staged_(default_value) {}
+
+  /**
+   * @fn Get
+   * @brief Get the value for the current frame. Lock free.
+   */
+  inline T Get() const { return value_.load(std::memory_order_relaxed); }
+
+  inline T GetDefault() const { return default_value_; }
+
+  /**
+   * @fn Set
+   * @brief Stages value to become visible at the next frame boundary. Safe to
+   * call from any thread. The last value staged before the boundary wins.
+   */
+  inline void Set(T value) {
+    staged_.store(value, std::memory_order_relaxed);
+    QueueChange();
+  }
+
+  inline void Reset() { Set(default_value_); }
+
+  /**
+   * @fn AddCallback
+   * @brief Registers a function that is called on the main thread at the
+   * frame boundary where the value changes.
+   * @return A handle for RemoveCallback.
+   */
+  uint32_t AddCallback(const ChangeCallback& callback) {
+    std::lock_guard<std::mutex> lock(callback_mutex_);
+    callbacks_.push_back({ next_callback_, callback });
+    return next_callback_++;
+  }
+
+  void RemoveCallback(uint32_t handle) {
+    std::lock_guard<std::mutex> lock(callback_mutex_);
+    for (auto it = callbacks_.begin(); it != callbacks_.end(); ++it) {
+      if (it->first == handle) {
+        callbacks_.erase(it);
+        return;
+      }
+    }
+  }
+
+  std::string ToString() const override { return FormatValue(Get()); }
+
+  bool SetFromString(const std::string& text) override {
+    T value;
+    if (!ParseValue(text, &value)) {
+      return false;
+    }
+    Set(value);
+    return true;
+  }
+
+ protected:
+  bool Apply() override {
+    T staged = staged_.load(std::memory_order_relaxed);
+    return value_.exchange(staged, std::memory_order_relaxed) != staged;
+  }
+
+  /**
+   * Copies the callbacks first so that a callback may add or remove
+   * callbacks without deadlocking.
+   */
+  void NotifyChanged() override {
+    std::vector<std::pair<uint32_t, ChangeCallback>> callbacks;
+    {
+      std::lock_guard<std::mutex> lock(callback_mutex_);
+      callbacks = callbacks_;
+    }
+
+    T value = Get();
+    for (const auto& callback : callbacks) {
+      callback.second(value);
+    }
+  }
+
+ private:
+  const T default_value_;
+  std::atomic<T> value_;
+  std::atomic<T> staged_;
+  std::vector<std::pair<uint32_t, ChangeCallback>> callbacks_;
+  uint32_t next_callback_ = 0;
+};
+
+// ---------------------------------- REGISTRY ---------------------------------
+
+/**
+ * @class ConsoleVariables
+ * @brief Static interface into the registry of every console variable.
+ */
+class ENGINE_API ConsoleVariables {
+ public:
+  /**
+   * @fn Find
+   * @brief Get the variable with the given name, or nullptr if there is none.
+   */
+  static ConsoleVariableBase* Find(const std::string& name);
+
+  /**
+   * @fn Find
+   * @brief Get the variable with the given name and type, or nullptr if there
+   * is none. The result should be cached rather than looked up every frame.
+   */
+  template<typename T>
+  static ConsoleVariable<T>* Find(const std::string& name) {
+    ConsoleVariableBase* variable = Find(name);
+    if (!variable || variable->GetType() != ConsoleVariableTraits<T>::kType) {
+      return nullptr;
+    }
+    return static_cast<ConsoleVariable<T>*>(variable);
+  }
+
+  /**
+   * @fn Set
+   * @brief Stages a value for the named variable. Logs a warning and returns
+   * false if the variable doesn't exist or the value can't be parsed.
+   */
+  static bool Set(const std::string& name, const std::string& value);
+
+  /**
+   * @fn Execute
+   * @brief Runs a console command of the form "name value" or "name=value".
+   * A command with only a name logs the variable and its description.
+   */
+  static bool Execute(const std::string& command);
+
+  /**
+   * @fn ParseCommandLine
+   * @brief Stages every argument of the form +name=value. Other arguments are
+   * left for the application.
+   */
+  static void ParseCommandLine(int argc, char** argv);
+
+  /**
+   * @fn LoadFile
+   * @brief Stages every line of a config file. Lines hold commands accepted
+   * by Execute, and everything after a # is a comment.
+   * @return false if the file couldn't be opened.
+   */
+  static bool LoadFile(const std::string& path);
+
+  /**
+   * @fn ApplyChanges
+   * @brief Publishes every staged value and runs the change callbacks. Called
+   * by the application on the main thread at the end of every frame.
+   */
+  static void ApplyChanges();
+
+  /**
+   * @fn GetAll
+   * @brief Get every registered variable sorted by name.
+   */
+  static std::vector<ConsoleVariableBase*> GetAll();
+
+ private:
+  static void Register(ConsoleVariableBase* variable);
+  static void Unregister(ConsoleVariableBase* variable);
+  static void QueueChange(ConsoleVariableBase* variable);
+
+  friend class ConsoleVariableBase;
+};
+
+}  // namespace cvars
+}  // namespace engine
+
+#endif  // ENGINE_SRC_CORE_CVARS_CONSOLEVARIABLE_H_
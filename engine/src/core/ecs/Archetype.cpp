@@ -0,0 +1,124 @@
+#include "core/ecs/Archetype.h"
+
+#include <cstring>
+
+#include "core/Assert.h"
+
+namespace engine {
+namespace ecs {
+
+namespace {
+
+inline size_t AlignUp(size_t value, size_t alignment) {
+  return (value + alignment - 1) & ~(alignment - 1);
+}
+
+}  // namespace
+
+/**
+ * Chunks start with their Chunk header and the column versions, followed by
+ * the entities and then one aligned column per component. The capacity is
+ * the largest number of entities for which all of that fits in kChunkSize.
+ */
+Archetype::Archetype(
+    ComponentMask mask,
+    const std::vector<ComponentLayout>& components,
+    memory::BlockPool* pool)
+    : mask_(mask), pool_(pool) {
+  std::memset(column_of_, -1, sizeof(column_of_));
+  size_t header_size = sizeof(Chunk) + components.size() * sizeof(uint64_t);
+  size_t row_size = sizeof(Entity);
+  size_t padding = 0;
+  for (const ComponentLayout& component : components) {
+    column_of_[component.Id] = static_cast<int8_t>(columns_.size());
+    columns_.push_back({component.Id, component.Size, 0});
+    row_size += component.Size;
+    padding += component.Alignment - 1;
+  }
+
+  entities_offset_ = AlignUp(header_size, alignof(Entity));
+  size_t available = kChunkSize - entities_offset_;
+  capacity_ = available > padding
+      ? static_cast<uint32_t>((available - padding) / row_size)
+      : 0;
+  ENGINE_CORE_ASSERT(
+      capacity_ > 0, "The components of an archetype don't fit in a chunk.");
+
+  size_t offset = entities_offset_ + capacity_ * sizeof(Entity);
+  for (size_t i = 0; i < columns_.size(); ++i) {
+    offset = AlignUp(offset, components[i].Alignment);
+    columns_[i].Offset = static_cast<uint32_t>(offset);
+    offset += static_cast<size_t>(capacity_) * columns_[i].Size;
+  }
+}
+
+Archetype::~Archetype() {
+  for (Chunk* chunk : chunks_) {
+    pool_->Release(chunk);
+  }
+}
+
+bool Archetype::AddRow(
+    Entity entity, uint64_t version, uint32_t* chunk, uint32_t* row) {
+  if (chunks_.empty() || chunks_.back()->Count == capacity_) {
+    if (AllocateChunk() == nullptr) {
+      return false;
+    }
+  }
+
+  Chunk* last = chunks_.back();
+  *chunk = static_cast<uint32_t>(chunks_.size() - 1);
+  *row = last->Count++;
+  last->Entities[*row] = entity;
+  for (size_t column = 0; column < columns_.size(); ++column) {
+    last->Versions[column] = version;
+  }
+  ++entity_count_;
+  return true;
+}
+
+Entity Archetype::RemoveRow(uint32_t chunk, uint32_t row, uint64_t version) {
+  Chunk* target = chunks_[chunk];
+  Chunk* last = chunks_.back();
+  uint32_t last_row = last->Count - 1;
+
+  Entity moved;
+  if (target != last || row != last_row) {
+    moved = last->Entities[last_row];
+    target->Entities[row] = moved;
+    for (size_t column = 0; column < columns_.size(); ++column) {
+      uint32_t size = columns_[column].Size;
+      uint8_t* base = target->Data + columns_[column].Offset;
+      const uint8_t* source = last->Data + columns_[column].Offset;
+      std::memcpy(
+          base + static_cast<size_t>(row) * size,
+          source + static_cast<size_t>(last_row) * size, size);
+      target->Versions[column] = version;
+    }
+  }
+
+  if (--last->Count == 0) {
+    pool_->Release(last);
+    chunks_.pop_back();
+  }
+  --entity_count_;
+  return moved;
+}
+
+Chunk* Archetype::AllocateChunk() {
+  void* block = pool_->Acquire();
+  if (block == nullptr) {
+    return nullptr;
+  }
+  Chunk* chunk = new (block) Chunk();
+  chunk->Count = 0;
+  chunk->Data = static_cast<uint8_t*>(block);
+  chunk->Versions = reinterpret_cast<uint64_t*>(chunk->Data + sizeof(Chunk));
+  chunk->Entities =
+      reinterpret_cast<Entity*>(chunk->Data + entities_offset_);
+  chunks_.push_back(chunk);
+  return chunk;
+}
+
+}  // namespace ecs
+}  // namespace engine
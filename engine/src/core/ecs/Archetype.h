@@ -0,0 +1,183 @@
+/**
+ * @file engine/src/core/ecs/Archetype.h
+ * @brief The storage behind the entity registry.
+ *
+ * Every distinct set of components is an archetype, and an archetype stores
+ * its entities in fixed size chunks. A chunk holds one column per component
+ * plus the entities themselves, with the components of a column packed next to
+ * each other, so systems stream through exactly the data they read.
+ *
+ * Every column of a chunk carries the version of the last write to it. Systems
+ * compare those versions against the version of their own last run to skip
+ * whole chunks whose components haven't changed, without touching a single
+ * component.
+ */
+#ifndef ENGINE_SRC_CORE_ECS_ARCHETYPE_H_
+#define ENGINE_SRC_CORE_ECS_ARCHETYPE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "core/Core.h"
+#include "core/memory/HandlePool.h"
+#include "core/memory/VirtualArena.h"
+
+namespace engine {
+namespace ecs {
+
+/**
+ * @typedef Entity
+ * @brief A handle to an entity.
+ */
+typedef memory::Handle<struct EntityTag> Entity;
+
+/**
+ * @typedef ComponentId
+ * @brief The index of a component type within a registry.
+ */
+typedef uint32_t ComponentId;
+
+/**
+ * @typedef ComponentMask
+ * @brief A set of component types, one bit per ComponentId.
+ */
+typedef uint64_t ComponentMask;
+
+/**
+ * @var kMaxComponentTypes
+ * @brief The number of component types a single registry can hold.
+ */
+constexpr uint32_t kMaxComponentTypes = 64;
+
+/**
+ * @var kChunkSize
+ * @brief The size of every chunk, which keeps a chunk within reach of the L1
+ * and L2 caches while still holding enough entities to amortize the per chunk
+ * checks.
+ */
+constexpr size_t kChunkSize = 16 * 1024;
+
+/**
+ * @struct ComponentLayout
+ * @brief The size and alignment of a component type.
+ */
+struct ComponentLayout {
+  ComponentId Id;
+  uint32_t Size;
+  uint32_t Alignment;
+};
+
+/**
+ * @struct Chunk
+ * @brief A block of entities of a single archetype. Lives at the start of the
+ * block of memory it describes.
+ */
+struct Chunk {
+  uint32_t Count;
+
+  // The version of the last write to every column, indexed like the columns of
+  // the archetype.
+  uint64_t* Versions;
+
+  Entity* Entities;
+  uint8_t* Data;
+};
+
+/**
+ * @class Archetype
+ * @brief All entities that have exactly the same set of components.
+ */
+class ENGINE_API Archetype {
+ public:
+  /**
+   * @param mask The components of the archetype.
+   * @param components The layout of every component in the mask, in order of
+   * their ids.
+   * @param pool The pool every chunk is acquired from, whose blocks are
+   * kChunkSize bytes.
+   */
+  Archetype(
+      ComponentMask mask,
+      const std::vector<ComponentLayout>& components,
+      memory::BlockPool* pool);
+  ~Archetype();
+
+  Archetype(const Archetype&) = delete;
+  Archetype& operator=(const Archetype&) = delete;
+
+  /**
+   * @fn AddRow
+   * @brief Appends an entity with uninitialized components. Stamps every
+   * column of the chunk it lands in with the version.
+   * @return false if no chunk could be allocated.
+   */
+  bool AddRow(
+      Entity entity, uint64_t version, uint32_t* chunk, uint32_t* row);
+
+  /**
+   * @fn RemoveRow
+   * @brief Removes an entity by moving the last entity of the archetype into
+   * its row, and stamps the chunks involved with the version.
+   * @return The entity that was moved into the row, or an invalid entity if
+   * the removed entity was the last one.
+   */
+  Entity RemoveRow(uint32_t chunk, uint32_t row, uint64_t version);
+
+  /**
+   * @fn FindColumn
+   * @brief Get the column of a component, or -1 if the archetype doesn't have
+   * it.
+   */
+  inline int FindColumn(ComponentId id) const { return column_of_[id]; }
+
+  /**
+   * @fn GetComponent
+   * @brief Get the component of the entity in a row of a chunk.
+   */
+  inline void* GetComponent(
+      uint32_t chunk, uint32_t row, uint32_t column) const {
+    return chunks_[chunk]->Data + columns_[column].Offset
+        + static_cast<size_t>(row) * columns_[column].Size;
+  }
+
+  inline ComponentMask GetMask() const { return mask_; }
+  inline uint32_t GetColumnCount() const {
+    return static_cast<uint32_t>(columns_.size());
+  }
+  inline ComponentId GetColumnComponent(uint32_t column) const {
+    return columns_[column].Id;
+  }
+  inline uint32_t GetColumnSize(uint32_t column) const {
+    return columns_[column].Size;
+  }
+  inline uint32_t GetColumnOffset(uint32_t column) const {
+    return columns_[column].Offset;
+  }
+  inline uint32_t GetChunkCapacity() const { return capacity_; }
+  inline const std::vector<Chunk*>& GetChunks() const { return chunks_; }
+  inline uint32_t GetEntityCount() const { return entity_count_; }
+
+ private:
+  struct Column {
+    ComponentId Id;
+    uint32_t Size;
+    uint32_t Offset;
+  };
+
+  Chunk* AllocateChunk();
+
+  ComponentMask mask_;
+  std::vector<Column> columns_;
+  int8_t column_of_[kMaxComponentTypes];
+  uint32_t capacity_ = 0;
+  size_t entities_offset_ = 0;
+  std::vector<Chunk*> chunks_;
+  uint32_t entity_count_ = 0;
+  memory::BlockPool* pool_;
+};
+
+}  // namespace ecs
+}  // namespace engine
+
+#endif  // ENGINE_SRC_CORE_ECS_ARCHETYPE_H_
@@ -0,0 +1,301 @@
+#include "core/ecs/Registry.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "core/Assert.h"
+#include "core/Log.h"
+#include "core/jobs/JobSystem.h"
+
+namespace engine {
+namespace ecs {
+
+namespace {
+
+// Chunks are aligned to cache lines, which is also the largest alignment a
+// component can ask for.
+constexpr size_t kChunkAlignment = 64;
+
+}  // namespace
+
+// ----------------------------------- QUERY -----------------------------------
+
+void Query::ForEachChunk(const ChunkFn& function) {
+  CollectChunks();
+  uint64_t version = registry_->GetVersion();
+  for (const std::pair<const Archetype*, Chunk*>& match : matched_) {
+    ChunkView view(registry_, match.first, match.second, version);
+    function(view);
+  }
+}
+
+void Query::ParallelForEachChunk(const ChunkFn& function) {
+  CollectChunks();
+  uint64_t version = registry_->GetVersion();
+  jobs::JobSystem::ParallelFor(
+      static_cast<uint32_t>(matched_.size()), 1,
+      [&](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; ++i) {
+          ChunkView view(
+              registry_, matched_[i].first, matched_[i].second, version);
+          function(view);
+        }
+      });
+}
+
+uint32_t Query::CountEntities() {
+  CollectChunks();
+  uint32_t count = 0;
+  for (const std::pair<const Archetype*, Chunk*>& match : matched_) {
+    count += match.second->Count;
+  }
+  return count;
+}
+
+// Change filters are resolved to the columns of the filtered components once
+// per archetype, so an unchanged chunk costs a few loads.
+void Query::CollectChunks() {
+  matched_.clear();
+  std::vector<uint32_t> filter_columns;
+  std::vector<uint32_t> filter_ends;
+  for (const std::unique_ptr<Archetype>& archetype :
+       registry_->GetArchetypes()) {
+    ComponentMask mask = archetype->GetMask();
+    if ((mask & required_) != required_ || (mask & excluded_) != 0
+        || archetype->GetEntityCount() == 0) {
+      continue;
+    }
+
+    filter_columns.clear();
+    filter_ends.clear();
+    for (const ChangeFilter& filter : changed_) {
+      for (uint32_t column = 0; column < archetype->GetColumnCount();
+           ++column) {
+        ComponentId id = archetype->GetColumnComponent(column);
+        if (filter.Components & (ComponentMask(1) << id)) {
+          filter_columns.push_back(column);
+        }
+      }
+      filter_ends.push_back(static_cast<uint32_t>(filter_columns.size()));
+    }
+
+    for (Chunk* chunk : archetype->GetChunks()) {
+      bool changed = true;
+      uint32_t begin = 0;
+      for (size_t filter = 0; filter < changed_.size() && changed; ++filter) {
+        bool filter_changed = false;
+        for (uint32_t i = begin; i < filter_ends[filter]; ++i) {
+          filter_changed |=
+              chunk->Versions[filter_columns[i]] > changed_[filter].Version;
+        }
+        changed = filter_changed;
+        begin = filter_ends[filter];
+      }
+      if (changed) {
+        matched_.push_back({archetype.get(), chunk});
+      }
+    }
+  }
+}
+
+// ---------------------------------- REGISTRY ---------------------------------
+
+Registry::Registry(const memory::ArenaSettings& settings)
+    : chunk_pool_(kChunkSize, kChunkAlignment, settings) {}
+
+Registry::~Registry() {}
+
+Entity Registry::Create() {
+  Entity entity = handles_.Allocate();
+  if (entity.Index == records_.size()) {
+    records_.emplace_back();
+  }
+
+  EntityRecord& record = records_[entity.Index];
+  record.Owner = GetArchetype(0);
+  if (!record.Owner->AddRow(entity, version_, &record.Chunk, &record.Row)) {
+    ENGINE_CORE_ERROR("Ran out of memory for entities.");
+    record.Owner = nullptr;
+    handles_.Free(entity);
+    return Entity();
+  }
+  ++entity_count_;
+  return entity;
+}
+
+void Registry::Destroy(Entity entity) {
+  if (!IsAlive(entity)) {
+    return;
+  }
+
+  EntityRecord& record = records_[entity.Index];
+  Archetype* owner = record.Owner;
+  for (uint32_t column = 0; column < owner->GetColumnCount(); ++column) {
+    removed_[owner->GetColumnComponent(column)].push_back({entity, version_});
+  }
+  Entity moved = owner->RemoveRow(record.Chunk, record.Row, version_);
+  if (moved.IsValid()) {
+    records_[moved.Index].Chunk = record.Chunk;
+    records_[moved.Index].Row = record.Row;
+  }
+
+  record.Owner = nullptr;
+  handles_.Free(entity);
+  --entity_count_;
+}
+
+bool Registry::IsAlive(Entity entity) const {
+  return FindRecord(entity) != nullptr;
+}
+
+void Registry::EndFrame() {
+  for (uint32_t id = 0; id < components_.size(); ++id) {
+    for (std::vector<Change>* changes : {&added_[id], &removed_[id]}) {
+      auto end = std::upper_bound(
+          changes->begin(), changes->end(), previous_frame_version_,
+          [](uint64_t version, const Change& change) {
+            return version < change.Version;
+          });
+      changes->erase(changes->begin(), end);
+    }
+  }
+  previous_frame_version_ = version_;
+  ++version_;
+}
+
+bool Registry::FindComponentId(uint32_t type_hash, ComponentId* id) const {
+  auto it = component_of_hash_.find(type_hash);
+  if (it == component_of_hash_.end()) {
+    return false;
+  }
+  *id = it->second;
+  return true;
+}
+
+ComponentId Registry::RegisterComponent(const reflection::TypeInfo& info) {
+  ComponentId id;
+  if (FindComponentId(info.NameHash, &id)) {
+    return id;
+  }
+
+  ENGINE_CORE_ASSERT(
+      components_.size() < kMaxComponentTypes,
+      "A registry can't hold more than 64 component types.");
+  ENGINE_CORE_ASSERT(
+      info.Alignment <= kChunkAlignment,
+      "Components can't be aligned to more than a cache line.");
+  id = static_cast<ComponentId>(components_.size());
+  components_.push_back({id, info.Size, info.Alignment});
+  component_of_hash_[info.NameHash] = id;
+  return id;
+}
+
+void* Registry::AddComponent(Entity entity, ComponentId id) {
+  if (FindRecord(entity) == nullptr) {
+    return nullptr;
+  }
+
+  EntityRecord* record = &records_[entity.Index];
+  if (record->Owner->FindColumn(id) < 0) {
+    Archetype* target = GetArchetype(
+        record->Owner->GetMask() | (ComponentMask(1) << id));
+    if (!MoveEntity(record, entity, target)) {
+      return nullptr;
+    }
+    added_[id].push_back({entity, version_});
+  }
+  return GetComponent(entity, id, true);
+}
+
+bool Registry::RemoveComponent(Entity entity, ComponentId id) {
+  if (FindRecord(entity) == nullptr) {
+    return false;
+  }
+
+  EntityRecord* record = &records_[entity.Index];
+  if (record->Owner->FindColumn(id) < 0) {
+    return false;
+  }
+  Archetype* target = GetArchetype(
+      record->Owner->GetMask() & ~(ComponentMask(1) << id));
+  if (!MoveEntity(record, entity, target)) {
+    return false;
+  }
+  removed_[id].push_back({entity, version_});
+  return true;
+}
+
+void* Registry::GetComponent(
+    Entity entity, ComponentId id, bool write) const {
+  const EntityRecord* record = FindRecord(entity);
+  if (record == nullptr) {
+    return nullptr;
+  }
+  int column = record->Owner->FindColumn(id);
+  if (column < 0) {
+    return nullptr;
+  }
+  if (write) {
+    record->Owner->GetChunks()[record->Chunk]->Versions[column] = version_;
+  }
+  return record->Owner->GetComponent(record->Chunk, record->Row, column);
+}
+
+const Registry::EntityRecord* Registry::FindRecord(Entity entity) const {
+  return handles_.IsAlive(entity) ? &records_[entity.Index] : nullptr;
+}
+
+Archetype* Registry::GetArchetype(ComponentMask mask) {
+  auto it = archetype_of_mask_.find(mask);
+  if (it != archetype_of_mask_.end()) {
+    return it->second;
+  }
+
+  std::vector<ComponentLayout> layouts;
+  for (const ComponentLayout& layout : components_) {
+    if (mask & (ComponentMask(1) << layout.Id)) {
+      layouts.push_back(layout);
+    }
+  }
+  archetypes_.push_back(
+      std::make_unique<Archetype>(mask, layouts, &chunk_pool_));
+  archetype_of_mask_[mask] = archetypes_.back().get();
+  return archetypes_.back().get();
+}
+
+// The entity is appended to the target before it leaves its archetype, so
+// the components both share can be copied straight across. If the target
+// has no room the entity stays where it is.
+bool Registry::MoveEntity(
+    EntityRecord* record, Entity entity, Archetype* target) {
+  Archetype* source = record->Owner;
+  uint32_t chunk, row;
+  if (!target->AddRow(entity, version_, &chunk, &row)) {
+    ENGINE_CORE_ERROR("Ran out of memory for components.");
+    return false;
+  }
+
+  for (uint32_t column = 0; column < source->GetColumnCount(); ++column) {
+    int target_column = target->FindColumn(
+        source->GetColumnComponent(column));
+    if (target_column >= 0) {
+      std::memcpy(
+          target->GetComponent(chunk, row, target_column),
+          source->GetComponent(record->Chunk, record->Row, column),
+          source->GetColumnSize(column));
+    }
+  }
+
+  Entity moved = source->RemoveRow(record->Chunk, record->Row, version_);
+  if (moved.IsValid()) {
+    records_[moved.Index].Chunk = record->Chunk;
+    records_[moved.Index].Row = record->Row;
+  }
+  record->Owner = target;
+  record->Chunk = chunk;
+  record->Row = row;
+  return true;
+}
+
+}  // namespace ecs
+}  // namespace engine
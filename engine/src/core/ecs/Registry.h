@@ -0,0 +1,442 @@
+/**
+ * @file engine/src/core/ecs/Registry.h
+ * @brief Entities, their components and queries over them.
+ *
+ * Components are reflected, trivially copyable structs (Check
+ * `engine/src/core/reflection/Reflection.h`), stored by archetype in chunks.
+ *
+ * Change detection is built on a version counter. Every write through the
+ * registry or a query stamps the chunk column it touches with the current
+ * version, and every system run started with RunSystem advances it. A system
+ * remembers the version of its last run and asks for the chunks changed since
+ * then, so transform propagation, render proxy sync and replication skip
+ * unchanged chunks without looking at their components. Entities gaining or
+ * losing a component are recorded in per component lists the same way.
+ */
+#ifndef ENGINE_SRC_CORE_ECS_REGISTRY_H_
+#define ENGINE_SRC_CORE_ECS_REGISTRY_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "core/Core.h"
+#include "core/ecs/Archetype.h"
+#include "core/memory/VirtualArena.h"
+#include "core/reflection/Reflection.h"
+
+namespace engine {
+namespace ecs {
+
+class Registry;
+
+/**
+ * @class ChunkView
+ * @brief Access to the components of a chunk matched by a query.
+ */
+class ENGINE_API ChunkView {
+ public:
+  ChunkView(
+      const Registry* registry,
+      const Archetype* archetype,
+      Chunk* chunk,
+      uint64_t version)
+      : registry_(registry),
+        archetype_(archetype),
+        chunk_(chunk),
+        version_(version) {}
+
+  inline uint32_t GetCount() const { return chunk_->Count; }
+  inline const Entity* GetEntities() const { return chunk_->Entities; }
+
+  /**
+   * @fn Read
+   * @brief Get the column of a component without marking it as changed, or
+   * nullptr if the chunk doesn't have the component.
+   */
+  template<typename T>
+  inline const T* Read() const {
+    int column = FindColumn<T>();
+    return column < 0 ? nullptr : reinterpret_cast<const T*>(
+        chunk_->Data + archetype_->GetColumnOffset(column));
+  }
+
+  /**
+   * @fn Write
+   * @brief Get the column of a component and mark it as changed, or nullptr
+   * if the chunk doesn't have the component.
+   */
+  template<typename T>
+  inline T* Write() {
+    int column = FindColumn<T>();
+    if (column < 0) {
+      return nullptr;
+    }
+    chunk_->Versions[column] = version_;
+    return reinterpret_cast<T*>(
+        chunk_->Data + archetype_->GetColumnOffset(column));
+  }
+
+  /**
+   * @fn HasChangedSince
+   * @brief Returns true if the column of a component was written after the
+   * given version.
+   */
+  template<typename T>
+  inline bool HasChangedSince(uint64_t version) const {
+    int column = FindColumn<T>();
+    return column >= 0 && chunk_->Versions[column] > version;
+  }
+
+ private:
+  template<typename T>
+  int FindColumn() const;
+
+  const Registry* registry_;
+  const Archetype* archetype_;
+  Chunk* chunk_;
+  uint64_t version_;
+};
+
+/**
+ * @class Query
+ * @brief Selects the chunks of every archetype with a set of components.
+ *
+ * e.g. the transforms that moved since a system last ran:
+ * ```
+ * ecs::Query query(&registry);
+ * query.With<Transform>().ChangedSince<Transform>(since).ForEachChunk(
+ *     [](ecs::ChunkView& chunk) { ... });
+ * ```
+ * Queries must be built on the thread that owns the registry. Iterating with
+ * ParallelForEachChunk hands every chunk to exactly one job.
+ */
+class ENGINE_API Query {
+ public:
+  typedef std::function<void(ChunkView& chunk)> ChunkFn;
+
+  explicit Query(Registry* registry) : registry_(registry) {}
+
+  /**
+   * @fn With
+   * @brief Requires every matched entity to have all of the components.
+   */
+  template<typename... T>
+  Query& With();
+
+  /**
+   * @fn Without
+   * @brief Excludes entities with any of the components.
+   */
+  template<typename... T>
+  Query& Without();
+
+  /**
+   * @fn ChangedSince
+   * @brief Only matches chunks where any of the components was written after
+   * the version. Filters added by separate calls must all pass.
+   */
+  template<typename... T>
+  Query& ChangedSince(uint64_t version);
+
+  /**
+   * @fn ForEachChunk
+   * @brief Invokes the function for every matched, non empty chunk.
+   */
+  void ForEachChunk(const ChunkFn& function);
+
+  /**
+   * @fn ParallelForEachChunk
+   * @brief Like ForEachChunk, but spreads the chunks over the job system and
+   * blocks until all of them are done.
+   */
+  void ParallelForEachChunk(const ChunkFn& function);
+
+  /**
+   * @fn CountEntities
+   * @brief Get the number of entities in the matched chunks.
+   */
+  uint32_t CountEntities();
+
+ private:
+  struct ChangeFilter {
+    ComponentMask Components;
+    uint64_t Version;
+  };
+
+  void CollectChunks();
+
+  Registry* registry_;
+  ComponentMask required_ = 0;
+  ComponentMask excluded_ = 0;
+  std::vector<ChangeFilter> changed_;
+  std::vector<std::pair<const Archetype*, Chunk*>> matched_;
+};
+
+/**
+ * @class Registry
+ * @brief The entities of a world and their components.
+ *
+ * A registry isn't thread safe, apart from iterating queries in parallel.
+ */
+class ENGINE_API Registry {
+ public:
+  /**
+   * @param settings The arena the chunks are allocated from. The reserve size
+   * caps the memory of all components.
+   */
+  explicit Registry(const memory::ArenaSettings& settings = {});
+  ~Registry();
+
+  Registry(const Registry&) = delete;
+  Registry& operator=(const Registry&) = delete;
+
+  /**
+   * @fn Create
+   * @brief Creates an entity without any components.
+   */
+  Entity Create();
+
+  /**
+   * @fn Destroy
+   * @brief Destroys an entity, recording the removal of all its components.
+   */
+  void Destroy(Entity entity);
+
+  bool IsAlive(Entity entity) const;
+
+  /**
+   * @fn Add
+   * @brief Adds a component to an entity, or overwrites the one it has.
+   * @return The component, or nullptr if the entity isn't alive or there is
+   * no memory left for its components.
+   */
+  template<typename T>
+  T* Add(Entity entity, const T& value = T()) {
+    void* component = AddComponent(entity, GetComponentId<T>());
+    return component == nullptr ? nullptr : new (component) T(value);
+  }
+
+  /**
+   * @fn Remove
+   * @return false if the entity didn't have the component or there is no
+   * memory left to move it without it.
+   */
+  template<typename T>
+  bool Remove(Entity entity) {
+    return RemoveComponent(entity, GetComponentId<T>());
+  }
+
+  template<typename T>
+  bool Has(Entity entity) const {
+    ComponentId id;
+    return FindComponentId(reflection::GetTypeHash<T>(), &id)
+        && GetComponent(entity, id, false) != nullptr;
+  }
+
+  /**
+   * @fn Get
+   * @brief Get a component for reading, or nullptr if the entity doesn't
+   * have it.
+   */
+  template<typename T>
+  const T* Get(Entity entity) const {
+    ComponentId id;
+    return FindComponentId(reflection::GetTypeHash<T>(), &id)
+        ? static_cast<const T*>(GetComponent(entity, id, false))
+        : nullptr;
+  }
+
+  /**
+   * @fn Write
+   * @brief Get a component for writing, which marks its chunk column as
+   * changed, or nullptr if the entity doesn't have it.
+   */
+  template<typename T>
+  T* Write(Entity entity) {
+    ComponentId id;
+    return FindComponentId(reflection::GetTypeHash<T>(), &id)
+        ? static_cast<T*>(GetComponent(entity, id, true))
+        : nullptr;
+  }
+
+  /**
+   * @fn RunSystem
+   * @param last_run The version of the system's previous run, 0 before the
+   * first one, which is updated by the call.
+   * @param system Invoked with the version of the previous run, to be passed
+   * to Query::ChangedSince and ForEachAdded.
+   * @brief Runs a system under a version of its own. A system doesn't see its
+   * own writes as changes, but sees everything written since it last started,
+   * by other systems or outside of any.
+   */
+  template<typename F>
+  void RunSystem(uint64_t* last_run, F&& system) {
+    uint64_t since = *last_run;
+    *last_run = ++version_;
+    system(since);
+    ++version_;
+  }
+
+  /**
+   * @fn ForEachAdded
+   * @brief Invokes the function for every entity that gained the component
+   * after the version and still has it.
+   */
+  template<typename T, typename F>
+  void ForEachAdded(uint64_t since, F&& function) const {
+    ComponentId id;
+    if (FindComponentId(reflection::GetTypeHash<T>(), &id)) {
+      ForEachChange(added_[id], since, [&](Entity entity) {
+        if (GetComponent(entity, id, false) != nullptr) {
+          function(entity);
+        }
+      });
+    }
+  }
+
+  /**
+   * @fn ForEachRemoved
+   * @brief Invokes the function for every entity that lost the component
+   * after the version, including destroyed entities.
+   */
+  template<typename T, typename F>
+  void ForEachRemoved(uint64_t since, F&& function) const {
+    ComponentId id;
+    if (FindComponentId(reflection::GetTypeHash<T>(), &id)) {
+      ForEachChange(removed_[id], since, function);
+    }
+  }
+
+  /**
+   * @fn EndFrame
+   * @brief Forgets the additions and removals recorded before the previous
+   * call, so every system running once per frame sees each of them once.
+   */
+  void EndFrame();
+
+  /**
+   * @fn GetComponentId
+   * @brief Get the id of a component, registering it on first use.
+   */
+  template<typename T>
+  ComponentId GetComponentId() {
+    static_assert(
+        std::is_trivially_copyable<T>::value,
+        "Components must be trivially copyable.");
+    return RegisterComponent(reflection::GetTypeInfo<T>());
+  }
+
+  /**
+   * @fn FindComponentId
+   * @brief Looks up a registered component by its reflected name hash.
+   * @return false if the component was never registered.
+   */
+  bool FindComponentId(uint32_t type_hash, ComponentId* id) const;
+
+  ComponentId RegisterComponent(const reflection::TypeInfo& info);
+  void* AddComponent(Entity entity, ComponentId id);
+  bool RemoveComponent(Entity entity, ComponentId id);
+  void* GetComponent(Entity entity, ComponentId id, bool write) const;
+
+  inline uint64_t GetVersion() const { return version_; }
+  inline uint32_t GetEntityCount() const { return entity_count_; }
+  inline const std::vector<std::unique_ptr<Archetype>>& GetArchetypes() const {
+    return archetypes_;
+  }
+
+ private:
+  struct EntityRecord {
+    Archetype* Owner = nullptr;
+    uint32_t Chunk = 0;
+    uint32_t Row = 0;
+  };
+
+  struct Change {
+    Entity Target;
+    uint64_t Version;
+  };
+
+  template<typename F>
+  static void ForEachChange(
+      const std::vector<Change>& changes, uint64_t since, F&& function) {
+    // Changes are recorded in version order.
+    auto it = std::upper_bound(
+        changes.begin(), changes.end(), since,
+        [](uint64_t version, const Change& change) {
+          return version < change.Version;
+        });
+    for (; it != changes.end(); ++it) {
+      function(it->Target);
+    }
+  }
+
+  const EntityRecord* FindRecord(Entity entity) const;
+  Archetype* GetArchetype(ComponentMask mask);
+  bool MoveEntity(EntityRecord* record, Entity entity, Archetype* target);
+
+  memory::BlockPool chunk_pool_;
+  std::vector<std::unique_ptr<Archetype>> archetypes_;
+  std::unordered_map<ComponentMask, Archetype*> archetype_of_mask_;
+
+  std::vector<ComponentLayout> components_;
+  std::unordered_map<uint32_t, ComponentId> component_of_hash_;
+
+  memory::HandlePool<Entity> handles_;
+  std::vector<EntityRecord> records_;
+  uint32_t entity_count_ = 0;
+
+  // Versions start at 1 so that a system that never ran, with a last run of
+  // 0, sees everything.
+  uint64_t version_ = 1;
+  uint64_t previous_frame_version_ = 0;
+  std::vector<Change> added_[kMaxComponentTypes];
+  std::vector<Change> removed_[kMaxComponentTypes];
+};
+
+// ------------------------------ TEMPLATE METHODS -----------------------------
+
+template<typename T>
+int ChunkView::FindColumn() const {
+  ComponentId id;
+  return registry_->FindComponentId(reflection::GetTypeHash<T>(), &id)
+      ? archetype_->FindColumn(id)
+      : -1;
+}
+
+template<typename... T>
+Query& Query::With() {
+  for (ComponentId id : {registry_->GetComponentId<T>()...}) {
+    required_ |= ComponentMask(1) << id;
+  }
+  return *this;
+}
+
+template<typename... T>
+Query& Query::Without() {
+  for (ComponentId id : {registry_->GetComponentId<T>()...}) {
+    excluded_ |= ComponentMask(1) << id;
+  }
+  return *this;
+}
+
+template<typename... T>
+Query& Query::ChangedSince(uint64_t version) {
+  ChangeFilter filter = {0, version};
+  for (ComponentId id : {registry_->GetComponentId<T>()...}) {
+    filter.Components |= ComponentMask(1) << id;
+  }
+  changed_.push_back(filter);
+  return *this;
+}
+
+}  // namespace ecs
+}  // namespace engine
+
+#endif  // ENGINE_SRC_CORE_ECS_REGISTRY_H_
@@ -10,6 +10,7 @@
 #ifndef ENGINE_SRC_CORE_EVENTS_EVENT_H_
 #define ENGINE_SRC_CORE_EVENTS_EVENT_H_
 
+#include <cstdint>
 #include <functional>
 #include <ostream>
 #include <string>
@@ -24,20 +25,41 @@ namespace events {
 // ----------------------- EVENT TYPES & CATEGORIES ---------------------------
 
 /**
- * @enum EventType
+ * @typedef EventType
  * @brief An Events specific type.
  *
- * This defines all the EventTypes that are available within the engine. Events
- * that are not registered here cannot be used for instantiating classes that
- * want to extend the base class Event and use the event dispatcher.
+ * Types are the FNV-1a hash of the fully qualified name of the event class,
+ * computed at compile time, so games and engine modules define their own
+ * events without registering them anywhere and without RTTI. Events with the
+ * same name in different namespaces get different types. Hashes don't depend
+ * on the module they're computed in, which keeps them stable across the
+ * engine's DLL boundary as long as both sides are built by the same compiler.
  */
-enum class EventType {
-  None = 0,
-  kWindowClose, kWindowResize, kWindowFocus, kWindowLostFocus, kWindowMoved,
-  kAppTick, kAppUpdate, kAppRender,
-  kKeyPressed, kKeyReleased, kKeyTyped,
-  kMouseButtonPressed, kMouseButtonReleased, kMouseMoved, kMouseScrolled
-};
+typedef uint64_t EventType;
+
+/**
+ * @fn MakeEventType
+ * @param name The text to hash, see EVENT_CLASS_TYPE.
+ * @brief Computes the EventType of an event name.
+ */
+constexpr EventType MakeEventType(const char* name) {
+  EventType hash = 14695981039346656037ull;
+  for (; *name != '\0'; ++name) {
+    hash = (hash ^ static_cast<uint8_t>(*name)) * 1099511628211ull;
+  }
+  return hash;
+}
+
+/**
+ * @def ENGINE_FUNCTION_SIGNATURE
+ * @brief The signature of the enclosing function, which spells out the
+ * namespaces and class of a member function.
+ */
+#if defined(_MSC_VER)
+  #define ENGINE_FUNCTION_SIGNATURE __FUNCSIG__
+#else
+  #define ENGINE_FUNCTION_SIGNATURE __PRETTY_FUNCTION__
+#endif
 
 /**
  * @enum EventCategory
@@ -53,22 +75,30 @@ enum EventCategory {
   kEventCategoryInput = BIT(1),
   kEventCategoryKeyboard = BIT(2),
   kEventCategoryMouse = BIT(3),
-  kEventCategoryMouseButton = BIT(4)
+  kEventCategoryMouseButton = BIT(4),
+  kEventCategoryGame = BIT(5)
 };
 
 // ------------------------------------- MACROS --------------------------------
 
 /**
  * @def EVENT_CLASS_TYPE(type)
- * @param type the child classes EventType.
+ * @param type the child classes name, as returned by GetName.
  * @brief Helper macro to fill out child event classes.
  *
  * All children of the base Class Event are to implement this in their class
- * definition in order to be compatible with the EventDispatcher.
+ * definition in order to be compatible with the EventDispatcher. The macro
+ * works in any namespace, so events can be defined outside of the engine.
+ * The EventType is derived from the signature of GetStaticType, which
+ * qualifies the class with its namespaces.
  */
 #define EVENT_CLASS_TYPE(type) \
-    static EventType GetStaticType() { return EventType::type; } \
-    EventType GetEventType() const override { return GetStaticType(); } \
+    static constexpr ::engine::events::EventType GetStaticType() { \
+      return ::engine::events::MakeEventType(ENGINE_FUNCTION_SIGNATURE); \
+    } \
+    ::engine::events::EventType GetEventType() const override { \
+      return GetStaticType(); \
+    } \
     const char* GetName() const override { return #type; }
 
 /**
@@ -107,7 +137,10 @@ enum EventCategory {
  */
 class ENGINE_API Event {
   friend class EventDispatcher;
+  friend class EventQueue;
  public:
+  virtual ~Event() = default;
+
   virtual EventType GetEventType() const = 0;
   virtual const char* GetName() const = 0;
   virtual int GetCategoryFlags() const = 0;
@@ -140,6 +173,10 @@ class ENGINE_API Event {
  protected:
   bool has_been_handled_ = false;
   inline void SetHandled(const bool success) { has_been_handled_ = success; }
+
+ private:
+  // Links the event into an EventQueue while it waits to be delivered.
+  Event* next_posted_ = nullptr;
 };
 
 /**
@@ -178,7 +215,8 @@ class EventDispatcher {
   template<typename T>
   bool Dispatch(EventFn<T> func) {
     if (event_->GetEventType() == T::GetStaticType()) {
-      event_->SetHandled(func(dynamic_cast<const T&>(*event_)));
+      // The types match, so the cast is safe without asking RTTI.
+      event_->SetHandled(func(static_cast<const T&>(*event_)));
       return true;
     }
     return false;
@@ -0,0 +1,46 @@
+#include "core/events/EventQueue.h"
+
+namespace engine {
+namespace events {
+
+EventQueue::~EventQueue() {
+  Event* event = head_.exchange(nullptr, std::memory_order_acquire);
+  while (event != nullptr) {
+    Event* next = event->next_posted_;
+    delete event;
+    event = next;
+  }
+}
+
+void EventQueue::Post(std::unique_ptr<Event> event) {
+  Event* posted = event.release();
+  posted->next_posted_ = head_.load(std::memory_order_relaxed);
+  while (!head_.compare_exchange_weak(
+      posted->next_posted_, posted,
+      std::memory_order_release, std::memory_order_relaxed)) {
+  }
+}
+
+// The stack holds the newest event first, so it is reversed before delivery.
+uint32_t EventQueue::Drain(const std::function<void(Event* event)>& deliver) {
+  Event* newest = head_.exchange(nullptr, std::memory_order_acquire);
+  Event* oldest = nullptr;
+  while (newest != nullptr) {
+    Event* next = newest->next_posted_;
+    newest->next_posted_ = oldest;
+    oldest = newest;
+    newest = next;
+  }
+
+  uint32_t count = 0;
+  while (oldest != nullptr) {
+    std::unique_ptr<Event> event(oldest);
+    oldest = oldest->next_posted_;
+    deliver(event.get());
+    ++count;
+  }
+  return count;
+}
+
+}  // namespace events
+}  // namespace engine
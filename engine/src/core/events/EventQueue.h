@@ -0,0 +1,87 @@
+/**
+ * @file engine/src/core/events/EventQueue.h
+ * @brief A lock free queue for posting events from any thread.
+ *
+ * Events from the window arrive on the main thread, but gameplay jobs and
+ * networking threads have events of their own for the layers. They post them
+ * into a queue that the thread updating the layers drains once per frame, so
+ * layers still only ever see events on their own thread and need no locks.
+ */
+#ifndef ENGINE_SRC_CORE_EVENTS_EVENTQUEUE_H_
+#define ENGINE_SRC_CORE_EVENTS_EVENTQUEUE_H_
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <utility>
+
+#include "core/Core.h"
+#include "core/events/Event.h"
+
+namespace engine {
+namespace events {
+
+/**
+ * @class EventQueue
+ * @brief A multiple producer, single consumer queue of events.
+ *
+ * Posting pushes the event onto an intrusive lock free stack, which is a
+ * single compare and swap and never allocates beyond the event itself.
+ * Draining takes the whole stack with one exchange and delivers it oldest
+ * first, so every producer's events arrive in the order it posted them.
+ * Events posted while a queue drains are delivered by the next drain.
+ */
+class ENGINE_API EventQueue {
+ public:
+  EventQueue() = default;
+
+  /**
+   * @fn ~EventQueue
+   * @brief Destroys the events that were never delivered.
+   */
+  ~EventQueue();
+
+  EventQueue(const EventQueue&) = delete;
+  EventQueue& operator=(const EventQueue&) = delete;
+
+  /**
+   * @fn Post
+   * @brief Queues an event. Safe to call from any thread.
+   */
+  void Post(std::unique_ptr<Event> event);
+
+  /**
+   * @fn Post
+   * @brief Constructs an event of type T and queues it.
+   */
+  template<typename T, typename... Args>
+  inline void Post(Args&&... args) {
+    Post(std::unique_ptr<Event>(new T(std::forward<Args>(args)...)));
+  }
+
+  /**
+   * @fn Drain
+   * @param deliver Invoked for every queued event, in the order they were
+   * posted. The event is destroyed once it returns.
+   * @brief Delivers every queued event. Must only be called by one thread at
+   * a time.
+   * @return The number of events delivered.
+   */
+  uint32_t Drain(const std::function<void(Event* event)>& deliver);
+
+  /**
+   * @fn IsEmpty
+   * @brief Returns true if no events are waiting to be drained.
+   */
+  inline bool IsEmpty() const {
+    return head_.load(std::memory_order_relaxed) == nullptr;
+  }
+
+ private:
+  std::atomic<Event*> head_{nullptr};
+};
+
+}  // namespace events
+}  // namespace engine
+
+#endif  // ENGINE_SRC_CORE_EVENTS_EVENTQUEUE_H_
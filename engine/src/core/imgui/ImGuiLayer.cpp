@@ -1,9 +1,12 @@
 #include "core/imgui/ImGuiLayer.h"
 
+#include <cstdint>
+#include <cstring>
+
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 
-#include "core/Application.h"
+#include "core/cvars/ConsoleVariable.h"
 #include "core/events/Event.h"
 #include "core/imgui/ImGuiBuild.h"
 
@@ -11,8 +14,15 @@ namespace engine {
 namespace imgui {
 
 bool ImGuiLayer::show_demo_window_ = true;
-
-ImGuiLayer::ImGuiLayer() : Layer("ImGuiLayer") {}
+bool ImGuiLayer::show_console_variables_ = true;
+bool ImGuiLayer::show_performance_ = true;
+
+ImGuiLayer::ImGuiLayer(
+    const Window& window,
+    const renderer::ResolutionScaler* resolution_scaler)
+    : Layer("ImGuiLayer"),
+      window_(window),
+      resolution_scaler_(resolution_scaler) {}
 ImGuiLayer::~ImGuiLayer() {}
 
 /**
@@ -37,9 +47,7 @@ void ImGuiLayer::OnAttach() {
     style.Colors[ImGuiCol_WindowBg].w = 1.0f;
   }
 
-  const Application& app = Application::GetApplication();
-  GLFWwindow* window = static_cast<GLFWwindow*>(
-      app.GetWindow().GetNativeWindow());
+  GLFWwindow* window = static_cast<GLFWwindow*>(window_.GetNativeWindow());
 
   ImGui_ImplGlfw_InitForOpenGL(window, true);
   ImGui_ImplOpenGL3_Init("#version 410");
@@ -62,9 +70,7 @@ void ImGuiLayer::Begin() {
 
 void ImGuiLayer::End() {
   ImGuiIO& io = ImGui::GetIO();
-  const Application& app = Application::GetApplication();
-  io.DisplaySize = ImVec2(
-      app.GetWindow().GetWidth(), app.GetWindow().GetHeight());
+  io.DisplaySize = ImVec2(window_.GetWidth(), window_.GetHeight());
 
   ImGui::Render();
   ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
@@ -79,6 +85,142 @@ void ImGuiLayer::End() {
 
 void ImGuiLayer::OnImGuiRender() {
   ImGui::ShowDemoWindow(&show_demo_window_);
+  DrawConsoleVariables();
+  DrawPerformance();
+}
+
+/**
+ * Edits are staged like every other change, so they show up in the widgets
+ * one frame later, once they have been applied.
+ */
+void ImGuiLayer::DrawConsoleVariables() {
+  if (!show_console_variables_) {
+    return;
+  }
+
+  if (!ImGui::Begin("Console Variables", &show_console_variables_)) {
+    ImGui::End();
+    return;
+  }
+
+  if (ImGui::InputText(
+          "Command",
+          console_command_,
+          sizeof(console_command_),
+          ImGuiInputTextFlags_EnterReturnsTrue)) {
+    cvars::ConsoleVariables::Execute(console_command_);
+    console_command_[0] = '\0';
+  }
+  ImGui::InputText("Filter", console_filter_, sizeof(console_filter_));
+  ImGui::Separator();
+
+  for (cvars::ConsoleVariableBase* base : cvars::ConsoleVariables::GetAll()) {
+    if (console_filter_[0] && !std::strstr(base->GetName(), console_filter_)) {
+      continue;
+    }
+
+    switch (base->GetType()) {
+      case cvars::ConsoleVariableType::kBool: {
+        auto* variable = static_cast<cvars::ConsoleVariable<bool>*>(base);
+        bool value = variable->Get();
+        if (ImGui::Checkbox(variable->GetName(), &value)) {
+          variable->Set(value);
+        }
+        break;
+      }
+      case cvars::ConsoleVariableType::kInt: {
+        auto* variable = static_cast<cvars::ConsoleVariable<int32_t>*>(base);
+        int value = variable->Get();
+        if (ImGui::DragInt(variable->GetName(), &value)) {
+          variable->Set(value);
+        }
+        break;
+      }
+      case cvars::ConsoleVariableType::kFloat: {
+        auto* variable = static_cast<cvars::ConsoleVariable<float>*>(base);
+        float value = variable->Get();
+        if (ImGui::DragFloat(variable->GetName(), &value, 0.01f)) {
+          variable->Set(value);
+        }
+        break;
+      }
+    }
+
+    if (ImGui::IsItemHovered()) {
+      ImGui::SetTooltip("%s", base->GetDescription());
+    }
+  }
+
+  ImGui::End();
+}
+
+/**
+ * Shows the smoothed timings the render scale is picked from, the scale of
+ * the last 128 frames and the last change along with what caused it.
+ */
+void ImGuiLayer::DrawPerformance() {
+  if (!show_performance_ || resolution_scaler_ == nullptr) {
+    return;
+  }
+
+  if (!ImGui::Begin("Performance", &show_performance_)) {
+    ImGui::End();
+    return;
+  }
+
+  const renderer::ResolutionScaler& scaler = *resolution_scaler_;
+  ImGui::Text("Frame: %.2f ms (CPU)", scaler.GetFrameTime() * 1000.0);
+  if (scaler.GetGpuTime() >= 0.0) {
+    ImGui::Text("Scene: %.2f ms (GPU)", scaler.GetGpuTime() * 1000.0);
+  } else {
+    ImGui::Text("Scene: not measured (GPU)");
+  }
+  ImGui::Text(
+      "Target: %.2f ms",
+      scaler.GetSettings().TargetFrameTime * 1000.0);
+  ImGui::Separator();
+
+  uint32_t render_width, render_height;
+  scaler.GetRenderSize(
+      window_.GetWidth(), window_.GetHeight(), &render_width, &render_height);
+  ImGui::Text(
+      "Render scale: %.0f%% (%ux%u)%s",
+      scaler.GetScale() * 100.0f,
+      render_width,
+      render_height,
+      scaler.GetSettings().Enabled ? "" : ", dynamic resolution off");
+  ImGui::PlotLines(
+      "##RenderScale",
+      scaler.GetHistory(),
+      renderer::ResolutionScaler::kHistorySize,
+      scaler.GetHistoryOffset(),
+      nullptr,
+      0.0f,
+      1.0f,
+      ImVec2(0.0f, 48.0f));
+
+  if (scaler.GetChangeCount() > 0) {
+    const renderer::ScaleChange& change = scaler.GetLastChange();
+    ImGui::Text(
+        "%s %.0f%% to %.0f%%, %llu frames ago",
+        change.To < change.From ? "Lowered" : "Raised",
+        change.From * 100.0f,
+        change.To * 100.0f,
+        static_cast<unsigned long long>(scaler.GetFrame() - change.Frame));
+    if (change.GpuTime >= 0.0) {
+      ImGui::Text(
+          "at %.2f ms CPU, %.2f ms GPU",
+          change.FrameTime * 1000.0,
+          change.GpuTime * 1000.0);
+    } else {
+      ImGui::Text("at %.2f ms CPU", change.FrameTime * 1000.0);
+    }
+    ImGui::Text(
+        "%llu changes",
+        static_cast<unsigned long long>(scaler.GetChangeCount()));
+  }
+
+  ImGui::End();
 }
 
 }  // namespace imgui
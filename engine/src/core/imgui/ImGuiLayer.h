@@ -11,10 +11,12 @@
 
 #include "core/Core.h"
 #include "core/Layer.h"
+#include "core/Window.h"
 #include "core/events/ApplicationEvent.h"
 #include "core/events/Event.h"
 #include "core/events/KeyEvent.h"
 #include "core/events/MouseEvent.h"
+#include "core/renderer/ResolutionScaler.h"
 
 namespace engine {
 namespace imgui {
@@ -26,7 +28,15 @@ namespace imgui {
  */
 class ENGINE_API ImGuiLayer : public Layer {
  public:
-  ImGuiLayer();
+  /**
+   * @param window The window ImGui renders into and reads input from. Must
+   * outlive the layer.
+   * @param resolution_scaler Shown in the performance overlay if not null.
+   * Must outlive the layer.
+   */
+  explicit ImGuiLayer(
+      const Window& window,
+      const renderer::ResolutionScaler* resolution_scaler = nullptr);
   ~ImGuiLayer();
 
   /**
@@ -74,8 +84,27 @@ class ENGINE_API ImGuiLayer : public Layer {
   void End();
 
  private:
+  const Window& window_;
+  const renderer::ResolutionScaler* resolution_scaler_;
   float time_ = 0.0f;
+  char console_command_[256] = {};
+  char console_filter_[64] = {};
   static bool show_demo_window_;
+  static bool show_console_variables_;
+  static bool show_performance_;
+
+  /**
+   * @fn DrawConsoleVariables
+   * @brief Draws a window for inspecting and editing console variables.
+   */
+  void DrawConsoleVariables();
+
+  /**
+   * @fn DrawPerformance
+   * @brief Draws an overlay with the frame timings and the render scale
+   * picked from them.
+   */
+  void DrawPerformance();
 };
 
 }  // namespace imgui
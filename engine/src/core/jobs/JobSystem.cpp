@@ -0,0 +1,334 @@
+#include "core/jobs/JobSystem.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "core/Assert.h"
+#include "core/Log.h"
+#include "core/cpu/Topology.h"
+#include "core/cvars/ConsoleVariable.h"
+
+namespace engine {
+namespace jobs {
+
+namespace {
+
+cvars::ConsoleVariable<int32_t> kWorkerCountVariable(
+    "jobs.worker_count",
+    0,
+    "Worker threads to spawn, or 0 for one per hardware thread. Read when the "
+    "job system starts.");
+
+cvars::ConsoleVariable<bool> kPinWorkersVariable(
+    "jobs.pin_workers",
+    false,
+    "Pin every worker to its own logical processor, spreading them over the "
+    "NUMA nodes. Meant for dedicated servers. Read when the job system "
+    "starts.");
+
+struct WorkerQueue {
+  std::mutex Mutex;
+  std::deque<JobSystem::Job> Jobs;
+};
+
+struct JobSystemState {
+  std::vector<std::unique_ptr<WorkerQueue>> Queues;
+  std::vector<std::thread> Workers;
+
+  // The order in which every worker visits the queues, its own queue first,
+  // then the queues of the other workers on its node, then the rest.
+  std::vector<std::vector<uint32_t>> StealOrders;
+  std::vector<std::vector<uint32_t>> NodeQueues;
+
+  std::atomic<bool> Running{false};
+  std::atomic<uint32_t> Queued{0};
+  std::atomic<uint32_t> NextQueue{0};
+  std::mutex WakeMutex;
+  std::condition_variable Wake;
+};
+
+JobSystemState kState;
+thread_local int kWorkerIndex = -1;
+thread_local int kHomeNode = -1;
+
+// Workers pop the most recently pushed job from their own queue to keep caches
+// warm, and steal the oldest job from other queues to reduce contention.
+bool RunPendingJob(uint32_t home_queue) {
+  const std::vector<uint32_t>& order = kState.StealOrders[home_queue];
+  for (uint32_t i = 0; i < order.size(); ++i) {
+    WorkerQueue& queue = *kState.Queues[order[i]];
+    JobSystem::Job job;
+    {
+      std::lock_guard<std::mutex> lock(queue.Mutex);
+      if (queue.Jobs.empty()) {
+        continue;
+      }
+
+      if (i == 0) {
+        job = std::move(queue.Jobs.back());
+        queue.Jobs.pop_back();
+      } else {
+        job = std::move(queue.Jobs.front());
+        queue.Jobs.pop_front();
+      }
+    }
+
+    kState.Queued.fetch_sub(1, std::memory_order_relaxed);
+    job();
+    return true;
+  }
+  return false;
+}
+
+uint32_t GetHomeQueue() {
+  if (kWorkerIndex >= 0) {
+    return static_cast<uint32_t>(kWorkerIndex);
+  }
+
+  uint32_t next = kState.NextQueue.fetch_add(1, std::memory_order_relaxed);
+  if (kHomeNode >= 0
+      && static_cast<size_t>(kHomeNode) < kState.NodeQueues.size()
+      && !kState.NodeQueues[kHomeNode].empty()) {
+    const std::vector<uint32_t>& queues = kState.NodeQueues[kHomeNode];
+    return queues[next % queues.size()];
+  }
+  return next % static_cast<uint32_t>(kState.Queues.size());
+}
+
+/**
+ * Spreads the workers over the nodes in proportion to their processors and
+ * builds the steal orders. Returns the processor of every worker.
+ */
+std::vector<uint32_t> PlaceWorkers(uint32_t worker_count) {
+  const cpu::CpuTopology& topology = cpu::GetCpuTopology();
+  uint32_t node_count = static_cast<uint32_t>(topology.Nodes.size());
+
+  // Interleave the nodes so that fewer workers than processors are still
+  // spread evenly, and leave the first processor to the main thread.
+  std::vector<std::pair<uint32_t, uint32_t>> slots;
+  for (size_t rank = 0; slots.size() < topology.GetProcessorCount(); ++rank) {
+    for (uint32_t node = 0; node < node_count; ++node) {
+      const std::vector<uint32_t>& processors = topology.Nodes[node].Processors;
+      if (rank < processors.size()) {
+        slots.emplace_back(processors[rank], node);
+      }
+    }
+  }
+  std::rotate(slots.begin(), slots.begin() + 1, slots.end());
+
+  std::vector<uint32_t> worker_processors(worker_count);
+  std::vector<uint32_t> worker_nodes(worker_count);
+  kState.NodeQueues.assign(node_count, {});
+  for (uint32_t worker = 0; worker < worker_count; ++worker) {
+    worker_processors[worker] = slots[worker % slots.size()].first;
+    worker_nodes[worker] = slots[worker % slots.size()].second;
+    kState.NodeQueues[worker_nodes[worker]].push_back(worker);
+  }
+
+  kState.StealOrders.assign(worker_count, {});
+  for (uint32_t worker = 0; worker < worker_count; ++worker) {
+    std::vector<uint32_t>& order = kState.StealOrders[worker];
+    for (uint32_t distance = 0; distance < node_count; ++distance) {
+      uint32_t node = (worker_nodes[worker] + distance) % node_count;
+      const std::vector<uint32_t>& queues = kState.NodeQueues[node];
+      auto home = std::find(queues.begin(), queues.end(), worker);
+      size_t start = home == queues.end() ? 0 : home - queues.begin();
+      for (size_t i = 0; i < queues.size(); ++i) {
+        order.push_back(queues[(start + i) % queues.size()]);
+      }
+    }
+  }
+  return worker_processors;
+}
+
+void WorkerLoop(int worker_index, int processor) {
+  kWorkerIndex = worker_index;
+  if (processor >= 0 && !cpu::PinCurrentThread(processor)) {
+    ENGINE_CORE_WARN(
+        "Couldn't pin worker {} to processor {}.", worker_index, processor);
+  }
+
+  while (true) {
+    if (RunPendingJob(static_cast<uint32_t>(worker_index))) {
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(kState.WakeMutex);
+    kState.Wake.wait(lock, [] {
+      return kState.Queued.load() > 0 || !kState.Running.load();
+    });
+
+    if (!kState.Running.load() && kState.Queued.load() == 0) {
+      return;
+    }
+  }
+}
+
+}  // namespace
+
+void JobSystem::Init(uint32_t worker_count) {
+  ENGINE_CORE_ASSERT(
+      !kState.Running.load(), "The job system has already been initialized.");
+
+  if (worker_count == 0 && kWorkerCountVariable.Get() > 0) {
+    worker_count = static_cast<uint32_t>(kWorkerCountVariable.Get());
+  }
+
+  if (worker_count == 0) {
+    uint32_t hardware_threads = std::thread::hardware_concurrency();
+    worker_count = hardware_threads > 1 ? hardware_threads - 1 : 0;
+  }
+
+  if (worker_count == 0) {
+    ENGINE_CORE_INFO("Job system running without worker threads.");
+    return;
+  }
+
+  kState.Running = true;
+  for (uint32_t i = 0; i < worker_count; ++i) {
+    kState.Queues.emplace_back(new WorkerQueue());
+  }
+
+  std::vector<uint32_t> processors = PlaceWorkers(worker_count);
+  bool pin = kPinWorkersVariable.Get();
+  for (uint32_t i = 0; i < worker_count; ++i) {
+    int processor = pin ? static_cast<int>(processors[i]) : -1;
+    kState.Workers.emplace_back(WorkerLoop, static_cast<int>(i), processor);
+  }
+
+  ENGINE_CORE_INFO(
+      "Job system started {0} worker threads on {1} NUMA nodes{2}.",
+      worker_count, cpu::GetCpuTopology().Nodes.size(),
+      pin ? ", pinned to processors" : "");
+}
+
+void JobSystem::Shutdown() {
+  if (!kState.Running.load()) {
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(kState.WakeMutex);
+    kState.Running = false;
+  }
+  kState.Wake.notify_all();
+
+  for (std::thread& worker : kState.Workers) {
+    worker.join();
+  }
+
+  kState.Workers.clear();
+  kState.Queues.clear();
+  kState.StealOrders.clear();
+  kState.NodeQueues.clear();
+}
+
+void JobSystem::Execute(const Job& job, JobCounter* counter) {
+  if (kState.Workers.empty()) {
+    job();
+    return;
+  }
+
+  WorkerQueue& queue = *kState.Queues[GetHomeQueue()];
+  if (counter) {
+    counter->Pending.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  // The job is counted before any worker can see it, so a worker that takes
+  // it right away can't wrap the count below zero.
+  {
+    std::lock_guard<std::mutex> lock(queue.Mutex);
+    kState.Queued.fetch_add(1, std::memory_order_relaxed);
+    if (counter) {
+      queue.Jobs.emplace_back([job, counter] {
+        job();
+        counter->Pending.fetch_sub(1, std::memory_order_release);
+      });
+    } else {
+      queue.Jobs.emplace_back(job);
+    }
+  }
+
+  // Passing through the wake mutex keeps a worker that is about to wait from
+  // missing the notification.
+  {
+    std::lock_guard<std::mutex> lock(kState.WakeMutex);
+  }
+  kState.Wake.notify_one();
+}
+
+void JobSystem::ParallelFor(
+    uint32_t count, uint32_t batch_size, const RangeJob& job) {
+  if (count == 0) {
+    return;
+  }
+
+  batch_size = std::max(batch_size, 1u);
+  if (kState.Workers.empty() || count <= batch_size) {
+    job(0, count);
+    return;
+  }
+
+  JobCounter counter;
+  for (uint32_t begin = 0; begin < count; begin += batch_size) {
+    uint32_t end = std::min(count, begin + batch_size);
+    Execute([&job, begin, end] { job(begin, end); }, &counter);
+  }
+
+  Wait(counter);
+}
+
+// The job is shared between all batches since it has to outlive the call.
+void JobSystem::ParallelForAsync(
+    uint32_t count,
+    uint32_t batch_size,
+    const RangeJob& job,
+    JobCounter* counter) {
+  if (count == 0) {
+    return;
+  }
+
+  batch_size = std::max(batch_size, 1u);
+  auto shared_job = std::make_shared<RangeJob>(job);
+  for (uint32_t begin = 0; begin < count; begin += batch_size) {
+    uint32_t end = std::min(count, begin + batch_size);
+    Execute([shared_job, begin, end] { (*shared_job)(begin, end); }, counter);
+  }
+}
+
+void JobSystem::Wait(const JobCounter& counter) {
+  while (counter.Pending.load(std::memory_order_acquire) > 0) {
+    if (kState.Queues.empty() || !RunPendingJob(GetHomeQueue())) {
+      std::this_thread::yield();
+    }
+  }
+}
+
+uint32_t JobSystem::GetWorkerCount() {
+  return static_cast<uint32_t>(kState.Workers.size());
+}
+
+int JobSystem::GetCurrentWorkerIndex() {
+  return kWorkerIndex;
+}
+
+void JobSystem::SetHomeNode(int node) {
+  kHomeNode = node;
+}
+
+int JobSystem::GetHomeNode() {
+  return kHomeNode;
+}
+
+uint32_t JobSystem::GetNodeCount() {
+  return static_cast<uint32_t>(cpu::GetCpuTopology().Nodes.size());
+}
+
+}  // namespace jobs
+}  // namespace engine
@@ -0,0 +1,154 @@
+/**
+ * @file engine/src/core/jobs/JobSystem.h
+ * @brief The engines worker thread pool.
+ *
+ * Jobs are small units of work that are executed by a fixed pool of worker
+ * threads. Every worker owns a queue and steals from the queues of other
+ * workers once it runs out of work. Threads waiting on a job to complete will
+ * help execute pending jobs instead of blocking.
+ *
+ * On NUMA machines workers are spread over the nodes and steal from workers on
+ * their own node before crossing to another one, which keeps the memory a job
+ * touches local for as long as there is local work. Threads that aren't
+ * workers can pick the node their jobs go to with SetHomeNode.
+ */
+#ifndef ENGINE_SRC_CORE_JOBS_JOBSYSTEM_H_
+#define ENGINE_SRC_CORE_JOBS_JOBSYSTEM_H_
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+
+#include "core/Core.h"
+
+namespace engine {
+namespace jobs {
+
+/**
+ * @struct JobCounter
+ * @brief Tracks the number of jobs that are still pending for a group of jobs.
+ *
+ * Counters are passed into Execute and then waited upon with Wait.
+ */
+struct JobCounter {
+  std::atomic<uint32_t> Pending{0};
+};
+
+/**
+ * @class JobSystem
+ * @brief Static interface into the worker pool.
+ *
+ * When the job system hasn't been initialized (or was initialized without any
+ * workers) all jobs are executed immediately on the calling thread.
+ */
+class ENGINE_API JobSystem {
+ public:
+  /**
+   * @typedef Job
+   * @brief A single unit of work.
+   */
+  typedef std::function<void()> Job;
+
+  /**
+   * @typedef RangeJob
+   * @brief A unit of work over the half open range [begin, end).
+   */
+  typedef std::function<void(uint32_t begin, uint32_t end)> RangeJob;
+
+  /**
+   * @fn Init
+   * @param worker_count The number of worker threads to spawn. Passing 0 will
+   * use the jobs.worker_count console variable, or spawn one worker for every
+   * hardware thread except the calling one if that is 0 as well.
+   * @brief Spawns the worker threads.
+   */
+  static void Init(uint32_t worker_count = 0);
+
+  /**
+   * @fn Shutdown
+   * @brief Finishes all queued jobs and joins the worker threads.
+   */
+  static void Shutdown();
+
+  /**
+   * @fn Execute
+   * @param job The job to be executed.
+   * @param counter An optional counter that is incremented until the job has
+   * completed.
+   * @brief Queues a job for execution on the worker threads.
+   */
+  static void Execute(const Job& job, JobCounter* counter = nullptr);
+
+  /**
+   * @fn ParallelFor
+   * @param count The number of items to process.
+   * @param batch_size The number of items processed by a single job.
+   * @param job The job invoked for every batch of items.
+   * @brief Splits [0, count) into batches that are processed in parallel and
+   * blocks until all of them have completed.
+   */
+  static void ParallelFor(
+      uint32_t count, uint32_t batch_size, const RangeJob& job);
+
+  /**
+   * @fn ParallelForAsync
+   * @param count The number of items to process.
+   * @param batch_size The number of items processed by a single job.
+   * @param job The job invoked for every batch of items.
+   * @param counter The counter to wait on for all batches to complete.
+   * @brief Like ParallelFor, but returns immediately after queueing the
+   * batches. Anything referenced by the job must outlive the counter.
+   */
+  static void ParallelForAsync(
+      uint32_t count,
+      uint32_t batch_size,
+      const RangeJob& job,
+      JobCounter* counter);
+
+  /**
+   * @fn Wait
+   * @brief Blocks until all jobs associated with the counter have completed.
+   *
+   * The calling thread executes pending jobs while it waits.
+   */
+  static void Wait(const JobCounter& counter);
+
+  /**
+   * @fn GetWorkerCount
+   * @brief Get the number of worker threads in the pool.
+   */
+  static uint32_t GetWorkerCount();
+
+  /**
+   * @fn GetCurrentWorkerIndex
+   * @brief Get the index of the worker executing the calling thread, or -1 if
+   * the calling thread isn't a worker.
+   */
+  static int GetCurrentWorkerIndex();
+
+  /**
+   * @fn SetHomeNode
+   * @param node An index into cpu::CpuTopology::Nodes, or -1 for any node.
+   * @brief Sends the jobs the calling thread queues to the workers on a NUMA
+   * node, which is where the memory they work on should live as well (Check
+   * `memory::ArenaSettings::NumaNode`). Workers always queue to themselves.
+   */
+  static void SetHomeNode(int node);
+
+  /**
+   * @fn GetHomeNode
+   * @brief Get the home node of the calling thread, or -1 if it has none.
+   */
+  static int GetHomeNode();
+
+  /**
+   * @fn GetNodeCount
+   * @brief Get the number of NUMA nodes workers are spread over.
+   */
+  static uint32_t GetNodeCount();
+};
+
+}  // namespace jobs
+}  // namespace engine
+
+#endif  // ENGINE_SRC_CORE_JOBS_JOBSYSTEM_H_
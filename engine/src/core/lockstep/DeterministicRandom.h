@@ -0,0 +1,82 @@
+/**
+ * @file engine/src/core/lockstep/DeterministicRandom.h
+ * @brief A random number generator for deterministic simulation.
+ *
+ * Standard library distributions are implementation defined and may produce
+ * different sequences on different platforms. This generator only relies on
+ * integer arithmetic and produces fixed point results, so a given seed yields
+ * the same sequence everywhere.
+ */
+#ifndef ENGINE_SRC_CORE_LOCKSTEP_DETERMINISTICRANDOM_H_
+#define ENGINE_SRC_CORE_LOCKSTEP_DETERMINISTICRANDOM_H_
+
+#include <cstdint>
+
+#include "core/lockstep/Fixed.h"
+#include "core/random/Random.h"
+
+namespace engine {
+namespace lockstep {
+
+/**
+ * @class DeterministicRandom
+ * @brief A Pcg32 generator with fixed point helpers.
+ *
+ * The complete state is two integers, which makes it cheap to hash and to
+ * store in simulation snapshots.
+ */
+class DeterministicRandom {
+ public:
+  explicit DeterministicRandom(uint64_t seed = 0, uint64_t stream = 0)
+      : generator_(seed, stream) {}
+
+  /**
+   * @fn Seed
+   * @param seed The starting point within the sequence.
+   * @param stream Selects one of 2^63 independent sequences.
+   */
+  inline void Seed(uint64_t seed, uint64_t stream = 0) {
+    generator_.Seed(seed, stream);
+  }
+
+  inline uint32_t NextUInt32() { return generator_.NextUInt32(); }
+
+  /**
+   * @fn NextBelow
+   * @brief Get a uniformly distributed integer in [0, bound).
+   */
+  inline uint32_t NextBelow(uint32_t bound) {
+    return generator_.NextBelow(bound);
+  }
+
+  /**
+   * @fn NextFixed
+   * @brief Get a uniformly distributed fixed point number in [0, 1).
+   */
+  template<typename T = Fixed>
+  inline T NextFixed() {
+    static_assert(T::kFractionBits <= 32, "Too many fractional bits.");
+    return T::FromRaw(static_cast<typename T::RawType>(
+        NextUInt32() >> (32 - T::kFractionBits)));
+  }
+
+  /**
+   * @fn NextRange
+   * @brief Get a uniformly distributed fixed point number in [low, high).
+   */
+  template<typename T>
+  inline T NextRange(T low, T high) {
+    return low + (high - low) * NextFixed<T>();
+  }
+
+  inline uint64_t GetState() const { return generator_.GetState(); }
+  inline uint64_t GetIncrement() const { return generator_.GetIncrement(); }
+
+ private:
+  random::Pcg32 generator_;
+};
+
+}  // namespace lockstep
+}  // namespace engine
+
+#endif  // ENGINE_SRC_CORE_LOCKSTEP_DETERMINISTICRANDOM_H_
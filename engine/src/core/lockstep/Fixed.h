@@ -0,0 +1,359 @@
+/**
+ * @file engine/src/core/lockstep/Fixed.h
+ * @brief Fixed point numbers for deterministic simulation.
+ *
+ * Floating point results can differ between compilers, instruction sets and
+ * optimization levels, which makes them unusable for simulations that have to
+ * produce bit identical results on every machine. Fixed point numbers only use
+ * integer arithmetic, so every operation (including the math functions in this
+ * file) produces the same bits everywhere.
+ *
+ * Two formats are provided: Fixed (Q16.16) for the bulk of gameplay values and
+ * Fixed64 (Q32.32) for values that need a larger range or more precision, such
+ * as world positions on large maps.
+ */
+#ifndef ENGINE_SRC_CORE_LOCKSTEP_FIXED_H_
+#define ENGINE_SRC_CORE_LOCKSTEP_FIXED_H_
+
+#include <cstdint>
+#include <limits>
+
+namespace engine {
+namespace lockstep {
+
+namespace detail {
+
+// ------------------------------- WIDE ARITHMETIC -----------------------------
+
+// Computes (a * b) >> shift rounding towards negative infinity.
+inline int32_t MultiplyShift(int32_t a, int32_t b, int shift) {
+  return static_cast<int32_t>((static_cast<int64_t>(a) * b) >> shift);
+}
+
+inline int64_t MultiplyShift(int64_t a, int64_t b, int shift) {
+#if defined(__SIZEOF_INT128__)
+  return static_cast<int64_t>((static_cast<__int128>(a) * b) >> shift);
+#else
+  // Multiply the magnitudes as four 32 bit halves into a 128 bit product, then
+  // restore the sign in two's complement so that the shift rounds the same way
+  // as the native 128 bit path.
+  bool negative = (a < 0) != (b < 0);
+  uint64_t ua = a < 0 ? 0 - static_cast<uint64_t>(a) : a;
+  uint64_t ub = b < 0 ? 0 - static_cast<uint64_t>(b) : b;
+
+  uint64_t a_low = ua & 0xffffffffu, a_high = ua >> 32;
+  uint64_t b_low = ub & 0xffffffffu, b_high = ub >> 32;
+  uint64_t low_low = a_low * b_low;
+  uint64_t high_low = a_high * b_low;
+  uint64_t low_high = a_low * b_high;
+  uint64_t high_high = a_high * b_high;
+
+  uint64_t cross = (low_low >> 32) + (high_low & 0xffffffffu) + low_high;
+  uint64_t high = high_high + (high_low >> 32) + (cross >> 32);
+  uint64_t low = (cross << 32) | (low_low & 0xffffffffu);
+
+  if (negative) {
+    low = ~low + 1;
+    high = ~high + (low == 0 ? 1 : 0);
+  }
+
+  if (shift == 0) {
+    return static_cast<int64_t>(low);
+  }
+  return static_cast<int64_t>((high << (64 - shift)) | (low >> shift));
+#endif
+}
+
+// Computes (a << shift) / b rounding towards zero. Division by zero saturates.
+inline int32_t DivideShift(int32_t a, int32_t b, int shift) {
+  if (b == 0) {
+    return a < 0
+        ? std::numeric_limits<int32_t>::min()
+        : std::numeric_limits<int32_t>::max();
+  }
+  return static_cast<int32_t>((static_cast<int64_t>(a) * (1ll << shift)) / b);
+}
+
+inline int64_t DivideShift(int64_t a, int64_t b, int shift) {
+  if (b == 0) {
+    return a < 0
+        ? std::numeric_limits<int64_t>::min()
+        : std::numeric_limits<int64_t>::max();
+  }
+#if defined(__SIZEOF_INT128__)
+  return static_cast<int64_t>(
+      (static_cast<__int128>(a) * (static_cast<__int128>(1) << shift)) / b);
+#else
+  // Long division of the 128 bit magnitude |a| << shift by |b|.
+  bool negative = (a < 0) != (b < 0);
+  uint64_t ua = a < 0 ? 0 - static_cast<uint64_t>(a) : a;
+  uint64_t ub = b < 0 ? 0 - static_cast<uint64_t>(b) : b;
+  uint64_t high = shift == 0 ? 0 : ua >> (64 - shift);
+  uint64_t low = ua << shift;
+
+  uint64_t quotient = 0;
+  uint64_t remainder = 0;
+  for (int bit = 127; bit >= 0; --bit) {
+    uint64_t next = bit >= 64 ? (high >> (bit - 64)) & 1 : (low >> bit) & 1;
+    bool carry = (remainder >> 63) != 0;
+    remainder = (remainder << 1) | next;
+    quotient <<= 1;
+    if (carry || remainder >= ub) {
+      remainder -= ub;
+      quotient |= 1;
+    }
+  }
+
+  return negative
+      ? static_cast<int64_t>(0 - quotient)
+      : static_cast<int64_t>(quotient);
+#endif
+}
+
+// Square root of raw * 2^fraction_bits, computed one result bit at a time.
+// The remainder never exceeds twice the root, so it fits into 64 bits even
+// for Q32.32 where the radicand itself is 96 bits wide.
+inline uint64_t SquareRootShift(uint64_t raw, int raw_bits, int fraction_bits) {
+  uint64_t remainder = 0;
+  uint64_t root = 0;
+  for (int pair = (raw_bits + fraction_bits) / 2 - 1; pair >= 0; --pair) {
+    int bit = 2 * pair - fraction_bits;
+    uint64_t digits = bit >= 0 ? (raw >> bit) & 3 : 0;
+    remainder = (remainder << 2) | digits;
+    uint64_t trial = (root << 2) | 1;
+    root <<= 1;
+    if (remainder >= trial) {
+      remainder -= trial;
+      root |= 1;
+    }
+  }
+  return root;
+}
+
+}  // namespace detail
+
+// --------------------------------- FIXED POINT -------------------------------
+
+/**
+ * @class FixedPoint
+ * @brief A signed fixed point number with FractionBits fractional bits stored
+ * in Raw.
+ *
+ * Arithmetic wraps on overflow like the underlying integers would. Conversions
+ * from floating point are meant for loading data and tooling only, since the
+ * simulation itself should never touch floats.
+ */
+template<typename Raw, int FractionBits>
+class FixedPoint {
+ public:
+  typedef Raw RawType;
+  static constexpr int kFractionBits = FractionBits;
+  static constexpr Raw kOne = static_cast<Raw>(Raw(1) << FractionBits);
+
+  constexpr FixedPoint() : raw_(0) {}
+
+  static constexpr FixedPoint FromRaw(Raw raw) {
+    return FixedPoint(raw, 0);
+  }
+
+  static constexpr FixedPoint FromInt(int64_t value) {
+    return FromRaw(static_cast<Raw>(value * kOne));
+  }
+
+  /**
+   * @fn FromRatio
+   * @brief Creates numerator / denominator without going through floating
+   * point, which makes it safe for deterministic constants.
+   */
+  static constexpr FixedPoint FromRatio(
+      int64_t numerator, int64_t denominator) {
+    return FromRaw(static_cast<Raw>(numerator * kOne / denominator));
+  }
+
+  static constexpr FixedPoint FromDouble(double value) {
+    return FromRaw(static_cast<Raw>(
+        value * static_cast<double>(kOne) + (value < 0.0 ? -0.5 : 0.5)));
+  }
+
+  static constexpr FixedPoint Zero() { return FixedPoint(); }
+  static constexpr FixedPoint One() { return FromRaw(kOne); }
+  static constexpr FixedPoint Half() { return FromRaw(kOne / 2); }
+  static constexpr FixedPoint Pi()
+      { return FromDouble(3.14159265358979323846); }
+  static constexpr FixedPoint HalfPi()
+      { return FromDouble(1.57079632679489661923); }
+  static constexpr FixedPoint TwoPi()
+      { return FromDouble(6.28318530717958647692); }
+  static constexpr FixedPoint Max()
+      { return FromRaw(std::numeric_limits<Raw>::max()); }
+  static constexpr FixedPoint Min()
+      { return FromRaw(std::numeric_limits<Raw>::min()); }
+
+  constexpr Raw GetRaw() const { return raw_; }
+  constexpr float ToFloat() const
+      { return static_cast<float>(raw_) / static_cast<float>(kOne); }
+  constexpr double ToDouble() const
+      { return static_cast<double>(raw_) / static_cast<double>(kOne); }
+
+  /**
+   * @fn ToInt
+   * @brief Converts to an integer, rounding towards negative infinity.
+   */
+  constexpr int64_t ToInt() const { return raw_ >> FractionBits; }
+
+  constexpr FixedPoint operator-() const { return FromRaw(-raw_); }
+  constexpr FixedPoint operator+(FixedPoint other) const
+      { return FromRaw(raw_ + other.raw_); }
+  constexpr FixedPoint operator-(FixedPoint other) const
+      { return FromRaw(raw_ - other.raw_); }
+  inline FixedPoint operator*(FixedPoint other) const
+      { return FromRaw(detail::MultiplyShift(raw_, other.raw_, FractionBits)); }
+  inline FixedPoint operator/(FixedPoint other) const
+      { return FromRaw(detail::DivideShift(raw_, other.raw_, FractionBits)); }
+
+  inline FixedPoint& operator+=(FixedPoint other)
+      { raw_ += other.raw_; return *this; }
+  inline FixedPoint& operator-=(FixedPoint other)
+      { raw_ -= other.raw_; return *this; }
+  inline FixedPoint& operator*=(FixedPoint other)
+      { return *this = *this * other; }
+  inline FixedPoint& operator/=(FixedPoint other)
+      { return *this = *this / other; }
+
+  constexpr bool operator==(FixedPoint other) const
+      { return raw_ == other.raw_; }
+  constexpr bool operator!=(FixedPoint other) const
+      { return raw_ != other.raw_; }
+  constexpr bool operator<(FixedPoint other) const
+      { return raw_ < other.raw_; }
+  constexpr bool operator<=(FixedPoint other) const
+      { return raw_ <= other.raw_; }
+  constexpr bool operator>(FixedPoint other) const
+      { return raw_ > other.raw_; }
+  constexpr bool operator>=(FixedPoint other) const
+      { return raw_ >= other.raw_; }
+
+ private:
+  Raw raw_;
+
+  constexpr FixedPoint(Raw raw, int) : raw_(raw) {}
+};
+
+/**
+ * @typedef Fixed
+ * @brief A Q16.16 fixed point number with a range of +-32768.
+ */
+typedef FixedPoint<int32_t, 16> Fixed;
+
+/**
+ * @typedef Fixed64
+ * @brief A Q32.32 fixed point number with a range of +-2^31.
+ */
+typedef FixedPoint<int64_t, 32> Fixed64;
+
+// ------------------------------------- MATH ----------------------------------
+
+template<typename Raw, int F>
+inline FixedPoint<Raw, F> Abs(FixedPoint<Raw, F> value) {
+  return value.GetRaw() < 0 ? -value : value;
+}
+
+template<typename Raw, int F>
+inline FixedPoint<Raw, F> Min(FixedPoint<Raw, F> a, FixedPoint<Raw, F> b) {
+  return a < b ? a : b;
+}
+
+template<typename Raw, int F>
+inline FixedPoint<Raw, F> Max(FixedPoint<Raw, F> a, FixedPoint<Raw, F> b) {
+  return a > b ? a : b;
+}
+
+template<typename Raw, int F>
+inline FixedPoint<Raw, F> Clamp(
+    FixedPoint<Raw, F> value, FixedPoint<Raw, F> low, FixedPoint<Raw, F> high) {
+  return Min(Max(value, low), high);
+}
+
+template<typename Raw, int F>
+inline FixedPoint<Raw, F> Floor(FixedPoint<Raw, F> value) {
+  return FixedPoint<Raw, F>::FromRaw(
+      value.GetRaw() & ~(FixedPoint<Raw, F>::kOne - 1));
+}
+
+template<typename Raw, int F>
+inline FixedPoint<Raw, F> Ceil(FixedPoint<Raw, F> value) {
+  return -Floor(-value);
+}
+
+template<typename Raw, int F>
+inline FixedPoint<Raw, F> Lerp(
+    FixedPoint<Raw, F> a, FixedPoint<Raw, F> b, FixedPoint<Raw, F> t) {
+  return a + (b - a) * t;
+}
+
+/**
+ * @fn Sqrt
+ * @brief The square root of value, or zero for negative values.
+ */
+template<typename Raw, int F>
+inline FixedPoint<Raw, F> Sqrt(FixedPoint<Raw, F> value) {
+  if (value.GetRaw() <= 0) {
+    return FixedPoint<Raw, F>();
+  }
+  return FixedPoint<Raw, F>::FromRaw(static_cast<Raw>(
+      detail::SquareRootShift(
+          static_cast<uint64_t>(value.GetRaw()), sizeof(Raw) * 8, F)));
+}
+
+/**
+ * @fn Sin
+ * @brief The sine of an angle in radians.
+ *
+ * The angle is reduced to [-pi/2, pi/2] where a Taylor series up to the 11th
+ * power is evaluated. Both steps run in Q32.32 so that the series coefficients
+ * keep enough precision for every format.
+ */
+template<typename Raw, int F>
+inline FixedPoint<Raw, F> Sin(FixedPoint<Raw, F> angle) {
+  static_assert(F <= Fixed64::kFractionBits, "Too many fractional bits.");
+  constexpr int kShift = Fixed64::kFractionBits - F;
+
+  int64_t two_pi = Fixed64::TwoPi().GetRaw();
+  int64_t reduced =
+      static_cast<int64_t>(angle.GetRaw()) * (int64_t(1) << kShift) % two_pi;
+  if (reduced > Fixed64::Pi().GetRaw()) {
+    reduced -= two_pi;
+  } else if (reduced < -Fixed64::Pi().GetRaw()) {
+    reduced += two_pi;
+  }
+
+  Fixed64 x = Fixed64::FromRaw(reduced);
+  if (x > Fixed64::HalfPi()) {
+    x = Fixed64::Pi() - x;
+  } else if (x < -Fixed64::HalfPi()) {
+    x = -Fixed64::Pi() - x;
+  }
+
+  Fixed64 x2 = x * x;
+  Fixed64 result = Fixed64::FromRatio(-1, 39916800);
+  result = result * x2 + Fixed64::FromRatio(1, 362880);
+  result = result * x2 + Fixed64::FromRatio(-1, 5040);
+  result = result * x2 + Fixed64::FromRatio(1, 120);
+  result = result * x2 + Fixed64::FromRatio(-1, 6);
+  result = result * x2 + Fixed64::One();
+  result = result * x;
+
+  int64_t rounding = kShift > 0 ? int64_t(1) << (kShift - 1) : 0;
+  return FixedPoint<Raw, F>::FromRaw(
+      static_cast<Raw>((result.GetRaw() + rounding) >> kShift));
+}
+
+template<typename Raw, int F>
+inline FixedPoint<Raw, F> Cos(FixedPoint<Raw, F> angle) {
+  return Sin(angle + FixedPoint<Raw, F>::HalfPi());
+}
+
+}  // namespace lockstep
+}  // namespace engine
+
+#endif  // ENGINE_SRC_CORE_LOCKSTEP_FIXED_H_
@@ -0,0 +1,217 @@
+/**
+ * @file engine/src/core/lockstep/FixedVector.h
+ * @brief Vectors and matrices of fixed point numbers.
+ *
+ * These mirror the float vector and matrix types used by the rest of the
+ * engine so that deterministic simulation code reads the same, but every
+ * operation is built on the integer arithmetic of FixedPoint.
+ */
+#ifndef ENGINE_SRC_CORE_LOCKSTEP_FIXEDVECTOR_H_
+#define ENGINE_SRC_CORE_LOCKSTEP_FIXEDVECTOR_H_
+
+#include "core/lockstep/Fixed.h"
+
+namespace engine {
+namespace lockstep {
+
+// ----------------------------------- VECTOR 2 --------------------------------
+
+template<typename T>
+struct Vector2T {
+  T x, y;
+
+  inline Vector2T operator+(const Vector2T& other) const
+      { return { x + other.x, y + other.y }; }
+  inline Vector2T operator-(const Vector2T& other) const
+      { return { x - other.x, y - other.y }; }
+  inline Vector2T operator-() const { return { -x, -y }; }
+  inline Vector2T operator*(T scalar) const
+      { return { x * scalar, y * scalar }; }
+  inline Vector2T operator/(T scalar) const
+      { return { x / scalar, y / scalar }; }
+
+  inline Vector2T& operator+=(const Vector2T& other)
+      { x += other.x; y += other.y; return *this; }
+  inline Vector2T& operator-=(const Vector2T& other)
+      { x -= other.x; y -= other.y; return *this; }
+
+  inline bool operator==(const Vector2T& other) const
+      { return x == other.x && y == other.y; }
+  inline bool operator!=(const Vector2T& other) const
+      { return !(*this == other); }
+};
+
+template<typename T>
+inline T Dot(const Vector2T<T>& a, const Vector2T<T>& b) {
+  return a.x * b.x + a.y * b.y;
+}
+
+/**
+ * @fn Cross
+ * @brief The z component of the cross product of two vectors in the plane.
+ */
+template<typename T>
+inline T Cross(const Vector2T<T>& a, const Vector2T<T>& b) {
+  return a.x * b.y - a.y * b.x;
+}
+
+template<typename T>
+inline T Length(const Vector2T<T>& vector) {
+  return Sqrt(Dot(vector, vector));
+}
+
+/**
+ * @fn Normalize
+ * @brief Get the unit length vector in the same direction, or the zero vector
+ * if the vector has no length.
+ */
+template<typename T>
+inline Vector2T<T> Normalize(const Vector2T<T>& vector) {
+  T length = Length(vector);
+  return length > T() ? vector / length : Vector2T<T>{ T(), T() };
+}
+
+// ----------------------------------- VECTOR 3 --------------------------------
+
+template<typename T>
+struct Vector3T {
+  T x, y, z;
+
+  inline Vector3T operator+(const Vector3T& other) const
+      { return { x + other.x, y + other.y, z + other.z }; }
+  inline Vector3T operator-(const Vector3T& other) const
+      { return { x - other.x, y - other.y, z - other.z }; }
+  inline Vector3T operator-() const { return { -x, -y, -z }; }
+  inline Vector3T operator*(T scalar) const
+      { return { x * scalar, y * scalar, z * scalar }; }
+  inline Vector3T operator/(T scalar) const
+      { return { x / scalar, y / scalar, z / scalar }; }
+
+  inline Vector3T& operator+=(const Vector3T& other)
+      { x += other.x; y += other.y; z += other.z; return *this; }
+  inline Vector3T& operator-=(const Vector3T& other)
+      { x -= other.x; y -= other.y; z -= other.z; return *this; }
+
+  inline bool operator==(const Vector3T& other) const
+      { return x == other.x && y == other.y && z == other.z; }
+  inline bool operator!=(const Vector3T& other) const
+      { return !(*this == other); }
+};
+
+template<typename T>
+inline T Dot(const Vector3T<T>& a, const Vector3T<T>& b) {
+  return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+template<typename T>
+inline Vector3T<T> Cross(const Vector3T<T>& a, const Vector3T<T>& b) {
+  return {
+      a.y * b.z - a.z * b.y,
+      a.z * b.x - a.x * b.z,
+      a.x * b.y - a.y * b.x };
+}
+
+template<typename T>
+inline T Length(const Vector3T<T>& vector) {
+  return Sqrt(Dot(vector, vector));
+}
+
+template<typename T>
+inline Vector3T<T> Normalize(const Vector3T<T>& vector) {
+  T length = Length(vector);
+  return length > T() ? vector / length : Vector3T<T>{ T(), T(), T() };
+}
+
+// ----------------------------------- MATRIX 3 --------------------------------
+
+/**
+ * @struct Matrix3T
+ * @brief A 3x3 matrix stored as rows.
+ *
+ * Used for rotations and scales in 3D, or for full affine transforms of 2D
+ * points in homogeneous coordinates, which covers most RTS simulations.
+ */
+template<typename T>
+struct Matrix3T {
+  Vector3T<T> Rows[3];
+
+  static inline Matrix3T Identity() {
+    T zero = T(), one = T::One();
+    return { {
+        { one, zero, zero },
+        { zero, one, zero },
+        { zero, zero, one } } };
+  }
+
+  /**
+   * @fn RotationY
+   * @brief A rotation about the up axis by angle radians.
+   */
+  static inline Matrix3T RotationY(T angle) {
+    T zero = T(), one = T::One();
+    T sin = Sin(angle), cos = Cos(angle);
+    return { {
+        { cos, zero, sin },
+        { zero, one, zero },
+        { -sin, zero, cos } } };
+  }
+
+  /**
+   * @fn Transform2D
+   * @brief A 2D rotation by angle radians followed by a translation, applied
+   * to points of the form (x, y, 1).
+   */
+  static inline Matrix3T Transform2D(T angle, const Vector2T<T>& translation) {
+    T zero = T(), one = T::One();
+    T sin = Sin(angle), cos = Cos(angle);
+    return { {
+        { cos, -sin, translation.x },
+        { sin, cos, translation.y },
+        { zero, zero, one } } };
+  }
+
+  inline Vector3T<T> operator*(const Vector3T<T>& vector) const {
+    return {
+        Dot(Rows[0], vector), Dot(Rows[1], vector), Dot(Rows[2], vector) };
+  }
+
+  inline Vector2T<T> TransformPoint(const Vector2T<T>& point) const {
+    Vector3T<T> result = *this * Vector3T<T>{ point.x, point.y, T::One() };
+    return { result.x, result.y };
+  }
+
+  inline Matrix3T Transpose() const {
+    return { {
+        { Rows[0].x, Rows[1].x, Rows[2].x },
+        { Rows[0].y, Rows[1].y, Rows[2].y },
+        { Rows[0].z, Rows[1].z, Rows[2].z } } };
+  }
+
+  inline Matrix3T operator*(const Matrix3T& other) const {
+    Matrix3T columns = other.Transpose();
+    Matrix3T result;
+    for (int row = 0; row < 3; ++row) {
+      result.Rows[row] = columns * Rows[row];
+    }
+    return result;
+  }
+
+  inline bool operator==(const Matrix3T& other) const {
+    return Rows[0] == other.Rows[0]
+        && Rows[1] == other.Rows[1]
+        && Rows[2] == other.Rows[2];
+  }
+};
+
+typedef Vector2T<Fixed> FixedVector2;
+typedef Vector3T<Fixed> FixedVector3;
+typedef Matrix3T<Fixed> FixedMatrix3;
+
+typedef Vector2T<Fixed64> Fixed64Vector2;
+typedef Vector3T<Fixed64> Fixed64Vector3;
+typedef Matrix3T<Fixed64> Fixed64Matrix3;
+
+}  // namespace lockstep
+}  // namespace engine
+
+#endif  // ENGINE_SRC_CORE_LOCKSTEP_FIXEDVECTOR_H_
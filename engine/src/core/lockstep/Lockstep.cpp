@@ -0,0 +1,205 @@
+#include "core/lockstep/Lockstep.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "core/Assert.h"
+#include "core/Log.h"
+
+namespace engine {
+namespace lockstep {
+
+/**
+ * Nobody can schedule inputs for the first ticks within the input delay, so
+ * they start out with empty inputs for every player.
+ */
+LockstepSession::LockstepSession(
+    const LockstepSettings& settings, LockstepSimulation* simulation)
+    : settings_(settings), simulation_(simulation), sealed_tick_(0) {
+  ENGINE_CORE_ASSERT(simulation_, "Lockstep requires a simulation.");
+  ENGINE_CORE_ASSERT(
+      settings_.LocalPlayer < settings_.PlayerCount,
+      "The local player must be one of the players.");
+  ENGINE_CORE_ASSERT(
+      settings_.TicksPerSecond > 0 && settings_.HashInterval > 0,
+      "The tick rate and hash interval must be positive.");
+
+  for (uint32_t tick = 0; tick < settings_.InputDelay; ++tick) {
+    for (uint32_t player = 0; player < settings_.PlayerCount; ++player) {
+      inputs_[tick].push_back({ player, tick, {} });
+    }
+  }
+  sealed_tick_ = settings_.InputDelay;
+}
+
+void LockstepSession::QueueLocalInput(const void* data, size_t size) {
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+  local_input_.insert(local_input_.end(), bytes, bytes + size);
+}
+
+void LockstepSession::ReceiveInput(const PlayerInput& input) {
+  if (input.Player == settings_.LocalPlayer) {
+    return;
+  }
+  AddInput(input);
+}
+
+void LockstepSession::ReceiveStateHash(
+    uint32_t player, uint32_t tick, uint64_t hash) {
+  if (player == settings_.LocalPlayer) {
+    return;
+  }
+
+  if (tick >= current_tick_) {
+    remote_hashes_.insert({ tick, { player, hash } });
+    return;
+  }
+
+  // Hashes for ticks that have already fallen out of the history can't be
+  // checked anymore.
+  if (local_hashes_.count(tick)) {
+    CompareHash(player, tick, hash);
+  }
+}
+
+uint32_t LockstepSession::Update(float delta_seconds) {
+  const float tick_length = 1.0f / settings_.TicksPerSecond;
+  accumulator_ += delta_seconds;
+
+  uint32_t ticks = 0;
+  while (accumulator_ >= tick_length && ticks < settings_.MaxTicksPerUpdate) {
+    if (!AdvanceTick()) {
+      break;
+    }
+    accumulator_ -= tick_length;
+    ++ticks;
+  }
+
+  // Don't build up a backlog of ticks while stalled on inputs or when the
+  // simulation can't keep up, since catching up would freeze the game.
+  accumulator_ = std::min(
+      accumulator_, tick_length * settings_.MaxTicksPerUpdate);
+  return ticks;
+}
+
+bool LockstepSession::AdvanceTick() {
+  if (sealed_tick_ <= current_tick_ + settings_.InputDelay) {
+    SealLocalInput();
+  }
+
+  if (IsWaitingForInput()) {
+    return false;
+  }
+
+  auto frame = inputs_.find(current_tick_);
+  std::vector<PlayerInput>& inputs = frame->second;
+  std::sort(
+      inputs.begin(),
+      inputs.end(),
+      [](const PlayerInput& a, const PlayerInput& b) {
+        return a.Player < b.Player;
+      });
+  simulation_->OnTick(
+      current_tick_, inputs.data(), static_cast<uint32_t>(inputs.size()));
+  inputs_.erase(frame);
+
+  if (current_tick_ % settings_.HashInterval == 0) {
+    StateHasher hasher;
+    simulation_->HashState(&hasher);
+    uint64_t hash = hasher.GetHash();
+
+    local_hashes_[current_tick_] = hash;
+    while (local_hashes_.size() > settings_.HashHistory) {
+      local_hashes_.erase(local_hashes_.begin());
+    }
+
+    if (hash_callback_) {
+      hash_callback_(current_tick_, hash);
+    }
+
+    auto pending = remote_hashes_.equal_range(current_tick_);
+    for (auto it = pending.first; it != pending.second; ++it) {
+      CompareHash(it->second.Player, current_tick_, it->second.Hash);
+    }
+  }
+
+  // Remote hashes of ticks that weren't hashed here can never be checked.
+  remote_hashes_.erase(
+      remote_hashes_.begin(), remote_hashes_.upper_bound(current_tick_));
+
+  ++current_tick_;
+  return true;
+}
+
+bool LockstepSession::IsWaitingForInput() const {
+  auto frame = inputs_.find(current_tick_);
+  return frame == inputs_.end()
+      || frame->second.size() < settings_.PlayerCount;
+}
+
+bool LockstepSession::GetStateHash(uint32_t tick, uint64_t* hash) const {
+  auto entry = local_hashes_.find(tick);
+  if (entry == local_hashes_.end()) {
+    return false;
+  }
+  *hash = entry->second;
+  return true;
+}
+
+float LockstepSession::GetInterpolationAlpha() const {
+  return std::min(accumulator_ * settings_.TicksPerSecond, 1.0f);
+}
+
+void LockstepSession::SealLocalInput() {
+  PlayerInput input = {
+      settings_.LocalPlayer, sealed_tick_, std::move(local_input_) };
+  local_input_.clear();
+  ++sealed_tick_;
+
+  AddInput(input);
+  if (input_callback_) {
+    input_callback_(input);
+  }
+}
+
+void LockstepSession::AddInput(const PlayerInput& input) {
+  if (input.Player >= settings_.PlayerCount || input.Tick < current_tick_) {
+    ENGINE_CORE_WARN(
+        "Dropping lockstep input of player {} for tick {}.",
+        input.Player,
+        input.Tick);
+    return;
+  }
+
+  std::vector<PlayerInput>& frame = inputs_[input.Tick];
+  for (const PlayerInput& existing : frame) {
+    if (existing.Player == input.Player) {
+      return;
+    }
+  }
+  frame.push_back(input);
+}
+
+void LockstepSession::CompareHash(
+    uint32_t player, uint32_t tick, uint64_t remote_hash) {
+  uint64_t local_hash = local_hashes_[tick];
+  if (desynced_ || local_hash == remote_hash) {
+    return;
+  }
+
+  desynced_ = true;
+  desync_ = { tick, player, local_hash, remote_hash };
+  ENGINE_CORE_ERROR(
+      "Lockstep desync with player {} at tick {} ({:016x} != {:016x}).",
+      player,
+      tick,
+      local_hash,
+      remote_hash);
+
+  if (desync_callback_) {
+    desync_callback_(desync_);
+  }
+}
+
+}  // namespace lockstep
+}  // namespace engine
@@ -0,0 +1,215 @@
+/**
+ * @file engine/src/core/lockstep/Lockstep.h
+ * @brief Deterministic lockstep simulation driven by player inputs.
+ *
+ * In lockstep every machine runs the exact same simulation and only the inputs
+ * of the players are sent over the network. A tick is simulated once the
+ * inputs of every player for it have arrived. Inputs are scheduled a few ticks
+ * into the future to hide the network latency.
+ *
+ * After hashed ticks the simulation state is hashed and exchanged between
+ * players. Any difference means that the simulations have diverged, which is
+ * reported as a desync together with the first tick at which it was noticed.
+ */
+#ifndef ENGINE_SRC_CORE_LOCKSTEP_LOCKSTEP_H_
+#define ENGINE_SRC_CORE_LOCKSTEP_LOCKSTEP_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <vector>
+
+#include "core/Core.h"
+#include "core/lockstep/Fixed.h"
+#include "core/lockstep/StateHasher.h"
+
+namespace engine {
+namespace lockstep {
+
+/**
+ * @struct LockstepSettings
+ * @brief Configures a lockstep session.
+ *
+ * A session with a single player and no input delay is a plain deterministic
+ * fixed timestep loop.
+ */
+struct LockstepSettings {
+  uint32_t TicksPerSecond = 20;
+  uint32_t PlayerCount = 1;
+  uint32_t LocalPlayer = 0;
+  uint32_t InputDelay = 2;
+  uint32_t HashInterval = 1;
+  uint32_t HashHistory = 256;
+  uint32_t MaxTicksPerUpdate = 4;
+};
+
+/**
+ * @struct PlayerInput
+ * @brief The serialized commands issued by a player for a single tick.
+ */
+struct PlayerInput {
+  uint32_t Player;
+  uint32_t Tick;
+  std::vector<uint8_t> Data;
+};
+
+/**
+ * @struct DesyncReport
+ * @brief Describes the first state hash that didn't match between machines.
+ */
+struct DesyncReport {
+  uint32_t Tick;
+  uint32_t Player;
+  uint64_t LocalHash;
+  uint64_t RemoteHash;
+};
+
+/**
+ * @class LockstepSimulation
+ * @brief Implemented by the game to be driven by a LockstepSession.
+ */
+class ENGINE_API LockstepSimulation {
+ public:
+  virtual ~LockstepSimulation() {}
+
+  /**
+   * @fn OnTick
+   * @param tick The tick being simulated.
+   * @param inputs The inputs of every player for this tick, ordered by player.
+   * @param count The number of inputs.
+   * @brief Advances the simulation by one tick. Must be fully deterministic.
+   */
+  virtual void OnTick(
+      uint32_t tick, const PlayerInput* inputs, uint32_t count) = 0;
+
+  /**
+   * @fn HashState
+   * @brief Adds all simulation state to the hasher.
+   */
+  virtual void HashState(StateHasher* hasher) const = 0;
+};
+
+/**
+ * @class LockstepSession
+ * @brief Schedules ticks, exchanges inputs and compares state hashes.
+ *
+ * The session doesn't do any networking itself. Sealed local inputs and state
+ * hashes are handed to callbacks to be sent, and everything received from
+ * other players is passed back in through ReceiveInput and ReceiveStateHash.
+ */
+class ENGINE_API LockstepSession {
+ public:
+  typedef std::function<void(const PlayerInput&)> InputCallback;
+  typedef std::function<void(uint32_t tick, uint64_t hash)> HashCallback;
+  typedef std::function<void(const DesyncReport&)> DesyncCallback;
+
+  LockstepSession(
+      const LockstepSettings& settings, LockstepSimulation* simulation);
+
+  /**
+   * @fn QueueLocalInput
+   * @brief Appends serialized commands to the local input of the next tick
+   * that is sealed.
+   */
+  void QueueLocalInput(const void* data, size_t size);
+
+  /**
+   * @fn ReceiveInput
+   * @brief Adds the input of a remote player.
+   */
+  void ReceiveInput(const PlayerInput& input);
+
+  /**
+   * @fn ReceiveStateHash
+   * @brief Compares the state hash of a remote player against the local one.
+   */
+  void ReceiveStateHash(uint32_t player, uint32_t tick, uint64_t hash);
+
+  /**
+   * @fn Update
+   * @param delta_seconds The real time that has passed since the last update.
+   * @brief Simulates every tick that is due and whose inputs are complete.
+   * Returns the number of ticks that were simulated.
+   *
+   * The elapsed time only decides when ticks run, never what they compute.
+   */
+  uint32_t Update(float delta_seconds);
+
+  /**
+   * @fn AdvanceTick
+   * @brief Simulates the next tick if all of its inputs have arrived.
+   */
+  bool AdvanceTick();
+
+  /**
+   * @fn IsWaitingForInput
+   * @brief Checks whether the next tick is stalled on remote inputs.
+   */
+  bool IsWaitingForInput() const;
+
+  /**
+   * @fn GetStateHash
+   * @brief Get the local state hash of a recent hashed tick.
+   */
+  bool GetStateHash(uint32_t tick, uint64_t* hash) const;
+
+  /**
+   * @fn GetInterpolationAlpha
+   * @brief Get how far real time has progressed towards the next tick, for
+   * interpolating rendered state between the last two ticks.
+   */
+  float GetInterpolationAlpha() const;
+
+  /**
+   * @fn GetTickDuration
+   * @brief Get the simulated time of a single tick in seconds.
+   */
+  inline Fixed GetTickDuration() const {
+    return Fixed::FromRatio(1, settings_.TicksPerSecond);
+  }
+
+  inline uint32_t GetCurrentTick() const { return current_tick_; }
+  inline bool HasDesynced() const { return desynced_; }
+  inline const DesyncReport& GetDesyncReport() const { return desync_; }
+  inline const LockstepSettings& GetSettings() const { return settings_; }
+
+  inline void SetInputCallback(const InputCallback& callback)
+      { input_callback_ = callback; }
+  inline void SetHashCallback(const HashCallback& callback)
+      { hash_callback_ = callback; }
+  inline void SetDesyncCallback(const DesyncCallback& callback)
+      { desync_callback_ = callback; }
+
+ private:
+  struct RemoteHash {
+    uint32_t Player;
+    uint64_t Hash;
+  };
+
+  LockstepSettings settings_;
+  LockstepSimulation* simulation_;
+  uint32_t current_tick_ = 0;
+  uint32_t sealed_tick_ = 0;
+  float accumulator_ = 0.0f;
+  bool desynced_ = false;
+  DesyncReport desync_;
+
+  std::vector<uint8_t> local_input_;
+  std::map<uint32_t, std::vector<PlayerInput>> inputs_;
+  std::map<uint32_t, uint64_t> local_hashes_;
+  std::multimap<uint32_t, RemoteHash> remote_hashes_;
+
+  InputCallback input_callback_;
+  HashCallback hash_callback_;
+  DesyncCallback desync_callback_;
+
+  void SealLocalInput();
+  void AddInput(const PlayerInput& input);
+  void CompareHash(uint32_t player, uint32_t tick, uint64_t remote_hash);
+};
+
+}  // namespace lockstep
+}  // namespace engine
+
+#endif  // ENGINE_SRC_CORE_LOCKSTEP_LOCKSTEP_H_
@@ -0,0 +1,82 @@
+/**
+ * @file engine/src/core/lockstep/StateHasher.h
+ * @brief Hashes simulation state to detect desyncs between machines.
+ */
+#ifndef ENGINE_SRC_CORE_LOCKSTEP_STATEHASHER_H_
+#define ENGINE_SRC_CORE_LOCKSTEP_STATEHASHER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "core/reflection/Reflection.h"
+
+namespace engine {
+namespace lockstep {
+
+/**
+ * @class StateHasher
+ * @brief Accumulates a 64 bit FNV-1a hash over simulation state.
+ *
+ * Only hash values whose bytes are fully determined by the simulation. Padding
+ * inside of structs holds whatever happened to be in memory, so structs should
+ * either be hashed field by field or registered with reflection and hashed
+ * with AddComponent.
+ */
+class StateHasher {
+ public:
+  inline void Reset() { hash_ = kOffsetBasis_; }
+
+  inline void AddBytes(const void* data, size_t size) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; ++i) {
+      hash_ = (hash_ ^ bytes[i]) * kPrime_;
+    }
+  }
+
+  /**
+   * @fn Add
+   * @brief Hashes an integer, enum or fixed point value.
+   */
+  template<typename T>
+  inline void Add(const T& value) {
+    static_assert(
+        std::is_trivially_copyable<T>::value,
+        "Only trivially copyable values can be hashed directly.");
+    static_assert(
+        !std::is_floating_point<T>::value,
+        "Floating point values aren't deterministic across machines.");
+    AddBytes(&value, sizeof(T));
+  }
+
+  /**
+   * @fn AddComponent
+   * @brief Hashes every reflected field of a component except the ones that
+   * are flagged as transient, skipping any padding between them.
+   */
+  template<typename T>
+  inline void AddComponent(const T& component) {
+    const reflection::TypeInfo& info = reflection::GetTypeInfo<T>();
+    const uint8_t* base = reinterpret_cast<const uint8_t*>(&component);
+    Add(info.NameHash);
+    for (uint32_t i = 0; i < info.FieldCount; ++i) {
+      const reflection::FieldInfo& field = info.Fields[i];
+      if (!(field.Flags & reflection::kFieldFlagTransient)) {
+        AddBytes(base + field.Offset, field.Size);
+      }
+    }
+  }
+
+  inline uint64_t GetHash() const { return hash_; }
+
+ private:
+  static constexpr uint64_t kOffsetBasis_ = 14695981039346656037ull;
+  static constexpr uint64_t kPrime_ = 1099511628211ull;
+
+  uint64_t hash_ = kOffsetBasis_;
+};
+
+}  // namespace lockstep
+}  // namespace engine
+
+#endif  // ENGINE_SRC_CORE_LOCKSTEP_STATEHASHER_H_
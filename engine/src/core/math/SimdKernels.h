@@ -0,0 +1,293 @@
+/**
+ * @file engine/src/core/math/SimdKernels.h
+ * @brief The batch kernels behind SimdMath.h, written once against the wide
+ * types and instantiated for every instruction set.
+ *
+ * Each SimdKernels*.cpp file is compiled with the flags of its instruction
+ * set and builds a KernelTable from these templates. Only SimdMath.cpp should
+ * include this file.
+ */
+#ifndef ENGINE_SRC_CORE_MATH_SIMDKERNELS_H_
+#define ENGINE_SRC_CORE_MATH_SIMDKERNELS_H_
+
+#include <cstddef>
+
+#include "core/math/SimdMath.h"
+#include "core/math/Wide.h"
+
+namespace engine {
+namespace math {
+namespace detail {
+
+/**
+ * @struct KernelTable
+ * @brief The kernels of one instruction set.
+ */
+struct KernelTable {
+  InstructionSet Set;
+  void (*TransformPoints)(
+      const Matrix4&, const Vector3SoA&, const Vector3SoA&, size_t);
+  void (*MultiplyQuaternions)(
+      const QuaternionSoA&, const QuaternionSoA&, const QuaternionSoA&,
+      size_t);
+  void (*InvertMatrices)(const Matrix4*, Matrix4*, size_t);
+  void (*TransformAabbs)(
+      const Matrix4&, const AabbSoA&, const AabbSoA&, size_t);
+};
+
+// Each returns nullptr when the build can't compile for the instruction set.
+const KernelTable* GetBaselineKernels();
+const KernelTable* GetSse42Kernels();
+const KernelTable* GetAvx2Kernels();
+const KernelTable* GetAvx512Kernels();
+
+}  // namespace detail
+
+inline namespace ENGINE_SIMD_NAMESPACE {
+namespace kernels {
+
+// Every kernel processes [begin, end) in steps of the wide type and returns
+// the index of the first element it didn't process.
+
+template<typename Wide>
+size_t TransformPointsRange(
+    const Matrix4& matrix,
+    const Vector3SoA& points,
+    const Vector3SoA& out,
+    size_t begin,
+    size_t end) {
+  Wide m[4][3];
+  for (int column = 0; column < 4; ++column) {
+    for (int row = 0; row < 3; ++row) {
+      m[column][row] = Wide::Broadcast(matrix.Columns[column][row]);
+    }
+  }
+
+  size_t i = begin;
+  for (; i + Wide::kWidth <= end; i += Wide::kWidth) {
+    Wide x = Wide::Load(points.x + i);
+    Wide y = Wide::Load(points.y + i);
+    Wide z = Wide::Load(points.z + i);
+    MulAdd(m[2][0], z, MulAdd(m[1][0], y, MulAdd(m[0][0], x, m[3][0])))
+        .Store(out.x + i);
+    MulAdd(m[2][1], z, MulAdd(m[1][1], y, MulAdd(m[0][1], x, m[3][1])))
+        .Store(out.y + i);
+    MulAdd(m[2][2], z, MulAdd(m[1][2], y, MulAdd(m[0][2], x, m[3][2])))
+        .Store(out.z + i);
+  }
+  return i;
+}
+
+template<typename Wide>
+size_t MultiplyQuaternionsRange(
+    const QuaternionSoA& a,
+    const QuaternionSoA& b,
+    const QuaternionSoA& out,
+    size_t begin,
+    size_t end) {
+  size_t i = begin;
+  for (; i + Wide::kWidth <= end; i += Wide::kWidth) {
+    Wide ax = Wide::Load(a.x + i), ay = Wide::Load(a.y + i);
+    Wide az = Wide::Load(a.z + i), aw = Wide::Load(a.w + i);
+    Wide bx = Wide::Load(b.x + i), by = Wide::Load(b.y + i);
+    Wide bz = Wide::Load(b.z + i), bw = Wide::Load(b.w + i);
+
+    Wide x = NegMulAdd(az, by, MulAdd(ay, bz, MulAdd(ax, bw, aw * bx)));
+    Wide y = MulAdd(az, bx, MulAdd(ay, bw, NegMulAdd(ax, bz, aw * by)));
+    Wide z = MulAdd(az, bw, NegMulAdd(ay, bx, MulAdd(ax, by, aw * bz)));
+    Wide w = NegMulAdd(az, bz, NegMulAdd(ay, by, NegMulAdd(ax, bx, aw * bw)));
+    x.Store(out.x + i);
+    y.Store(out.y + i);
+    z.Store(out.z + i);
+    w.Store(out.w + i);
+  }
+  return i;
+}
+
+/**
+ * Inverts the matrices by expanding the determinant along the 2x2 minors of
+ * their upper and lower halves. Each block of matrices is transposed into
+ * lanes through a small buffer, which costs far less than the inversions.
+ */
+template<typename Wide>
+size_t InvertMatricesRange(
+    const Matrix4* matrices, Matrix4* out, size_t begin, size_t end) {
+  constexpr int kWidth = Wide::kWidth;
+  alignas(64) float lanes[16][kWidth];
+
+  size_t i = begin;
+  for (; i + kWidth <= end; i += kWidth) {
+    for (int lane = 0; lane < kWidth; ++lane) {
+      const float* elements = &matrices[i + lane].Columns[0][0];
+      for (int element = 0; element < 16; ++element) {
+        lanes[element][lane] = elements[element];
+      }
+    }
+
+    Wide a[4][4];
+    for (int element = 0; element < 16; ++element) {
+      a[element / 4][element % 4] = Wide::Load(lanes[element]);
+    }
+
+    Wide s0 = NegMulAdd(a[1][0], a[0][1], a[0][0] * a[1][1]);
+    Wide s1 = NegMulAdd(a[1][0], a[0][2], a[0][0] * a[1][2]);
+    Wide s2 = NegMulAdd(a[1][0], a[0][3], a[0][0] * a[1][3]);
+    Wide s3 = NegMulAdd(a[1][1], a[0][2], a[0][1] * a[1][2]);
+    Wide s4 = NegMulAdd(a[1][1], a[0][3], a[0][1] * a[1][3]);
+    Wide s5 = NegMulAdd(a[1][2], a[0][3], a[0][2] * a[1][3]);
+
+    Wide c5 = NegMulAdd(a[3][2], a[2][3], a[2][2] * a[3][3]);
+    Wide c4 = NegMulAdd(a[3][1], a[2][3], a[2][1] * a[3][3]);
+    Wide c3 = NegMulAdd(a[3][1], a[2][2], a[2][1] * a[3][2]);
+    Wide c2 = NegMulAdd(a[3][0], a[2][3], a[2][0] * a[3][3]);
+    Wide c1 = NegMulAdd(a[3][0], a[2][2], a[2][0] * a[3][2]);
+    Wide c0 = NegMulAdd(a[3][0], a[2][1], a[2][0] * a[3][1]);
+
+    Wide determinant = MulAdd(s5, c0, NegMulAdd(s4, c1, MulAdd(s3, c2,
+        MulAdd(s2, c3, NegMulAdd(s1, c4, s0 * c5)))));
+    Wide inverse = Wide::Broadcast(1.0f) / determinant;
+
+    Wide b[4][4];
+    b[0][0] = MulAdd(a[1][3], c3, NegMulAdd(a[1][2], c4, a[1][1] * c5));
+    b[0][1] = NegMulAdd(a[0][3], c3, MulAdd(a[0][2], c4, -a[0][1] * c5));
+    b[0][2] = MulAdd(a[3][3], s3, NegMulAdd(a[3][2], s4, a[3][1] * s5));
+    b[0][3] = NegMulAdd(a[2][3], s3, MulAdd(a[2][2], s4, -a[2][1] * s5));
+
+    b[1][0] = NegMulAdd(a[1][3], c1, MulAdd(a[1][2], c2, -a[1][0] * c5));
+    b[1][1] = MulAdd(a[0][3], c1, NegMulAdd(a[0][2], c2, a[0][0] * c5));
+    b[1][2] = NegMulAdd(a[3][3], s1, MulAdd(a[3][2], s2, -a[3][0] * s5));
+    b[1][3] = MulAdd(a[2][3], s1, NegMulAdd(a[2][2], s2, a[2][0] * s5));
+
+    b[2][0] = MulAdd(a[1][3], c0, NegMulAdd(a[1][1], c2, a[1][0] * c4));
+    b[2][1] = NegMulAdd(a[0][3], c0, MulAdd(a[0][1], c2, -a[0][0] * c4));
+    b[2][2] = MulAdd(a[3][3], s0, NegMulAdd(a[3][1], s2, a[3][0] * s4));
+    b[2][3] = NegMulAdd(a[2][3], s0, MulAdd(a[2][1], s2, -a[2][0] * s4));
+
+    b[3][0] = NegMulAdd(a[1][2], c0, MulAdd(a[1][1], c1, -a[1][0] * c3));
+    b[3][1] = MulAdd(a[0][2], c0, NegMulAdd(a[0][1], c1, a[0][0] * c3));
+    b[3][2] = NegMulAdd(a[3][2], s0, MulAdd(a[3][1], s1, -a[3][0] * s3));
+    b[3][3] = MulAdd(a[2][2], s0, NegMulAdd(a[2][1], s1, a[2][0] * s3));
+
+    for (int element = 0; element < 16; ++element) {
+      (b[element / 4][element % 4] * inverse).Store(lanes[element]);
+    }
+
+    for (int lane = 0; lane < kWidth; ++lane) {
+      float* elements = &out[i + lane].Columns[0][0];
+      for (int element = 0; element < 16; ++element) {
+        elements[element] = lanes[element][lane];
+      }
+    }
+  }
+  return i;
+}
+
+/**
+ * Transforms the center of each box and projects its extents onto the axes of
+ * the transformed space using the absolute values of the matrix, which gives
+ * the tightest box around the transformed one.
+ */
+template<typename Wide>
+size_t TransformAabbsRange(
+    const Matrix4& matrix,
+    const AabbSoA& boxes,
+    const AabbSoA& out,
+    size_t begin,
+    size_t end) {
+  Wide m[4][3], absolute[3][3];
+  for (int column = 0; column < 4; ++column) {
+    for (int row = 0; row < 3; ++row) {
+      m[column][row] = Wide::Broadcast(matrix.Columns[column][row]);
+      if (column < 3) {
+        absolute[column][row] = Abs(m[column][row]);
+      }
+    }
+  }
+
+  const Wide half = Wide::Broadcast(0.5f);
+  size_t i = begin;
+  for (; i + Wide::kWidth <= end; i += Wide::kWidth) {
+    Wide min_x = Wide::Load(boxes.Min.x + i);
+    Wide min_y = Wide::Load(boxes.Min.y + i);
+    Wide min_z = Wide::Load(boxes.Min.z + i);
+    Wide max_x = Wide::Load(boxes.Max.x + i);
+    Wide max_y = Wide::Load(boxes.Max.y + i);
+    Wide max_z = Wide::Load(boxes.Max.z + i);
+
+    Wide center[3] = {
+        (min_x + max_x) * half, (min_y + max_y) * half,
+        (min_z + max_z) * half };
+    Wide extent[3] = {
+        (max_x - min_x) * half, (max_y - min_y) * half,
+        (max_z - min_z) * half };
+
+    float* min_out[3] = { out.Min.x + i, out.Min.y + i, out.Min.z + i };
+    float* max_out[3] = { out.Max.x + i, out.Max.y + i, out.Max.z + i };
+    for (int row = 0; row < 3; ++row) {
+      Wide c = MulAdd(m[2][row], center[2], MulAdd(m[1][row], center[1],
+          MulAdd(m[0][row], center[0], m[3][row])));
+      Wide e = MulAdd(absolute[2][row], extent[2], MulAdd(
+          absolute[1][row], extent[1], absolute[0][row] * extent[0]));
+      (c - e).Store(min_out[row]);
+      (c + e).Store(max_out[row]);
+    }
+  }
+  return i;
+}
+
+/**
+ * Runs a kernel over the full blocks of the wide type and finishes the tail
+ * one element at a time with the same code.
+ */
+template<typename Wide>
+struct Kernels {
+  static void TransformPoints(
+      const Matrix4& matrix, const Vector3SoA& points, const Vector3SoA& out,
+      size_t count) {
+    size_t done = TransformPointsRange<Wide>(matrix, points, out, 0, count);
+    TransformPointsRange<float1x>(matrix, points, out, done, count);
+  }
+
+  static void MultiplyQuaternions(
+      const QuaternionSoA& a, const QuaternionSoA& b, const QuaternionSoA& out,
+      size_t count) {
+    size_t done = MultiplyQuaternionsRange<Wide>(a, b, out, 0, count);
+    MultiplyQuaternionsRange<float1x>(a, b, out, done, count);
+  }
+
+  static void InvertMatrices(
+      const Matrix4* matrices, Matrix4* out, size_t count) {
+    size_t done = InvertMatricesRange<Wide>(matrices, out, 0, count);
+    InvertMatricesRange<float1x>(matrices, out, done, count);
+  }
+
+  static void TransformAabbs(
+      const Matrix4& matrix, const AabbSoA& boxes, const AabbSoA& out,
+      size_t count) {
+    size_t done = TransformAabbsRange<Wide>(matrix, boxes, out, 0, count);
+    TransformAabbsRange<float1x>(matrix, boxes, out, done, count);
+  }
+
+  // Keyed on the instruction set as well as the wide type, since compilers
+  // that don't define a macro per instruction set (MSVC has none for
+  // SSE4.2) build the baseline and SSE4.2 kernels into the same inline
+  // namespace, where a table keyed on the type alone would be shared.
+  template<InstructionSet kSet>
+  static const detail::KernelTable* GetTable() {
+    static const detail::KernelTable kTable = {
+        kSet,
+        &TransformPoints,
+        &MultiplyQuaternions,
+        &InvertMatrices,
+        &TransformAabbs };
+    return &kTable;
+  }
+};
+
+}  // namespace kernels
+}  // namespace ENGINE_SIMD_NAMESPACE
+
+}  // namespace math
+}  // namespace engine
+
+#endif  // ENGINE_SRC_CORE_MATH_SIMDKERNELS_H_
@@ -0,0 +1,19 @@
+// Compiled with the AVX2 flags set for this file in CMakeLists.txt.
+#include "core/math/SimdKernels.h"
+
+namespace engine {
+namespace math {
+namespace detail {
+
+#if defined(__AVX2__) && defined(ENGINE_SIMD_FMA)
+const KernelTable* GetAvx2Kernels() {
+  return kernels::Kernels<float8x>::GetTable<
+      InstructionSet::kAvx2>();
+}
+#else
+const KernelTable* GetAvx2Kernels() { return nullptr; }
+#endif
+
+}  // namespace detail
+}  // namespace math
+}  // namespace engine
@@ -0,0 +1,19 @@
+// Compiled with the AVX-512 flags set for this file in CMakeLists.txt.
+#include "core/math/SimdKernels.h"
+
+namespace engine {
+namespace math {
+namespace detail {
+
+#if defined(__AVX512F__)
+const KernelTable* GetAvx512Kernels() {
+  return kernels::Kernels<float16x>::GetTable<
+      InstructionSet::kAvx512>();
+}
+#else
+const KernelTable* GetAvx512Kernels() { return nullptr; }
+#endif
+
+}  // namespace detail
+}  // namespace math
+}  // namespace engine
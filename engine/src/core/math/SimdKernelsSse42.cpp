@@ -0,0 +1,19 @@
+// Compiled with the SSE4.2 flags set for this file in CMakeLists.txt.
+#include "core/math/SimdKernels.h"
+
+namespace engine {
+namespace math {
+namespace detail {
+
+#if defined(__SSE4_2__)
+const KernelTable* GetSse42Kernels() {
+  return kernels::Kernels<float4x>::GetTable<
+      InstructionSet::kSse42>();
+}
+#else
+const KernelTable* GetSse42Kernels() { return nullptr; }
+#endif
+
+}  // namespace detail
+}  // namespace math
+}  // namespace engine
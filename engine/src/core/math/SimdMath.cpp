@@ -0,0 +1,236 @@
+#include "core/math/SimdMath.h"
+
+#include <atomic>
+
+#include "core/cpu/Dispatch.h"
+#include "core/math/SimdKernels.h"
+
+namespace engine {
+namespace math {
+
+namespace detail {
+
+// The baseline kernels are compiled with the flags of the rest of the engine.
+const KernelTable* GetBaselineKernels() {
+  return kernels::Kernels<float4x>::GetTable<
+      InstructionSet::kBaseline>();
+}
+
+}  // namespace detail
+
+namespace {
+
+std::atomic<const detail::KernelTable*> kKernels(nullptr);
+
+/**
+ * Get the kernels of the widest instruction set up to the limit that both the
+ * build and the processor support.
+ */
+const detail::KernelTable* SelectKernels(InstructionSet limit) {
+  auto allow = [limit](InstructionSet set, const detail::KernelTable* table) {
+    return set <= limit ? table : nullptr;
+  };
+
+  return cpu::SelectKernel<const detail::KernelTable>({
+      { cpu::kCpuFeatureAvx512F | cpu::kCpuFeatureAvx2 | cpu::kCpuFeatureFma,
+        allow(InstructionSet::kAvx512, detail::GetAvx512Kernels()) },
+      { cpu::kCpuFeatureAvx2 | cpu::kCpuFeatureFma,
+        allow(InstructionSet::kAvx2, detail::GetAvx2Kernels()) },
+      { cpu::kCpuFeatureSse42,
+        allow(InstructionSet::kSse42, detail::GetSse42Kernels()) },
+      { cpu::kCpuFeatureNone, detail::GetBaselineKernels() } });
+}
+
+/**
+ * Selection is idempotent, so threads racing through the first call all store
+ * the same table.
+ */
+inline const detail::KernelTable* GetKernels() {
+  const detail::KernelTable* table = kKernels.load(std::memory_order_acquire);
+  if (!table) {
+    table = SelectKernels(InstructionSet::kAvx512);
+    kKernels.store(table, std::memory_order_release);
+  }
+  return table;
+}
+
+}  // namespace
+
+// ---------------------------------- KERNELS ----------------------------------
+
+void TransformPoints(
+    const Matrix4& matrix,
+    const Vector3SoA& points,
+    const Vector3SoA& out,
+    size_t count) {
+  GetKernels()->TransformPoints(matrix, points, out, count);
+}
+
+void MultiplyQuaternions(
+    const QuaternionSoA& a,
+    const QuaternionSoA& b,
+    const QuaternionSoA& out,
+    size_t count) {
+  GetKernels()->MultiplyQuaternions(a, b, out, count);
+}
+
+void InvertMatrices(const Matrix4* matrices, Matrix4* out, size_t count) {
+  GetKernels()->InvertMatrices(matrices, out, count);
+}
+
+void TransformAabbs(
+    const Matrix4& matrix, const AabbSoA& boxes, const AabbSoA& out,
+    size_t count) {
+  GetKernels()->TransformAabbs(matrix, boxes, out, count);
+}
+
+// --------------------------------- CONVERSION --------------------------------
+
+/**
+ * Conversions are bound by memory bandwidth rather than arithmetic, so SSE
+ * shuffles are as fast as anything wider and there is nothing to dispatch.
+ */
+void SplitVector3(
+    const float* interleaved, size_t count, const Vector3SoA& out) {
+  size_t i = 0;
+#if defined(ENGINE_SIMD_SSE)
+  for (; i + 4 <= count; i += 4) {
+    const float* source = interleaved + i * 3;
+    __m128 a = _mm_loadu_ps(source);      // x0 y0 z0 x1
+    __m128 b = _mm_loadu_ps(source + 4);  // y1 z1 x2 y2
+    __m128 c = _mm_loadu_ps(source + 8);  // z2 x3 y3 z3
+
+    __m128 x = _mm_shuffle_ps(
+        a, _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2)),
+        _MM_SHUFFLE(2, 0, 3, 0));
+    __m128 y = _mm_shuffle_ps(
+        _mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1)),
+        _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3)),
+        _MM_SHUFFLE(2, 0, 2, 0));
+    __m128 z = _mm_shuffle_ps(
+        _mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2)), c,
+        _MM_SHUFFLE(3, 0, 2, 0));
+
+    _mm_storeu_ps(out.x + i, x);
+    _mm_storeu_ps(out.y + i, y);
+    _mm_storeu_ps(out.z + i, z);
+  }
+#endif
+  for (; i < count; ++i) {
+    out.x[i] = interleaved[i * 3];
+    out.y[i] = interleaved[i * 3 + 1];
+    out.z[i] = interleaved[i * 3 + 2];
+  }
+}
+
+void InterleaveVector3(
+    const Vector3SoA& vectors, size_t count, float* interleaved) {
+  size_t i = 0;
+#if defined(ENGINE_SIMD_SSE)
+  for (; i + 4 <= count; i += 4) {
+    __m128 x = _mm_loadu_ps(vectors.x + i);
+    __m128 y = _mm_loadu_ps(vectors.y + i);
+    __m128 z = _mm_loadu_ps(vectors.z + i);
+
+    __m128 a = _mm_shuffle_ps(
+        _mm_shuffle_ps(x, y, _MM_SHUFFLE(0, 0, 0, 0)),
+        _mm_shuffle_ps(z, x, _MM_SHUFFLE(1, 1, 0, 0)),
+        _MM_SHUFFLE(2, 0, 2, 0));
+    __m128 b = _mm_shuffle_ps(
+        _mm_shuffle_ps(y, z, _MM_SHUFFLE(1, 1, 1, 1)),
+        _mm_shuffle_ps(x, y, _MM_SHUFFLE(2, 2, 2, 2)),
+        _MM_SHUFFLE(2, 0, 2, 0));
+    __m128 c = _mm_shuffle_ps(
+        _mm_shuffle_ps(z, x, _MM_SHUFFLE(3, 3, 2, 2)),
+        _mm_shuffle_ps(y, z, _MM_SHUFFLE(3, 3, 3, 3)),
+        _MM_SHUFFLE(2, 0, 2, 0));
+
+    float* destination = interleaved + i * 3;
+    _mm_storeu_ps(destination, a);
+    _mm_storeu_ps(destination + 4, b);
+    _mm_storeu_ps(destination + 8, c);
+  }
+#endif
+  for (; i < count; ++i) {
+    interleaved[i * 3] = vectors.x[i];
+    interleaved[i * 3 + 1] = vectors.y[i];
+    interleaved[i * 3 + 2] = vectors.z[i];
+  }
+}
+
+void SplitVector4(
+    const float* interleaved, size_t count, const Vector4SoA& out) {
+  size_t i = 0;
+#if defined(ENGINE_SIMD_SSE)
+  for (; i + 4 <= count; i += 4) {
+    const float* source = interleaved + i * 4;
+    __m128 x = _mm_loadu_ps(source);
+    __m128 y = _mm_loadu_ps(source + 4);
+    __m128 z = _mm_loadu_ps(source + 8);
+    __m128 w = _mm_loadu_ps(source + 12);
+    _MM_TRANSPOSE4_PS(x, y, z, w);
+    _mm_storeu_ps(out.x + i, x);
+    _mm_storeu_ps(out.y + i, y);
+    _mm_storeu_ps(out.z + i, z);
+    _mm_storeu_ps(out.w + i, w);
+  }
+#endif
+  for (; i < count; ++i) {
+    out.x[i] = interleaved[i * 4];
+    out.y[i] = interleaved[i * 4 + 1];
+    out.z[i] = interleaved[i * 4 + 2];
+    out.w[i] = interleaved[i * 4 + 3];
+  }
+}
+
+void InterleaveVector4(
+    const Vector4SoA& vectors, size_t count, float* interleaved) {
+  size_t i = 0;
+#if defined(ENGINE_SIMD_SSE)
+  for (; i + 4 <= count; i += 4) {
+    __m128 a = _mm_loadu_ps(vectors.x + i);
+    __m128 b = _mm_loadu_ps(vectors.y + i);
+    __m128 c = _mm_loadu_ps(vectors.z + i);
+    __m128 d = _mm_loadu_ps(vectors.w + i);
+    _MM_TRANSPOSE4_PS(a, b, c, d);
+    float* destination = interleaved + i * 4;
+    _mm_storeu_ps(destination, a);
+    _mm_storeu_ps(destination + 4, b);
+    _mm_storeu_ps(destination + 8, c);
+    _mm_storeu_ps(destination + 12, d);
+  }
+#endif
+  for (; i < count; ++i) {
+    interleaved[i * 4] = vectors.x[i];
+    interleaved[i * 4 + 1] = vectors.y[i];
+    interleaved[i * 4 + 2] = vectors.z[i];
+    interleaved[i * 4 + 3] = vectors.w[i];
+  }
+}
+
+// ---------------------------------- DISPATCH ---------------------------------
+
+InstructionSet GetInstructionSet() {
+  return GetKernels()->Set;
+}
+
+void SetInstructionSet(InstructionSet instruction_set) {
+  kKernels.store(SelectKernels(instruction_set), std::memory_order_release);
+}
+
+const char* GetInstructionSetName(InstructionSet instruction_set) {
+  switch (instruction_set) {
+    case InstructionSet::kBaseline:
+      return "Baseline";
+    case InstructionSet::kSse42:
+      return "SSE4.2";
+    case InstructionSet::kAvx2:
+      return "AVX2";
+    case InstructionSet::kAvx512:
+      return "AVX-512";
+  }
+  return "Unknown";
+}
+
+}  // namespace math
+}  // namespace engine
@@ -0,0 +1,167 @@
+/**
+ * @file engine/src/core/math/SimdMath.h
+ * @brief Batch operations on arrays of vectors, quaternions and matrices.
+ *
+ * glm operates on one vector at a time, which leaves most of every SIMD
+ * register unused. The functions in this file operate on whole arrays stored
+ * as structures of arrays, so that each lane of a register holds a different
+ * element and every instruction does useful work in all of its lanes.
+ *
+ * The kernels are compiled once for every supported instruction set and the
+ * widest one the processor supports is selected the first time any of them is
+ * called. Results may differ in the last bit between instruction sets because
+ * only some of them fuse multiplies and adds.
+ */
+#ifndef ENGINE_SRC_CORE_MATH_SIMDMATH_H_
+#define ENGINE_SRC_CORE_MATH_SIMDMATH_H_
+
+#include <cstddef>
+
+#include "core/Core.h"
+
+namespace engine {
+namespace math {
+
+/**
+ * @struct Matrix4
+ * @brief A 4x4 matrix stored as columns.
+ *
+ * The layout matches glm::mat4, so arrays of either can be copied into each
+ * other.
+ */
+struct Matrix4 {
+  float Columns[4][4];
+};
+
+/**
+ * @struct Vector3SoA
+ * @brief The component arrays of an array of 3D vectors.
+ */
+struct Vector3SoA {
+  float* x;
+  float* y;
+  float* z;
+};
+
+/**
+ * @struct Vector4SoA
+ * @brief The component arrays of an array of 4D vectors or quaternions.
+ */
+struct Vector4SoA {
+  float* x;
+  float* y;
+  float* z;
+  float* w;
+};
+
+typedef Vector4SoA QuaternionSoA;
+
+/**
+ * @struct AabbSoA
+ * @brief The corner arrays of an array of axis aligned boxes.
+ */
+struct AabbSoA {
+  Vector3SoA Min;
+  Vector3SoA Max;
+};
+
+/**
+ * @enum InstructionSet
+ * @brief The instruction sets the batch kernels are compiled for, from the
+ * narrowest to the widest. kBaseline is whatever the engine is compiled for.
+ */
+enum class InstructionSet {
+  kBaseline = 0,
+  kSse42,
+  kAvx2,
+  kAvx512
+};
+
+// ---------------------------------- KERNELS ----------------------------------
+
+/**
+ * @fn TransformPoints
+ * @brief Transforms count points by an affine matrix. The input and output
+ * may be the same arrays.
+ */
+ENGINE_API void TransformPoints(
+    const Matrix4& matrix,
+    const Vector3SoA& points,
+    const Vector3SoA& out,
+    size_t count);
+
+/**
+ * @fn MultiplyQuaternions
+ * @brief Computes out[i] = a[i] * b[i], the rotation b followed by a.
+ */
+ENGINE_API void MultiplyQuaternions(
+    const QuaternionSoA& a,
+    const QuaternionSoA& b,
+    const QuaternionSoA& out,
+    size_t count);
+
+/**
+ * @fn InvertMatrices
+ * @brief Inverts count general 4x4 matrices. Singular matrices produce
+ * non-finite elements, as with glm::inverse.
+ *
+ * Matrices are usually stored whole, so this takes them as they are and
+ * transposes them into lanes internally.
+ */
+ENGINE_API void InvertMatrices(
+    const Matrix4* matrices, Matrix4* out, size_t count);
+
+/**
+ * @fn TransformAabbs
+ * @brief Computes the axis aligned bounds of count boxes after an affine
+ * transform.
+ */
+ENGINE_API void TransformAabbs(
+    const Matrix4& matrix, const AabbSoA& boxes, const AabbSoA& out,
+    size_t count);
+
+// --------------------------------- CONVERSION --------------------------------
+
+/**
+ * @fn SplitVector3
+ * @brief Copies count tightly packed xyz triples into component arrays.
+ */
+ENGINE_API void SplitVector3(
+    const float* interleaved, size_t count, const Vector3SoA& out);
+
+ENGINE_API void InterleaveVector3(
+    const Vector3SoA& vectors, size_t count, float* interleaved);
+
+/**
+ * @fn SplitVector4
+ * @brief Copies count tightly packed xyzw quadruples, such as glm::quat or
+ * glm::vec4 arrays, into component arrays.
+ */
+ENGINE_API void SplitVector4(
+    const float* interleaved, size_t count, const Vector4SoA& out);
+
+ENGINE_API void InterleaveVector4(
+    const Vector4SoA& vectors, size_t count, float* interleaved);
+
+// ---------------------------------- DISPATCH ---------------------------------
+
+/**
+ * @fn GetInstructionSet
+ * @brief Get the instruction set of the kernels in use.
+ */
+ENGINE_API InstructionSet GetInstructionSet();
+
+/**
+ * @fn SetInstructionSet
+ * @brief Limits the kernels to an instruction set, for benchmarks and for
+ * comparing results. Falls back to narrower kernels when the processor or the
+ * build doesn't support the requested ones.
+ */
+ENGINE_API void SetInstructionSet(InstructionSet instruction_set);
+
+ENGINE_API const char* GetInstructionSetName(InstructionSet instruction_set);
+
+}  // namespace math
+}  // namespace engine
+
+#endif  // ENGINE_SRC_CORE_MATH_SIMDMATH_H_
@@ -0,0 +1,368 @@
+/**
+ * @file engine/src/core/math/Wide.h
+ * @brief Fixed width SIMD vectors of floats.
+ *
+ * float4x, float8x and float16x hold one float per lane and map onto SSE, AVX
+ * and AVX-512 registers when the translation unit is compiled for them.
+ * Otherwise they are composed of narrower types, so code written against them
+ * compiles everywhere and only gets slower. float1x is a single float with the
+ * same interface, which lets kernels reuse their vector code for the tail of
+ * an array.
+ *
+ * Every type lives in an inline namespace named after the instruction set of
+ * the translation unit. Kernels compiled with different flags therefore never
+ * share an inline function, which would otherwise let the linker pick an AVX
+ * version of a function for code that runs on an SSE machine.
+ */
+#ifndef ENGINE_SRC_CORE_MATH_WIDE_H_
+#define ENGINE_SRC_CORE_MATH_WIDE_H_
+
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#define ENGINE_SIMD_SSE
+#endif
+
+#if defined(__FMA__) || (defined(_MSC_VER) && defined(__AVX2__))
+#define ENGINE_SIMD_FMA
+#endif
+
+/**
+ * @def ENGINE_SIMD_NAMESPACE
+ * @brief The inline namespace of the wide types in this translation unit.
+ */
+#if defined(__AVX512F__)
+  #define ENGINE_SIMD_NAMESPACE avx512
+#elif defined(__AVX2__)
+  #define ENGINE_SIMD_NAMESPACE avx2
+#elif defined(__AVX__)
+  #define ENGINE_SIMD_NAMESPACE avx
+#elif defined(__SSE4_2__)
+  #define ENGINE_SIMD_NAMESPACE sse42
+#elif defined(ENGINE_SIMD_SSE)
+  #define ENGINE_SIMD_NAMESPACE sse2
+#else
+  #define ENGINE_SIMD_NAMESPACE scalar
+#endif
+
+namespace engine {
+namespace math {
+inline namespace ENGINE_SIMD_NAMESPACE {
+
+// ----------------------------------- FLOAT1X ---------------------------------
+
+struct float1x {
+  static constexpr int kWidth = 1;
+  float v;
+
+  static inline float1x Broadcast(float value) { return { value }; }
+  static inline float1x Load(const float* source) { return { *source }; }
+  inline void Store(float* destination) const { *destination = v; }
+
+  inline float1x operator+(float1x other) const { return { v + other.v }; }
+  inline float1x operator-(float1x other) const { return { v - other.v }; }
+  inline float1x operator*(float1x other) const { return { v * other.v }; }
+  inline float1x operator/(float1x other) const { return { v / other.v }; }
+  inline float1x operator-() const { return { -v }; }
+};
+
+inline float1x MulAdd(float1x a, float1x b, float1x c) {
+  return { a.v * b.v + c.v };
+}
+inline float1x NegMulAdd(float1x a, float1x b, float1x c) {
+  return { c.v - a.v * b.v };
+}
+inline float1x Min(float1x a, float1x b) { return { a.v < b.v ? a.v : b.v }; }
+inline float1x Max(float1x a, float1x b) { return { a.v > b.v ? a.v : b.v }; }
+inline float1x Abs(float1x a) { return { std::fabs(a.v) }; }
+inline float1x Sqrt(float1x a) { return { std::sqrt(a.v) }; }
+
+// ----------------------------------- FLOAT4X ---------------------------------
+
+#if defined(ENGINE_SIMD_SSE)
+
+struct float4x {
+  static constexpr int kWidth = 4;
+  __m128 v;
+
+  static inline float4x Broadcast(float value)
+      { return { _mm_set1_ps(value) }; }
+  static inline float4x Load(const float* source)
+      { return { _mm_loadu_ps(source) }; }
+  inline void Store(float* destination) const
+      { _mm_storeu_ps(destination, v); }
+
+  inline float4x operator+(float4x other) const
+      { return { _mm_add_ps(v, other.v) }; }
+  inline float4x operator-(float4x other) const
+      { return { _mm_sub_ps(v, other.v) }; }
+  inline float4x operator*(float4x other) const
+      { return { _mm_mul_ps(v, other.v) }; }
+  inline float4x operator/(float4x other) const
+      { return { _mm_div_ps(v, other.v) }; }
+  inline float4x operator-() const
+      { return { _mm_xor_ps(v, _mm_set1_ps(-0.0f)) }; }
+};
+
+#if defined(ENGINE_SIMD_FMA)
+inline float4x MulAdd(float4x a, float4x b, float4x c) {
+  return { _mm_fmadd_ps(a.v, b.v, c.v) };
+}
+inline float4x NegMulAdd(float4x a, float4x b, float4x c) {
+  return { _mm_fnmadd_ps(a.v, b.v, c.v) };
+}
+#else
+inline float4x MulAdd(float4x a, float4x b, float4x c) { return a * b + c; }
+inline float4x NegMulAdd(float4x a, float4x b, float4x c) { return c - a * b; }
+#endif
+
+inline float4x Min(float4x a, float4x b) { return { _mm_min_ps(a.v, b.v) }; }
+inline float4x Max(float4x a, float4x b) { return { _mm_max_ps(a.v, b.v) }; }
+inline float4x Abs(float4x a) {
+  return { _mm_andnot_ps(_mm_set1_ps(-0.0f), a.v) };
+}
+inline float4x Sqrt(float4x a) { return { _mm_sqrt_ps(a.v) }; }
+
+#else
+
+struct float4x {
+  static constexpr int kWidth = 4;
+  float1x v[4];
+
+  static inline float4x Broadcast(float value) {
+    float1x lane = float1x::Broadcast(value);
+    return { { lane, lane, lane, lane } };
+  }
+  static inline float4x Load(const float* source) {
+    return { {
+        float1x::Load(source), float1x::Load(source + 1),
+        float1x::Load(source + 2), float1x::Load(source + 3) } };
+  }
+  inline void Store(float* destination) const {
+    for (int lane = 0; lane < kWidth; ++lane) {
+      v[lane].Store(destination + lane);
+    }
+  }
+
+  inline float4x operator+(float4x other) const
+      { return Apply(other, [](float1x a, float1x b) { return a + b; }); }
+  inline float4x operator-(float4x other) const
+      { return Apply(other, [](float1x a, float1x b) { return a - b; }); }
+  inline float4x operator*(float4x other) const
+      { return Apply(other, [](float1x a, float1x b) { return a * b; }); }
+  inline float4x operator/(float4x other) const
+      { return Apply(other, [](float1x a, float1x b) { return a / b; }); }
+  inline float4x operator-() const
+      { return { { -v[0], -v[1], -v[2], -v[3] } }; }
+
+  template<typename Function>
+  inline float4x Apply(float4x other, Function function) const {
+    return { {
+        function(v[0], other.v[0]), function(v[1], other.v[1]),
+        function(v[2], other.v[2]), function(v[3], other.v[3]) } };
+  }
+};
+
+inline float4x MulAdd(float4x a, float4x b, float4x c) { return a * b + c; }
+inline float4x NegMulAdd(float4x a, float4x b, float4x c) { return c - a * b; }
+inline float4x Min(float4x a, float4x b) {
+  return a.Apply(b, [](float1x x, float1x y) { return Min(x, y); });
+}
+inline float4x Max(float4x a, float4x b) {
+  return a.Apply(b, [](float1x x, float1x y) { return Max(x, y); });
+}
+inline float4x Abs(float4x a) {
+  return { { Abs(a.v[0]), Abs(a.v[1]), Abs(a.v[2]), Abs(a.v[3]) } };
+}
+inline float4x Sqrt(float4x a) {
+  return { { Sqrt(a.v[0]), Sqrt(a.v[1]), Sqrt(a.v[2]), Sqrt(a.v[3]) } };
+}
+
+#endif
+
+// ----------------------------------- FLOAT8X ---------------------------------
+
+#if defined(__AVX__)
+
+struct float8x {
+  static constexpr int kWidth = 8;
+  __m256 v;
+
+  static inline float8x Broadcast(float value)
+      { return { _mm256_set1_ps(value) }; }
+  static inline float8x Load(const float* source)
+      { return { _mm256_loadu_ps(source) }; }
+  inline void Store(float* destination) const
+      { _mm256_storeu_ps(destination, v); }
+
+  inline float8x operator+(float8x other) const
+      { return { _mm256_add_ps(v, other.v) }; }
+  inline float8x operator-(float8x other) const
+      { return { _mm256_sub_ps(v, other.v) }; }
+  inline float8x operator*(float8x other) const
+      { return { _mm256_mul_ps(v, other.v) }; }
+  inline float8x operator/(float8x other) const
+      { return { _mm256_div_ps(v, other.v) }; }
+  inline float8x operator-() const
+      { return { _mm256_xor_ps(v, _mm256_set1_ps(-0.0f)) }; }
+};
+
+#if defined(ENGINE_SIMD_FMA)
+inline float8x MulAdd(float8x a, float8x b, float8x c) {
+  return { _mm256_fmadd_ps(a.v, b.v, c.v) };
+}
+inline float8x NegMulAdd(float8x a, float8x b, float8x c) {
+  return { _mm256_fnmadd_ps(a.v, b.v, c.v) };
+}
+#else
+inline float8x MulAdd(float8x a, float8x b, float8x c) { return a * b + c; }
+inline float8x NegMulAdd(float8x a, float8x b, float8x c) { return c - a * b; }
+#endif
+
+inline float8x Min(float8x a, float8x b) {
+  return { _mm256_min_ps(a.v, b.v) };
+}
+inline float8x Max(float8x a, float8x b) {
+  return { _mm256_max_ps(a.v, b.v) };
+}
+inline float8x Abs(float8x a) {
+  return { _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a.v) };
+}
+inline float8x Sqrt(float8x a) { return { _mm256_sqrt_ps(a.v) }; }
+
+#else
+
+struct float8x {
+  static constexpr int kWidth = 8;
+  float4x low, high;
+
+  static inline float8x Broadcast(float value) {
+    float4x half = float4x::Broadcast(value);
+    return { half, half };
+  }
+  static inline float8x Load(const float* source)
+      { return { float4x::Load(source), float4x::Load(source + 4) }; }
+  inline void Store(float* destination) const
+      { low.Store(destination); high.Store(destination + 4); }
+
+  inline float8x operator+(float8x other) const
+      { return { low + other.low, high + other.high }; }
+  inline float8x operator-(float8x other) const
+      { return { low - other.low, high - other.high }; }
+  inline float8x operator*(float8x other) const
+      { return { low * other.low, high * other.high }; }
+  inline float8x operator/(float8x other) const
+      { return { low / other.low, high / other.high }; }
+  inline float8x operator-() const { return { -low, -high }; }
+};
+
+inline float8x MulAdd(float8x a, float8x b, float8x c) {
+  return { MulAdd(a.low, b.low, c.low), MulAdd(a.high, b.high, c.high) };
+}
+inline float8x NegMulAdd(float8x a, float8x b, float8x c) {
+  return {
+      NegMulAdd(a.low, b.low, c.low), NegMulAdd(a.high, b.high, c.high) };
+}
+inline float8x Min(float8x a, float8x b) {
+  return { Min(a.low, b.low), Min(a.high, b.high) };
+}
+inline float8x Max(float8x a, float8x b) {
+  return { Max(a.low, b.low), Max(a.high, b.high) };
+}
+inline float8x Abs(float8x a) { return { Abs(a.low), Abs(a.high) }; }
+inline float8x Sqrt(float8x a) { return { Sqrt(a.low), Sqrt(a.high) }; }
+
+#endif
+
+// ---------------------------------- FLOAT16X ---------------------------------
+
+#if defined(__AVX512F__)
+
+struct float16x {
+  static constexpr int kWidth = 16;
+  __m512 v;
+
+  static inline float16x Broadcast(float value)
+      { return { _mm512_set1_ps(value) }; }
+  static inline float16x Load(const float* source)
+      { return { _mm512_loadu_ps(source) }; }
+  inline void Store(float* destination) const
+      { _mm512_storeu_ps(destination, v); }
+
+  inline float16x operator+(float16x other) const
+      { return { _mm512_add_ps(v, other.v) }; }
+  inline float16x operator-(float16x other) const
+      { return { _mm512_sub_ps(v, other.v) }; }
+  inline float16x operator*(float16x other) const
+      { return { _mm512_mul_ps(v, other.v) }; }
+  inline float16x operator/(float16x other) const
+      { return { _mm512_div_ps(v, other.v) }; }
+  inline float16x operator-() const
+      { return { _mm512_sub_ps(_mm512_setzero_ps(), v) }; }
+};
+
+inline float16x MulAdd(float16x a, float16x b, float16x c) {
+  return { _mm512_fmadd_ps(a.v, b.v, c.v) };
+}
+inline float16x NegMulAdd(float16x a, float16x b, float16x c) {
+  return { _mm512_fnmadd_ps(a.v, b.v, c.v) };
+}
+inline float16x Min(float16x a, float16x b) {
+  return { _mm512_min_ps(a.v, b.v) };
+}
+inline float16x Max(float16x a, float16x b) {
+  return { _mm512_max_ps(a.v, b.v) };
+}
+inline float16x Abs(float16x a) { return { _mm512_abs_ps(a.v) }; }
+inline float16x Sqrt(float16x a) { return { _mm512_sqrt_ps(a.v) }; }
+
+#else
+
+struct float16x {
+  static constexpr int kWidth = 16;
+  float8x low, high;
+
+  static inline float16x Broadcast(float value) {
+    float8x half = float8x::Broadcast(value);
+    return { half, half };
+  }
+  static inline float16x Load(const float* source)
+      { return { float8x::Load(source), float8x::Load(source + 8) }; }
+  inline void Store(float* destination) const
+      { low.Store(destination); high.Store(destination + 8); }
+
+  inline float16x operator+(float16x other) const
+      { return { low + other.low, high + other.high }; }
+  inline float16x operator-(float16x other) const
+      { return { low - other.low, high - other.high }; }
+  inline float16x operator*(float16x other) const
+      { return { low * other.low, high * other.high }; }
+  inline float16x operator/(float16x other) const
+      { return { low / other.low, high / other.high }; }
+  inline float16x operator-() const { return { -low, -high }; }
+};
+
+inline float16x MulAdd(float16x a, float16x b, float16x c) {
+  return { MulAdd(a.low, b.low, c.low), MulAdd(a.high, b.high, c.high) };
+}
+inline float16x NegMulAdd(float16x a, float16x b, float16x c) {
+  return {
+      NegMulAdd(a.low, b.low, c.low), NegMulAdd(a.high, b.high, c.high) };
+}
+inline float16x Min(float16x a, float16x b) {
+  return { Min(a.low, b.low), Min(a.high, b.high) };
+}
+inline float16x Max(float16x a, float16x b) {
+  return { Max(a.low, b.low), Max(a.high, b.high) };
+}
+inline float16x Abs(float16x a) { return { Abs(a.low), Abs(a.high) }; }
+inline float16x Sqrt(float16x a) { return { Sqrt(a.low), Sqrt(a.high) }; }
+
+#endif
+
+}  // namespace ENGINE_SIMD_NAMESPACE
+}  // namespace math
+}  // namespace engine
+
+#endif  // ENGINE_SRC_CORE_MATH_WIDE_H_
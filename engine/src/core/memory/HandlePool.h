@@ -0,0 +1,134 @@
+/**
+ * @file engine/src/core/memory/HandlePool.h
+ * @brief Generational handles to objects that are stored by index.
+ *
+ * Systems that keep their objects in arrays hand out handles instead of
+ * indices, pairing the index of a slot with the generation the slot had when
+ * the object was created. Freeing the slot bumps its generation, so handles to
+ * the old object stop matching it. They can be checked, freed a second time or
+ * held on to without ever reaching whatever reuses the slot.
+ *
+ * Generations are 32 bit and skip 0, the generation of the invalid handle,
+ * when they wrap. A handle is therefore only unique until its slot has been
+ * reused 2^32 - 1 times.
+ */
+#ifndef ENGINE_SRC_CORE_MEMORY_HANDLEPOOL_H_
+#define ENGINE_SRC_CORE_MEMORY_HANDLEPOOL_H_
+
+#include <cstdint>
+#include <vector>
+
+namespace engine {
+namespace memory {
+
+/**
+ * @struct Handle
+ * @brief Identifies an object in a HandlePool. The tag only keeps the handles
+ * of different systems from being mixed up.
+ */
+template<typename Tag>
+struct Handle {
+  uint32_t Index = 0;
+  uint32_t Generation = 0;
+
+  inline bool IsValid() const { return Generation != 0; }
+  inline bool operator==(const Handle& other) const {
+    return Index == other.Index && Generation == other.Generation;
+  }
+  inline bool operator!=(const Handle& other) const {
+    return !(*this == other);
+  }
+};
+
+/**
+ * @class HandlePool
+ * @brief Hands out slots and tracks their generations, reusing the most
+ * recently freed slot first.
+ *
+ * The pool only knows which slots are alive. Owners keep the objects in
+ * arrays of their own, indexed by Handle::Index, and grow them whenever a
+ * slot past their end is allocated.
+ */
+template<typename H>
+class HandlePool {
+ public:
+  /**
+   * @fn Allocate
+   * @brief Get a handle to a free slot, adding one if there is none.
+   */
+  H Allocate();
+
+  /**
+   * @fn Free
+   * @brief Frees the slot of a handle.
+   * @return false if the handle was already freed, leaving the slot alone.
+   */
+  bool Free(H handle);
+
+  inline bool IsAlive(H handle) const {
+    return handle.Index < generations_.size()
+        && generations_[handle.Index] == handle.Generation;
+  }
+
+  /**
+   * @fn GetHandle
+   * @brief Get the handle to the object currently in a slot.
+   */
+  inline H GetHandle(uint32_t index) const {
+    H handle;
+    handle.Index = index;
+    handle.Generation = generations_[index];
+    return handle;
+  }
+
+  inline uint32_t GetSlotCount() const {
+    return static_cast<uint32_t>(generations_.size());
+  }
+
+  void Reserve(uint32_t count);
+
+ private:
+  // The generation of a free slot is the one its next object gets, which no
+  // handle has yet.
+  std::vector<uint32_t> generations_;
+  std::vector<uint32_t> free_;
+};
+
+// ------------------------------ TEMPLATE METHODS -----------------------------
+
+template<typename H>
+H HandlePool<H>::Allocate() {
+  uint32_t index;
+  if (!free_.empty()) {
+    index = free_.back();
+    free_.pop_back();
+  } else {
+    index = static_cast<uint32_t>(generations_.size());
+    generations_.push_back(1);
+  }
+  return GetHandle(index);
+}
+
+template<typename H>
+bool HandlePool<H>::Free(H handle) {
+  if (!IsAlive(handle)) {
+    return false;
+  }
+  uint32_t& generation = generations_[handle.Index];
+  if (++generation == 0) {
+    generation = 1;
+  }
+  free_.push_back(handle.Index);
+  return true;
+}
+
+template<typename H>
+void HandlePool<H>::Reserve(uint32_t count) {
+  generations_.reserve(count);
+  free_.reserve(count);
+}
+
+}  // namespace memory
+}  // namespace engine
+
+#endif  // ENGINE_SRC_CORE_MEMORY_HANDLEPOOL_H_
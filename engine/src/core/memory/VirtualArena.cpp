@@ -0,0 +1,325 @@
+#include "core/memory/VirtualArena.h"
+
+#include <algorithm>
+
+#if defined(ENGINE_PLATFORM_WINDOWS)
+  // Keeps windows.h from defining min and max macros, which would break
+  // std::min and std::max.
+  #ifndef NOMINMAX
+    #define NOMINMAX
+  #endif
+  #include <windows.h>
+#else
+  #include <sys/mman.h>
+  #include <sys/syscall.h>
+  #include <unistd.h>
+#endif
+
+#include "core/Assert.h"
+#include "core/Log.h"
+#include "core/cpu/Topology.h"
+#include "core/cvars/ConsoleVariable.h"
+
+namespace engine {
+namespace memory {
+
+namespace {
+
+cvars::ConsoleVariable<bool> kHugePagesVariable(
+    "memory.huge_pages",
+    true,
+    "Back arenas that ask for it with 2 MB pages. Read when an arena is "
+    "created.");
+
+inline size_t RoundUp(size_t value, size_t multiple) {
+  return (value + multiple - 1) / multiple * multiple;
+}
+
+inline uintptr_t AlignUp(uintptr_t value, size_t alignment) {
+  return (value + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+}
+
+}  // namespace
+
+// ---------------------------------- PAGES ------------------------------------
+
+#if defined(ENGINE_PLATFORM_WINDOWS)
+
+size_t GetPageSize() {
+  static const size_t kPageSize = [] {
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return static_cast<size_t>(info.dwPageSize);
+  }();
+  return kPageSize;
+}
+
+void* ReserveAddressSpace(size_t size, size_t alignment) {
+  // Reservations are aligned to 64 KB and can't be partially released, so
+  // larger alignments reserve extra, release it, and reserve again at the
+  // aligned address. Another thread can take the range in between, hence the
+  // retries.
+  for (int attempt = 0; attempt < 8; ++attempt) {
+    void* base = VirtualAlloc(nullptr, size, MEM_RESERVE, PAGE_NOACCESS);
+    if (base == nullptr
+        || reinterpret_cast<uintptr_t>(base) % alignment == 0) {
+      return base;
+    }
+    VirtualFree(base, 0, MEM_RELEASE);
+
+    void* padded = VirtualAlloc(
+        nullptr, size + alignment, MEM_RESERVE, PAGE_NOACCESS);
+    if (padded == nullptr) {
+      return nullptr;
+    }
+    VirtualFree(padded, 0, MEM_RELEASE);
+
+    void* aligned = reinterpret_cast<void*>(
+        AlignUp(reinterpret_cast<uintptr_t>(padded), alignment));
+    base = VirtualAlloc(aligned, size, MEM_RESERVE, PAGE_NOACCESS);
+    if (base != nullptr) {
+      return base;
+    }
+  }
+  return nullptr;
+}
+
+void ReleaseAddressSpace(void* base, size_t /*size*/) {
+  VirtualFree(base, 0, MEM_RELEASE);
+}
+
+bool CommitPages(void* address, size_t size, bool /*huge_pages*/) {
+  // Large pages need the lock pages privilege and have to be committed with
+  // the reservation, so the hint is ignored here.
+  return VirtualAlloc(address, size, MEM_COMMIT, PAGE_READWRITE) != nullptr;
+}
+
+void DecommitPages(void* address, size_t size) {
+  VirtualFree(address, size, MEM_DECOMMIT);
+}
+
+void BindToNumaNode(
+    void* /*address*/, size_t /*size*/, uint32_t /*node*/) {
+  // Topology detection reports a single node here.
+}
+
+#else
+
+size_t GetPageSize() {
+  static const size_t kPageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  return kPageSize;
+}
+
+void* ReserveAddressSpace(size_t size, size_t alignment) {
+  // Reserve extra and unmap the unaligned head and the tail.
+  size_t padding = alignment > GetPageSize() ? alignment : 0;
+  void* mapping = mmap(
+      nullptr, size + padding, PROT_NONE,
+      MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (mapping == MAP_FAILED) {
+    return nullptr;
+  }
+
+  uintptr_t start = reinterpret_cast<uintptr_t>(mapping);
+  uintptr_t aligned = padding ? AlignUp(start, alignment) : start;
+  if (aligned != start) {
+    munmap(mapping, aligned - start);
+  }
+  size_t tail = padding - (aligned - start);
+  if (tail) {
+    munmap(reinterpret_cast<void*>(aligned + size), tail);
+  }
+  return reinterpret_cast<void*>(aligned);
+}
+
+void ReleaseAddressSpace(void* base, size_t size) {
+  munmap(base, size);
+}
+
+bool CommitPages(void* address, size_t size, bool huge_pages) {
+  if (mprotect(address, size, PROT_READ | PROT_WRITE) != 0) {
+    return false;
+  }
+#if defined(MADV_HUGEPAGE)
+  // Transparent huge pages only back 2 MB aligned ranges, which the arena
+  // takes care of. Failing is harmless, e.g. when THP is disabled.
+  if (huge_pages) {
+    madvise(address, size, MADV_HUGEPAGE);
+  }
+#endif
+  return true;
+}
+
+void DecommitPages(void* address, size_t size) {
+  // Dropping the pages first frees the memory, and a later commit gets zero
+  // pages again.
+  madvise(address, size, MADV_DONTNEED);
+  mprotect(address, size, PROT_NONE);
+}
+
+void BindToNumaNode(void* address, size_t size, uint32_t node) {
+#if defined(SYS_mbind)
+  const cpu::CpuTopology& topology = cpu::GetCpuTopology();
+  if (topology.Nodes.size() < 2 || node >= topology.Nodes.size()) {
+    return;
+  }
+
+  // MPOL_PREFERRED from <numaif.h>, which is part of libnuma.
+  constexpr int kPreferredPolicy = 1;
+  constexpr size_t kMaskBits = 8 * sizeof(unsigned long);
+  unsigned long mask[1024 / kMaskBits] = {};
+  uint32_t id = topology.Nodes[node].Id;
+  if (id >= 1024) {
+    return;
+  }
+  mask[id / kMaskBits] = 1ul << (id % kMaskBits);
+  if (syscall(
+          SYS_mbind, address, size, kPreferredPolicy, mask, 1024, 0) != 0) {
+    ENGINE_CORE_WARN("Couldn't bind memory to NUMA node {}.", id);
+  }
+#endif
+}
+
+#endif  // ENGINE_PLATFORM_WINDOWS
+
+// ---------------------------------- ARENAS -----------------------------------
+
+VirtualArena::VirtualArena(const ArenaSettings& settings) {
+  huge_pages_ = settings.HugePages && kHugePagesVariable.Get();
+  size_t granularity = huge_pages_ ? kHugePageSize : GetPageSize();
+  commit_size_ = RoundUp(std::max<size_t>(settings.CommitSize, 1), granularity);
+  reserved_ = RoundUp(std::max<size_t>(settings.ReserveSize, 1), commit_size_);
+  retain_size_ = std::min(
+      RoundUp(settings.RetainSize, commit_size_), reserved_);
+
+  base_ = static_cast<uint8_t*>(ReserveAddressSpace(reserved_, granularity));
+  if (base_ == nullptr) {
+    ENGINE_CORE_ERROR(
+        "Couldn't reserve {} MB of address space for an arena.",
+        reserved_ >> 20);
+    reserved_ = 0;
+    return;
+  }
+
+  // The policy covers the whole reservation, so it applies to pages that are
+  // committed later as well.
+  if (settings.NumaNode >= 0) {
+    BindToNumaNode(
+        base_, reserved_, static_cast<uint32_t>(settings.NumaNode));
+  }
+}
+
+VirtualArena::~VirtualArena() {
+  Release();
+}
+
+VirtualArena::VirtualArena(VirtualArena&& other) noexcept {
+  *this = std::move(other);
+}
+
+VirtualArena& VirtualArena::operator=(VirtualArena&& other) noexcept {
+  if (this != &other) {
+    Release();
+    base_ = std::exchange(other.base_, nullptr);
+    used_ = std::exchange(other.used_, 0);
+    committed_ = std::exchange(other.committed_, 0);
+    reserved_ = std::exchange(other.reserved_, 0);
+    commit_size_ = other.commit_size_;
+    retain_size_ = other.retain_size_;
+    huge_pages_ = other.huge_pages_;
+  }
+  return *this;
+}
+
+void* VirtualArena::Allocate(size_t size, size_t alignment) {
+  ENGINE_CORE_ASSERT(
+      (alignment & (alignment - 1)) == 0, "Alignment must be a power of two.");
+  uintptr_t start = reinterpret_cast<uintptr_t>(base_);
+  size_t offset = AlignUp(start + used_, alignment) - start;
+  if (base_ == nullptr || offset > reserved_ || reserved_ - offset < size) {
+    ENGINE_CORE_ERROR(
+        "Arena of {} MB is out of space for {} bytes.", reserved_ >> 20, size);
+    return nullptr;
+  }
+
+  size_t end = offset + size;
+  if (end > committed_ && !Commit(end)) {
+    return nullptr;
+  }
+  used_ = end;
+  return base_ + offset;
+}
+
+void VirtualArena::Rewind(Marker marker) {
+  ENGINE_CORE_ASSERT(marker <= used_, "Rewinding an arena forwards.");
+  used_ = marker;
+}
+
+void VirtualArena::Reset() {
+  used_ = 0;
+  if (committed_ > retain_size_) {
+    DecommitPages(base_ + retain_size_, committed_ - retain_size_);
+    committed_ = retain_size_;
+  }
+}
+
+bool VirtualArena::Commit(size_t size) {
+  size_t target = std::min(RoundUp(size, commit_size_), reserved_);
+  if (!CommitPages(base_ + committed_, target - committed_, huge_pages_)) {
+    ENGINE_CORE_ERROR(
+        "Couldn't commit {} KB of arena memory.",
+        (target - committed_) >> 10);
+    return false;
+  }
+  committed_ = target;
+  return true;
+}
+
+void VirtualArena::Release() {
+  if (base_ != nullptr) {
+    ReleaseAddressSpace(base_, reserved_);
+    base_ = nullptr;
+  }
+  used_ = committed_ = reserved_ = 0;
+}
+
+// ----------------------------------- POOLS -----------------------------------
+
+BlockPool::BlockPool(
+    size_t block_size, size_t block_alignment, const ArenaSettings& settings)
+    : arena_(settings),
+      block_size_(RoundUp(
+          std::max(block_size, sizeof(FreeBlock)),
+          std::max(block_alignment, alignof(FreeBlock)))),
+      block_alignment_(std::max(block_alignment, alignof(FreeBlock))) {}
+
+void* BlockPool::Acquire() {
+  void* block;
+  if (free_list_ != nullptr) {
+    block = free_list_;
+    free_list_ = free_list_->Next;
+  } else {
+    block = arena_.Allocate(block_size_, block_alignment_);
+    if (block == nullptr) {
+      return nullptr;
+    }
+  }
+  ++live_blocks_;
+  return block;
+}
+
+void BlockPool::Release(void* block) {
+  ENGINE_CORE_ASSERT(
+      arena_.Contains(block), "Releasing a block from another pool.");
+  free_list_ = new (block) FreeBlock{ free_list_ };
+  --live_blocks_;
+}
+
+void BlockPool::Reset() {
+  arena_.Reset();
+  free_list_ = nullptr;
+  live_blocks_ = 0;
+}
+
+}  // namespace memory
+}  // namespace engine
@@ -0,0 +1,302 @@
+/**
+ * @file engine/src/core/memory/VirtualArena.h
+ * @brief Linear allocators backed by reserved ranges of virtual memory.
+ *
+ * An arena reserves its whole capacity of address space up front, which costs
+ * no physical memory, and commits pages as allocations reach them. Memory is
+ * therefore contiguous and never moves, unlike a growing std::vector, and the
+ * heap isn't fragmented by large short lived allocations. Resetting an arena
+ * frees everything at once and hands the pages it no longer needs back to the
+ * operating system.
+ *
+ * Arenas can ask to be backed by 2 MB pages, which lets a single TLB entry
+ * cover what would otherwise take 512, and cuts page faults by the same
+ * factor when the memory is first touched. Big scenes with many ECS chunks or
+ * large assets benefit the most.
+ *
+ * Arenas aren't thread safe. Give every thread its own arena, or allocate up
+ * front and hand out disjoint ranges to jobs.
+ */
+#ifndef ENGINE_SRC_CORE_MEMORY_VIRTUALARENA_H_
+#define ENGINE_SRC_CORE_MEMORY_VIRTUALARENA_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+
+#include "core/Core.h"
+
+namespace engine {
+namespace memory {
+
+/**
+ * @var kHugePageSize
+ * @brief The size of the large pages arenas use when asked to.
+ */
+constexpr size_t kHugePageSize = 2 * 1024 * 1024;
+
+// --------------------------------- PAGES -------------------------------------
+
+/**
+ * @fn GetPageSize
+ * @brief Get the size of a regular page, the granularity of commits.
+ */
+ENGINE_API size_t GetPageSize();
+
+/**
+ * @fn ReserveAddressSpace
+ * @param size The number of bytes to reserve, a multiple of the page size.
+ * @param alignment The alignment of the range, a power of two.
+ * @brief Reserves a range of address space without committing memory to it.
+ * @return The start of the range, or nullptr if it couldn't be reserved.
+ */
+ENGINE_API void* ReserveAddressSpace(size_t size, size_t alignment);
+
+/**
+ * @fn ReleaseAddressSpace
+ * @brief Releases a range returned by ReserveAddressSpace.
+ */
+ENGINE_API void ReleaseAddressSpace(void* base, size_t size);
+
+/**
+ * @fn CommitPages
+ * @param huge_pages Ask the operating system to back the pages with 2 MB
+ * pages. Only a hint, which is ignored where it isn't supported.
+ * @brief Makes a page aligned range of reserved memory readable and writable.
+ * Committed memory reads as zero until it is written.
+ */
+ENGINE_API bool CommitPages(void* address, size_t size, bool huge_pages);
+
+/**
+ * @fn DecommitPages
+ * @brief Returns the physical memory of a page aligned range to the operating
+ * system, keeping the range reserved.
+ */
+ENGINE_API void DecommitPages(void* address, size_t size);
+
+/**
+ * @fn BindToNumaNode
+ * @param node An index into cpu::CpuTopology::Nodes.
+ * @brief Asks for the pages of a range to be placed on a NUMA node when they
+ * are first touched. Pages fall back to other nodes when the node runs out of
+ * memory. Does nothing on machines with a single node.
+ */
+ENGINE_API void BindToNumaNode(void* address, size_t size, uint32_t node);
+
+// --------------------------------- ARENAS ------------------------------------
+
+/**
+ * @struct ArenaSettings
+ * @brief How an arena reserves and commits memory.
+ */
+struct ArenaSettings {
+  // The capacity of the arena. Rounded up to the commit granularity.
+  size_t ReserveSize = 64 * 1024 * 1024;
+
+  // How much is committed at once when allocations run past the committed
+  // memory. Rounded up to the page size, or to kHugePageSize with HugePages.
+  size_t CommitSize = 64 * 1024;
+
+  // How much stays committed when the arena is reset, so that arenas reset
+  // every frame don't fault their pages back in every frame.
+  size_t RetainSize = 0;
+
+  // Back the arena with 2 MB pages, subject to the memory.huge_pages console
+  // variable.
+  bool HugePages = false;
+
+  // The NUMA node to place the pages on, as an index into
+  // cpu::CpuTopology::Nodes, or -1 to place them on the node of the thread
+  // that first touches them.
+  int32_t NumaNode = -1;
+};
+
+/**
+ * @class VirtualArena
+ * @brief A linear allocator over a reserved range of address space.
+ *
+ *   memory::ArenaSettings settings;
+ *   settings.ReserveSize = 1ull << 30;
+ *   settings.HugePages = true;
+ *   memory::VirtualArena arena(settings);
+ *
+ *   float* positions = arena.Allocate<float>(count);
+ *
+ * Allocations stay valid until the arena is reset, rewound past them, or
+ * destroyed. Destructors of objects placed in an arena aren't run.
+ */
+class ENGINE_API VirtualArena {
+ public:
+  /**
+   * @typedef Marker
+   * @brief A position in the arena to rewind to.
+   */
+  typedef size_t Marker;
+
+  /**
+   * @fn VirtualArena
+   * @brief Creates an empty arena that owns no memory.
+   */
+  VirtualArena() = default;
+  explicit VirtualArena(const ArenaSettings& settings);
+  ~VirtualArena();
+
+  VirtualArena(const VirtualArena&) = delete;
+  VirtualArena& operator=(const VirtualArena&) = delete;
+  VirtualArena(VirtualArena&& other) noexcept;
+  VirtualArena& operator=(VirtualArena&& other) noexcept;
+
+  /**
+   * @fn Allocate
+   * @param size The number of bytes to allocate.
+   * @param alignment The alignment of the allocation, a power of two.
+   * @brief Allocates uninitialized memory, committing pages if needed.
+   * @return nullptr and logs an error if the arena is out of address space.
+   */
+  void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+  /**
+   * @fn Allocate
+   * @brief Allocates an uninitialized array of count values of type T.
+   */
+  template<typename T>
+  inline T* Allocate(size_t count) {
+    return static_cast<T*>(Allocate(count * sizeof(T), alignof(T)));
+  }
+
+  /**
+   * @fn New
+   * @brief Constructs a T in the arena. Its destructor is never run.
+   */
+  template<typename T, typename... Args>
+  T* New(Args&&... args) {
+    void* memory = Allocate(sizeof(T), alignof(T));
+    return memory ? new (memory) T(std::forward<Args>(args)...) : nullptr;
+  }
+
+  inline Marker GetMarker() const { return used_; }
+
+  /**
+   * @fn Rewind
+   * @brief Frees every allocation made since marker was taken. Committed
+   * memory stays committed.
+   */
+  void Rewind(Marker marker);
+
+  /**
+   * @fn Reset
+   * @brief Frees every allocation and decommits all memory past the retained
+   * size.
+   */
+  void Reset();
+
+  inline uint8_t* GetBase() const { return base_; }
+  inline size_t GetUsedSize() const { return used_; }
+  inline size_t GetCommittedSize() const { return committed_; }
+  inline size_t GetReservedSize() const { return reserved_; }
+
+  /**
+   * @fn Contains
+   * @brief Returns true if the pointer is inside the reserved range.
+   */
+  inline bool Contains(const void* pointer) const {
+    const uint8_t* address = static_cast<const uint8_t*>(pointer);
+    return address >= base_ && address < base_ + reserved_;
+  }
+
+ private:
+  bool Commit(size_t size);
+  void Release();
+
+  uint8_t* base_ = nullptr;
+  size_t used_ = 0;
+  size_t committed_ = 0;
+  size_t reserved_ = 0;
+  size_t commit_size_ = 0;
+  size_t retain_size_ = 0;
+  bool huge_pages_ = false;
+};
+
+/**
+ * @class ArenaScope
+ * @brief Rewinds an arena to where it was when the scope was entered.
+ *
+ *   {
+ *     memory::ArenaScope scope(&scratch);
+ *     uint32_t* indices = scratch.Allocate<uint32_t>(count);
+ *     ...
+ *   }  // indices is freed here.
+ */
+class ArenaScope {
+ public:
+  explicit ArenaScope(VirtualArena* arena)
+      : arena_(arena), marker_(arena->GetMarker()) {}
+  ~ArenaScope() { arena_->Rewind(marker_); }
+
+  ArenaScope(const ArenaScope&) = delete;
+  ArenaScope& operator=(const ArenaScope&) = delete;
+
+ private:
+  VirtualArena* arena_;
+  VirtualArena::Marker marker_;
+};
+
+/**
+ * @class BlockPool
+ * @brief Fixed size blocks carved out of an arena, such as ECS chunks.
+ *
+ * Released blocks are reused before the arena grows, so a pool never holds
+ * more memory than its peak usage. Like arenas, pools aren't thread safe.
+ */
+class ENGINE_API BlockPool {
+ public:
+  /**
+   * @fn BlockPool
+   * @param block_size The size of every block, at least the size of a pointer.
+   * @param block_alignment The alignment of every block, a power of two.
+   */
+  BlockPool(
+      size_t block_size,
+      size_t block_alignment,
+      const ArenaSettings& settings);
+
+  /**
+   * @fn Acquire
+   * @brief Get a block. Its contents are undefined.
+   * @return nullptr if the arena is out of address space.
+   */
+  void* Acquire();
+
+  /**
+   * @fn Release
+   * @brief Returns a block acquired from this pool for reuse.
+   */
+  void Release(void* block);
+
+  /**
+   * @fn Reset
+   * @brief Releases every block at once and decommits the arena.
+   */
+  void Reset();
+
+  inline size_t GetBlockSize() const { return block_size_; }
+  inline size_t GetLiveBlockCount() const { return live_blocks_; }
+  inline const VirtualArena& GetArena() const { return arena_; }
+
+ private:
+  struct FreeBlock {
+    FreeBlock* Next;
+  };
+
+  VirtualArena arena_;
+  size_t block_size_;
+  size_t block_alignment_;
+  FreeBlock* free_list_ = nullptr;
+  size_t live_blocks_ = 0;
+};
+
+}  // namespace memory
+}  // namespace engine
+
+#endif  // ENGINE_SRC_CORE_MEMORY_VIRTUALARENA_H_
@@ -0,0 +1,146 @@
+#include "core/physics/BroadPhase.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "core/Assert.h"
+
+namespace engine {
+namespace physics {
+
+namespace {
+
+constexpr uint32_t kMaxLeafSize = 4;
+
+}  // namespace
+
+BroadPhase::BroadPhase() {}
+
+BroadPhase::~BroadPhase() {}
+
+uint32_t BroadPhase::CreateProxy(const AABB& bounds, uint32_t user_data) {
+  uint32_t proxy;
+  if (!free_proxies_.empty()) {
+    proxy = free_proxies_.back();
+    free_proxies_.pop_back();
+  } else {
+    proxy = static_cast<uint32_t>(proxies_.size());
+    proxies_.emplace_back();
+  }
+
+  proxies_[proxy] = { bounds, user_data, true };
+  needs_rebuild_ = true;
+  return proxy;
+}
+
+void BroadPhase::DestroyProxy(uint32_t proxy) {
+  ENGINE_CORE_ASSERT(proxies_[proxy].Alive, "Proxy was already destroyed.");
+  proxies_[proxy].Alive = false;
+  free_proxies_.push_back(proxy);
+  needs_rebuild_ = true;
+}
+
+void BroadPhase::MoveProxy(uint32_t proxy, const AABB& bounds) {
+  proxies_[proxy].Bounds = bounds;
+  needs_refit_ = true;
+}
+
+void BroadPhase::Update() {
+  if (needs_rebuild_) {
+    Rebuild();
+  } else if (needs_refit_) {
+    Refit();
+  }
+}
+
+void BroadPhase::Rebuild() {
+  primitives_.clear();
+  centers_.resize(proxies_.size());
+  for (uint32_t proxy = 0; proxy < proxies_.size(); ++proxy) {
+    if (proxies_[proxy].Alive) {
+      primitives_.push_back(proxy);
+      centers_[proxy] = proxies_[proxy].Bounds.GetCenter();
+    }
+  }
+
+  nodes_.clear();
+  if (!primitives_.empty()) {
+    nodes_.reserve(2 * primitives_.size() / kMaxLeafSize + 1);
+    BuildNode(0, static_cast<uint32_t>(primitives_.size()), 0);
+  }
+
+  needs_rebuild_ = false;
+  needs_refit_ = false;
+}
+
+/**
+ * Splits primitives at the median of the axis along which their centers are
+ * spread the furthest. Median splits keep the tree balanced, which bounds its
+ * depth and the traversal stacks used to query it.
+ */
+void BroadPhase::BuildNode(uint32_t begin, uint32_t end, uint32_t depth) {
+  ENGINE_CORE_ASSERT(depth < kMaxDepth, "Broadphase exceeded maximum depth.");
+
+  uint32_t index = static_cast<uint32_t>(nodes_.size());
+  nodes_.emplace_back();
+
+  AABB bounds = proxies_[primitives_[begin]].Bounds;
+  AABB center_bounds = { centers_[primitives_[begin]],
+                         centers_[primitives_[begin]] };
+  for (uint32_t i = begin + 1; i < end; ++i) {
+    const Vector3& center = centers_[primitives_[i]];
+    bounds = AABB::Merge(bounds, proxies_[primitives_[i]].Bounds);
+    center_bounds = AABB::Merge(center_bounds, { center, center });
+  }
+  nodes_[index].Bounds = bounds;
+
+  if (end - begin <= kMaxLeafSize) {
+    nodes_[index].Offset = begin;
+    nodes_[index].Count = end - begin;
+    return;
+  }
+
+  Vector3 extent = center_bounds.GetExtent();
+  int axis = extent.x > extent.y
+      ? (extent.x > extent.z ? 0 : 2)
+      : (extent.y > extent.z ? 1 : 2);
+
+  uint32_t middle = begin + (end - begin) / 2;
+  std::nth_element(
+      primitives_.begin() + begin,
+      primitives_.begin() + middle,
+      primitives_.begin() + end,
+      [this, axis](uint32_t a, uint32_t b) {
+        const float* center_a = &centers_[a].x;
+        const float* center_b = &centers_[b].x;
+        return center_a[axis] < center_b[axis];
+      });
+
+  BuildNode(begin, middle, depth + 1);
+  nodes_[index].Offset = static_cast<uint32_t>(nodes_.size());
+  nodes_[index].Count = 0;
+  BuildNode(middle, end, depth + 1);
+}
+
+// Children are always stored after their parents, so walking the nodes in
+// reverse refits every child before its parent.
+void BroadPhase::Refit() {
+  for (size_t i = nodes_.size(); i-- > 0;) {
+    Node& node = nodes_[i];
+    if (node.Count > 0) {
+      AABB bounds = proxies_[primitives_[node.Offset]].Bounds;
+      for (uint32_t p = node.Offset + 1; p < node.Offset + node.Count; ++p) {
+        bounds = AABB::Merge(bounds, proxies_[primitives_[p]].Bounds);
+      }
+      node.Bounds = bounds;
+    } else {
+      node.Bounds = AABB::Merge(
+          nodes_[i + 1].Bounds, nodes_[node.Offset].Bounds);
+    }
+  }
+
+  needs_refit_ = false;
+}
+
+}  // namespace physics
+}  // namespace engine
@@ -0,0 +1,225 @@
+/**
+ * @file engine/src/core/physics/BroadPhase.h
+ * @brief The broadphase used to cull collision candidates.
+ *
+ * Proxies are stored in a bounding volume hierarchy that is laid out as a flat
+ * array of nodes in depth first order. The hierarchy is rebuilt whenever
+ * proxies are created or destroyed and refitted when they only move, which
+ * keeps traversal cache friendly and safe to run from many threads at once.
+ */
+#ifndef ENGINE_SRC_CORE_PHYSICS_BROADPHASE_H_
+#define ENGINE_SRC_CORE_PHYSICS_BROADPHASE_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "core/Core.h"
+#include "core/physics/Collision.h"
+#include "core/physics/RayPacket.h"
+
+namespace engine {
+namespace physics {
+
+/**
+ * @class BroadPhase
+ * @brief A bounding volume hierarchy over proxy bounds.
+ *
+ * Queries may run concurrently, but only after Update() has been called for
+ * all modifications made since the last query.
+ */
+class ENGINE_API BroadPhase {
+ public:
+  /**
+   * @struct Node
+   * @brief A node of the hierarchy.
+   *
+   * Leaves have a non zero Count and reference Count primitives starting at
+   * Offset. The left child of an internal node always directly follows it,
+   * while Offset holds the index of its right child.
+   */
+  struct Node {
+    AABB Bounds;
+    uint32_t Offset;
+    uint32_t Count;
+  };
+
+  BroadPhase();
+  ~BroadPhase();
+
+  /**
+   * @fn CreateProxy
+   * @brief Inserts bounds into the broadphase and returns the proxy id.
+   */
+  uint32_t CreateProxy(const AABB& bounds, uint32_t user_data);
+
+  /**
+   * @fn DestroyProxy
+   * @brief Removes a proxy from the broadphase.
+   */
+  void DestroyProxy(uint32_t proxy);
+
+  /**
+   * @fn MoveProxy
+   * @brief Updates the bounds of a proxy.
+   */
+  void MoveProxy(uint32_t proxy, const AABB& bounds);
+
+  /**
+   * @fn Update
+   * @brief Rebuilds or refits the hierarchy to reflect all changes.
+   */
+  void Update();
+
+  /**
+   * @fn Rebuild
+   * @brief Forces the hierarchy to be rebuilt from scratch. Useful after many
+   * proxies have moved far from where they were at the last rebuild.
+   */
+  void Rebuild();
+
+  inline bool IsUpToDate() const { return !needs_rebuild_ && !needs_refit_; }
+
+  /**
+   * @fn Query
+   * @param bounds The region to query.
+   * @param callback Invoked with the user data of every proxy overlapping the
+   * bounds. Returning false from the callback stops the query.
+   */
+  template<typename Callback>
+  void Query(const AABB& bounds, Callback callback) const;
+
+  /**
+   * @fn RaycastPacket
+   * @param packet The rays to trace. Callbacks may shorten the max distance of
+   * any lane to skip everything further away than a hit.
+   * @param callback Invoked with the user data of every proxy whose bounds are
+   * hit by at least one ray, and a mask of the lanes that hit them.
+   * @brief Traverses the hierarchy once for all rays of the packet, visiting
+   * children front to back along the first active ray.
+   */
+  template<typename Callback>
+  void RaycastPacket(RayPacket* packet, Callback callback) const;
+
+  inline const std::vector<Node>& GetNodes() const { return nodes_; }
+
+  /**
+   * @fn GetPrimitive
+   * @brief Get the proxy referenced by a leaf primitive slot.
+   */
+  inline uint32_t GetPrimitive(uint32_t slot) const
+      { return primitives_[slot]; }
+
+  inline const AABB& GetBounds(uint32_t proxy) const
+      { return proxies_[proxy].Bounds; }
+  inline uint32_t GetUserData(uint32_t proxy) const
+      { return proxies_[proxy].UserData; }
+
+  /**
+   * @var kMaxDepth
+   * @brief The maximum depth of the hierarchy, which bounds traversal stacks.
+   */
+  static constexpr uint32_t kMaxDepth = 64;
+
+ private:
+  struct Proxy {
+    AABB Bounds;
+    uint32_t UserData;
+    bool Alive;
+  };
+
+  std::vector<Proxy> proxies_;
+  std::vector<uint32_t> free_proxies_;
+  std::vector<uint32_t> primitives_;
+  std::vector<Node> nodes_;
+  std::vector<Vector3> centers_;
+  bool needs_rebuild_ = false;
+  bool needs_refit_ = false;
+
+  void BuildNode(uint32_t begin, uint32_t end, uint32_t depth);
+  void Refit();
+};
+
+template<typename Callback>
+void BroadPhase::Query(const AABB& bounds, Callback callback) const {
+  if (nodes_.empty()) {
+    return;
+  }
+
+  uint32_t stack[kMaxDepth];
+  uint32_t stack_size = 0;
+  stack[stack_size++] = 0;
+
+  while (stack_size > 0) {
+    const Node& node = nodes_[stack[--stack_size]];
+    if (!node.Bounds.Overlaps(bounds)) {
+      continue;
+    }
+
+    if (node.Count > 0) {
+      for (uint32_t i = node.Offset; i < node.Offset + node.Count; ++i) {
+        const Proxy& proxy = proxies_[primitives_[i]];
+        if (proxy.Bounds.Overlaps(bounds) && !callback(proxy.UserData)) {
+          return;
+        }
+      }
+    } else {
+      uint32_t index = static_cast<uint32_t>(&node - nodes_.data());
+      stack[stack_size++] = node.Offset;
+      stack[stack_size++] = index + 1;
+    }
+  }
+}
+
+template<typename Callback>
+void BroadPhase::RaycastPacket(RayPacket* packet, Callback callback) const {
+  if (nodes_.empty() || !packet->ActiveMask) {
+    return;
+  }
+
+  uint32_t lead = 0;
+  while (!(packet->ActiveMask & (1u << lead))) {
+    ++lead;
+  }
+  const Vector3 lead_direction = packet->GetDirection(lead);
+
+  uint32_t stack[kMaxDepth];
+  uint32_t stack_size = 0;
+  stack[stack_size++] = 0;
+
+  while (stack_size > 0) {
+    uint32_t index = stack[--stack_size];
+    const Node& node = nodes_[index];
+    if (!IntersectRayPacket(*packet, node.Bounds)) {
+      continue;
+    }
+
+    if (node.Count > 0) {
+      for (uint32_t i = node.Offset; i < node.Offset + node.Count; ++i) {
+        const Proxy& proxy = proxies_[primitives_[i]];
+        uint32_t mask = IntersectRayPacket(*packet, proxy.Bounds);
+        if (mask) {
+          callback(proxy.UserData, mask);
+        }
+      }
+      continue;
+    }
+
+    // Push the far child first so that the near child is visited first.
+    uint32_t left = index + 1;
+    uint32_t right = node.Offset;
+    Vector3 between = nodes_[right].Bounds.GetCenter()
+        - nodes_[left].Bounds.GetCenter();
+    if (Dot(between, lead_direction) >= 0.0f) {
+      stack[stack_size++] = right;
+      stack[stack_size++] = left;
+    } else {
+      stack[stack_size++] = left;
+      stack[stack_size++] = right;
+    }
+  }
+}
+
+}  // namespace physics
+}  // namespace engine
+
+#endif  // ENGINE_SRC_CORE_PHYSICS_BROADPHASE_H_
@@ -0,0 +1,250 @@
+#include "core/physics/CharacterController.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "core/jobs/JobSystem.h"
+
+namespace engine {
+namespace physics {
+
+namespace {
+
+constexpr float kPi = 3.14159265358979f;
+constexpr float kMinimumMove = 1e-5f;
+constexpr uint32_t kControllersPerJob = 16;
+
+inline float HorizontalLengthSquared(const Vector3& vector) {
+  return vector.x * vector.x + vector.z * vector.z;
+}
+
+}  // namespace
+
+CharacterController::CharacterController(
+    const CharacterSettings& settings, const Vector3& position)
+    : settings_(settings),
+      shape_(Shape::CreateCapsule(
+          settings.Radius,
+          std::max(settings.Height * 0.5f - settings.Radius, 0.0f))),
+      ground_shape_(Shape::CreateCapsule(
+          std::max(
+              settings.Radius - settings.SkinWidth, 0.5f * settings.Radius),
+          std::max(settings.Height * 0.5f - settings.Radius, 0.0f))),
+      position_(position),
+      min_ground_normal_y_(
+          std::cos(settings.MaxSlopeDegrees * kPi / 180.0f)) {}
+
+/**
+ * Horizontal and vertical motion are resolved separately so that gravity
+ * pressing the character into the ground doesn't eat into its horizontal
+ * speed, and so that steps are only attempted for horizontal motion.
+ */
+uint32_t CharacterController::Move(
+    const CollisionWorld& world, const Vector3& displacement) {
+  const bool was_grounded = grounded_;
+  uint32_t flags = kCharacterCollisionNone;
+  Vector3 position = position_;
+
+  Vector3 correction;
+  if (world.ComputePenetration(
+          shape_, position, settings_.CollisionMask, &correction)) {
+    position += correction;
+  }
+
+  Vector3 horizontal = { displacement.x, 0.0f, displacement.z };
+  if (HorizontalLengthSquared(horizontal) > kMinimumMove * kMinimumMove) {
+    uint32_t slide_flags = kCharacterCollisionNone;
+    Vector3 slid = SlideMove(world, position, horizontal, true, &slide_flags);
+
+    if ((slide_flags & kCharacterCollisionSides)
+        && was_grounded
+        && settings_.StepHeight > 0.0f) {
+      Vector3 stepped = position;
+      uint32_t step_flags = kCharacterCollisionNone;
+      if (StepMove(world, horizontal, &stepped, &step_flags)
+          && HorizontalLengthSquared(stepped - position)
+              > HorizontalLengthSquared(slid - position)) {
+        slid = stepped;
+        slide_flags = step_flags;
+      }
+    }
+
+    position = slid;
+    flags |= slide_flags;
+  }
+
+  Vector3 vertical = { 0.0f, displacement.y, 0.0f };
+  if (std::fabs(vertical.y) > kMinimumMove) {
+    position = SlideMove(world, position, vertical, false, &flags);
+  }
+
+  // Keep grounded characters attached to the ground when walking down slopes
+  // and stairs instead of launching them off of every edge.
+  grounded_ = false;
+  if (displacement.y <= 0.0f) {
+    float probe = (was_grounded ? settings_.StepHeight : 0.0f)
+        + 2.0f * settings_.SkinWidth;
+    SweepHit hit;
+    if (CastDown(world, position, probe, &hit)
+        || IsStepEdge(world, hit, horizontal)) {
+      position = hit.Position;
+      grounded_ = true;
+      ground_normal_ = hit.Normal;
+      flags |= kCharacterCollisionBelow;
+    }
+  }
+
+  position_ = position;
+  collision_flags_ = flags;
+  return flags;
+}
+
+void CharacterController::MoveAll(
+    const CollisionWorld& world,
+    CharacterController* const* controllers,
+    const Vector3* displacements,
+    uint32_t count) {
+  jobs::JobSystem::ParallelFor(
+      count, kControllersPerJob, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; ++i) {
+          controllers[i]->Move(world, displacements[i]);
+        }
+      });
+}
+
+/**
+ * Every hit stops the character just short of the surface and projects the
+ * remaining motion onto the surface. When climbing is prevented, surfaces that
+ * are too steep to walk on are treated as vertical walls so that sliding along
+ * them can't push the character upwards.
+ */
+Vector3 CharacterController::SlideMove(
+    const CollisionWorld& world,
+    const Vector3& start,
+    const Vector3& displacement,
+    bool prevent_climbing,
+    uint32_t* flags) {
+  Vector3 position = start;
+  Vector3 remaining = displacement;
+
+  for (uint32_t i = 0; i < settings_.MaxSlideIterations; ++i) {
+    float distance = Length(remaining);
+    if (distance < kMinimumMove) {
+      break;
+    }
+
+    SweepHit hit;
+    if (!world.Sweep(
+            shape_, position, remaining, settings_.CollisionMask, &hit)) {
+      position += remaining;
+      break;
+    }
+
+    float travel = std::max(distance * hit.Time - settings_.SkinWidth, 0.0f);
+    position += remaining * (travel / distance);
+
+    Vector3 normal = hit.Normal;
+    if (IsWalkable(normal)) {
+      *flags |= kCharacterCollisionBelow;
+      ground_normal_ = normal;
+    } else if (-normal.y >= min_ground_normal_y_) {
+      *flags |= kCharacterCollisionAbove;
+    } else {
+      *flags |= kCharacterCollisionSides;
+      if (prevent_climbing) {
+        Vector3 flattened = Normalize({ normal.x, 0.0f, normal.z });
+        if (Dot(flattened, flattened) > 0.0f) {
+          normal = flattened;
+        }
+      }
+    }
+
+    Vector3 rest = remaining * (1.0f - travel / distance);
+    remaining = rest - normal * Dot(rest, normal);
+  }
+
+  return position;
+}
+
+bool CharacterController::StepMove(
+    const CollisionWorld& world,
+    const Vector3& horizontal,
+    Vector3* position,
+    uint32_t* flags) {
+  const float skin = settings_.SkinWidth;
+  const Vector3 up = { 0.0f, settings_.StepHeight, 0.0f };
+
+  SweepHit hit;
+  Vector3 raised = *position + up;
+  if (world.Sweep(shape_, *position, up, settings_.CollisionMask, &hit)) {
+    float travel = std::max(settings_.StepHeight * hit.Time - skin, 0.0f);
+    raised = *position + Vector3{ 0.0f, travel, 0.0f };
+  }
+
+  uint32_t step_flags = kCharacterCollisionNone;
+  Vector3 moved = SlideMove(world, raised, horizontal, true, &step_flags);
+
+  float drop = raised.y - position->y + 2.0f * skin;
+  if (!CastDown(world, moved, drop, &hit)
+      && !IsStepEdge(world, hit, horizontal)) {
+    return false;
+  }
+
+  *position = hit.Position;
+  *flags = step_flags | kCharacterCollisionBelow;
+  return true;
+}
+
+/**
+ * Landing on the rim of a step reports the normal of the rim rather than of
+ * the surface behind it. Probe just past the rim with a tiny sphere to find
+ * out whether that surface is walkable.
+ */
+bool CharacterController::IsStepEdge(
+    const CollisionWorld& world,
+    const SweepHit& hit,
+    const Vector3& horizontal) const {
+  if (!hit.HasHit()
+      || hit.Normal.y <= 0.0f
+      || HorizontalLengthSquared(horizontal) == 0.0f) {
+    return false;
+  }
+
+  const float skin = settings_.SkinWidth;
+  Vector3 direction = Normalize(horizontal);
+  Vector3 start = hit.Point + direction * (4.0f * skin);
+  start.y += 2.0f * skin;
+
+  SweepHit rim;
+  return world.Sweep(
+          Shape::CreateSphere(skin),
+          start,
+          { 0.0f, -4.0f * skin, 0.0f },
+          settings_.CollisionMask,
+          &rim)
+      && IsWalkable(rim.Normal);
+}
+
+bool CharacterController::CastDown(
+    const CollisionWorld& world,
+    const Vector3& position,
+    float distance,
+    SweepHit* hit) const {
+  const float skin = settings_.SkinWidth;
+  if (!world.Sweep(
+          ground_shape_,
+          position,
+          { 0.0f, -(distance + skin), 0.0f },
+          settings_.CollisionMask,
+          hit)) {
+    return false;
+  }
+
+  // The bottom of the thinner capsule sits a skin width above the bottom of
+  // the character, so the character itself rests two skin widths higher.
+  hit->Position.y = std::min(hit->Position.y + 2.0f * skin, position.y);
+  return IsWalkable(hit->Normal);
+}
+
+}  // namespace physics
+}  // namespace engine
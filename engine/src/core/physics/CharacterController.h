@@ -0,0 +1,161 @@
+/**
+ * @file engine/src/core/physics/CharacterController.h
+ * @brief A kinematic capsule character controller.
+ *
+ * The controller is moved with explicit displacements and resolves them with
+ * swept capsule queries, sliding along walls, stepping up small ledges and
+ * sticking to the ground when walking down slopes and stairs. The up axis is
+ * positive y.
+ */
+#ifndef ENGINE_SRC_CORE_PHYSICS_CHARACTERCONTROLLER_H_
+#define ENGINE_SRC_CORE_PHYSICS_CHARACTERCONTROLLER_H_
+
+#include <cstdint>
+
+#include "core/Core.h"
+#include "core/physics/Collision.h"
+#include "core/physics/CollisionWorld.h"
+#include "core/physics/PhysicsTypes.h"
+
+namespace engine {
+namespace physics {
+
+/**
+ * @struct CharacterSettings
+ * @brief The dimensions and movement limits of a character.
+ *
+ * Height is the total height of the capsule including both hemispheres.
+ */
+struct CharacterSettings {
+  float Radius = 0.4f;
+  float Height = 1.8f;
+  float MaxSlopeDegrees = 50.0f;
+  float StepHeight = 0.35f;
+  float SkinWidth = 0.02f;
+  uint32_t MaxSlideIterations = 4;
+  uint32_t CollisionMask = kAllCollisionLayers;
+};
+
+/**
+ * @enum CharacterCollisionFlags
+ * @brief Describes which sides of the character collided during a move.
+ */
+enum CharacterCollisionFlags {
+  kCharacterCollisionNone = 0,
+  kCharacterCollisionSides = BIT(0),
+  kCharacterCollisionAbove = BIT(1),
+  kCharacterCollisionBelow = BIT(2),
+};
+
+/**
+ * @class CharacterController
+ * @brief Moves a capsule through a CollisionWorld.
+ *
+ * Controllers only collide against colliders in the world and not against
+ * each other, which allows many of them to be moved in parallel with MoveAll.
+ */
+class ENGINE_API CharacterController {
+ public:
+  explicit CharacterController(
+      const CharacterSettings& settings = CharacterSettings(),
+      const Vector3& position = { 0.0f, 0.0f, 0.0f });
+
+  /**
+   * @fn Move
+   * @param world The world to collide against.
+   * @param displacement The desired motion for this frame, including gravity.
+   * @brief Moves the character as far as possible along the displacement.
+   * Returns a combination of CharacterCollisionFlags.
+   */
+  uint32_t Move(const CollisionWorld& world, const Vector3& displacement);
+
+  /**
+   * @fn MoveAll
+   * @brief Moves many controllers in parallel on the job system.
+   */
+  static void MoveAll(
+      const CollisionWorld& world,
+      CharacterController* const* controllers,
+      const Vector3* displacements,
+      uint32_t count);
+
+  /**
+   * @fn GetPosition
+   * @brief Get the center of the capsule.
+   */
+  inline const Vector3& GetPosition() const { return position_; }
+
+  /**
+   * @fn SetPosition
+   * @brief Teleports the character without any collision checks.
+   */
+  inline void SetPosition(const Vector3& position) { position_ = position; }
+
+  inline bool IsGrounded() const { return grounded_; }
+  inline const Vector3& GetGroundNormal() const { return ground_normal_; }
+  inline uint32_t GetCollisionFlags() const { return collision_flags_; }
+  inline const CharacterSettings& GetSettings() const { return settings_; }
+
+ private:
+  CharacterSettings settings_;
+  Shape shape_;
+  Shape ground_shape_;
+  Vector3 position_;
+  Vector3 ground_normal_ = { 0.0f, 1.0f, 0.0f };
+  float min_ground_normal_y_;
+  bool grounded_ = false;
+  uint32_t collision_flags_ = kCharacterCollisionNone;
+
+  inline bool IsWalkable(const Vector3& normal) const
+      { return normal.y >= min_ground_normal_y_; }
+
+  /**
+   * @fn SlideMove
+   * @brief Moves from position along displacement, sliding along every
+   * surface that is hit. Returns the final position.
+   */
+  Vector3 SlideMove(
+      const CollisionWorld& world,
+      const Vector3& position,
+      const Vector3& displacement,
+      bool prevent_climbing,
+      uint32_t* flags);
+
+  /**
+   * @fn StepMove
+   * @brief Attempts to move over a ledge no higher than the step height by
+   * moving up, forward and back down again. Returns false if the character
+   * didn't land on walkable ground.
+   */
+  bool StepMove(
+      const CollisionWorld& world,
+      const Vector3& horizontal,
+      Vector3* position,
+      uint32_t* flags);
+
+  /**
+   * @fn CastDown
+   * @brief Sweeps the character down by distance to find walkable ground. If
+   * anything is hit, the hit position is where the character rests on it.
+   */
+  bool CastDown(
+      const CollisionWorld& world,
+      const Vector3& position,
+      float distance,
+      SweepHit* hit) const;
+
+  /**
+   * @fn IsStepEdge
+   * @brief Checks whether a ground hit is the rim of a step with a walkable
+   * surface behind it in the direction of motion.
+   */
+  bool IsStepEdge(
+      const CollisionWorld& world,
+      const SweepHit& hit,
+      const Vector3& horizontal) const;
+};
+
+}  // namespace physics
+}  // namespace engine
+
+#endif  // ENGINE_SRC_CORE_PHYSICS_CHARACTERCONTROLLER_H_
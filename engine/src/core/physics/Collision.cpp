@@ -0,0 +1,447 @@
+#include "core/physics/Collision.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "core/Assert.h"
+
+namespace engine {
+namespace physics {
+
+namespace {
+
+constexpr float kEpsilon = 1e-6f;
+
+// Shapes closer than this are considered to be touching.
+constexpr float kContactTolerance = 1e-3f;
+constexpr uint32_t kMaxAdvancementIterations = 32;
+constexpr uint32_t kSegmentSearchIterations = 32;
+
+inline float Clamp01(float value) {
+  return std::min(std::max(value, 0.0f), 1.0f);
+}
+
+inline Vector3 ClampToBox(
+    const Vector3& point, const Vector3& min, const Vector3& max) {
+  return {
+      std::min(std::max(point.x, min.x), max.x),
+      std::min(std::max(point.y, min.y), max.y),
+      std::min(std::max(point.z, min.z), max.z) };
+}
+
+// Closest points between segments p1q1 and p2q2. From Real-Time Collision
+// Detection, section 5.1.9.
+void ClosestPointsOnSegments(
+    const Vector3& p1,
+    const Vector3& q1,
+    const Vector3& p2,
+    const Vector3& q2,
+    Vector3* c1,
+    Vector3* c2) {
+  Vector3 d1 = q1 - p1;
+  Vector3 d2 = q2 - p2;
+  Vector3 r = p1 - p2;
+  float a = Dot(d1, d1);
+  float e = Dot(d2, d2);
+  float f = Dot(d2, r);
+  float s, t;
+
+  if (a <= kEpsilon && e <= kEpsilon) {
+    s = t = 0.0f;
+  } else if (a <= kEpsilon) {
+    s = 0.0f;
+    t = Clamp01(f / e);
+  } else {
+    float c = Dot(d1, r);
+    if (e <= kEpsilon) {
+      t = 0.0f;
+      s = Clamp01(-c / a);
+    } else {
+      float b = Dot(d1, d2);
+      float denominator = a * e - b * b;
+      s = denominator != 0.0f ? Clamp01((b * f - c * e) / denominator) : 0.0f;
+      t = (b * s + f) / e;
+      if (t < 0.0f) {
+        t = 0.0f;
+        s = Clamp01(-c / a);
+      } else if (t > 1.0f) {
+        t = 1.0f;
+        s = Clamp01((b - c) / a);
+      }
+    }
+  }
+
+  *c1 = p1 + d1 * s;
+  *c2 = p2 + d2 * t;
+}
+
+// The distance from a segment to a box is convex along the segment, so the
+// closest point on the segment is found with a ternary search.
+Vector3 ClosestPointOnSegmentToBox(
+    const Vector3& start,
+    const Vector3& end,
+    const Vector3& min,
+    const Vector3& max) {
+  Vector3 direction = end - start;
+  if (Dot(direction, direction) <= kEpsilon) {
+    return start;
+  }
+
+  auto distance_squared = [&](float t) {
+    Vector3 point = start + direction * t;
+    Vector3 offset = point - ClampToBox(point, min, max);
+    return Dot(offset, offset);
+  };
+
+  float low = 0.0f, high = 1.0f;
+  for (uint32_t i = 0; i < kSegmentSearchIterations; ++i) {
+    float third = (high - low) / 3.0f;
+    if (distance_squared(low + third) < distance_squared(high - third)) {
+      high = high - third;
+    } else {
+      low = low + third;
+    }
+  }
+
+  return start + direction * ((low + high) * 0.5f);
+}
+
+ClosestPoints RoundedVersusRounded(
+    const Shape& a,
+    const Vector3& position_a,
+    const Shape& b,
+    const Vector3& position_b) {
+  Vector3 core_a, core_b;
+  ClosestPointsOnSegments(
+      position_a - a.Axis,
+      position_a + a.Axis,
+      position_b - b.Axis,
+      position_b + b.Axis,
+      &core_a,
+      &core_b);
+
+  ClosestPoints result;
+  Vector3 offset = core_a - core_b;
+  float core_distance = Length(offset);
+  result.Valid = core_distance > kEpsilon;
+  result.Normal = result.Valid
+      ? offset * (1.0f / core_distance) : Vector3{ 0.0f, 1.0f, 0.0f };
+  result.Distance = core_distance - a.Radius - b.Radius;
+  result.PointOnA = core_a - result.Normal * a.Radius;
+  result.PointOnB = core_b + result.Normal * b.Radius;
+  return result;
+}
+
+ClosestPoints RoundedVersusBox(
+    const Shape& a,
+    const Vector3& position_a,
+    const Shape& b,
+    const Vector3& position_b) {
+  Vector3 min = position_b - b.HalfExtents;
+  Vector3 max = position_b + b.HalfExtents;
+  Vector3 core_a = ClosestPointOnSegmentToBox(
+      position_a - a.Axis, position_a + a.Axis, min, max);
+  Vector3 core_b = ClampToBox(core_a, min, max);
+
+  ClosestPoints result;
+  Vector3 offset = core_a - core_b;
+  float core_distance = Length(offset);
+
+  if (core_distance > kEpsilon) {
+    result.Valid = true;
+    result.Normal = offset * (1.0f / core_distance);
+    result.Distance = core_distance - a.Radius;
+  } else {
+    // The core is inside of the box, so push it out through the closest face.
+    float faces[6] = {
+        core_a.x - min.x, max.x - core_a.x,
+        core_a.y - min.y, max.y - core_a.y,
+        core_a.z - min.z, max.z - core_a.z };
+    uint32_t closest = static_cast<uint32_t>(
+        std::min_element(faces, faces + 6) - faces);
+
+    Vector3 normal = { 0.0f, 0.0f, 0.0f };
+    float sign = (closest & 1) ? 1.0f : -1.0f;
+    if (closest < 2) {
+      normal.x = sign;
+    } else if (closest < 4) {
+      normal.y = sign;
+    } else {
+      normal.z = sign;
+    }
+
+    result.Valid = true;
+    result.Normal = normal;
+    result.Distance = -faces[closest] - a.Radius;
+    core_b = core_a + normal * faces[closest];
+  }
+
+  result.PointOnA = core_a - result.Normal * a.Radius;
+  result.PointOnB = core_b;
+  return result;
+}
+
+
+// Rays only enter the cap spheres from the outside, so only the first root of
+// the quadratic is considered.
+bool RayVersusSphere(
+    const Vector3& origin,
+    const Vector3& direction,
+    const Vector3& center,
+    float radius,
+    float* distance,
+    Vector3* normal) {
+  Vector3 offset = origin - center;
+  float b = Dot(direction, offset);
+  float c = Dot(offset, offset) - radius * radius;
+  float discriminant = b * b - c;
+  if (discriminant < 0.0f) {
+    return false;
+  }
+
+  float t = -b - std::sqrt(discriminant);
+  if (t < 0.0f || t > *distance) {
+    return false;
+  }
+
+  *distance = t;
+  *normal = (offset + direction * t) * (1.0f / radius);
+  return true;
+}
+
+bool RayVersusRounded(
+    const Vector3& origin,
+    const Vector3& direction,
+    float max_distance,
+    const Shape& shape,
+    const Vector3& position,
+    RayIntersection* result) {
+  Vector3 a = position - shape.Axis;
+  Vector3 b = position + shape.Axis;
+  Vector3 ba = b - a;
+  Vector3 oa = origin - a;
+  float radius = shape.Radius;
+  float baba = Dot(ba, ba);
+
+  float along = baba > kEpsilon ? Clamp01(Dot(oa, ba) / baba) : 0.0f;
+  Vector3 inside = oa - ba * along;
+  if (Dot(inside, inside) <= radius * radius) {
+    result->Distance = 0.0f;
+    result->Normal = direction * -1.0f;
+    return true;
+  }
+
+  float distance = max_distance;
+  Vector3 normal;
+  bool hit = false;
+
+  // The cylindrical body, solved in the plane perpendicular to the segment.
+  float bard = Dot(ba, direction);
+  float baoa = Dot(ba, oa);
+  float qa = baba - bard * bard;
+  if (baba > kEpsilon && qa > kEpsilon) {
+    float qb = baba * Dot(direction, oa) - baoa * bard;
+    float qc = baba * Dot(oa, oa) - baoa * baoa - radius * radius * baba;
+    float discriminant = qb * qb - qa * qc;
+    if (discriminant >= 0.0f) {
+      float t = (-qb - std::sqrt(discriminant)) / qa;
+      float y = baoa + t * bard;
+      if (t >= 0.0f && t <= distance && y > 0.0f && y < baba) {
+        distance = t;
+        normal = (oa + direction * t - ba * (y / baba)) * (1.0f / radius);
+        hit = true;
+      }
+    }
+  }
+
+  hit |= RayVersusSphere(origin, direction, a, radius, &distance, &normal);
+  if (baba > kEpsilon) {
+    hit |= RayVersusSphere(origin, direction, b, radius, &distance, &normal);
+  }
+
+  if (hit) {
+    result->Distance = distance;
+    result->Normal = normal;
+  }
+  return hit;
+}
+
+bool RayVersusBox(
+    const Vector3& origin,
+    const Vector3& direction,
+    float max_distance,
+    const Shape& shape,
+    const Vector3& position,
+    RayIntersection* result) {
+  Vector3 lower = position - shape.HalfExtents;
+  Vector3 upper = position + shape.HalfExtents;
+  const float* min = &lower.x;
+  const float* max = &upper.x;
+  const float* start = &origin.x;
+  const float* step = &direction.x;
+
+  float enter = 0.0f;
+  float exit = max_distance;
+  int enter_axis = -1;
+  float enter_sign = 0.0f;
+
+  for (int axis = 0; axis < 3; ++axis) {
+    if (std::fabs(step[axis]) < kEpsilon) {
+      if (start[axis] < min[axis] || start[axis] > max[axis]) {
+        return false;
+      }
+      continue;
+    }
+
+    float inverse = 1.0f / step[axis];
+    float t1 = (min[axis] - start[axis]) * inverse;
+    float t2 = (max[axis] - start[axis]) * inverse;
+    float sign = -1.0f;
+    if (t1 > t2) {
+      std::swap(t1, t2);
+      sign = 1.0f;
+    }
+
+    if (t1 > enter) {
+      enter = t1;
+      enter_axis = axis;
+      enter_sign = sign;
+    }
+    exit = std::min(exit, t2);
+    if (enter > exit) {
+      return false;
+    }
+  }
+
+  result->Distance = enter;
+  if (enter_axis < 0) {
+    result->Normal = direction * -1.0f;
+  } else {
+    result->Normal = { 0.0f, 0.0f, 0.0f };
+    (&result->Normal.x)[enter_axis] = enter_sign;
+  }
+  return true;
+}
+
+}  // namespace
+
+// ------------------------------------ SHAPES ---------------------------------
+
+AABB Shape::GetBounds(const Vector3& position) const {
+  if (Type == ShapeType::Box) {
+    return { position - HalfExtents, position + HalfExtents };
+  }
+
+  Vector3 extent = {
+      std::fabs(Axis.x) + Radius,
+      std::fabs(Axis.y) + Radius,
+      std::fabs(Axis.z) + Radius };
+  return { position - extent, position + extent };
+}
+
+Shape Shape::CreateSphere(float radius) {
+  Shape shape;
+  shape.Type = ShapeType::Sphere;
+  shape.Radius = radius;
+  return shape;
+}
+
+Shape Shape::CreateCapsule(
+    float radius, float half_height, const Vector3& axis) {
+  Shape shape;
+  shape.Type = ShapeType::Capsule;
+  shape.Axis = Normalize(axis) * half_height;
+  shape.Radius = radius;
+  return shape;
+}
+
+Shape Shape::CreateBox(const Vector3& half_extents) {
+  Shape shape;
+  shape.Type = ShapeType::Box;
+  shape.HalfExtents = half_extents;
+  return shape;
+}
+
+// --------------------------------- NARROW PHASE ------------------------------
+
+ClosestPoints ComputeClosestPoints(
+    const Shape& a,
+    const Vector3& position_a,
+    const Shape& b,
+    const Vector3& position_b) {
+  ENGINE_CORE_ASSERT(
+      a.IsRounded(), "Distance queries require a sphere or capsule first.");
+
+  if (b.Type == ShapeType::Box) {
+    return RoundedVersusBox(a, position_a, b, position_b);
+  }
+  return RoundedVersusRounded(a, position_a, b, position_b);
+}
+
+/**
+ * Under pure translation the distance between two convex shapes is a convex
+ * function of time whose slope is given by the closing speed along the contact
+ * normal. Advancing by distance / closing speed therefore never steps past the
+ * first time of impact.
+ */
+bool ComputeTimeOfImpact(
+    const Shape& a,
+    const Vector3& start,
+    const Vector3& displacement,
+    const Shape& b,
+    const Vector3& position_b,
+    TimeOfImpact* result) {
+  float time = 0.0f;
+
+  for (uint32_t i = 0; i < kMaxAdvancementIterations; ++i) {
+    ClosestPoints points = ComputeClosestPoints(
+        a, start + displacement * time, b, position_b);
+
+    float closing_speed = -Dot(displacement, points.Normal);
+    if (points.Distance <= kContactTolerance) {
+      if (closing_speed <= 0.0f && points.Valid) {
+        return false;
+      }
+
+      result->Time = time;
+      result->Normal = points.Normal;
+      result->Point = points.PointOnB;
+      return true;
+    }
+
+    if (closing_speed <= kEpsilon) {
+      return false;
+    }
+
+    time += (points.Distance - kContactTolerance * 0.5f) / closing_speed;
+    if (time > 1.0f) {
+      return false;
+    }
+  }
+
+  // Grazing contacts can converge slowly. Report the contact conservatively.
+  ClosestPoints points = ComputeClosestPoints(
+      a, start + displacement * time, b, position_b);
+  result->Time = time;
+  result->Normal = points.Normal;
+  result->Point = points.PointOnB;
+  return true;
+}
+
+bool ComputeRayIntersection(
+    const Vector3& origin,
+    const Vector3& direction,
+    float max_distance,
+    const Shape& shape,
+    const Vector3& position,
+    RayIntersection* result) {
+  if (shape.Type == ShapeType::Box) {
+    return RayVersusBox(
+        origin, direction, max_distance, shape, position, result);
+  }
+  return RayVersusRounded(
+      origin, direction, max_distance, shape, position, result);
+}
+
+}  // namespace physics
+}  // namespace engine
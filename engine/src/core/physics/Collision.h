@@ -0,0 +1,204 @@
+/**
+ * @file engine/src/core/physics/Collision.h
+ * @brief Collision shapes and the narrow phase distance queries between them.
+ *
+ * Shapes are never rotated. Spheres and capsules are both represented as a
+ * segment swept by a radius, where a sphere is simply a capsule whose segment
+ * has no length. Boxes are axis aligned.
+ */
+#ifndef ENGINE_SRC_CORE_PHYSICS_COLLISION_H_
+#define ENGINE_SRC_CORE_PHYSICS_COLLISION_H_
+
+#include <algorithm>
+#include <cstdint>
+
+#include "core/Core.h"
+#include "core/physics/PhysicsTypes.h"
+
+namespace engine {
+namespace physics {
+
+// ------------------------------------- AABB ----------------------------------
+
+/**
+ * @struct AABB
+ * @brief An axis aligned bounding box.
+ */
+struct AABB {
+  Vector3 Min;
+  Vector3 Max;
+
+  inline Vector3 GetCenter() const { return (Min + Max) * 0.5f; }
+  inline Vector3 GetExtent() const { return Max - Min; }
+
+  inline bool Overlaps(const AABB& other) const {
+    return Min.x <= other.Max.x && Max.x >= other.Min.x
+        && Min.y <= other.Max.y && Max.y >= other.Min.y
+        && Min.z <= other.Max.z && Max.z >= other.Min.z;
+  }
+
+  inline float GetSurfaceArea() const {
+    Vector3 extent = GetExtent();
+    return 2.0f * (
+        extent.x * extent.y + extent.y * extent.z + extent.z * extent.x);
+  }
+
+  /**
+   * @fn Merge
+   * @brief Get the smallest box that contains both boxes.
+   */
+  static inline AABB Merge(const AABB& a, const AABB& b) {
+    return {
+        { std::min(a.Min.x, b.Min.x),
+          std::min(a.Min.y, b.Min.y),
+          std::min(a.Min.z, b.Min.z) },
+        { std::max(a.Max.x, b.Max.x),
+          std::max(a.Max.y, b.Max.y),
+          std::max(a.Max.z, b.Max.z) } };
+  }
+};
+
+// ------------------------------------ SHAPES ---------------------------------
+
+/**
+ * @enum ShapeType
+ * @brief The kinds of shapes supported by the collision system.
+ */
+enum class ShapeType {
+  None = 0,
+  Sphere,
+  Capsule,
+  Box,
+};
+
+/**
+ * @struct Shape
+ * @brief A collision shape relative to its center.
+ *
+ * Spheres and capsules use Axis as half of their segment and Radius as the
+ * radius around it. Boxes use HalfExtents.
+ */
+struct Shape {
+  ShapeType Type = ShapeType::None;
+  Vector3 Axis = { 0.0f, 0.0f, 0.0f };
+  Vector3 HalfExtents = { 0.0f, 0.0f, 0.0f };
+  float Radius = 0.0f;
+
+  inline bool IsRounded() const { return Type != ShapeType::Box; }
+
+  /**
+   * @fn GetBounds
+   * @brief Get the bounds of the shape when centered at position.
+   */
+  AABB GetBounds(const Vector3& position) const;
+
+  static Shape CreateSphere(float radius);
+
+  /**
+   * @fn CreateCapsule
+   * @param radius The radius of the capsule.
+   * @param half_height Half of the distance between the centers of the two
+   * hemispheres.
+   * @param axis The direction of the capsule. Defaults to the up axis.
+   */
+  static Shape CreateCapsule(
+      float radius,
+      float half_height,
+      const Vector3& axis = { 0.0f, 1.0f, 0.0f });
+
+  static Shape CreateBox(const Vector3& half_extents);
+};
+
+// --------------------------------- NARROW PHASE ------------------------------
+
+/**
+ * @struct ClosestPoints
+ * @brief The result of a distance query between two shapes.
+ *
+ * Distance is negative when the shapes overlap. Normal points from the surface
+ * of B towards A and is only meaningful when Valid is set, since it can't be
+ * determined when the core of one shape lies inside the other.
+ */
+struct ClosestPoints {
+  Vector3 PointOnA;
+  Vector3 PointOnB;
+  Vector3 Normal;
+  float Distance;
+  bool Valid;
+};
+
+/**
+ * @fn ComputeClosestPoints
+ * @brief Computes the closest points between two shapes. Shape a must be a
+ * sphere or capsule.
+ */
+ENGINE_API ClosestPoints ComputeClosestPoints(
+    const Shape& a,
+    const Vector3& position_a,
+    const Shape& b,
+    const Vector3& position_b);
+
+/**
+ * @struct TimeOfImpact
+ * @brief The result of sweeping a shape against another.
+ */
+struct TimeOfImpact {
+  float Time;
+  Vector3 Normal;
+  Vector3 Point;
+};
+
+/**
+ * @fn ComputeTimeOfImpact
+ * @param a The moving shape, which must be a sphere or capsule.
+ * @param start The position of the moving shape at time 0.
+ * @param displacement The translation of the moving shape from time 0 to 1.
+ * @param b The stationary shape.
+ * @param position_b The position of the stationary shape.
+ * @param result Receives the time of impact if the shapes collide.
+ * @brief Finds the first time in [0, 1] at which the shapes touch using
+ * conservative advancement.
+ *
+ * Shapes that start out touching only collide if they are moving towards each
+ * other, which lets anything resting against a surface move away from it.
+ */
+ENGINE_API bool ComputeTimeOfImpact(
+    const Shape& a,
+    const Vector3& start,
+    const Vector3& displacement,
+    const Shape& b,
+    const Vector3& position_b,
+    TimeOfImpact* result);
+
+/**
+ * @struct RayIntersection
+ * @brief The result of casting a ray against a shape.
+ */
+struct RayIntersection {
+  float Distance;
+  Vector3 Normal;
+};
+
+/**
+ * @fn ComputeRayIntersection
+ * @param origin The start of the ray.
+ * @param direction The normalized direction of the ray.
+ * @param max_distance The length of the ray.
+ * @param shape The shape to intersect.
+ * @param position The position of the shape.
+ * @param result Receives the first intersection along the ray.
+ * @brief Finds where a ray enters a shape. Rays that start inside of the shape
+ * hit it at distance 0 with a normal opposing the ray.
+ */
+ENGINE_API bool ComputeRayIntersection(
+    const Vector3& origin,
+    const Vector3& direction,
+    float max_distance,
+    const Shape& shape,
+    const Vector3& position,
+    RayIntersection* result);
+
+}  // namespace physics
+}  // namespace engine
+
+#endif  // ENGINE_SRC_CORE_PHYSICS_COLLISION_H_
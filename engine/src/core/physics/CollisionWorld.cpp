@@ -0,0 +1,339 @@
+#include "core/physics/CollisionWorld.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "core/Assert.h"
+#include "core/jobs/JobSystem.h"
+
+namespace engine {
+namespace physics {
+
+namespace {
+
+// The number of queries or bodies processed by a single job. Must be a
+// multiple of the ray packet size so that jobs only trace full packets.
+constexpr uint32_t kQueriesPerJob = 64;
+
+}  // namespace
+
+CollisionWorld::CollisionWorld() {}
+
+CollisionWorld::~CollisionWorld() {}
+
+ColliderHandle CollisionWorld::AddCollider(
+    const Shape& shape, const Vector3& position, uint32_t layer) {
+  ColliderHandle handle;
+  if (!free_colliders_.empty()) {
+    handle = free_colliders_.back();
+    free_colliders_.pop_back();
+  } else {
+    handle = static_cast<ColliderHandle>(colliders_.size());
+    colliders_.emplace_back();
+  }
+
+  Collider& collider = colliders_[handle];
+  collider.ColliderShape = shape;
+  collider.Position = position;
+  collider.Layer = layer;
+  collider.Proxy = broad_phase_.CreateProxy(shape.GetBounds(position), handle);
+  collider.Alive = true;
+  return handle;
+}
+
+void CollisionWorld::RemoveCollider(ColliderHandle collider) {
+  ENGINE_CORE_ASSERT(
+      colliders_[collider].Alive, "Collider was already removed.");
+
+  broad_phase_.DestroyProxy(colliders_[collider].Proxy);
+  colliders_[collider].Alive = false;
+  free_colliders_.push_back(collider);
+}
+
+void CollisionWorld::SetColliderPosition(
+    ColliderHandle collider, const Vector3& position) {
+  Collider& target = colliders_[collider];
+  target.Position = position;
+  broad_phase_.MoveProxy(
+      target.Proxy, target.ColliderShape.GetBounds(position));
+}
+
+void CollisionWorld::Update() {
+  broad_phase_.Update();
+}
+
+/**
+ * Candidates are culled with the bounds of the whole motion before every
+ * candidate is swept with conservative advancement.
+ */
+bool CollisionWorld::Sweep(
+    const Shape& shape,
+    const Vector3& start,
+    const Vector3& displacement,
+    uint32_t collision_mask,
+    SweepHit* hit) const {
+  ENGINE_CORE_ASSERT(
+      broad_phase_.IsUpToDate(), "CollisionWorld::Update() wasn't called.");
+
+  AABB swept_bounds = AABB::Merge(
+      shape.GetBounds(start), shape.GetBounds(start + displacement));
+
+  *hit = SweepHit();
+  broad_phase_.Query(swept_bounds, [&](uint32_t handle) {
+    const Collider& collider = colliders_[handle];
+    if (!(collider.Layer & collision_mask)) {
+      return true;
+    }
+
+    TimeOfImpact impact;
+    if (ComputeTimeOfImpact(
+            shape,
+            start,
+            displacement,
+            collider.ColliderShape,
+            collider.Position,
+            &impact)
+        && impact.Time < hit->Time) {
+      hit->Collider = handle;
+      hit->Time = impact.Time;
+      hit->Normal = impact.Normal;
+      hit->Point = impact.Point;
+    }
+    return true;
+  });
+
+  hit->Position = start + displacement * hit->Time;
+  return hit->HasHit();
+}
+
+void CollisionWorld::SweepBatch(
+    const SweepQuery* queries, uint32_t count, SweepHit* hits) const {
+  jobs::JobSystem::ParallelFor(
+      count, kQueriesPerJob, [&](uint32_t begin, uint32_t end) {
+        SweepRange(queries, begin, end, hits);
+      });
+}
+
+void CollisionWorld::SweepBatchAsync(
+    const SweepQuery* queries,
+    uint32_t count,
+    SweepHit* hits,
+    jobs::JobCounter* counter) const {
+  jobs::JobSystem::ParallelForAsync(
+      count,
+      kQueriesPerJob,
+      [this, queries, hits](uint32_t begin, uint32_t end) {
+        SweepRange(queries, begin, end, hits);
+      },
+      counter);
+}
+
+void CollisionWorld::SweepRange(
+    const SweepQuery* queries,
+    uint32_t begin,
+    uint32_t end,
+    SweepHit* hits) const {
+  for (uint32_t i = begin; i < end; ++i) {
+    const SweepQuery& query = queries[i];
+    Sweep(
+        query.QueryShape,
+        query.Start,
+        query.Displacement,
+        query.CollisionMask,
+        &hits[i]);
+  }
+}
+
+bool CollisionWorld::Raycast(
+    const Vector3& origin,
+    const Vector3& direction,
+    float max_distance,
+    uint32_t collision_mask,
+    RaycastHit* hit) const {
+  RaycastQuery query = { origin, direction, max_distance, collision_mask };
+  RaycastPacket(&query, 1, hit);
+  return hit->HasHit();
+}
+
+void CollisionWorld::RaycastBatch(
+    const RaycastQuery* queries, uint32_t count, RaycastHit* hits) const {
+  jobs::JobSystem::ParallelFor(
+      count, kQueriesPerJob, [&](uint32_t begin, uint32_t end) {
+        RaycastRange(queries, begin, end, hits);
+      });
+}
+
+void CollisionWorld::RaycastBatchAsync(
+    const RaycastQuery* queries,
+    uint32_t count,
+    RaycastHit* hits,
+    jobs::JobCounter* counter) const {
+  jobs::JobSystem::ParallelForAsync(
+      count,
+      kQueriesPerJob,
+      [this, queries, hits](uint32_t begin, uint32_t end) {
+        RaycastRange(queries, begin, end, hits);
+      },
+      counter);
+}
+
+void CollisionWorld::RaycastRange(
+    const RaycastQuery* queries,
+    uint32_t begin,
+    uint32_t end,
+    RaycastHit* hits) const {
+  for (uint32_t i = begin; i < end; i += kRayPacketSize) {
+    uint32_t count = std::min(kRayPacketSize, end - i);
+    RaycastPacket(queries + i, count, hits + i);
+  }
+}
+
+/**
+ * The broadphase culls nodes for all rays of the packet at once. Only the
+ * lanes that hit a collider's bounds run the exact test, and every hit
+ * shortens its ray so that colliders behind it are culled for that lane.
+ */
+void CollisionWorld::RaycastPacket(
+    const RaycastQuery* queries, uint32_t count, RaycastHit* hits) const {
+  ENGINE_CORE_ASSERT(
+      broad_phase_.IsUpToDate(), "CollisionWorld::Update() wasn't called.");
+
+  RayPacket packet;
+  packet.Clear();
+  for (uint32_t lane = 0; lane < count; ++lane) {
+    const RaycastQuery& query = queries[lane];
+    packet.SetRay(lane, query.Origin, query.Direction, query.MaxDistance);
+    hits[lane] = RaycastHit();
+  }
+
+  broad_phase_.RaycastPacket(&packet, [&](uint32_t handle, uint32_t mask) {
+    const Collider& collider = colliders_[handle];
+    for (uint32_t lane = 0; lane < count; ++lane) {
+      if (!(mask & (1u << lane))
+          || !(collider.Layer & queries[lane].CollisionMask)) {
+        continue;
+      }
+
+      Vector3 origin = packet.GetOrigin(lane);
+      Vector3 direction = packet.GetDirection(lane);
+      RayIntersection intersection;
+      if (ComputeRayIntersection(
+              origin,
+              direction,
+              packet.MaxDistance[lane],
+              collider.ColliderShape,
+              collider.Position,
+              &intersection)) {
+        packet.MaxDistance[lane] = intersection.Distance;
+
+        RaycastHit& hit = hits[lane];
+        hit.Collider = handle;
+        hit.Distance = intersection.Distance;
+        hit.Point = origin + direction * intersection.Distance;
+        hit.Normal = intersection.Normal;
+      }
+    }
+  });
+}
+
+void CollisionWorld::Overlap(
+    const Shape& shape,
+    const Vector3& position,
+    uint32_t collision_mask,
+    std::vector<ColliderHandle>* results) const {
+  ENGINE_CORE_ASSERT(
+      broad_phase_.IsUpToDate(), "CollisionWorld::Update() wasn't called.");
+
+  broad_phase_.Query(shape.GetBounds(position), [&](uint32_t handle) {
+    const Collider& collider = colliders_[handle];
+    if ((collider.Layer & collision_mask)
+        && ComputeClosestPoints(
+            shape,
+            position,
+            collider.ColliderShape,
+            collider.Position).Distance < 0.0f) {
+      results->push_back(handle);
+    }
+    return true;
+  });
+}
+
+bool CollisionWorld::ComputePenetration(
+    const Shape& shape,
+    const Vector3& position,
+    uint32_t collision_mask,
+    Vector3* correction) const {
+  ENGINE_CORE_ASSERT(
+      broad_phase_.IsUpToDate(), "CollisionWorld::Update() wasn't called.");
+
+  *correction = { 0.0f, 0.0f, 0.0f };
+  bool penetrating = false;
+
+  broad_phase_.Query(shape.GetBounds(position), [&](uint32_t handle) {
+    const Collider& collider = colliders_[handle];
+    if (!(collider.Layer & collision_mask)) {
+      return true;
+    }
+
+    // Resolve against the already corrected position so that overlapping
+    // colliders don't push the shape out twice.
+    ClosestPoints points = ComputeClosestPoints(
+        shape,
+        position + *correction,
+        collider.ColliderShape,
+        collider.Position);
+    if (points.Distance < 0.0f) {
+      *correction += points.Normal * -points.Distance;
+      penetrating = true;
+    }
+    return true;
+  });
+
+  return penetrating;
+}
+
+void CollisionWorld::StepBodies(
+    MovingBody* bodies, uint32_t count, float delta_time) const {
+  jobs::JobSystem::ParallelFor(
+      count, kQueriesPerJob, [&](uint32_t begin, uint32_t end) {
+        std::vector<ColliderHandle> overlaps;
+        for (uint32_t i = begin; i < end; ++i) {
+          MovingBody& body = bodies[i];
+          Vector3 displacement = body.Velocity * delta_time;
+
+          if (body.Flags & kBodyFlagContinuous) {
+            Sweep(
+                body.BodyShape,
+                body.Position,
+                displacement,
+                body.CollisionMask,
+                &body.Hit);
+            body.Position = body.Hit.Position;
+            continue;
+          }
+
+          body.Position += displacement;
+          body.Hit = SweepHit();
+
+          overlaps.clear();
+          Overlap(
+              body.BodyShape, body.Position, body.CollisionMask, &overlaps);
+          if (!overlaps.empty()) {
+            const Collider& collider = colliders_[overlaps.front()];
+            ClosestPoints points = ComputeClosestPoints(
+                body.BodyShape,
+                body.Position,
+                collider.ColliderShape,
+                collider.Position);
+            body.Hit.Collider = overlaps.front();
+            body.Hit.Time = 1.0f;
+            body.Hit.Position = body.Position;
+            body.Hit.Normal = points.Normal;
+            body.Hit.Point = points.PointOnB;
+          }
+        }
+      });
+}
+
+}  // namespace physics
+}  // namespace engine
@@ -0,0 +1,306 @@
+/**
+ * @file engine/src/core/physics/CollisionWorld.h
+ * @brief The collision world that owns colliders and answers shape queries.
+ *
+ * Queries use the broadphase to cull candidates before running the narrow
+ * phase. Fast moving bodies can opt into continuous collision detection,
+ * which sweeps them along their motion instead of only testing where they end
+ * up, so that they can't tunnel through thin geometry.
+ */
+#ifndef ENGINE_SRC_CORE_PHYSICS_COLLISIONWORLD_H_
+#define ENGINE_SRC_CORE_PHYSICS_COLLISIONWORLD_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "core/Core.h"
+#include "core/jobs/JobSystem.h"
+#include "core/physics/BroadPhase.h"
+#include "core/physics/Collision.h"
+#include "core/physics/PhysicsTypes.h"
+
+namespace engine {
+namespace physics {
+
+/**
+ * @typedef ColliderHandle
+ * @brief Identifies a collider inside of a CollisionWorld.
+ */
+typedef uint32_t ColliderHandle;
+
+/**
+ * @var kInvalidCollider
+ * @brief A handle that never refers to a collider.
+ */
+constexpr ColliderHandle kInvalidCollider = ~0u;
+
+/**
+ * @var kAllCollisionLayers
+ * @brief A collision mask that matches colliders on every layer.
+ */
+constexpr uint32_t kAllCollisionLayers = ~0u;
+
+/**
+ * @struct SweepHit
+ * @brief The first contact found by sweeping a shape through the world.
+ */
+struct SweepHit {
+  ColliderHandle Collider = kInvalidCollider;
+  float Time = 1.0f;
+  Vector3 Position = { 0.0f, 0.0f, 0.0f };
+  Vector3 Normal = { 0.0f, 0.0f, 0.0f };
+  Vector3 Point = { 0.0f, 0.0f, 0.0f };
+
+  inline bool HasHit() const { return Collider != kInvalidCollider; }
+};
+
+/**
+ * @struct SweepQuery
+ * @brief A sweep to be executed as part of a batch.
+ */
+struct SweepQuery {
+  Shape QueryShape;
+  Vector3 Start;
+  Vector3 Displacement;
+  uint32_t CollisionMask = kAllCollisionLayers;
+};
+
+/**
+ * @struct RaycastHit
+ * @brief The closest collider hit by a ray.
+ */
+struct RaycastHit {
+  ColliderHandle Collider = kInvalidCollider;
+  float Distance = 0.0f;
+  Vector3 Point = { 0.0f, 0.0f, 0.0f };
+  Vector3 Normal = { 0.0f, 0.0f, 0.0f };
+
+  inline bool HasHit() const { return Collider != kInvalidCollider; }
+};
+
+/**
+ * @struct RaycastQuery
+ * @brief A ray to be traced as part of a batch. Direction must be normalized.
+ */
+struct RaycastQuery {
+  Vector3 Origin;
+  Vector3 Direction;
+  float MaxDistance;
+  uint32_t CollisionMask = kAllCollisionLayers;
+};
+
+/**
+ * @enum BodyFlags
+ * @brief Flags controlling how a MovingBody is stepped.
+ */
+enum BodyFlags {
+  kBodyFlagNone = 0,
+  kBodyFlagContinuous = BIT(0),
+};
+
+/**
+ * @struct MovingBody
+ * @brief A body that is moved through the world by StepBodies.
+ *
+ * Bodies flagged as continuous stop at the first surface along their path.
+ * All other bodies are moved discretely and only report contacts at the end of
+ * their step, which is cheaper but lets fast bodies pass through thin walls.
+ */
+struct MovingBody {
+  Shape BodyShape;
+  Vector3 Position = { 0.0f, 0.0f, 0.0f };
+  Vector3 Velocity = { 0.0f, 0.0f, 0.0f };
+  uint32_t CollisionMask = kAllCollisionLayers;
+  uint32_t Flags = kBodyFlagNone;
+  SweepHit Hit;
+};
+
+/**
+ * @class CollisionWorld
+ * @brief Owns static and kinematic colliders.
+ *
+ * All modifications must be followed by Update() before queries are issued.
+ * Queries are const and can run concurrently. Asynchronous batches read the
+ * world until their counter completes, so the world must not be modified
+ * while any of them are in flight.
+ */
+class ENGINE_API CollisionWorld {
+ public:
+  CollisionWorld();
+  ~CollisionWorld();
+
+  /**
+   * @fn AddCollider
+   * @param shape The shape of the collider.
+   * @param position The center of the collider.
+   * @param layer The collision layer bits of the collider.
+   * @brief Adds a collider and returns its handle.
+   */
+  ColliderHandle AddCollider(
+      const Shape& shape,
+      const Vector3& position,
+      uint32_t layer = BIT(0));
+
+  /**
+   * @fn RemoveCollider
+   * @brief Removes a collider. Its handle may be reused by later colliders.
+   */
+  void RemoveCollider(ColliderHandle collider);
+
+  /**
+   * @fn SetColliderPosition
+   * @brief Moves a collider to a new position.
+   */
+  void SetColliderPosition(ColliderHandle collider, const Vector3& position);
+
+  inline const Shape& GetColliderShape(ColliderHandle collider) const
+      { return colliders_[collider].ColliderShape; }
+  inline const Vector3& GetColliderPosition(ColliderHandle collider) const
+      { return colliders_[collider].Position; }
+
+  /**
+   * @fn Update
+   * @brief Brings the broadphase up to date with all modifications.
+   */
+  void Update();
+
+  /**
+   * @fn Sweep
+   * @param shape The sphere or capsule to sweep.
+   * @param start The starting position of the shape.
+   * @param displacement The motion of the shape.
+   * @param collision_mask Only colliders on these layers are considered.
+   * @param hit Receives the first contact along the motion.
+   * @brief Sweeps a shape through the world. Returns true if it hit anything.
+   */
+  bool Sweep(
+      const Shape& shape,
+      const Vector3& start,
+      const Vector3& displacement,
+      uint32_t collision_mask,
+      SweepHit* hit) const;
+
+  /**
+   * @fn SweepBatch
+   * @brief Executes many sweeps in parallel on the job system. hits must have
+   * room for count results.
+   */
+  void SweepBatch(
+      const SweepQuery* queries, uint32_t count, SweepHit* hits) const;
+
+  /**
+   * @fn SweepBatchAsync
+   * @brief Queues a batch of sweeps on the job system and returns
+   * immediately. The queries and hits must stay alive until the counter has
+   * completed.
+   */
+  void SweepBatchAsync(
+      const SweepQuery* queries,
+      uint32_t count,
+      SweepHit* hits,
+      jobs::JobCounter* counter) const;
+
+  /**
+   * @fn Raycast
+   * @param origin The start of the ray.
+   * @param direction The normalized direction of the ray.
+   * @param max_distance The length of the ray.
+   * @param collision_mask Only colliders on these layers are considered.
+   * @param hit Receives the closest collider along the ray.
+   * @brief Traces a single ray immediately. Returns true if it hit anything.
+   */
+  bool Raycast(
+      const Vector3& origin,
+      const Vector3& direction,
+      float max_distance,
+      uint32_t collision_mask,
+      RaycastHit* hit) const;
+
+  /**
+   * @fn RaycastBatch
+   * @brief Traces many rays in parallel on the job system. hits must have room
+   * for count results.
+   *
+   * Consecutive rays are traced together as packets, so rays that start close
+   * to each other and point in similar directions, such as the line of sight
+   * checks of a single agent, should be submitted next to each other.
+   */
+  void RaycastBatch(
+      const RaycastQuery* queries, uint32_t count, RaycastHit* hits) const;
+
+  /**
+   * @fn RaycastBatchAsync
+   * @brief Queues a batch of rays on the job system and returns immediately.
+   * The queries and hits must stay alive until the counter has completed.
+   */
+  void RaycastBatchAsync(
+      const RaycastQuery* queries,
+      uint32_t count,
+      RaycastHit* hits,
+      jobs::JobCounter* counter) const;
+
+  /**
+   * @fn Overlap
+   * @param shape The sphere or capsule to test.
+   * @param position The position of the shape.
+   * @param collision_mask Only colliders on these layers are considered.
+   * @param results Receives every collider overlapping the shape.
+   * @brief Collects all colliders overlapping a shape.
+   */
+  void Overlap(
+      const Shape& shape,
+      const Vector3& position,
+      uint32_t collision_mask,
+      std::vector<ColliderHandle>* results) const;
+
+  /**
+   * @fn ComputePenetration
+   * @brief Computes the smallest translation that separates a shape from all
+   * colliders it overlaps. Returns false if it isn't overlapping anything.
+   */
+  bool ComputePenetration(
+      const Shape& shape,
+      const Vector3& position,
+      uint32_t collision_mask,
+      Vector3* correction) const;
+
+  /**
+   * @fn StepBodies
+   * @brief Moves bodies by their velocity over delta_time in parallel,
+   * sweeping the ones that are flagged as continuous.
+   */
+  void StepBodies(MovingBody* bodies, uint32_t count, float delta_time) const;
+
+  inline const BroadPhase& GetBroadPhase() const { return broad_phase_; }
+
+ private:
+  struct Collider {
+    Shape ColliderShape;
+    Vector3 Position;
+    uint32_t Layer;
+    uint32_t Proxy;
+    bool Alive;
+  };
+
+  std::vector<Collider> colliders_;
+  std::vector<ColliderHandle> free_colliders_;
+  BroadPhase broad_phase_;
+
+  void SweepRange(
+      const SweepQuery* queries,
+      uint32_t begin,
+      uint32_t end,
+      SweepHit* hits) const;
+  void RaycastRange(
+      const RaycastQuery* queries,
+      uint32_t begin,
+      uint32_t end,
+      RaycastHit* hits) const;
+  void RaycastPacket(
+      const RaycastQuery* queries, uint32_t count, RaycastHit* hits) const;
+};
+
+}  // namespace physics
+}  // namespace engine
+
+#endif  // ENGINE_SRC_CORE_PHYSICS_COLLISIONWORLD_H_
@@ -0,0 +1,441 @@
+#include "core/physics/Fluid.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "core/Assert.h"
+#include "core/jobs/JobSystem.h"
+
+namespace engine {
+namespace physics {
+
+namespace {
+
+constexpr float kPi = 3.14159265358979f;
+constexpr float kEpsilon = 1e-12f;
+
+// The number of particles processed by a single job.
+constexpr uint32_t kParticlesPerJob = 256;
+
+// Reorders a particle array into the order given by the sort.
+template<typename T>
+void Reorder(
+    std::vector<T>* values,
+    const std::vector<uint32_t>& order,
+    std::vector<T>* scratch) {
+  scratch->resize(values->size());
+  for (size_t i = 0; i < order.size(); ++i) {
+    (*scratch)[i] = (*values)[order[i]];
+  }
+  values->swap(*scratch);
+}
+
+#if defined(__SSE2__)
+inline float HorizontalSum(__m128 value) {
+  alignas(16) float lanes[4];
+  _mm_store_ps(lanes, value);
+  return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+}
+#endif  // __SSE2__
+
+}  // namespace
+
+Fluid::Fluid(const FluidSettings& settings) : settings_(settings) {
+  ResizeGrid();
+}
+
+Fluid::~Fluid() {}
+
+void Fluid::SetSettings(const FluidSettings& settings) {
+  settings_ = settings;
+  ResizeGrid();
+}
+
+void Fluid::ResizeGrid() {
+  ENGINE_CORE_ASSERT(
+      settings_.SmoothingRadius > 0.0f, "The smoothing radius must be > 0.");
+
+  const Vector3 extent = settings_.BoundsMax - settings_.BoundsMin;
+  inverse_cell_size_ = 1.0f / settings_.SmoothingRadius;
+  cells_x_ = std::max(1u, static_cast<uint32_t>(
+      std::ceil(extent.x * inverse_cell_size_)));
+  cells_y_ = std::max(1u, static_cast<uint32_t>(
+      std::ceil(extent.y * inverse_cell_size_)));
+  cells_z_ = std::max(1u, static_cast<uint32_t>(
+      std::ceil(extent.z * inverse_cell_size_)));
+  cell_start_.assign(cells_x_ * cells_y_ * cells_z_ + 1, 0);
+}
+
+void Fluid::AddParticle(const Vector3& position, const Vector3& velocity) {
+  position_x_.push_back(position.x);
+  position_y_.push_back(position.y);
+  position_z_.push_back(position.z);
+  velocity_x_.push_back(velocity.x);
+  velocity_y_.push_back(velocity.y);
+  velocity_z_.push_back(velocity.z);
+  density_.push_back(settings_.RestDensity);
+  pressure_.push_back(0.0f);
+  acceleration_x_.push_back(0.0f);
+  acceleration_y_.push_back(0.0f);
+  acceleration_z_.push_back(0.0f);
+}
+
+void Fluid::AddBlock(const Vector3& min, const Vector3& max, float spacing) {
+  for (float z = min.z; z <= max.z; z += spacing) {
+    for (float y = min.y; y <= max.y; y += spacing) {
+      for (float x = min.x; x <= max.x; x += spacing) {
+        AddParticle({ x, y, z }, { 0.0f, 0.0f, 0.0f });
+      }
+    }
+  }
+}
+
+void Fluid::Clear() {
+  position_x_.clear();
+  position_y_.clear();
+  position_z_.clear();
+  velocity_x_.clear();
+  velocity_y_.clear();
+  velocity_z_.clear();
+  density_.clear();
+  pressure_.clear();
+  acceleration_x_.clear();
+  acceleration_y_.clear();
+  acceleration_z_.clear();
+}
+
+uint32_t Fluid::GetCell(float x, float y, float z) const {
+  auto axis = [this](float value, float min, uint32_t cells) {
+    int cell = static_cast<int>((value - min) * inverse_cell_size_);
+    return static_cast<uint32_t>(
+        std::min(std::max(cell, 0), static_cast<int>(cells) - 1));
+  };
+
+  uint32_t cx = axis(x, settings_.BoundsMin.x, cells_x_);
+  uint32_t cy = axis(y, settings_.BoundsMin.y, cells_y_);
+  uint32_t cz = axis(z, settings_.BoundsMin.z, cells_z_);
+  return (cz * cells_y_ + cy) * cells_x_ + cx;
+}
+
+void Fluid::SortParticles() {
+  const uint32_t count = GetParticleCount();
+  particle_cell_.resize(count);
+  std::fill(cell_start_.begin(), cell_start_.end(), 0);
+
+  for (uint32_t i = 0; i < count; ++i) {
+    uint32_t cell = GetCell(position_x_[i], position_y_[i], position_z_[i]);
+    particle_cell_[i] = cell;
+    ++cell_start_[cell + 1];
+  }
+
+  for (size_t cell = 1; cell < cell_start_.size(); ++cell) {
+    cell_start_[cell] += cell_start_[cell - 1];
+  }
+
+  // Scatter every particle into the next free slot of its cell. The slots are
+  // tracked by temporarily advancing the start of each cell, which is then
+  // shifted back into place.
+  sort_order_.resize(count);
+  for (uint32_t i = 0; i < count; ++i) {
+    sort_order_[cell_start_[particle_cell_[i]]++] = i;
+  }
+
+  for (size_t cell = cell_start_.size() - 1; cell > 0; --cell) {
+    cell_start_[cell] = cell_start_[cell - 1];
+  }
+  cell_start_[0] = 0;
+
+  Reorder(&position_x_, sort_order_, &scratch_);
+  Reorder(&position_y_, sort_order_, &scratch_);
+  Reorder(&position_z_, sort_order_, &scratch_);
+  Reorder(&velocity_x_, sort_order_, &scratch_);
+  Reorder(&velocity_y_, sort_order_, &scratch_);
+  Reorder(&velocity_z_, sort_order_, &scratch_);
+
+  std::vector<uint32_t> sorted_cells(count);
+  for (uint32_t i = 0; i < count; ++i) {
+    sorted_cells[i] = particle_cell_[sort_order_[i]];
+  }
+  particle_cell_.swap(sorted_cells);
+}
+
+template<typename Function>
+void Fluid::ForEachNeighbourRange(uint32_t cell, Function func) const {
+  const int cx = static_cast<int>(cell % cells_x_);
+  const int cy = static_cast<int>((cell / cells_x_) % cells_y_);
+  const int cz = static_cast<int>(cell / (cells_x_ * cells_y_));
+
+  // Neighbouring cells along x are adjacent in memory, so each row of three
+  // cells forms a single contiguous range of particles.
+  const uint32_t first_x = static_cast<uint32_t>(std::max(cx - 1, 0));
+  const uint32_t last_x = std::min(
+      static_cast<uint32_t>(cx + 1), cells_x_ - 1);
+
+  for (int z = std::max(cz - 1, 0);
+       z <= std::min(cz + 1, static_cast<int>(cells_z_) - 1);
+       ++z) {
+    for (int y = std::max(cy - 1, 0);
+         y <= std::min(cy + 1, static_cast<int>(cells_y_) - 1);
+         ++y) {
+      uint32_t row = (static_cast<uint32_t>(z) * cells_y_
+          + static_cast<uint32_t>(y)) * cells_x_;
+      uint32_t begin = cell_start_[row + first_x];
+      uint32_t end = cell_start_[row + last_x + 1];
+      if (begin < end) {
+        func(begin, end);
+      }
+    }
+  }
+}
+
+/**
+ * Density is accumulated with the poly6 kernel. The particle itself falls
+ * within its own neighbourhood and contributes to its density.
+ */
+void Fluid::ComputeDensity(uint32_t begin, uint32_t end) {
+  const float h = settings_.SmoothingRadius;
+  const float h2 = h * h;
+  const float poly6 = 315.0f / (64.0f * kPi * std::pow(h, 9.0f));
+  const float mass = settings_.ParticleMass;
+  const float* px = position_x_.data();
+  const float* py = position_y_.data();
+  const float* pz = position_z_.data();
+
+  for (uint32_t i = begin; i < end; ++i) {
+    const float xi = px[i], yi = py[i], zi = pz[i];
+    float sum = 0.0f;
+
+    auto accumulate = [&](uint32_t first, uint32_t last) {
+      uint32_t j = first;
+
+#if defined(__SSE2__)
+      const __m128 vxi = _mm_set1_ps(xi);
+      const __m128 vyi = _mm_set1_ps(yi);
+      const __m128 vzi = _mm_set1_ps(zi);
+      const __m128 vh2 = _mm_set1_ps(h2);
+      const __m128 zero = _mm_setzero_ps();
+      __m128 vsum = zero;
+
+      for (; j + 4 <= last; j += 4) {
+        __m128 dx = _mm_sub_ps(_mm_loadu_ps(px + j), vxi);
+        __m128 dy = _mm_sub_ps(_mm_loadu_ps(py + j), vyi);
+        __m128 dz = _mm_sub_ps(_mm_loadu_ps(pz + j), vzi);
+        __m128 r2 = _mm_add_ps(
+            _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)),
+            _mm_mul_ps(dz, dz));
+        __m128 diff = _mm_max_ps(_mm_sub_ps(vh2, r2), zero);
+        vsum = _mm_add_ps(vsum, _mm_mul_ps(_mm_mul_ps(diff, diff), diff));
+      }
+
+      sum += HorizontalSum(vsum);
+#endif  // __SSE2__
+
+      for (; j < last; ++j) {
+        float dx = px[j] - xi, dy = py[j] - yi, dz = pz[j] - zi;
+        float diff = std::max(h2 - (dx * dx + dy * dy + dz * dz), 0.0f);
+        sum += diff * diff * diff;
+      }
+    };
+    ForEachNeighbourRange(particle_cell_[i], accumulate);
+
+    density_[i] = mass * poly6 * sum;
+    pressure_[i] = std::max(
+        settings_.Stiffness * (density_[i] - settings_.RestDensity), 0.0f);
+  }
+}
+
+/**
+ * Pressure forces use the gradient of the spiky kernel and viscosity uses the
+ * laplacian of the viscosity kernel. Both are symmetrized so that pairs of
+ * particles exert equal and opposite forces on each other.
+ */
+void Fluid::ComputeForces(uint32_t begin, uint32_t end) {
+  const float h = settings_.SmoothingRadius;
+  const float h2 = h * h;
+  const float mass = settings_.ParticleMass;
+  const float spiky = mass * 45.0f / (kPi * std::pow(h, 6.0f));
+  const float pressure_constant = 0.5f * spiky;
+  const float viscosity = settings_.Viscosity * spiky;
+  const float* px = position_x_.data();
+  const float* py = position_y_.data();
+  const float* pz = position_z_.data();
+  const float* vx = velocity_x_.data();
+  const float* vy = velocity_y_.data();
+  const float* vz = velocity_z_.data();
+  const float* density = density_.data();
+  const float* pressure = pressure_.data();
+
+  for (uint32_t i = begin; i < end; ++i) {
+    const float xi = px[i], yi = py[i], zi = pz[i];
+    const float vxi = vx[i], vyi = vy[i], vzi = vz[i];
+    const float pi = pressure[i];
+    float fx = 0.0f, fy = 0.0f, fz = 0.0f;
+
+    auto accumulate = [&](uint32_t first, uint32_t last) {
+      uint32_t j = first;
+
+#if defined(__SSE2__)
+      const __m128 zero = _mm_setzero_ps();
+      const __m128 pressure_scale = _mm_set1_ps(pressure_constant);
+      const __m128 epsilon = _mm_set1_ps(kEpsilon);
+      const __m128 vh = _mm_set1_ps(h);
+      const __m128 vh2 = _mm_set1_ps(h2);
+      const __m128 vpi = _mm_set1_ps(pi);
+      const __m128 viscosity_scale = _mm_set1_ps(viscosity);
+      __m128 sum_x = zero, sum_y = zero, sum_z = zero;
+
+      for (; j + 4 <= last; j += 4) {
+        __m128 dx = _mm_sub_ps(_mm_set1_ps(xi), _mm_loadu_ps(px + j));
+        __m128 dy = _mm_sub_ps(_mm_set1_ps(yi), _mm_loadu_ps(py + j));
+        __m128 dz = _mm_sub_ps(_mm_set1_ps(zi), _mm_loadu_ps(pz + j));
+        __m128 r2 = _mm_add_ps(
+            _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)),
+            _mm_mul_ps(dz, dz));
+
+        // Skip the particle itself and anything outside of the radius.
+        __m128 inside = _mm_and_ps(
+            _mm_cmplt_ps(r2, vh2), _mm_cmpgt_ps(r2, epsilon));
+        __m128 r = _mm_sqrt_ps(_mm_max_ps(r2, epsilon));
+        __m128 falloff = _mm_and_ps(_mm_sub_ps(vh, r), inside);
+        __m128 inverse_density = _mm_div_ps(
+            _mm_set1_ps(1.0f), _mm_loadu_ps(density + j));
+
+        __m128 pressure_term = _mm_div_ps(
+            _mm_mul_ps(
+                _mm_mul_ps(
+                    _mm_mul_ps(
+                        _mm_add_ps(vpi, _mm_loadu_ps(pressure + j)),
+                        pressure_scale),
+                    inverse_density),
+                _mm_mul_ps(falloff, falloff)),
+            r);
+        __m128 viscosity_term = _mm_mul_ps(
+            _mm_mul_ps(falloff, inverse_density), viscosity_scale);
+
+        __m128 dvx = _mm_sub_ps(_mm_loadu_ps(vx + j), _mm_set1_ps(vxi));
+        __m128 dvy = _mm_sub_ps(_mm_loadu_ps(vy + j), _mm_set1_ps(vyi));
+        __m128 dvz = _mm_sub_ps(_mm_loadu_ps(vz + j), _mm_set1_ps(vzi));
+
+        sum_x = _mm_add_ps(sum_x, _mm_add_ps(
+            _mm_mul_ps(dx, pressure_term), _mm_mul_ps(dvx, viscosity_term)));
+        sum_y = _mm_add_ps(sum_y, _mm_add_ps(
+            _mm_mul_ps(dy, pressure_term), _mm_mul_ps(dvy, viscosity_term)));
+        sum_z = _mm_add_ps(sum_z, _mm_add_ps(
+            _mm_mul_ps(dz, pressure_term), _mm_mul_ps(dvz, viscosity_term)));
+      }
+
+      fx += HorizontalSum(sum_x);
+      fy += HorizontalSum(sum_y);
+      fz += HorizontalSum(sum_z);
+#endif  // __SSE2__
+
+      for (; j < last; ++j) {
+        float dx = xi - px[j], dy = yi - py[j], dz = zi - pz[j];
+        float r2 = dx * dx + dy * dy + dz * dz;
+        if (r2 >= h2 || r2 <= kEpsilon) {
+          continue;
+        }
+
+        float r = std::sqrt(r2);
+        float falloff = h - r;
+        float inverse_density = 1.0f / density[j];
+        float pressure_term = (pi + pressure[j]) * pressure_constant
+            * inverse_density
+            * falloff * falloff / r;
+        float viscosity_term = falloff * inverse_density * viscosity;
+
+        fx += dx * pressure_term + (vx[j] - vxi) * viscosity_term;
+        fy += dy * pressure_term + (vy[j] - vyi) * viscosity_term;
+        fz += dz * pressure_term + (vz[j] - vzi) * viscosity_term;
+      }
+    };
+    ForEachNeighbourRange(particle_cell_[i], accumulate);
+
+    const float inverse_density = 1.0f / density[i];
+    acceleration_x_[i] = fx * inverse_density + settings_.Gravity.x;
+    acceleration_y_[i] = fy * inverse_density + settings_.Gravity.y;
+    acceleration_z_[i] = fz * inverse_density + settings_.Gravity.z;
+  }
+}
+
+void Fluid::Integrate(uint32_t begin, uint32_t end, float delta_time) {
+  const Vector3& min = settings_.BoundsMin;
+  const Vector3& max = settings_.BoundsMax;
+  const float damping = -settings_.BoundaryDamping;
+
+  auto integrate_axis = [=](float* position, float* velocity, float accel,
+                            float low, float high) {
+    *velocity += accel * delta_time;
+    *position += *velocity * delta_time;
+    if (*position < low) {
+      *position = low;
+      *velocity *= damping;
+    } else if (*position > high) {
+      *position = high;
+      *velocity *= damping;
+    }
+  };
+
+  for (uint32_t i = begin; i < end; ++i) {
+    integrate_axis(
+        &position_x_[i], &velocity_x_[i], acceleration_x_[i], min.x, max.x);
+    integrate_axis(
+        &position_y_[i], &velocity_y_[i], acceleration_y_[i], min.y, max.y);
+    integrate_axis(
+        &position_z_[i], &velocity_z_[i], acceleration_z_[i], min.z, max.z);
+  }
+}
+
+void Fluid::Step(float delta_time) {
+  const uint32_t count = GetParticleCount();
+  if (count == 0) {
+    return;
+  }
+
+  density_.resize(count);
+  pressure_.resize(count);
+  acceleration_x_.resize(count);
+  acceleration_y_.resize(count);
+  acceleration_z_.resize(count);
+
+  SortParticles();
+
+  jobs::JobSystem::ParallelFor(
+      count, kParticlesPerJob, [this](uint32_t begin, uint32_t end) {
+        ComputeDensity(begin, end);
+      });
+
+  jobs::JobSystem::ParallelFor(
+      count, kParticlesPerJob, [this](uint32_t begin, uint32_t end) {
+        ComputeForces(begin, end);
+      });
+
+  jobs::JobSystem::ParallelFor(
+      count,
+      kParticlesPerJob,
+      [this, delta_time](uint32_t begin, uint32_t end) {
+        Integrate(begin, end, delta_time);
+      });
+}
+
+uint32_t Fluid::WriteRenderData(float* destination, uint32_t stride) const {
+  ENGINE_CORE_ASSERT(stride >= 4, "Render data needs at least 4 floats.");
+
+  const uint32_t count = GetParticleCount();
+  for (uint32_t i = 0; i < count; ++i) {
+    float* particle = destination + static_cast<size_t>(i) * stride;
+    particle[0] = position_x_[i];
+    particle[1] = position_y_[i];
+    particle[2] = position_z_[i];
+    particle[3] = density_[i];
+  }
+  return count;
+}
+
+}  // namespace physics
+}  // namespace engine
@@ -0,0 +1,153 @@
+/**
+ * @file engine/src/core/physics/Fluid.h
+ * @brief Smoothed particle hydrodynamics for particle based fluids.
+ *
+ * Particles are sorted into a uniform grid of cells as wide as the smoothing
+ * radius every step. Since the particles of a cell are stored contiguously,
+ * neighbours are found by walking a handful of contiguous ranges, which the
+ * density and force kernels process several particles at a time with SIMD.
+ * Every pass is split into chunks of particles that run on the job system.
+ */
+#ifndef ENGINE_SRC_CORE_PHYSICS_FLUID_H_
+#define ENGINE_SRC_CORE_PHYSICS_FLUID_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "core/Core.h"
+#include "core/physics/PhysicsTypes.h"
+
+namespace engine {
+namespace physics {
+
+/**
+ * @struct FluidSettings
+ * @brief The physical parameters of a fluid.
+ *
+ * Particles are confined to the box between BoundsMin and BoundsMax, which
+ * also determines the size of the neighbour grid.
+ */
+struct FluidSettings {
+  float SmoothingRadius = 0.1f;
+  float ParticleMass = 0.02f;
+  float RestDensity = 1000.0f;
+  float Stiffness = 3.0f;
+  float Viscosity = 3.5f;
+  float BoundaryDamping = 0.5f;
+  Vector3 Gravity = { 0.0f, -9.81f, 0.0f };
+  Vector3 BoundsMin = { -1.0f, 0.0f, -1.0f };
+  Vector3 BoundsMax = { 1.0f, 2.0f, 1.0f };
+};
+
+/**
+ * @class Fluid
+ * @brief A single SPH fluid volume.
+ *
+ * Particle indices are not stable across steps since particles are reordered
+ * by cell to keep neighbours close together in memory.
+ */
+class ENGINE_API Fluid {
+ public:
+  explicit Fluid(const FluidSettings& settings = FluidSettings());
+  ~Fluid();
+
+  /**
+   * @fn AddParticle
+   * @brief Spawns a particle with the given position and velocity.
+   */
+  void AddParticle(const Vector3& position, const Vector3& velocity);
+
+  /**
+   * @fn AddBlock
+   * @brief Fills the box between min and max with particles at the given
+   * spacing.
+   */
+  void AddBlock(const Vector3& min, const Vector3& max, float spacing);
+
+  /**
+   * @fn Clear
+   * @brief Removes all particles.
+   */
+  void Clear();
+
+  /**
+   * @fn Step
+   * @brief Advances the fluid by delta_time seconds.
+   */
+  void Step(float delta_time);
+
+  /**
+   * @fn WriteRenderData
+   * @param destination Receives x, y, z and density for every particle.
+   * @param stride The distance in floats between two particles.
+   * @brief Copies the particles into an interleaved buffer for the renderer.
+   *
+   * Returns the number of particles written. The destination must be large
+   * enough to hold GetParticleCount() particles.
+   */
+  uint32_t WriteRenderData(float* destination, uint32_t stride = 4) const;
+
+  inline uint32_t GetParticleCount() const
+      { return static_cast<uint32_t>(position_x_.size()); }
+
+  inline Vector3 GetPosition(uint32_t particle) const {
+    return {
+        position_x_[particle], position_y_[particle], position_z_[particle] };
+  }
+
+  inline float GetDensity(uint32_t particle) const
+      { return density_[particle]; }
+
+  inline const FluidSettings& GetSettings() const { return settings_; }
+
+  /**
+   * @fn SetSettings
+   * @brief Updates the settings of the fluid, resizing the grid if needed.
+   */
+  void SetSettings(const FluidSettings& settings);
+
+ private:
+  FluidSettings settings_;
+
+  // Particles, sorted by cell after every step.
+  std::vector<float> position_x_, position_y_, position_z_;
+  std::vector<float> velocity_x_, velocity_y_, velocity_z_;
+  std::vector<float> density_, pressure_;
+  std::vector<float> acceleration_x_, acceleration_y_, acceleration_z_;
+
+  // Neighbour grid.
+  uint32_t cells_x_, cells_y_, cells_z_;
+  float inverse_cell_size_;
+  std::vector<uint32_t> particle_cell_;
+  std::vector<uint32_t> cell_start_;
+  std::vector<uint32_t> sort_order_;
+  std::vector<float> scratch_;
+
+  void ResizeGrid();
+  uint32_t GetCell(float x, float y, float z) const;
+
+  /**
+   * @fn SortParticles
+   * @brief Counting sorts all particles by their cell so that the particles
+   * of every cell, and of every row of three neighbouring cells, are
+   * contiguous.
+   */
+  void SortParticles();
+
+  void ComputeDensity(uint32_t begin, uint32_t end);
+  void ComputeForces(uint32_t begin, uint32_t end);
+  void Integrate(uint32_t begin, uint32_t end, float delta_time);
+
+  /**
+   * @fn ForEachNeighbourRange
+   * @brief Invokes func(begin, end) for each of the nine contiguous particle
+   * ranges that cover the 27 cells around the given cell.
+   */
+  template<typename Function>
+  void ForEachNeighbourRange(uint32_t cell, Function func) const;
+};
+
+}  // namespace physics
+}  // namespace engine
+
+#endif  // ENGINE_SRC_CORE_PHYSICS_FLUID_H_
@@ -0,0 +1,84 @@
+/**
+ * @file engine/src/core/physics/PhysicsTypes.h
+ * @brief Small value types shared by the physics modules.
+ *
+ * Vector3 shares its memory layout with three packed floats, which makes it
+ * trivially convertible to and from the vector types used by the renderer.
+ */
+#ifndef ENGINE_SRC_CORE_PHYSICS_PHYSICSTYPES_H_
+#define ENGINE_SRC_CORE_PHYSICS_PHYSICSTYPES_H_
+
+#include <cmath>
+
+namespace engine {
+namespace physics {
+
+/**
+ * @struct Vector3
+ * @brief A three component float vector.
+ */
+struct Vector3 {
+  float x, y, z;
+
+  inline Vector3 operator+(const Vector3& other) const
+      { return { x + other.x, y + other.y, z + other.z }; }
+  inline Vector3 operator-(const Vector3& other) const
+      { return { x - other.x, y - other.y, z - other.z }; }
+  inline Vector3 operator*(float scalar) const
+      { return { x * scalar, y * scalar, z * scalar }; }
+  inline Vector3 operator-() const { return { -x, -y, -z }; }
+
+  inline Vector3& operator+=(const Vector3& other) {
+    x += other.x;
+    y += other.y;
+    z += other.z;
+    return *this;
+  }
+
+  inline Vector3& operator-=(const Vector3& other) {
+    x -= other.x;
+    y -= other.y;
+    z -= other.z;
+    return *this;
+  }
+};
+
+/**
+ * @fn Dot
+ * @brief The dot product of two vectors.
+ */
+inline float Dot(const Vector3& a, const Vector3& b) {
+  return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+/**
+ * @fn Cross
+ * @brief The cross product of two vectors.
+ */
+inline Vector3 Cross(const Vector3& a, const Vector3& b) {
+  return {
+      a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x };
+}
+
+/**
+ * @fn Length
+ * @brief The euclidean length of a vector.
+ */
+inline float Length(const Vector3& vector) {
+  return std::sqrt(Dot(vector, vector));
+}
+
+/**
+ * @fn Normalize
+ * @brief Returns the unit length vector pointing in the same direction, or the
+ * zero vector if the vector is degenerate.
+ */
+inline Vector3 Normalize(const Vector3& vector) {
+  float length = Length(vector);
+  return length > 1e-12f ? vector * (1.0f / length) : Vector3{ 0, 0, 0 };
+}
+
+}  // namespace physics
+}  // namespace engine
+
+#endif  // ENGINE_SRC_CORE_PHYSICS_PHYSICSTYPES_H_
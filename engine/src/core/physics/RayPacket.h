@@ -0,0 +1,182 @@
+/**
+ * @file engine/src/core/physics/RayPacket.h
+ * @brief Groups of rays that are traversed through the broadphase together.
+ *
+ * Packets store their rays as structures of arrays so that every lane of a
+ * SIMD register tests a different ray against the same box. Rays that start
+ * close to each other and point in similar directions visit mostly the same
+ * nodes, which lets a packet share a single traversal between all its rays.
+ */
+#ifndef ENGINE_SRC_CORE_PHYSICS_RAYPACKET_H_
+#define ENGINE_SRC_CORE_PHYSICS_RAYPACKET_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "core/physics/Collision.h"
+#include "core/physics/PhysicsTypes.h"
+
+namespace engine {
+namespace physics {
+
+/**
+ * @var kRayPacketSize
+ * @brief The number of rays in a packet.
+ */
+constexpr uint32_t kRayPacketSize = 4;
+
+/**
+ * @struct RayPacket
+ * @brief Up to kRayPacketSize rays in structure of arrays layout.
+ *
+ * Unused lanes have a negative maximum distance, which makes them miss every
+ * box. Queries shorten MaxDistance as they find hits so that the traversal can
+ * skip everything behind the closest hit of every lane.
+ */
+struct alignas(16) RayPacket {
+  float OriginX[kRayPacketSize];
+  float OriginY[kRayPacketSize];
+  float OriginZ[kRayPacketSize];
+  float DirectionX[kRayPacketSize];
+  float DirectionY[kRayPacketSize];
+  float DirectionZ[kRayPacketSize];
+  float InverseDirectionX[kRayPacketSize];
+  float InverseDirectionY[kRayPacketSize];
+  float InverseDirectionZ[kRayPacketSize];
+  float MaxDistance[kRayPacketSize];
+  uint32_t ActiveMask;
+
+  /**
+   * @fn Clear
+   * @brief Disables every lane of the packet.
+   */
+  inline void Clear() {
+    for (uint32_t lane = 0; lane < kRayPacketSize; ++lane) {
+      OriginX[lane] = OriginY[lane] = OriginZ[lane] = 0.0f;
+      DirectionX[lane] = DirectionY[lane] = DirectionZ[lane] = 0.0f;
+      InverseDirectionX[lane] = 0.0f;
+      InverseDirectionY[lane] = 0.0f;
+      InverseDirectionZ[lane] = 0.0f;
+      MaxDistance[lane] = -1.0f;
+    }
+    ActiveMask = 0;
+  }
+
+  /**
+   * @fn SetRay
+   * @param lane The lane to fill.
+   * @param origin The start of the ray.
+   * @param direction The normalized direction of the ray.
+   * @param max_distance The length of the ray.
+   * @brief Enables a lane of the packet.
+   */
+  inline void SetRay(
+      uint32_t lane,
+      const Vector3& origin,
+      const Vector3& direction,
+      float max_distance) {
+    OriginX[lane] = origin.x;
+    OriginY[lane] = origin.y;
+    OriginZ[lane] = origin.z;
+    DirectionX[lane] = direction.x;
+    DirectionY[lane] = direction.y;
+    DirectionZ[lane] = direction.z;
+    InverseDirectionX[lane] = Invert(direction.x);
+    InverseDirectionY[lane] = Invert(direction.y);
+    InverseDirectionZ[lane] = Invert(direction.z);
+    MaxDistance[lane] = max_distance;
+    ActiveMask |= 1u << lane;
+  }
+
+  inline Vector3 GetOrigin(uint32_t lane) const
+      { return { OriginX[lane], OriginY[lane], OriginZ[lane] }; }
+  inline Vector3 GetDirection(uint32_t lane) const
+      { return { DirectionX[lane], DirectionY[lane], DirectionZ[lane] }; }
+
+ private:
+  // Axis parallel directions use a huge but finite inverse so that the slab
+  // test never multiplies zero by infinity.
+  static inline float Invert(float value) {
+    constexpr float kHuge = 1e30f;
+    return std::fabs(value) > 1e-30f
+        ? 1.0f / value
+        : std::copysign(kHuge, value);
+  }
+};
+
+/**
+ * @fn IntersectRayPacket
+ * @brief Tests every ray of the packet against a box. Returns a mask with a
+ * bit set for every lane whose ray enters the box within its max distance.
+ */
+inline uint32_t IntersectRayPacket(const RayPacket& packet, const AABB& box) {
+#if defined(__SSE2__)
+  __m128 t1 = _mm_mul_ps(
+      _mm_sub_ps(_mm_set1_ps(box.Min.x), _mm_load_ps(packet.OriginX)),
+      _mm_load_ps(packet.InverseDirectionX));
+  __m128 t2 = _mm_mul_ps(
+      _mm_sub_ps(_mm_set1_ps(box.Max.x), _mm_load_ps(packet.OriginX)),
+      _mm_load_ps(packet.InverseDirectionX));
+  __m128 t_min = _mm_min_ps(t1, t2);
+  __m128 t_max = _mm_max_ps(t1, t2);
+
+  t1 = _mm_mul_ps(
+      _mm_sub_ps(_mm_set1_ps(box.Min.y), _mm_load_ps(packet.OriginY)),
+      _mm_load_ps(packet.InverseDirectionY));
+  t2 = _mm_mul_ps(
+      _mm_sub_ps(_mm_set1_ps(box.Max.y), _mm_load_ps(packet.OriginY)),
+      _mm_load_ps(packet.InverseDirectionY));
+  t_min = _mm_max_ps(t_min, _mm_min_ps(t1, t2));
+  t_max = _mm_min_ps(t_max, _mm_max_ps(t1, t2));
+
+  t1 = _mm_mul_ps(
+      _mm_sub_ps(_mm_set1_ps(box.Min.z), _mm_load_ps(packet.OriginZ)),
+      _mm_load_ps(packet.InverseDirectionZ));
+  t2 = _mm_mul_ps(
+      _mm_sub_ps(_mm_set1_ps(box.Max.z), _mm_load_ps(packet.OriginZ)),
+      _mm_load_ps(packet.InverseDirectionZ));
+  t_min = _mm_max_ps(t_min, _mm_min_ps(t1, t2));
+  t_max = _mm_min_ps(t_max, _mm_max_ps(t1, t2));
+
+  t_min = _mm_max_ps(t_min, _mm_setzero_ps());
+  t_max = _mm_min_ps(t_max, _mm_load_ps(packet.MaxDistance));
+  return static_cast<uint32_t>(_mm_movemask_ps(_mm_cmple_ps(t_min, t_max)));
+#else
+  uint32_t mask = 0;
+  for (uint32_t lane = 0; lane < kRayPacketSize; ++lane) {
+    float t1 = (box.Min.x - packet.OriginX[lane])
+        * packet.InverseDirectionX[lane];
+    float t2 = (box.Max.x - packet.OriginX[lane])
+        * packet.InverseDirectionX[lane];
+    float t_min = std::min(t1, t2);
+    float t_max = std::max(t1, t2);
+
+    t1 = (box.Min.y - packet.OriginY[lane]) * packet.InverseDirectionY[lane];
+    t2 = (box.Max.y - packet.OriginY[lane]) * packet.InverseDirectionY[lane];
+    t_min = std::max(t_min, std::min(t1, t2));
+    t_max = std::min(t_max, std::max(t1, t2));
+
+    t1 = (box.Min.z - packet.OriginZ[lane]) * packet.InverseDirectionZ[lane];
+    t2 = (box.Max.z - packet.OriginZ[lane]) * packet.InverseDirectionZ[lane];
+    t_min = std::max(t_min, std::min(t1, t2));
+    t_max = std::min(t_max, std::max(t1, t2));
+
+    t_min = std::max(t_min, 0.0f);
+    t_max = std::min(t_max, packet.MaxDistance[lane]);
+    if (t_min <= t_max) {
+      mask |= 1u << lane;
+    }
+  }
+  return mask;
+#endif
+}
+
+}  // namespace physics
+}  // namespace engine
+
+#endif  // ENGINE_SRC_CORE_PHYSICS_RAYPACKET_H_
@@ -0,0 +1,486 @@
+#include "core/physics/SoftBody.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "core/Assert.h"
+#include "core/Log.h"
+#include "core/jobs/JobSystem.h"
+
+namespace engine {
+namespace physics {
+
+namespace {
+
+// Each particle tracks the colors of its constraints in a single bitmask.
+// Constraints that find every color taken go into one more batch, which is
+// solved one constraint at a time.
+constexpr uint32_t kMaxColors = 64;
+constexpr float kEpsilon = 1e-6f;
+
+}  // namespace
+
+// --------------------------------- SOFT BODY ---------------------------------
+
+SoftBody::SoftBody() {}
+
+SoftBody::~SoftBody() {}
+
+uint32_t SoftBody::AddParticle(const Vector3& position, float inverse_mass) {
+  position_x_.push_back(position.x);
+  position_y_.push_back(position.y);
+  position_z_.push_back(position.z);
+  previous_x_.push_back(position.x);
+  previous_y_.push_back(position.y);
+  previous_z_.push_back(position.z);
+  inverse_mass_.push_back(inverse_mass);
+  return static_cast<uint32_t>(inverse_mass_.size() - 1);
+}
+
+void SoftBody::AddDistanceConstraint(uint32_t a, uint32_t b, float stiffness) {
+  ENGINE_CORE_ASSERT(
+      a < GetParticleCount() && b < GetParticleCount() && a != b,
+      "Distance constraints require two distinct particles.");
+
+  pending_a_.push_back(a);
+  pending_b_.push_back(b);
+  pending_rest_length_.push_back(Length(GetPosition(b) - GetPosition(a)));
+  pending_stiffness_.push_back(std::min(std::max(stiffness, 0.0f), 1.0f));
+  batches_dirty_ = true;
+}
+
+void SoftBody::SetInverseMass(uint32_t particle, float inverse_mass) {
+  inverse_mass_[particle] = inverse_mass;
+}
+
+void SoftBody::SetPosition(uint32_t particle, const Vector3& position) {
+  position_x_[particle] = previous_x_[particle] = position.x;
+  position_y_[particle] = previous_y_[particle] = position.y;
+  position_z_[particle] = previous_z_[particle] = position.z;
+}
+
+void SoftBody::BuildBatches() {
+  uint32_t constraint_count = GetConstraintCount();
+  std::vector<uint64_t> particle_colors(GetParticleCount(), 0);
+  std::vector<uint32_t> constraint_color(constraint_count);
+  std::vector<uint32_t> color_sizes(kMaxColors + 1, 0);
+  uint32_t color_count = 0;
+
+  for (uint32_t i = 0; i < constraint_count; ++i) {
+    uint64_t used = particle_colors[pending_a_[i]]
+        | particle_colors[pending_b_[i]];
+
+    uint32_t color = 0;
+    if (used == ~uint64_t(0)) {
+      color = kMaxColors;
+    } else {
+      while (used & (uint64_t(1) << color)) {
+        ++color;
+      }
+      particle_colors[pending_a_[i]] |= uint64_t(1) << color;
+      particle_colors[pending_b_[i]] |= uint64_t(1) << color;
+    }
+    constraint_color[i] = color;
+    ++color_sizes[color];
+    color_count = std::max(color_count, color + 1);
+  }
+
+  if (color_sizes[kMaxColors] > 0) {
+    ENGINE_CORE_WARN(
+        "{0} soft body constraints don't fit into {1} batches and are solved "
+        "sequentially.", color_sizes[kMaxColors], kMaxColors);
+  }
+
+  batch_offsets_.assign(color_count + 1, 0);
+  for (uint32_t color = 0; color < color_count; ++color) {
+    batch_offsets_[color + 1] = batch_offsets_[color] + color_sizes[color];
+  }
+
+  constraint_a_.resize(constraint_count);
+  constraint_b_.resize(constraint_count);
+  rest_length_.resize(constraint_count);
+  stiffness_.resize(constraint_count);
+
+  std::vector<uint32_t> cursor(batch_offsets_.begin(), batch_offsets_.end());
+  for (uint32_t i = 0; i < constraint_count; ++i) {
+    uint32_t slot = cursor[constraint_color[i]]++;
+    constraint_a_[slot] = pending_a_[i];
+    constraint_b_[slot] = pending_b_[i];
+    rest_length_[slot] = pending_rest_length_[i];
+    stiffness_[slot] = pending_stiffness_[i];
+  }
+
+  batches_dirty_ = false;
+}
+
+/**
+ * Verlet integration. Pinned particles are masked out by their inverse mass
+ * instead of branching so that the loop stays vectorizable.
+ */
+void SoftBody::Integrate(float delta_time) {
+  const float damping = settings_.Damping;
+  const float dt2 = delta_time * delta_time;
+  const float gravity_x = settings_.Gravity.x * dt2;
+  const float gravity_y = settings_.Gravity.y * dt2;
+  const float gravity_z = settings_.Gravity.z * dt2;
+
+  float* px = position_x_.data();
+  float* py = position_y_.data();
+  float* pz = position_z_.data();
+  float* ox = previous_x_.data();
+  float* oy = previous_y_.data();
+  float* oz = previous_z_.data();
+  const float* inverse_mass = inverse_mass_.data();
+
+  uint32_t count = GetParticleCount();
+  for (uint32_t i = 0; i < count; ++i) {
+    float movable = inverse_mass[i] > 0.0f ? 1.0f : 0.0f;
+    float x = px[i], y = py[i], z = pz[i];
+    px[i] = x + movable * ((x - ox[i]) * damping + gravity_x);
+    py[i] = y + movable * ((y - oy[i]) * damping + gravity_y);
+    pz[i] = z + movable * ((z - oz[i]) * damping + gravity_z);
+    ox[i] = x;
+    oy[i] = y;
+    oz[i] = z;
+  }
+}
+
+/**
+ * No two constraints inside of a batch touch the same particle, so four
+ * constraints can be gathered into SIMD lanes, solved together and scattered
+ * back without conflicts. The remainder is solved with the same math in
+ * scalar code.
+ */
+void SoftBody::SolveBatch(uint32_t begin, uint32_t end) {
+  uint32_t i = begin;
+
+#if defined(__SSE2__)
+  float* px = position_x_.data();
+  float* py = position_y_.data();
+  float* pz = position_z_.data();
+  const float* inverse_mass = inverse_mass_.data();
+  const uint32_t* ca = constraint_a_.data();
+  const uint32_t* cb = constraint_b_.data();
+
+  alignas(16) float ax[4], ay[4], az[4], bx[4], by[4], bz[4], wa[4], wb[4];
+  const __m128 epsilon = _mm_set1_ps(kEpsilon);
+
+  for (; i + 4 <= end; i += 4) {
+    for (uint32_t lane = 0; lane < 4; ++lane) {
+      uint32_t a = ca[i + lane], b = cb[i + lane];
+      ax[lane] = px[a]; ay[lane] = py[a]; az[lane] = pz[a];
+      bx[lane] = px[b]; by[lane] = py[b]; bz[lane] = pz[b];
+      wa[lane] = inverse_mass[a];
+      wb[lane] = inverse_mass[b];
+    }
+
+    __m128 vax = _mm_load_ps(ax), vay = _mm_load_ps(ay), vaz = _mm_load_ps(az);
+    __m128 vbx = _mm_load_ps(bx), vby = _mm_load_ps(by), vbz = _mm_load_ps(bz);
+    __m128 vwa = _mm_load_ps(wa), vwb = _mm_load_ps(wb);
+
+    __m128 dx = _mm_sub_ps(vbx, vax);
+    __m128 dy = _mm_sub_ps(vby, vay);
+    __m128 dz = _mm_sub_ps(vbz, vaz);
+    __m128 length = _mm_sqrt_ps(_mm_max_ps(
+        _mm_add_ps(
+            _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)),
+            _mm_mul_ps(dz, dz)),
+        epsilon));
+
+    __m128 weight = _mm_max_ps(_mm_add_ps(vwa, vwb), epsilon);
+    __m128 scale = _mm_div_ps(
+        _mm_mul_ps(
+            _mm_loadu_ps(&stiffness_[i]),
+            _mm_sub_ps(length, _mm_loadu_ps(&rest_length_[i]))),
+        _mm_mul_ps(length, weight));
+
+    __m128 scale_a = _mm_mul_ps(scale, vwa);
+    __m128 scale_b = _mm_mul_ps(scale, vwb);
+    _mm_store_ps(ax, _mm_add_ps(vax, _mm_mul_ps(dx, scale_a)));
+    _mm_store_ps(ay, _mm_add_ps(vay, _mm_mul_ps(dy, scale_a)));
+    _mm_store_ps(az, _mm_add_ps(vaz, _mm_mul_ps(dz, scale_a)));
+    _mm_store_ps(bx, _mm_sub_ps(vbx, _mm_mul_ps(dx, scale_b)));
+    _mm_store_ps(by, _mm_sub_ps(vby, _mm_mul_ps(dy, scale_b)));
+    _mm_store_ps(bz, _mm_sub_ps(vbz, _mm_mul_ps(dz, scale_b)));
+
+    for (uint32_t lane = 0; lane < 4; ++lane) {
+      uint32_t a = ca[i + lane], b = cb[i + lane];
+      px[a] = ax[lane]; py[a] = ay[lane]; pz[a] = az[lane];
+      px[b] = bx[lane]; py[b] = by[lane]; pz[b] = bz[lane];
+    }
+  }
+#endif  // __SSE2__
+
+  SolveSequential(i, end);
+}
+
+// Solves constraints one after the other, so they may share particles.
+void SoftBody::SolveSequential(uint32_t begin, uint32_t end) {
+  float* px = position_x_.data();
+  float* py = position_y_.data();
+  float* pz = position_z_.data();
+  const float* inverse_mass = inverse_mass_.data();
+  const uint32_t* ca = constraint_a_.data();
+  const uint32_t* cb = constraint_b_.data();
+
+  for (uint32_t i = begin; i < end; ++i) {
+    uint32_t a = ca[i], b = cb[i];
+    float dx = px[b] - px[a];
+    float dy = py[b] - py[a];
+    float dz = pz[b] - pz[a];
+    float length = std::sqrt(std::max(dx * dx + dy * dy + dz * dz, kEpsilon));
+    float weight = std::max(inverse_mass[a] + inverse_mass[b], kEpsilon);
+    float scale = stiffness_[i] * (length - rest_length_[i])
+        / (length * weight);
+
+    float scale_a = scale * inverse_mass[a];
+    float scale_b = scale * inverse_mass[b];
+    px[a] += dx * scale_a; py[a] += dy * scale_a; pz[a] += dz * scale_a;
+    px[b] -= dx * scale_b; py[b] -= dy * scale_b; pz[b] -= dz * scale_b;
+  }
+}
+
+/**
+ * Particles are projected onto the surface of any collider that they have
+ * penetrated. Capsules are handled as spheres centered on the closest point of
+ * their segment.
+ */
+void SoftBody::SolveCollisions(const SoftBodyColliders& colliders) {
+  float* px = position_x_.data();
+  float* py = position_y_.data();
+  float* pz = position_z_.data();
+  const float* inverse_mass = inverse_mass_.data();
+  const float margin = settings_.CollisionMargin;
+  uint32_t count = GetParticleCount();
+
+  for (uint32_t s = 0; s < colliders.SphereCount; ++s) {
+    const SphereCollider& sphere = colliders.Spheres[s];
+    const float radius = sphere.Radius + margin;
+
+    for (uint32_t i = 0; i < count; ++i) {
+      float dx = px[i] - sphere.Center.x;
+      float dy = py[i] - sphere.Center.y;
+      float dz = pz[i] - sphere.Center.z;
+      float distance = std::sqrt(
+          std::max(dx * dx + dy * dy + dz * dz, kEpsilon));
+      float push = std::max(radius - distance, 0.0f) / distance
+          * (inverse_mass[i] > 0.0f ? 1.0f : 0.0f);
+      px[i] += dx * push;
+      py[i] += dy * push;
+      pz[i] += dz * push;
+    }
+  }
+
+  for (uint32_t c = 0; c < colliders.CapsuleCount; ++c) {
+    const CapsuleCollider& capsule = colliders.Capsules[c];
+    const Vector3 axis = capsule.End - capsule.Start;
+    const float inverse_axis_length =
+        1.0f / std::max(Dot(axis, axis), kEpsilon);
+    const float radius = capsule.Radius + margin;
+
+    for (uint32_t i = 0; i < count; ++i) {
+      float t = ((px[i] - capsule.Start.x) * axis.x
+          + (py[i] - capsule.Start.y) * axis.y
+          + (pz[i] - capsule.Start.z) * axis.z) * inverse_axis_length;
+      t = std::min(std::max(t, 0.0f), 1.0f);
+
+      float dx = px[i] - (capsule.Start.x + axis.x * t);
+      float dy = py[i] - (capsule.Start.y + axis.y * t);
+      float dz = pz[i] - (capsule.Start.z + axis.z * t);
+      float distance = std::sqrt(
+          std::max(dx * dx + dy * dy + dz * dz, kEpsilon));
+      float push = std::max(radius - distance, 0.0f) / distance
+          * (inverse_mass[i] > 0.0f ? 1.0f : 0.0f);
+      px[i] += dx * push;
+      py[i] += dy * push;
+      pz[i] += dz * push;
+    }
+  }
+}
+
+void SoftBody::Step(float delta_time, const SoftBodyColliders& colliders) {
+  if (batches_dirty_) {
+    BuildBatches();
+  }
+
+  Integrate(delta_time);
+
+  uint32_t batch_count = GetBatchCount();
+  uint32_t colored_count = std::min(batch_count, kMaxColors);
+  for (uint32_t iteration = 0; iteration < settings_.Iterations; ++iteration) {
+    for (uint32_t batch = 0; batch < colored_count; ++batch) {
+      SolveBatch(batch_offsets_[batch], batch_offsets_[batch + 1]);
+    }
+    if (batch_count > kMaxColors) {
+      SolveSequential(
+          batch_offsets_[kMaxColors], batch_offsets_[kMaxColors + 1]);
+    }
+  }
+
+  SolveCollisions(colliders);
+}
+
+SoftBody* SoftBody::CreateCloth(
+    uint32_t columns,
+    uint32_t rows,
+    float spacing,
+    const Vector3& origin,
+    float inverse_mass) {
+  SoftBody* cloth = new SoftBody();
+  for (uint32_t row = 0; row < rows; ++row) {
+    for (uint32_t column = 0; column < columns; ++column) {
+      cloth->AddParticle(
+          origin + Vector3{ column * spacing, -(row * spacing), 0.0f },
+          inverse_mass);
+    }
+  }
+
+  auto index = [columns](uint32_t column, uint32_t row) {
+    return row * columns + column;
+  };
+
+  for (uint32_t row = 0; row < rows; ++row) {
+    for (uint32_t column = 0; column < columns; ++column) {
+      uint32_t particle = index(column, row);
+
+      // Structural constraints.
+      if (column + 1 < columns) {
+        cloth->AddDistanceConstraint(particle, index(column + 1, row));
+      }
+      if (row + 1 < rows) {
+        cloth->AddDistanceConstraint(particle, index(column, row + 1));
+      }
+
+      // Shear constraints.
+      if (column + 1 < columns && row + 1 < rows) {
+        cloth->AddDistanceConstraint(particle, index(column + 1, row + 1));
+        cloth->AddDistanceConstraint(
+            index(column + 1, row), index(column, row + 1));
+      }
+
+      // Bend constraints are softer to let the cloth fold.
+      if (column + 2 < columns) {
+        cloth->AddDistanceConstraint(particle, index(column + 2, row), 0.5f);
+      }
+      if (row + 2 < rows) {
+        cloth->AddDistanceConstraint(particle, index(column, row + 2), 0.5f);
+      }
+    }
+  }
+
+  return cloth;
+}
+
+SoftBody* SoftBody::CreateLattice(
+    uint32_t size_x,
+    uint32_t size_y,
+    uint32_t size_z,
+    float spacing,
+    const Vector3& origin,
+    float inverse_mass,
+    float stiffness) {
+  SoftBody* body = new SoftBody();
+  for (uint32_t z = 0; z < size_z; ++z) {
+    for (uint32_t y = 0; y < size_y; ++y) {
+      for (uint32_t x = 0; x < size_x; ++x) {
+        body->AddParticle(
+            origin + Vector3{ x * spacing, y * spacing, z * spacing },
+            inverse_mass);
+      }
+    }
+  }
+
+  auto index = [size_x, size_y](uint32_t x, uint32_t y, uint32_t z) {
+    return (z * size_y + y) * size_x + x;
+  };
+
+  // Connect every particle to all of its neighbours in the positive octant,
+  // which covers every structural and shear pair exactly once.
+  for (uint32_t z = 0; z < size_z; ++z) {
+    for (uint32_t y = 0; y < size_y; ++y) {
+      for (uint32_t x = 0; x < size_x; ++x) {
+        for (uint32_t offset = 1; offset < 8; ++offset) {
+          uint32_t nx = x + (offset & 1);
+          uint32_t ny = y + ((offset >> 1) & 1);
+          uint32_t nz = z + ((offset >> 2) & 1);
+          if (nx < size_x && ny < size_y && nz < size_z) {
+            body->AddDistanceConstraint(
+                index(x, y, z), index(nx, ny, nz), stiffness);
+          }
+        }
+
+        // Cross diagonals on each face, so that faces resist shearing in both
+        // directions.
+        if (x + 1 < size_x && y + 1 < size_y) {
+          body->AddDistanceConstraint(
+              index(x + 1, y, z), index(x, y + 1, z), stiffness);
+        }
+        if (y + 1 < size_y && z + 1 < size_z) {
+          body->AddDistanceConstraint(
+              index(x, y + 1, z), index(x, y, z + 1), stiffness);
+        }
+        if (x + 1 < size_x && z + 1 < size_z) {
+          body->AddDistanceConstraint(
+              index(x + 1, y, z), index(x, y, z + 1), stiffness);
+        }
+      }
+    }
+  }
+
+  return body;
+}
+
+// ------------------------------ SOFT BODY WORLD ------------------------------
+
+SoftBodyWorld::SoftBodyWorld() {}
+
+SoftBodyWorld::~SoftBodyWorld() {}
+
+SoftBody* SoftBodyWorld::Add(SoftBody* body) {
+  bodies_.emplace_back(body);
+  return body;
+}
+
+void SoftBodyWorld::Remove(SoftBody* body) {
+  auto it = std::find_if(
+      bodies_.begin(),
+      bodies_.end(),
+      [body](const std::unique_ptr<SoftBody>& owned) {
+        return owned.get() == body;
+      });
+
+  if (it != bodies_.end()) {
+    bodies_.erase(it);
+  }
+}
+
+void SoftBodyWorld::ClearColliders() {
+  spheres_.clear();
+  capsules_.clear();
+}
+
+void SoftBodyWorld::Step(float delta_time) {
+  SoftBodyColliders colliders;
+  colliders.Spheres = spheres_.data();
+  colliders.SphereCount = static_cast<uint32_t>(spheres_.size());
+  colliders.Capsules = capsules_.data();
+  colliders.CapsuleCount = static_cast<uint32_t>(capsules_.size());
+
+  jobs::JobSystem::ParallelFor(
+      GetBodyCount(),
+      1,
+      [this, delta_time, &colliders](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; ++i) {
+          bodies_[i]->Step(delta_time, colliders);
+        }
+      });
+}
+
+}  // namespace physics
+}  // namespace engine
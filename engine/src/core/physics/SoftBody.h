@@ -0,0 +1,262 @@
+/**
+ * @file engine/src/core/physics/SoftBody.h
+ * @brief Position based dynamics for cloth and simple soft bodies.
+ *
+ * Particles are stored as structures of arrays and integrated with verlet
+ * integration. Distance constraints are graph colored into batches in which no
+ * two constraints share a particle, which allows every constraint in a batch to
+ * be solved in its own SIMD lane without any write conflicts.
+ */
+#ifndef ENGINE_SRC_CORE_PHYSICS_SOFTBODY_H_
+#define ENGINE_SRC_CORE_PHYSICS_SOFTBODY_H_
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "core/Core.h"
+#include "core/physics/PhysicsTypes.h"
+
+namespace engine {
+namespace physics {
+
+/**
+ * @struct SphereCollider
+ * @brief A sphere that soft body particles collide against.
+ */
+struct SphereCollider {
+  Vector3 Center;
+  float Radius;
+};
+
+/**
+ * @struct CapsuleCollider
+ * @brief A capsule that soft body particles collide against, defined by the
+ * segment between Start and End.
+ */
+struct CapsuleCollider {
+  Vector3 Start;
+  Vector3 End;
+  float Radius;
+};
+
+/**
+ * @struct SoftBodyColliders
+ * @brief A view over the colliders that a soft body is stepped against.
+ */
+struct SoftBodyColliders {
+  const SphereCollider* Spheres = nullptr;
+  uint32_t SphereCount = 0;
+  const CapsuleCollider* Capsules = nullptr;
+  uint32_t CapsuleCount = 0;
+};
+
+/**
+ * @struct SoftBodySettings
+ * @brief Simulation parameters of a single soft body.
+ */
+struct SoftBodySettings {
+  Vector3 Gravity = { 0.0f, -9.81f, 0.0f };
+  float Damping = 0.99f;
+  uint32_t Iterations = 8;
+  float CollisionMargin = 0.01f;
+};
+
+/**
+ * @class SoftBody
+ * @brief A set of particles connected by distance constraints.
+ *
+ * Particles with an inverse mass of 0 are pinned in place and are never moved
+ * by the solver.
+ */
+class ENGINE_API SoftBody {
+ public:
+  SoftBody();
+  ~SoftBody();
+
+  /**
+   * @fn AddParticle
+   * @brief Adds a particle at rest and returns its index.
+   */
+  uint32_t AddParticle(const Vector3& position, float inverse_mass);
+
+  /**
+   * @fn AddDistanceConstraint
+   * @param a The index of the first particle.
+   * @param b The index of the second particle.
+   * @param stiffness How much of the error is corrected per iteration [0, 1].
+   * @brief Constrains two particles to their current distance.
+   */
+  void AddDistanceConstraint(uint32_t a, uint32_t b, float stiffness = 1.0f);
+
+  /**
+   * @fn SetInverseMass
+   * @brief Set the inverse mass of a particle. An inverse mass of 0 pins it.
+   */
+  void SetInverseMass(uint32_t particle, float inverse_mass);
+
+  /**
+   * @fn SetPosition
+   * @brief Teleports a particle, removing its velocity.
+   */
+  void SetPosition(uint32_t particle, const Vector3& position);
+
+  /**
+   * @fn Step
+   * @param delta_time The time to advance the simulation by in seconds.
+   * @param colliders The colliders that particles are pushed out of.
+   * @brief Integrates the particles and solves all constraints.
+   */
+  void Step(float delta_time, const SoftBodyColliders& colliders);
+
+  inline uint32_t GetParticleCount() const
+      { return static_cast<uint32_t>(inverse_mass_.size()); }
+
+  inline Vector3 GetPosition(uint32_t particle) const {
+    return {
+        position_x_[particle], position_y_[particle], position_z_[particle] };
+  }
+
+  /**
+   * @fn GetPositionsX
+   * @brief Direct access to the x coordinates of all particles. The y and z
+   * coordinates are stored in their own arrays of equal length.
+   */
+  inline const float* GetPositionsX() const { return position_x_.data(); }
+  inline const float* GetPositionsY() const { return position_y_.data(); }
+  inline const float* GetPositionsZ() const { return position_z_.data(); }
+
+  inline uint32_t GetConstraintCount() const
+      { return static_cast<uint32_t>(pending_a_.size()); }
+
+  /**
+   * @fn GetBatchCount
+   * @brief Get the number of constraint batches. All of them are conflict
+   * free, except for a 65th batch of the constraints that didn't fit into 64
+   * colors.
+   */
+  inline uint32_t GetBatchCount() const {
+    return batch_offsets_.empty()
+        ? 0 : static_cast<uint32_t>(batch_offsets_.size() - 1);
+  }
+
+  inline SoftBodySettings& GetSettings() { return settings_; }
+  inline const SoftBodySettings& GetSettings() const { return settings_; }
+
+  /**
+   * @fn CreateCloth
+   * @param columns The number of particles along the x axis.
+   * @param rows The number of particles along the negative y axis.
+   * @param spacing The distance between neighbouring particles.
+   * @param origin The position of the top left particle.
+   * @param inverse_mass The inverse mass of every particle.
+   * @brief Creates a hanging cloth with structural, shear and bend
+   * constraints. Pin particles with SetInverseMass to attach it.
+   */
+  static SoftBody* CreateCloth(
+      uint32_t columns,
+      uint32_t rows,
+      float spacing,
+      const Vector3& origin,
+      float inverse_mass = 1.0f);
+
+  /**
+   * @fn CreateLattice
+   * @brief Creates a box shaped soft body out of a 3D particle lattice with
+   * structural and shear constraints.
+   */
+  static SoftBody* CreateLattice(
+      uint32_t size_x,
+      uint32_t size_y,
+      uint32_t size_z,
+      float spacing,
+      const Vector3& origin,
+      float inverse_mass = 1.0f,
+      float stiffness = 0.5f);
+
+ private:
+  SoftBodySettings settings_;
+
+  // Particles.
+  std::vector<float> position_x_, position_y_, position_z_;
+  std::vector<float> previous_x_, previous_y_, previous_z_;
+  std::vector<float> inverse_mass_;
+
+  // Constraints in the order they were added.
+  std::vector<uint32_t> pending_a_, pending_b_;
+  std::vector<float> pending_rest_length_, pending_stiffness_;
+
+  // Constraints sorted into conflict free batches.
+  std::vector<uint32_t> constraint_a_, constraint_b_;
+  std::vector<float> rest_length_, stiffness_;
+  std::vector<uint32_t> batch_offsets_;
+  bool batches_dirty_ = false;
+
+  /**
+   * @fn BuildBatches
+   * @brief Greedily colors the constraint graph and sorts the constraints into
+   * one batch per color, plus one for the constraints that ran out of colors.
+   */
+  void BuildBatches();
+
+  void Integrate(float delta_time);
+  void SolveBatch(uint32_t begin, uint32_t end);
+  void SolveSequential(uint32_t begin, uint32_t end);
+  void SolveCollisions(const SoftBodyColliders& colliders);
+};
+
+/**
+ * @class SoftBodyWorld
+ * @brief Owns a set of soft bodies and steps them in parallel.
+ *
+ * Every soft body is independent of the others, so each one is stepped as its
+ * own job on the job system.
+ */
+class ENGINE_API SoftBodyWorld {
+ public:
+  SoftBodyWorld();
+  ~SoftBodyWorld();
+
+  /**
+   * @fn Add
+   * @brief Adds a soft body to the world, which takes ownership of it.
+   */
+  SoftBody* Add(SoftBody* body);
+
+  /**
+   * @fn Remove
+   * @brief Removes and destroys a soft body.
+   */
+  void Remove(SoftBody* body);
+
+  inline void AddSphere(const SphereCollider& sphere)
+      { spheres_.push_back(sphere); }
+  inline void AddCapsule(const CapsuleCollider& capsule)
+      { capsules_.push_back(capsule); }
+
+  /**
+   * @fn ClearColliders
+   * @brief Removes all colliders. Typically called every frame before the
+   * colliders of animated characters are added back.
+   */
+  void ClearColliders();
+
+  /**
+   * @fn Step
+   * @brief Steps every soft body in parallel.
+   */
+  void Step(float delta_time);
+
+  inline uint32_t GetBodyCount() const
+      { return static_cast<uint32_t>(bodies_.size()); }
+
+ private:
+  std::vector<std::unique_ptr<SoftBody>> bodies_;
+  std::vector<SphereCollider> spheres_;
+  std::vector<CapsuleCollider> capsules_;
+};
+
+}  // namespace physics
+}  // namespace engine
+
+#endif  // ENGINE_SRC_CORE_PHYSICS_SOFTBODY_H_
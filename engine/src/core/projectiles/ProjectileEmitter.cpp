@@ -0,0 +1,110 @@
+#include "core/projectiles/ProjectileEmitter.h"
+
+#include <cmath>
+
+#include "core/Assert.h"
+
+namespace engine {
+namespace projectiles {
+
+namespace {
+
+constexpr float kTwoPi = 6.28318530718f;
+constexpr double kTwoPiDouble = 6.283185307179586;
+
+}  // namespace
+
+ProjectileEmitter::ProjectileEmitter(const EmitterPattern& pattern)
+    : pattern_(pattern) {}
+
+uint32_t ProjectileEmitter::Update(
+    float delta_time, ProjectileSystem* system) {
+  ENGINE_CORE_ASSERT(
+      pattern_.Interval > 0.0f, "An emitter's interval must be > 0.");
+
+  double end = time_ + delta_time;
+
+  // Bursts whose projectiles would already have expired by the end of the
+  // update fire nothing, so they are skipped all at once.
+  double expired = end - pattern_.Projectile.Lifetime;
+  if (next_burst_ < expired) {
+    next_burst_ += pattern_.Interval
+        * std::floor((expired - next_burst_) / pattern_.Interval);
+  }
+
+  uint32_t fired = 0;
+  while (next_burst_ <= end) {
+    fired += FireBurst(
+        next_burst_, static_cast<float>(end - next_burst_), system);
+    next_burst_ += pattern_.Interval;
+  }
+  time_ = end;
+  return fired;
+}
+
+// Both curves are periodic, so they are reduced to a single period before
+// dropping to single precision.
+float ProjectileEmitter::GetDirection(double time) const {
+  double spin = std::fmod(pattern_.Spin * time, kTwoPiDouble);
+  double sweep = std::fmod(pattern_.SweepFrequency * time, 1.0);
+  return pattern_.Angle + static_cast<float>(spin)
+      + pattern_.SweepAngle * std::sin(kTwoPi * static_cast<float>(sweep));
+}
+
+void ProjectileEmitter::Reset() {
+  time_ = 0.0;
+  next_burst_ = 0.0;
+}
+
+// A burst over a full circle leaves a gap of one step between its last and
+// first projectile; a partial arc puts projectiles on both of its ends.
+uint32_t ProjectileEmitter::FireBurst(
+    double time, float age, ProjectileSystem* system) {
+  const uint32_t count = pattern_.BurstCount;
+  if (count == 0) {
+    return 0;
+  }
+
+  float first = GetDirection(time);
+  float step = 0.0f;
+  if (pattern_.Arc >= kTwoPi) {
+    step = kTwoPi / count;
+  } else if (count > 1) {
+    first -= 0.5f * pattern_.Arc;
+    step = pattern_.Arc / (count - 1);
+  }
+
+  ProjectileDesc desc = pattern_.Projectile;
+  desc.Lifetime -= age;
+  if (desc.Lifetime <= 0.0f) {
+    return 0;
+  }
+
+  uint32_t fired = 0;
+  for (uint32_t k = 0; k < count; ++k) {
+    float direction = first + step * k;
+    float cos = std::cos(direction);
+    float sin = std::sin(direction);
+    float speed = pattern_.Speed + pattern_.SpeedStep * k;
+
+    // Constant acceleration in the projectile's own frame, turned into the
+    // world frame once.
+    float ax = pattern_.Acceleration * cos - pattern_.Curl * sin;
+    float ay = pattern_.Acceleration * sin + pattern_.Curl * cos;
+    float travel = speed * age + pattern_.Offset;
+    desc.X = x_ + cos * travel + 0.5f * ax * age * age;
+    desc.Y = y_ + sin * travel + 0.5f * ay * age * age;
+    desc.VelocityX = cos * speed + ax * age;
+    desc.VelocityY = sin * speed + ay * age;
+    desc.AccelerationX = ax;
+    desc.AccelerationY = ay;
+    if (!system->Spawn(desc)) {
+      break;
+    }
+    ++fired;
+  }
+  return fired;
+}
+
+}  // namespace projectiles
+}  // namespace engine
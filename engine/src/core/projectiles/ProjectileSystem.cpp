@@ -0,0 +1,331 @@
+#include "core/projectiles/ProjectileSystem.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+#include "core/Assert.h"
+#include "core/jobs/JobSystem.h"
+#include "core/math/Wide.h"
+
+namespace engine {
+namespace projectiles {
+
+namespace {
+
+// The number of projectiles swept by a single job.
+constexpr uint32_t kProjectilesPerJob = 1024;
+
+// Integrates [begin, end) with semi-implicit Euler in steps of the wide type
+// and returns the index of the first projectile it didn't integrate.
+template<typename Wide>
+uint32_t IntegrateRange(
+    float* position_x,
+    float* position_y,
+    float* velocity_x,
+    float* velocity_y,
+    const float* acceleration_x,
+    const float* acceleration_y,
+    float* lifetime,
+    uint32_t begin,
+    uint32_t end,
+    float delta_time) {
+  const Wide step = Wide::Broadcast(delta_time);
+  uint32_t i = begin;
+  for (; i + Wide::kWidth <= end; i += Wide::kWidth) {
+    Wide vx = math::MulAdd(
+        Wide::Load(acceleration_x + i), step, Wide::Load(velocity_x + i));
+    Wide vy = math::MulAdd(
+        Wide::Load(acceleration_y + i), step, Wide::Load(velocity_y + i));
+    math::MulAdd(vx, step, Wide::Load(position_x + i)).Store(position_x + i);
+    math::MulAdd(vy, step, Wide::Load(position_y + i)).Store(position_y + i);
+    vx.Store(velocity_x + i);
+    vy.Store(velocity_y + i);
+    (Wide::Load(lifetime + i) - step).Store(lifetime + i);
+  }
+  return i;
+}
+
+}  // namespace
+
+ProjectileSystem::ProjectileSystem(const ProjectileSettings& settings)
+    : settings_(settings) {
+  ENGINE_CORE_ASSERT(settings_.CellSize > 0.0f, "The cell size must be > 0.");
+  ENGINE_CORE_ASSERT(
+      settings_.MaxX > settings_.MinX && settings_.MaxY > settings_.MinY,
+      "The play field of a projectile system can't be empty.");
+
+  for (std::vector<float>* values : {
+           &position_x_, &position_y_, &velocity_x_, &velocity_y_,
+           &acceleration_x_, &acceleration_y_, &lifetime_, &radius_}) {
+    values->resize(settings_.Capacity);
+  }
+  sprite_.resize(settings_.Capacity);
+  target_mask_.resize(settings_.Capacity);
+  tag_.resize(settings_.Capacity);
+  removed_.resize(settings_.Capacity);
+  pending_hits_.resize(settings_.Capacity);
+
+  inverse_cell_size_ = 1.0f / settings_.CellSize;
+  cells_x_ = std::max(1u, static_cast<uint32_t>(std::ceil(
+      (settings_.MaxX - settings_.MinX) * inverse_cell_size_)));
+  cells_y_ = std::max(1u, static_cast<uint32_t>(std::ceil(
+      (settings_.MaxY - settings_.MinY) * inverse_cell_size_)));
+  cell_start_.resize(cells_x_ * cells_y_ + 1);
+}
+
+ProjectileSystem::~ProjectileSystem() {}
+
+uint32_t ProjectileSystem::AddSprite(const ProjectileSprite& sprite) {
+  sprites_.push_back(sprite);
+  return static_cast<uint32_t>(sprites_.size() - 1);
+}
+
+bool ProjectileSystem::Spawn(const ProjectileDesc& desc) {
+  if (count_ == settings_.Capacity) {
+    return false;
+  }
+
+  uint32_t i = count_++;
+  position_x_[i] = desc.X;
+  position_y_[i] = desc.Y;
+  velocity_x_[i] = desc.VelocityX;
+  velocity_y_[i] = desc.VelocityY;
+  acceleration_x_[i] = desc.AccelerationX;
+  acceleration_y_[i] = desc.AccelerationY;
+  lifetime_[i] = desc.Lifetime;
+  radius_[i] = desc.Radius;
+  sprite_[i] = desc.Sprite;
+  target_mask_[i] = desc.TargetMask;
+  tag_[i] = desc.Tag;
+  max_radius_ = std::max(max_radius_, desc.Radius);
+  return true;
+}
+
+void ProjectileSystem::Clear() {
+  count_ = 0;
+  max_radius_ = 0.0f;
+}
+
+void ProjectileSystem::AddTarget(
+    float x, float y, float radius, uint32_t id, uint32_t layers) {
+  targets_.push_back({x, y, radius, id, layers});
+}
+
+void ProjectileSystem::Update(
+    float delta_time, renderer::QuadBatch* quads) {
+  hits_.clear();
+  BuildGrid();
+
+  uint32_t first_quad = 0;
+  renderer::QuadInstance* projectile_quads = nullptr;
+  if (quads != nullptr) {
+    ENGINE_CORE_ASSERT(
+        count_ == 0 || !sprites_.empty(),
+        "Drawing projectiles requires at least one sprite.");
+    first_quad = quads->GetCount();
+    projectile_quads = quads->Allocate(count_);
+  }
+
+  removed_count_.store(0, std::memory_order_relaxed);
+  pending_hit_count_.store(0, std::memory_order_relaxed);
+  jobs::JobSystem::ParallelFor(
+      count_,
+      kProjectilesPerJob,
+      [this, delta_time, projectile_quads](uint32_t begin, uint32_t end) {
+        Sweep(begin, end, delta_time, projectile_quads);
+      });
+
+  // The sweep records hits in whatever order the jobs ran in.
+  uint32_t hit_count = pending_hit_count_.load(std::memory_order_relaxed);
+  std::sort(
+      pending_hits_.begin(), pending_hits_.begin() + hit_count,
+      [](const PendingHit& a, const PendingHit& b) {
+        return a.Projectile < b.Projectile;
+      });
+  for (uint32_t i = 0; i < hit_count; ++i) {
+    uint32_t projectile = pending_hits_[i].Projectile;
+    hits_.push_back({
+        pending_hits_[i].Target, tag_[projectile],
+        position_x_[projectile], position_y_[projectile]});
+  }
+
+  RemoveProjectiles(projectile_quads);
+  if (quads != nullptr) {
+    quads->Truncate(first_quad + count_);
+  }
+  targets_.clear();
+}
+
+// Targets are counting sorted into every cell they overlap, grown by the
+// largest projectile radius, so that a projectile only ever has to look at
+// the cell its center is in.
+void ProjectileSystem::BuildGrid() {
+  std::fill(cell_start_.begin(), cell_start_.end(), 0);
+
+  auto cell_range = [this](float center, float extent, float min,
+                           uint32_t cells, uint32_t* first, uint32_t* last) {
+    int low = static_cast<int>(
+        std::floor((center - extent - min) * inverse_cell_size_));
+    int high = static_cast<int>(
+        std::floor((center + extent - min) * inverse_cell_size_));
+    if (high < 0 || low >= static_cast<int>(cells)) {
+      return false;
+    }
+    *first = static_cast<uint32_t>(std::max(low, 0));
+    *last = static_cast<uint32_t>(
+        std::min(high, static_cast<int>(cells) - 1));
+    return true;
+  };
+
+  auto for_each_cell = [&](const Target& target, auto function) {
+    float extent = target.Radius + max_radius_;
+    uint32_t x0, x1, y0, y1;
+    if (!cell_range(
+            target.X, extent, settings_.MinX, cells_x_, &x0, &x1)
+        || !cell_range(
+            target.Y, extent, settings_.MinY, cells_y_, &y0, &y1)) {
+      return;
+    }
+    for (uint32_t y = y0; y <= y1; ++y) {
+      for (uint32_t x = x0; x <= x1; ++x) {
+        function(y * cells_x_ + x);
+      }
+    }
+  };
+
+  for (const Target& target : targets_) {
+    for_each_cell(target, [this](uint32_t cell) { ++cell_start_[cell + 1]; });
+  }
+  for (size_t cell = 1; cell < cell_start_.size(); ++cell) {
+    cell_start_[cell] += cell_start_[cell - 1];
+  }
+
+  // Scatter through a copy of the starts, which leaves cell_start_ intact.
+  cell_targets_.resize(cell_start_.back());
+  std::vector<uint32_t> next(cell_start_.begin(), cell_start_.end() - 1);
+  for (uint32_t i = 0; i < targets_.size(); ++i) {
+    for_each_cell(targets_[i], [this, &next, i](uint32_t cell) {
+      cell_targets_[next[cell]++] = i;
+    });
+  }
+}
+
+void ProjectileSystem::Sweep(
+    uint32_t begin,
+    uint32_t end,
+    float delta_time,
+    renderer::QuadInstance* quads) {
+  uint32_t i = IntegrateRange<math::float4x>(
+      position_x_.data(), position_y_.data(),
+      velocity_x_.data(), velocity_y_.data(),
+      acceleration_x_.data(), acceleration_y_.data(),
+      lifetime_.data(), begin, end, delta_time);
+  IntegrateRange<math::float1x>(
+      position_x_.data(), position_y_.data(),
+      velocity_x_.data(), velocity_y_.data(),
+      acceleration_x_.data(), acceleration_y_.data(),
+      lifetime_.data(), i, end, delta_time);
+
+  auto remove = [this](uint32_t projectile) {
+    removed_[removed_count_.fetch_add(1, std::memory_order_relaxed)] =
+        projectile;
+  };
+
+  for (i = begin; i < end; ++i) {
+    float x = position_x_[i];
+    float y = position_y_[i];
+    if (lifetime_[i] <= 0.0f || !(x >= settings_.MinX && x < settings_.MaxX)
+        || !(y >= settings_.MinY && y < settings_.MaxY)) {
+      remove(i);
+      continue;
+    }
+
+    uint32_t cell_x = std::min(
+        static_cast<uint32_t>((x - settings_.MinX) * inverse_cell_size_),
+        cells_x_ - 1);
+    uint32_t cell_y = std::min(
+        static_cast<uint32_t>((y - settings_.MinY) * inverse_cell_size_),
+        cells_y_ - 1);
+    uint32_t cell = cell_y * cells_x_ + cell_x;
+    bool hit = false;
+    for (uint32_t entry = cell_start_[cell];
+         entry < cell_start_[cell + 1] && !hit; ++entry) {
+      const Target& target = targets_[cell_targets_[entry]];
+      float dx = target.X - x;
+      float dy = target.Y - y;
+      float reach = target.Radius + radius_[i];
+      if ((target.Layers & target_mask_[i]) != 0
+          && dx * dx + dy * dy <= reach * reach) {
+        pending_hits_[pending_hit_count_.fetch_add(
+            1, std::memory_order_relaxed)] = {i, target.Id};
+        hit = true;
+      }
+    }
+    if (hit) {
+      remove(i);
+      continue;
+    }
+
+    if (quads != nullptr) {
+      const ProjectileSprite& sprite = sprites_[sprite_[i]];
+      renderer::QuadInstance& quad = quads[i];
+      quad.X = x;
+      quad.Y = y;
+      quad.AxisX = sprite.HalfWidth;
+      quad.AxisY = 0.0f;
+      if (sprite.AlignToVelocity) {
+        float vx = velocity_x_[i];
+        float vy = velocity_y_[i];
+        float length_squared = vx * vx + vy * vy;
+        if (length_squared > 0.0f) {
+          float scale = sprite.HalfWidth / std::sqrt(length_squared);
+          quad.AxisX = vx * scale;
+          quad.AxisY = vy * scale;
+        }
+      }
+      quad.HalfHeight = sprite.HalfHeight;
+      quad.U0 = sprite.U0;
+      quad.V0 = sprite.V0;
+      quad.U1 = sprite.U1;
+      quad.V1 = sprite.V1;
+      quad.Color = sprite.Color;
+      quad.Texture = sprite.Texture;
+    }
+  }
+}
+
+// Removing from the highest index down means the last projectile is always
+// one that survived, so every hole is filled by a live projectile.
+void ProjectileSystem::RemoveProjectiles(renderer::QuadInstance* quads) {
+  uint32_t removed = removed_count_.load(std::memory_order_relaxed);
+  std::sort(
+      removed_.begin(), removed_.begin() + removed, std::greater<uint32_t>());
+  for (uint32_t r = 0; r < removed; ++r) {
+    uint32_t hole = removed_[r];
+    uint32_t last = --count_;
+    if (hole != last) {
+      MoveProjectile(last, hole);
+      if (quads != nullptr) {
+        quads[hole] = quads[last];
+      }
+    }
+  }
+}
+
+void ProjectileSystem::MoveProjectile(uint32_t from, uint32_t to) {
+  position_x_[to] = position_x_[from];
+  position_y_[to] = position_y_[from];
+  velocity_x_[to] = velocity_x_[from];
+  velocity_y_[to] = velocity_y_[from];
+  acceleration_x_[to] = acceleration_x_[from];
+  acceleration_y_[to] = acceleration_y_[from];
+  lifetime_[to] = lifetime_[from];
+  radius_[to] = radius_[from];
+  sprite_[to] = sprite_[from];
+  target_mask_[to] = target_mask_[from];
+  tag_[to] = tag_[from];
+}
+
+}  // namespace projectiles
+}  // namespace engine
@@ -0,0 +1,216 @@
+/**
+ * @file engine/src/core/projectiles/ProjectileSystem.h
+ * @brief Tens of thousands of simple 2D projectiles, stored and updated apart
+ * from the entities of a world.
+ *
+ * Projectiles only have a position, velocity, acceleration, lifetime and a
+ * circular hitbox, kept in parallel arrays so that integration runs several
+ * projectiles at a time with SIMD. Targets are registered every frame and
+ * binned into a uniform grid, so each projectile only tests the targets of
+ * the one cell it is in. A single parallel sweep integrates, ages, collides
+ * and writes the quad of every projectile; projectiles that expired, left
+ * the play field or hit something are swap-removed afterwards, which keeps
+ * the arrays dense without preserving their order.
+ */
+#ifndef ENGINE_SRC_CORE_PROJECTILES_PROJECTILESYSTEM_H_
+#define ENGINE_SRC_CORE_PROJECTILES_PROJECTILESYSTEM_H_
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "core/Core.h"
+#include "core/renderer/QuadBatch.h"
+
+namespace engine {
+namespace projectiles {
+
+/**
+ * @struct ProjectileSettings
+ * @brief The play field and limits of a projectile system.
+ *
+ * Projectiles that leave the box between the bounds are removed. The grid
+ * cells should be about as large as the targets.
+ */
+struct ProjectileSettings {
+  float MinX = 0.0f;
+  float MinY = 0.0f;
+  float MaxX = 1920.0f;
+  float MaxY = 1080.0f;
+  float CellSize = 64.0f;
+  uint32_t Capacity = 65536;
+};
+
+/**
+ * @struct ProjectileSprite
+ * @brief How a kind of projectile is drawn.
+ *
+ * The sprite is independent of the hitbox, which in most shooters is much
+ * smaller than what is drawn.
+ */
+struct ProjectileSprite {
+  uint32_t Texture = 0;
+  float U0 = 0.0f, V0 = 0.0f, U1 = 1.0f, V1 = 1.0f;
+  float HalfWidth = 4.0f;
+  float HalfHeight = 4.0f;
+  uint32_t Color = 0xffffffff;
+
+  // Points the sprite's x axis along the velocity instead of the world's.
+  bool AlignToVelocity = false;
+};
+
+/**
+ * @struct ProjectileDesc
+ * @brief The initial state of a projectile.
+ */
+struct ProjectileDesc {
+  float X = 0.0f, Y = 0.0f;
+  float VelocityX = 0.0f, VelocityY = 0.0f;
+  float AccelerationX = 0.0f, AccelerationY = 0.0f;
+  float Lifetime = 10.0f;
+  float Radius = 2.0f;
+  uint32_t Sprite = 0;
+
+  // The layers of targets the projectile hits.
+  uint32_t TargetMask = 0xffffffff;
+
+  // Passed through to hits, e.g. to identify the damage or the shooter.
+  uint32_t Tag = 0;
+};
+
+/**
+ * @struct ProjectileHit
+ * @brief A projectile that hit a target during the last update.
+ */
+struct ProjectileHit {
+  uint32_t Target;
+  uint32_t Tag;
+  float X, Y;
+};
+
+/**
+ * @class ProjectileSystem
+ * @brief All the projectiles of a play field.
+ *
+ * Spawning, targets and sprites must be set up from one thread between
+ * updates. Projectile indices change whenever projectiles are removed.
+ */
+class ENGINE_API ProjectileSystem {
+ public:
+  explicit ProjectileSystem(
+      const ProjectileSettings& settings = ProjectileSettings());
+  ~ProjectileSystem();
+
+  /**
+   * @fn AddSprite
+   * @brief Registers a sprite and returns the index projectiles refer to it
+   * by.
+   */
+  uint32_t AddSprite(const ProjectileSprite& sprite);
+
+  /**
+   * @fn Spawn
+   * @brief Adds a projectile, or returns false if the system is full.
+   */
+  bool Spawn(const ProjectileDesc& desc);
+
+  /**
+   * @fn Clear
+   * @brief Removes all projectiles.
+   */
+  void Clear();
+
+  /**
+   * @fn AddTarget
+   * @brief Adds a circular target for the next update only.
+   * @param id Reported in the hits against the target.
+   * @param layers The layers the target is on, matched against the target
+   * masks of projectiles.
+   */
+  void AddTarget(float x, float y, float radius, uint32_t id, uint32_t layers);
+
+  /**
+   * @fn Update
+   * @brief Advances every projectile by delta_time seconds, collides them
+   * with the targets added since the last update and removes the ones that
+   * are done.
+   * @param quads If not null, receives the quads of the surviving
+   * projectiles.
+   */
+  void Update(float delta_time, renderer::QuadBatch* quads = nullptr);
+
+  /**
+   * @fn GetHits
+   * @brief Get the hits of the last update, ordered by projectile.
+   */
+  inline const std::vector<ProjectileHit>& GetHits() const { return hits_; }
+
+  inline uint32_t GetCount() const { return count_; }
+
+  inline float GetPositionX(uint32_t projectile) const
+      { return position_x_[projectile]; }
+  inline float GetPositionY(uint32_t projectile) const
+      { return position_y_[projectile]; }
+
+  inline const ProjectileSettings& GetSettings() const { return settings_; }
+
+ private:
+  struct Target {
+    float X, Y, Radius;
+    uint32_t Id;
+    uint32_t Layers;
+  };
+
+  // A hit before the hit projectiles are removed, when its index still
+  // identifies the projectile.
+  struct PendingHit {
+    uint32_t Projectile;
+    uint32_t Target;
+  };
+
+  ProjectileSettings settings_;
+  std::vector<ProjectileSprite> sprites_;
+
+  // Projectiles, each array sized to the capacity.
+  uint32_t count_ = 0;
+  std::vector<float> position_x_, position_y_;
+  std::vector<float> velocity_x_, velocity_y_;
+  std::vector<float> acceleration_x_, acceleration_y_;
+  std::vector<float> lifetime_, radius_;
+  std::vector<uint32_t> sprite_, target_mask_, tag_;
+  float max_radius_ = 0.0f;
+
+  // Target grid, rebuilt every update.
+  std::vector<Target> targets_;
+  uint32_t cells_x_, cells_y_;
+  float inverse_cell_size_;
+  std::vector<uint32_t> cell_start_;
+  std::vector<uint32_t> cell_targets_;
+
+  // Written by the sweep through the atomic counts.
+  std::vector<uint32_t> removed_;
+  std::vector<PendingHit> pending_hits_;
+  std::atomic<uint32_t> removed_count_{0};
+  std::atomic<uint32_t> pending_hit_count_{0};
+  std::vector<ProjectileHit> hits_;
+
+  void BuildGrid();
+  void Sweep(
+      uint32_t begin,
+      uint32_t end,
+      float delta_time,
+      renderer::QuadInstance* quads);
+
+  /**
+   * @fn RemoveProjectiles
+   * @brief Swap-removes the projectiles the sweep flagged, moving their quads
+   * the same way.
+   */
+  void RemoveProjectiles(renderer::QuadInstance* quads);
+  void MoveProjectile(uint32_t from, uint32_t to);
+};
+
+}  // namespace projectiles
+}  // namespace engine
+
+#endif  // ENGINE_SRC_CORE_PROJECTILES_PROJECTILESYSTEM_H_
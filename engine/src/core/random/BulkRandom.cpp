@@ -0,0 +1,338 @@
+#include "core/random/BulkRandom.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "core/random/Random.h"
+
+namespace engine {
+namespace random {
+
+namespace {
+
+constexpr uint32_t kLanes = BulkRandom::kLanes;
+constexpr float kUnit = 1.0f / 16777216.0f;
+constexpr float kHalfPi = 1.57079632679489661923f;
+
+#if defined(__SSE2__)
+
+struct Lanes {
+  __m128i S0, S1, S2, S3;
+};
+
+inline Lanes Load(const uint32_t (*state)[kLanes]) {
+  return {
+      _mm_load_si128(reinterpret_cast<const __m128i*>(state[0])),
+      _mm_load_si128(reinterpret_cast<const __m128i*>(state[1])),
+      _mm_load_si128(reinterpret_cast<const __m128i*>(state[2])),
+      _mm_load_si128(reinterpret_cast<const __m128i*>(state[3])) };
+}
+
+inline void Store(const Lanes& lanes, uint32_t (*state)[kLanes]) {
+  _mm_store_si128(reinterpret_cast<__m128i*>(state[0]), lanes.S0);
+  _mm_store_si128(reinterpret_cast<__m128i*>(state[1]), lanes.S1);
+  _mm_store_si128(reinterpret_cast<__m128i*>(state[2]), lanes.S2);
+  _mm_store_si128(reinterpret_cast<__m128i*>(state[3]), lanes.S3);
+}
+
+// One step of xoshiro128+ in every lane.
+inline __m128i Next(Lanes* lanes) {
+  __m128i result = _mm_add_epi32(lanes->S0, lanes->S3);
+  __m128i t = _mm_slli_epi32(lanes->S1, 9);
+  lanes->S2 = _mm_xor_si128(lanes->S2, lanes->S0);
+  lanes->S3 = _mm_xor_si128(lanes->S3, lanes->S1);
+  lanes->S1 = _mm_xor_si128(lanes->S1, lanes->S2);
+  lanes->S0 = _mm_xor_si128(lanes->S0, lanes->S3);
+  lanes->S2 = _mm_xor_si128(lanes->S2, t);
+  lanes->S3 = _mm_or_si128(
+      _mm_slli_epi32(lanes->S3, 11), _mm_srli_epi32(lanes->S3, 21));
+  return result;
+}
+
+// The upper 24 bits as a float in [0, 1).
+inline __m128 ToUnit(__m128i bits) {
+  return _mm_mul_ps(
+      _mm_cvtepi32_ps(_mm_srli_epi32(bits, 8)), _mm_set1_ps(kUnit));
+}
+
+inline __m128 Select(__m128 mask, __m128 a, __m128 b) {
+  return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+// Natural logarithm of positive normal floats. The polynomial is the one used
+// by the Cephes library and is accurate to about one ulp.
+inline __m128 Log(__m128 x) {
+  __m128i bits = _mm_castps_si128(x);
+  __m128 exponent = _mm_cvtepi32_ps(
+      _mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(126)));
+  __m128 mantissa = _mm_castsi128_ps(_mm_or_si128(
+      _mm_and_si128(bits, _mm_set1_epi32(0x007fffff)),
+      _mm_set1_epi32(0x3f000000)));
+
+  __m128 one = _mm_set1_ps(1.0f);
+  __m128 small = _mm_cmplt_ps(mantissa, _mm_set1_ps(0.707106781186547524f));
+  exponent = _mm_sub_ps(exponent, _mm_and_ps(small, one));
+  __m128 m = _mm_add_ps(
+      _mm_sub_ps(mantissa, one), _mm_and_ps(small, mantissa));
+
+  __m128 z = _mm_mul_ps(m, m);
+  __m128 y = _mm_set1_ps(7.0376836292e-2f);
+  y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(-1.1514610310e-1f));
+  y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(1.1676998740e-1f));
+  y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(-1.2420140846e-1f));
+  y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(1.4249322787e-1f));
+  y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(-1.6668057665e-1f));
+  y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(2.0000714765e-1f));
+  y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(-2.4999993993e-1f));
+  y = _mm_add_ps(_mm_mul_ps(y, m), _mm_set1_ps(3.3333331174e-1f));
+  y = _mm_mul_ps(_mm_mul_ps(y, m), z);
+
+  y = _mm_add_ps(y, _mm_mul_ps(exponent, _mm_set1_ps(-2.12194440e-4f)));
+  y = _mm_sub_ps(y, _mm_mul_ps(z, _mm_set1_ps(0.5f)));
+  m = _mm_add_ps(m, y);
+  return _mm_add_ps(m, _mm_mul_ps(exponent, _mm_set1_ps(0.693359375f)));
+}
+
+// Sine and cosine of a uniformly distributed angle. The top two bits pick the
+// quadrant and the next 24 bits the angle within it, which avoids any range
+// reduction.
+inline void SinCos(__m128i bits, __m128* sin, __m128* cos) {
+  __m128i quadrant = _mm_srli_epi32(bits, 30);
+  __m128 x = _mm_mul_ps(
+      _mm_cvtepi32_ps(
+          _mm_and_si128(_mm_srli_epi32(bits, 6), _mm_set1_epi32(0xffffff))),
+      _mm_set1_ps(kUnit * kHalfPi));
+  __m128 x2 = _mm_mul_ps(x, x);
+
+  __m128 s = _mm_set1_ps(-1.0f / 39916800.0f);
+  s = _mm_add_ps(_mm_mul_ps(s, x2), _mm_set1_ps(1.0f / 362880.0f));
+  s = _mm_add_ps(_mm_mul_ps(s, x2), _mm_set1_ps(-1.0f / 5040.0f));
+  s = _mm_add_ps(_mm_mul_ps(s, x2), _mm_set1_ps(1.0f / 120.0f));
+  s = _mm_add_ps(_mm_mul_ps(s, x2), _mm_set1_ps(-1.0f / 6.0f));
+  s = _mm_add_ps(_mm_mul_ps(s, x2), _mm_set1_ps(1.0f));
+  s = _mm_mul_ps(s, x);
+
+  __m128 c = _mm_set1_ps(1.0f / 479001600.0f);
+  c = _mm_add_ps(_mm_mul_ps(c, x2), _mm_set1_ps(-1.0f / 3628800.0f));
+  c = _mm_add_ps(_mm_mul_ps(c, x2), _mm_set1_ps(1.0f / 40320.0f));
+  c = _mm_add_ps(_mm_mul_ps(c, x2), _mm_set1_ps(-1.0f / 720.0f));
+  c = _mm_add_ps(_mm_mul_ps(c, x2), _mm_set1_ps(1.0f / 24.0f));
+  c = _mm_add_ps(_mm_mul_ps(c, x2), _mm_set1_ps(-0.5f));
+  c = _mm_add_ps(_mm_mul_ps(c, x2), _mm_set1_ps(1.0f));
+
+  // Odd quadrants swap sine and cosine, and the signs follow the quadrant.
+  __m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(
+      _mm_and_si128(quadrant, _mm_set1_epi32(1)), _mm_set1_epi32(1)));
+  __m128 sin_sign = _mm_castsi128_ps(
+      _mm_slli_epi32(_mm_srli_epi32(quadrant, 1), 31));
+  __m128 cos_sign = _mm_castsi128_ps(_mm_slli_epi32(
+      _mm_xor_si128(quadrant, _mm_srli_epi32(quadrant, 1)), 31));
+
+  *sin = _mm_xor_ps(Select(swap, c, s), sin_sign);
+  *cos = _mm_xor_ps(Select(swap, s, c), cos_sign);
+}
+
+#else
+
+// One step of xoshiro128+ in every lane.
+inline void Next(uint32_t (*state)[kLanes], uint32_t* result) {
+  for (uint32_t lane = 0; lane < kLanes; ++lane) {
+    uint32_t& s0 = state[0][lane];
+    uint32_t& s1 = state[1][lane];
+    uint32_t& s2 = state[2][lane];
+    uint32_t& s3 = state[3][lane];
+    result[lane] = s0 + s3;
+    uint32_t t = s1 << 9;
+    s2 ^= s0;
+    s3 ^= s1;
+    s1 ^= s2;
+    s0 ^= s3;
+    s2 ^= t;
+    s3 = (s3 << 11) | (s3 >> 21);
+  }
+}
+
+inline void SinCos(uint32_t bits, float* sin, float* cos) {
+  float angle = static_cast<float>(bits >> 6) * (kUnit * kHalfPi);
+  *sin = std::sin(angle);
+  *cos = std::cos(angle);
+}
+
+#endif
+
+}  // namespace
+
+BulkRandom::BulkRandom(uint64_t seed) {
+  Seed(seed);
+}
+
+void BulkRandom::Seed(uint64_t seed) {
+  for (uint32_t lane = 0; lane < kLanes; ++lane) {
+    uint64_t low = SplitMix64(&seed);
+    uint64_t high = SplitMix64(&seed);
+    state_[0][lane] = static_cast<uint32_t>(low);
+    state_[1][lane] = static_cast<uint32_t>(low >> 32);
+    state_[2][lane] = static_cast<uint32_t>(high);
+    state_[3][lane] = static_cast<uint32_t>(high >> 32);
+  }
+}
+
+/**
+ * Every fill produces whole blocks of kLanes values. A partial block at the
+ * end is generated into a temporary block and only partially copied.
+ */
+void BulkRandom::FillUInt32(uint32_t* out, size_t count) {
+  alignas(16) uint32_t block[kLanes];
+#if defined(__SSE2__)
+  Lanes lanes = Load(state_);
+  size_t i = 0;
+  for (; i + kLanes <= count; i += kLanes) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), Next(&lanes));
+  }
+  if (i < count) {
+    _mm_store_si128(reinterpret_cast<__m128i*>(block), Next(&lanes));
+    std::copy(block, block + (count - i), out + i);
+  }
+  Store(lanes, state_);
+#else
+  for (size_t i = 0; i < count; i += kLanes) {
+    Next(state_, block);
+    std::copy(block, block + std::min<size_t>(kLanes, count - i), out + i);
+  }
+#endif
+}
+
+void BulkRandom::FillUniform(float* out, size_t count, float low, float high) {
+  alignas(16) float block[kLanes];
+  float range = high - low;
+#if defined(__SSE2__)
+  Lanes lanes = Load(state_);
+  __m128 scale = _mm_set1_ps(range);
+  __m128 offset = _mm_set1_ps(low);
+  for (size_t i = 0; i < count; i += kLanes) {
+    __m128 value = _mm_add_ps(
+        _mm_mul_ps(ToUnit(Next(&lanes)), scale), offset);
+    if (i + kLanes <= count) {
+      _mm_storeu_ps(out + i, value);
+    } else {
+      _mm_store_ps(block, value);
+      std::copy(block, block + (count - i), out + i);
+    }
+  }
+  Store(lanes, state_);
+#else
+  uint32_t bits[kLanes];
+  for (size_t i = 0; i < count; i += kLanes) {
+    Next(state_, bits);
+    for (uint32_t lane = 0; lane < kLanes; ++lane) {
+      block[lane] = low + range * ToUnitFloat(bits[lane]);
+    }
+    std::copy(block, block + std::min<size_t>(kLanes, count - i), out + i);
+  }
+#endif
+}
+
+/**
+ * Every pair of uniform values turns into two independent normal values, the
+ * radius times the cosine and the sine of the angle.
+ */
+void BulkRandom::FillNormal(
+    float* out, size_t count, float mean, float deviation) {
+  alignas(16) float block[2 * kLanes];
+#if defined(__SSE2__)
+  Lanes lanes = Load(state_);
+  __m128 scale = _mm_set1_ps(deviation);
+  __m128 offset = _mm_set1_ps(mean);
+  for (size_t i = 0; i < count; i += 2 * kLanes) {
+    // Shift the uniform value into (0, 1] so that the logarithm is finite.
+    __m128 u = _mm_add_ps(ToUnit(Next(&lanes)), _mm_set1_ps(kUnit));
+    __m128 radius = _mm_sqrt_ps(_mm_mul_ps(_mm_set1_ps(-2.0f), Log(u)));
+    __m128 sin, cos;
+    SinCos(Next(&lanes), &sin, &cos);
+
+    radius = _mm_mul_ps(radius, scale);
+    _mm_store_ps(block, _mm_add_ps(_mm_mul_ps(radius, cos), offset));
+    _mm_store_ps(block + kLanes, _mm_add_ps(_mm_mul_ps(radius, sin), offset));
+    std::copy(
+        block, block + std::min<size_t>(2 * kLanes, count - i), out + i);
+  }
+  Store(lanes, state_);
+#else
+  uint32_t radius_bits[kLanes];
+  uint32_t angle_bits[kLanes];
+  for (size_t i = 0; i < count; i += 2 * kLanes) {
+    Next(state_, radius_bits);
+    Next(state_, angle_bits);
+    for (uint32_t lane = 0; lane < kLanes; ++lane) {
+      float u = ToUnitFloat(radius_bits[lane]) + kUnit;
+      float radius = std::sqrt(-2.0f * std::log(u)) * deviation;
+      float sin, cos;
+      SinCos(angle_bits[lane], &sin, &cos);
+      block[lane] = mean + radius * cos;
+      block[kLanes + lane] = mean + radius * sin;
+    }
+    std::copy(
+        block, block + std::min<size_t>(2 * kLanes, count - i), out + i);
+  }
+#endif
+}
+
+/**
+ * The height is uniform in [-1, 1] and the angle around the up axis uniform
+ * in [0, 2pi), which by Archimedes' hat box theorem covers the sphere evenly.
+ */
+void BulkRandom::FillUnitSphere(float* x, float* y, float* z, size_t count) {
+  alignas(16) float block_x[kLanes];
+  alignas(16) float block_y[kLanes];
+  alignas(16) float block_z[kLanes];
+#if defined(__SSE2__)
+  Lanes lanes = Load(state_);
+  __m128 one = _mm_set1_ps(1.0f);
+  for (size_t i = 0; i < count; i += kLanes) {
+    __m128 height = _mm_sub_ps(
+        _mm_mul_ps(ToUnit(Next(&lanes)), _mm_set1_ps(2.0f)), one);
+    __m128 ring = _mm_sqrt_ps(_mm_max_ps(
+        _mm_sub_ps(one, _mm_mul_ps(height, height)), _mm_setzero_ps()));
+    __m128 sin, cos;
+    SinCos(Next(&lanes), &sin, &cos);
+
+    _mm_store_ps(block_x, _mm_mul_ps(ring, cos));
+    _mm_store_ps(block_y, _mm_mul_ps(ring, sin));
+    _mm_store_ps(block_z, height);
+
+    size_t valid = std::min<size_t>(kLanes, count - i);
+    std::copy(block_x, block_x + valid, x + i);
+    std::copy(block_y, block_y + valid, y + i);
+    std::copy(block_z, block_z + valid, z + i);
+  }
+  Store(lanes, state_);
+#else
+  uint32_t height_bits[kLanes];
+  uint32_t angle_bits[kLanes];
+  for (size_t i = 0; i < count; i += kLanes) {
+    Next(state_, height_bits);
+    Next(state_, angle_bits);
+    for (uint32_t lane = 0; lane < kLanes; ++lane) {
+      float height = ToUnitFloat(height_bits[lane]) * 2.0f - 1.0f;
+      float ring = std::sqrt(std::max(1.0f - height * height, 0.0f));
+      float sin, cos;
+      SinCos(angle_bits[lane], &sin, &cos);
+      block_x[lane] = ring * cos;
+      block_y[lane] = ring * sin;
+      block_z[lane] = height;
+    }
+
+    size_t valid = std::min<size_t>(kLanes, count - i);
+    std::copy(block_x, block_x + valid, x + i);
+    std::copy(block_y, block_y + valid, y + i);
+    std::copy(block_z, block_z + valid, z + i);
+  }
+#endif
+}
+
+}  // namespace random
+}  // namespace engine
@@ -0,0 +1,103 @@
+#include "core/random/Random.h"
+
+#include <atomic>
+
+#include "core/jobs/JobSystem.h"
+
+namespace engine {
+namespace random {
+
+namespace {
+
+// Threads outside of the job system draw from streams past every worker.
+constexpr uint32_t kExternalStreamBase = 1024;
+
+std::atomic<uint64_t> kSeed{0};
+std::atomic<uint32_t> kSeedGeneration{1};
+std::atomic<uint32_t> kNextExternalStream{kExternalStreamBase};
+
+struct ThreadGenerator {
+  Xoshiro256 Generator;
+  uint32_t Generation = 0;
+  uint32_t Stream = 0;
+  bool HasStream = false;
+};
+
+thread_local ThreadGenerator kThreadGenerator;
+
+}  // namespace
+
+// Lemire's multiply and shift, rejecting the few values that would bias the
+// result towards small numbers.
+uint32_t Xoshiro256::NextBelow(uint32_t bound) {
+  uint64_t product = static_cast<uint64_t>(NextUInt32()) * bound;
+  uint32_t low = static_cast<uint32_t>(product);
+  if (low < bound) {
+    uint32_t threshold = (0u - bound) % bound;
+    while (low < threshold) {
+      product = static_cast<uint64_t>(NextUInt32()) * bound;
+      low = static_cast<uint32_t>(product);
+    }
+  }
+  return static_cast<uint32_t>(product >> 32);
+}
+
+void Xoshiro256::Jump() {
+  static constexpr uint64_t kJump[] = {
+      0x180ec6d33cfd0abaull, 0xd5a61266f0c9392cull,
+      0xa9582618e03fc9aaull, 0x39abdc4529b1661cull };
+
+  uint64_t jumped[4] = { 0, 0, 0, 0 };
+  for (uint64_t polynomial : kJump) {
+    for (int bit = 0; bit < 64; ++bit) {
+      if (polynomial & (1ull << bit)) {
+        for (int i = 0; i < 4; ++i) {
+          jumped[i] ^= state_[i];
+        }
+      }
+      NextUInt64();
+    }
+  }
+
+  for (int i = 0; i < 4; ++i) {
+    state_[i] = jumped[i];
+  }
+}
+
+Xoshiro256 CreateStream(uint64_t seed, uint32_t index) {
+  Xoshiro256 generator(seed);
+  for (uint32_t i = 0; i < index; ++i) {
+    generator.Jump();
+  }
+  return generator;
+}
+
+void SetSeed(uint64_t seed) {
+  kSeed.store(seed, std::memory_order_relaxed);
+  kSeedGeneration.fetch_add(1, std::memory_order_release);
+}
+
+uint64_t GetSeed() {
+  return kSeed.load(std::memory_order_relaxed);
+}
+
+Xoshiro256& GetThreadGenerator() {
+  ThreadGenerator& thread = kThreadGenerator;
+  uint32_t generation = kSeedGeneration.load(std::memory_order_acquire);
+  if (thread.Generation != generation) {
+    if (!thread.HasStream) {
+      int worker = jobs::JobSystem::GetCurrentWorkerIndex();
+      thread.Stream = worker >= 0
+          ? static_cast<uint32_t>(worker)
+          : kNextExternalStream.fetch_add(1, std::memory_order_relaxed);
+      thread.HasStream = true;
+    }
+
+    thread.Generator = CreateStream(GetSeed(), thread.Stream);
+    thread.Generation = generation;
+  }
+  return thread.Generator;
+}
+
+}  // namespace random
+}  // namespace engine
@@ -0,0 +1,209 @@
+/**
+ * @file engine/src/core/random/Random.h
+ * @brief Fast seedable random number generators.
+ *
+ * Xoshiro256 is the general purpose generator of the engine. Its jump function
+ * splits a single seed into many streams that are guaranteed not to overlap,
+ * which is how every worker thread gets its own stream. Pcg32 has a smaller
+ * state and is cheaper to copy and hash, which suits simulations that store
+ * their generators in snapshots.
+ *
+ * All generators produce the same sequence on every platform for a given
+ * seed, so recorded seeds can be used to replay procedural generation.
+ */
+#ifndef ENGINE_SRC_CORE_RANDOM_RANDOM_H_
+#define ENGINE_SRC_CORE_RANDOM_RANDOM_H_
+
+#include <cstdint>
+
+#include "core/Core.h"
+
+namespace engine {
+namespace random {
+
+/**
+ * @fn SplitMix64
+ * @brief Advances state and returns a well mixed value. Used to expand seeds
+ * into the larger states of the other generators.
+ */
+inline uint64_t SplitMix64(uint64_t* state) {
+  uint64_t z = (*state += 0x9e3779b97f4a7c15ull);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+  return z ^ (z >> 31);
+}
+
+/**
+ * @fn ToUnitFloat
+ * @brief Converts the upper 24 bits of a value into a float in [0, 1).
+ */
+inline float ToUnitFloat(uint32_t value) {
+  return static_cast<float>(value >> 8) * (1.0f / 16777216.0f);
+}
+
+/**
+ * @fn ToUnitDouble
+ * @brief Converts the upper 53 bits of a value into a double in [0, 1).
+ */
+inline double ToUnitDouble(uint64_t value) {
+  return static_cast<double>(value >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// ---------------------------------- XOSHIRO256 -------------------------------
+
+/**
+ * @class Xoshiro256
+ * @brief The xoshiro256** generator by Blackman and Vigna.
+ */
+class ENGINE_API Xoshiro256 {
+ public:
+  explicit Xoshiro256(uint64_t seed = 0) { Seed(seed); }
+
+  inline void Seed(uint64_t seed) {
+    for (uint64_t& word : state_) {
+      word = SplitMix64(&seed);
+    }
+  }
+
+  inline uint64_t NextUInt64() {
+    uint64_t result = RotateLeft(state_[1] * 5, 7) * 9;
+    uint64_t t = state_[1] << 17;
+    state_[2] ^= state_[0];
+    state_[3] ^= state_[1];
+    state_[1] ^= state_[2];
+    state_[0] ^= state_[3];
+    state_[2] ^= t;
+    state_[3] = RotateLeft(state_[3], 45);
+    return result;
+  }
+
+  inline uint32_t NextUInt32()
+      { return static_cast<uint32_t>(NextUInt64() >> 32); }
+  inline float NextFloat() { return ToUnitFloat(NextUInt32()); }
+  inline double NextDouble() { return ToUnitDouble(NextUInt64()); }
+
+  /**
+   * @fn NextFloat
+   * @brief Get a uniformly distributed float in [low, high).
+   */
+  inline float NextFloat(float low, float high)
+      { return low + (high - low) * NextFloat(); }
+
+  /**
+   * @fn NextBelow
+   * @brief Get a uniformly distributed integer in [0, bound) without bias.
+   */
+  uint32_t NextBelow(uint32_t bound);
+
+  /**
+   * @fn Jump
+   * @brief Advances the generator by 2^128 steps. Calling Jump n times on
+   * copies of one generator yields n streams that never overlap.
+   */
+  void Jump();
+
+  inline const uint64_t* GetState() const { return state_; }
+
+ private:
+  uint64_t state_[4];
+
+  static inline uint64_t RotateLeft(uint64_t value, int count)
+      { return (value << count) | (value >> (64 - count)); }
+};
+
+// ------------------------------------ PCG32 ----------------------------------
+
+/**
+ * @class Pcg32
+ * @brief The PCG-XSH-RR generator by O'Neill with 64 bits of state.
+ */
+class ENGINE_API Pcg32 {
+ public:
+  explicit Pcg32(uint64_t seed = 0, uint64_t stream = 0) {
+    Seed(seed, stream);
+  }
+
+  /**
+   * @fn Seed
+   * @param seed The starting point within the sequence.
+   * @param stream Selects one of 2^63 independent sequences.
+   */
+  inline void Seed(uint64_t seed, uint64_t stream = 0) {
+    state_ = 0;
+    increment_ = (stream << 1) | 1;
+    NextUInt32();
+    state_ += seed;
+    NextUInt32();
+  }
+
+  inline uint32_t NextUInt32() {
+    uint64_t state = state_;
+    state_ = state * 6364136223846793005ull + increment_;
+    uint32_t xorshifted = static_cast<uint32_t>(((state >> 18) ^ state) >> 27);
+    uint32_t rotation = static_cast<uint32_t>(state >> 59);
+    return (xorshifted >> rotation) | (xorshifted << ((32 - rotation) & 31));
+  }
+
+  inline float NextFloat() { return ToUnitFloat(NextUInt32()); }
+  inline float NextFloat(float low, float high)
+      { return low + (high - low) * NextFloat(); }
+
+  /**
+   * @fn NextBelow
+   * @brief Get a uniformly distributed integer in [0, bound) without bias.
+   */
+  inline uint32_t NextBelow(uint32_t bound) {
+    if (bound == 0) {
+      return 0;
+    }
+
+    uint32_t threshold = (0u - bound) % bound;
+    for (;;) {
+      uint32_t value = NextUInt32();
+      if (value >= threshold) {
+        return value % bound;
+      }
+    }
+  }
+
+  inline uint64_t GetState() const { return state_; }
+  inline uint64_t GetIncrement() const { return increment_; }
+
+ private:
+  uint64_t state_;
+  uint64_t increment_;
+};
+
+// ----------------------------------- STREAMS ---------------------------------
+
+/**
+ * @fn CreateStream
+ * @brief Get the generator for stream index of a seed. Work that has to be
+ * replayable should draw from streams indexed by the work item rather than by
+ * the thread that happens to execute it.
+ */
+ENGINE_API Xoshiro256 CreateStream(uint64_t seed, uint32_t index);
+
+/**
+ * @fn SetSeed
+ * @brief Sets the seed of the per thread generators. Every thread reseeds its
+ * generator the next time it calls GetThreadGenerator.
+ */
+ENGINE_API void SetSeed(uint64_t seed);
+
+ENGINE_API uint64_t GetSeed();
+
+/**
+ * @fn GetThreadGenerator
+ * @brief Get the generator of the calling thread.
+ *
+ * Job system workers use the stream of their worker index, so their sequences
+ * only depend on the seed. Every other thread is assigned a stream of its own
+ * on first use. Generators are never shared and never need to be locked.
+ */
+ENGINE_API Xoshiro256& GetThreadGenerator();
+
+}  // namespace random
+}  // namespace engine
+
+#endif  // ENGINE_SRC_CORE_RANDOM_RANDOM_H_
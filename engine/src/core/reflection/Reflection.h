@@ -0,0 +1,232 @@
+/**
+ * @file engine/src/core/reflection/Reflection.h
+ * @brief Compile time reflection for engine components.
+ *
+ * Components are registered with the `ENGINE_REFLECT_*` macros, which generate
+ * a `constexpr` table describing every field (name hash, offset, type, size and
+ * flags) of the component. The tables are resolved entirely at compile time and
+ * require neither RTTI nor virtual calls, which allows serialization,
+ * replication and tooling to enumerate component fields without paying for
+ * them at runtime.
+ */
+
+/**
+ * @def ENGINE_REFLECT_BEGIN(type)
+ * @param type The fully qualified name of the component being reflected.
+ * @brief Opens the reflection table for a component.
+ *
+ * Must be invoked from the global namespace and closed with
+ * `ENGINE_REFLECT_END()`. e.g.
+ * ```
+ * ENGINE_REFLECT_BEGIN(game::Health)
+ *   ENGINE_REFLECT_FIELD(current, engine::reflection::kFieldFlagReplicated)
+ *   ENGINE_REFLECT_FIELD(maximum, engine::reflection::kFieldFlagNone)
+ * ENGINE_REFLECT_END()
+ * ```
+ */
+
+/**
+ * @def ENGINE_REFLECT_FIELD(field, flags)
+ * @param field The name of the member variable being reflected.
+ * @param flags A combination of `FieldFlags` for the field.
+ * @brief Registers a field inside of a reflection table.
+ */
+
+/**
+ * @def ENGINE_REFLECT_END()
+ * @brief Closes the reflection table for a component.
+ */
+
+#ifndef ENGINE_SRC_CORE_REFLECTION_REFLECTION_H_
+#define ENGINE_SRC_CORE_REFLECTION_REFLECTION_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "core/Core.h"
+
+namespace engine {
+namespace reflection {
+
+// ------------------------------- FIELD METADATA ------------------------------
+
+/**
+ * @enum FieldType
+ * @brief The primitive type of a reflected field.
+ *
+ * Any field type that isn't known to the engine is reflected as a Blob, which
+ * is copied byte for byte by the serializers.
+ */
+enum class FieldType : uint8_t {
+  None = 0,
+  Bool,
+  Int8, Int16, Int32, Int64,
+  UInt8, UInt16, UInt32, UInt64,
+  Float, Double,
+  Blob,
+};
+
+/**
+ * @enum FieldFlags
+ * @brief Flags describing how a reflected field is to be treated by the
+ * serializers and tools.
+ */
+enum FieldFlags {
+  kFieldFlagNone = 0,
+  kFieldFlagReplicated = BIT(0),
+  kFieldFlagTransient = BIT(1),
+  kFieldFlagEditorHidden = BIT(2)
+};
+
+/**
+ * @fn HashName
+ * @param name The null terminated name to hash.
+ * @brief 32 bit FNV-1a hash of a name that can be evaluated at compile time.
+ */
+constexpr uint32_t HashName(const char* name, uint32_t hash = 2166136261u) {
+  return *name == '\0'
+      ? hash
+      : HashName(
+          name + 1,
+          (hash ^ static_cast<uint8_t>(*name)) * 16777619u);
+}
+
+/**
+ * @struct FieldTypeOf
+ * @brief Maps a C++ type onto its FieldType.
+ */
+template<typename T> struct FieldTypeOf
+    { static constexpr FieldType value = FieldType::Blob; };
+
+#define ENGINE_REFLECTION_FIELD_TYPE(cpp_type, field_type) \
+    template<> struct FieldTypeOf<cpp_type> \
+        { static constexpr FieldType value = FieldType::field_type; };
+
+ENGINE_REFLECTION_FIELD_TYPE(bool, Bool)
+ENGINE_REFLECTION_FIELD_TYPE(int8_t, Int8)
+ENGINE_REFLECTION_FIELD_TYPE(int16_t, Int16)
+ENGINE_REFLECTION_FIELD_TYPE(int32_t, Int32)
+ENGINE_REFLECTION_FIELD_TYPE(int64_t, Int64)
+ENGINE_REFLECTION_FIELD_TYPE(uint8_t, UInt8)
+ENGINE_REFLECTION_FIELD_TYPE(uint16_t, UInt16)
+ENGINE_REFLECTION_FIELD_TYPE(uint32_t, UInt32)
+ENGINE_REFLECTION_FIELD_TYPE(uint64_t, UInt64)
+ENGINE_REFLECTION_FIELD_TYPE(float, Float)
+ENGINE_REFLECTION_FIELD_TYPE(double, Double)
+
+#undef ENGINE_REFLECTION_FIELD_TYPE
+
+/**
+ * @struct FieldInfo
+ * @brief The reflected description of a single component field.
+ */
+struct FieldInfo {
+  uint32_t NameHash;
+  const char* Name;
+  uint32_t Offset;
+  uint32_t Size;
+  FieldType Type;
+  uint32_t Flags;
+};
+
+/**
+ * @struct TypeInfo
+ * @brief The reflected description of a component.
+ *
+ * Trivial components can be serialized with a single memcpy over an array of
+ * components, while the field table is used for per field operations such as
+ * delta encoding.
+ */
+struct TypeInfo {
+  uint32_t NameHash;
+  const char* Name;
+  uint32_t Size;
+  uint32_t Alignment;
+  bool IsTrivial;
+  const FieldInfo* Fields;
+  uint32_t FieldCount;
+
+  /**
+   * @fn FindField
+   * @brief Find a field by its name hash. Returns nullptr if the component has
+   * no field with the given hash.
+   */
+  const FieldInfo* FindField(uint32_t name_hash) const {
+    for (uint32_t i = 0; i < FieldCount; ++i) {
+      if (Fields[i].NameHash == name_hash) {
+        return &Fields[i];
+      }
+    }
+    return nullptr;
+  }
+};
+
+// ----------------------------------- REGISTRY --------------------------------
+
+/**
+ * @struct TypeReflection
+ * @brief Specialized by `ENGINE_REFLECT_BEGIN` for every reflected component.
+ *
+ * Only specializations are ever defined, so using an unreflected type is a
+ * compile time error rather than a runtime one.
+ */
+template<typename T> struct TypeReflection;
+
+/**
+ * @fn GetTypeInfo
+ * @brief Get the reflected TypeInfo of a component.
+ */
+template<typename T>
+inline const TypeInfo& GetTypeInfo() { return TypeReflection<T>::Get(); }
+
+/**
+ * @fn GetTypeHash
+ * @brief Get the name hash of a reflected component.
+ */
+template<typename T>
+inline uint32_t GetTypeHash() { return TypeReflection<T>::Get().NameHash; }
+
+}  // namespace reflection
+}  // namespace engine
+
+// ------------------------------------- MACROS --------------------------------
+
+#define ENGINE_REFLECT_BEGIN(type) \
+    namespace engine { \
+    namespace reflection { \
+    template<> struct TypeReflection<type> { \
+      using Reflected = type; \
+      static constexpr const char* GetName() { return #type; } \
+      static const TypeInfo& Get() { \
+        static constexpr FieldInfo kFields[] = {
+
+#define ENGINE_REFLECT_FIELD(field, flags) \
+          { \
+            HashName(#field), \
+            #field, \
+            static_cast<uint32_t>(offsetof(Reflected, field)), \
+            static_cast<uint32_t>(sizeof(Reflected::field)), \
+            FieldTypeOf<std::remove_cv< \
+                decltype(Reflected::field)>::type>::value, \
+            static_cast<uint32_t>(flags) \
+          },
+
+#define ENGINE_REFLECT_END() \
+        }; \
+        static constexpr TypeInfo kInfo = { \
+          HashName(GetName()), \
+          GetName(), \
+          static_cast<uint32_t>(sizeof(Reflected)), \
+          static_cast<uint32_t>(alignof(Reflected)), \
+          std::is_trivially_copyable<Reflected>::value, \
+          kFields, \
+          static_cast<uint32_t>(sizeof(kFields) / sizeof(kFields[0])) \
+        }; \
+        return kInfo; \
+      } \
+    }; \
+    }  /* namespace reflection */ \
+    }  /* namespace engine */
+
+#endif  // ENGINE_SRC_CORE_REFLECTION_REFLECTION_H_
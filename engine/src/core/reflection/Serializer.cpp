@@ -0,0 +1,170 @@
+#include "core/reflection/Serializer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "core/Assert.h"
+#include "core/Log.h"
+
+namespace engine {
+namespace reflection {
+
+namespace {
+
+// Delta masks are stored as a single 64 bit word, which bounds the number of
+// fields a component can expose to replication.
+constexpr uint32_t kMaxDeltaFields = 64;
+
+void Append(std::vector<uint8_t>* out, const void* data, size_t size) {
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+  out->insert(out->end(), bytes, bytes + size);
+}
+
+bool IsDeltaField(const FieldInfo& field, uint32_t required_flags) {
+  return !(field.Flags & kFieldFlagTransient)
+      && (field.Flags & required_flags) == required_flags;
+}
+
+}  // namespace
+
+void WriteComponentBlock(
+    const TypeInfo& info,
+    const void* components,
+    uint32_t count,
+    std::vector<uint8_t>* out) {
+  ENGINE_CORE_ASSERT(
+      info.IsTrivial, "Only trivial components can be written as a block.");
+
+  ComponentBlockHeader header = { info.NameHash, info.Size, count };
+  size_t payload_size = static_cast<size_t>(info.Size) * count;
+
+  out->reserve(out->size() + sizeof(header) + payload_size);
+  Append(out, &header, sizeof(header));
+  Append(out, components, payload_size);
+}
+
+uint32_t ReadComponentBlock(
+    const TypeInfo& info,
+    const uint8_t* data,
+    size_t size,
+    void* components,
+    uint32_t capacity,
+    size_t* bytes_read) {
+  *bytes_read = 0;
+
+  ComponentBlockHeader header;
+  if (size < sizeof(header)) {
+    ENGINE_CORE_ERROR("Component block for {0} is truncated.", info.Name);
+    return 0;
+  }
+
+  std::memcpy(&header, data, sizeof(header));
+  if (header.TypeHash != info.NameHash || header.ComponentSize != info.Size) {
+    ENGINE_CORE_ERROR(
+        "Component block doesn't match the layout of {0}.", info.Name);
+    return 0;
+  }
+
+  size_t payload_size = static_cast<size_t>(header.ComponentSize)
+      * header.Count;
+  if (size - sizeof(header) < payload_size || header.Count > capacity) {
+    ENGINE_CORE_ERROR(
+        "Component block for {0} has {1} components but only {2} fit.",
+        info.Name,
+        header.Count,
+        capacity);
+    return 0;
+  }
+
+  std::memcpy(components, data + sizeof(header), payload_size);
+  *bytes_read = sizeof(header) + payload_size;
+  return header.Count;
+}
+
+/**
+ * The mask is reserved up front and patched once all fields have been compared
+ * so that the current state only has to be traversed once.
+ */
+uint32_t WriteDelta(
+    const TypeInfo& info,
+    const void* baseline,
+    const void* current,
+    uint32_t required_flags,
+    std::vector<uint8_t>* out) {
+  ENGINE_CORE_ASSERT(
+      info.FieldCount <= kMaxDeltaFields,
+      "Components can only replicate up to 64 fields.");
+
+  const uint8_t* old_bytes = static_cast<const uint8_t*>(baseline);
+  const uint8_t* new_bytes = static_cast<const uint8_t*>(current);
+
+  size_t mask_location = out->size();
+  uint64_t mask = 0;
+  uint32_t changed = 0;
+  out->resize(mask_location + sizeof(mask));
+
+  for (uint32_t i = 0; i < info.FieldCount; ++i) {
+    const FieldInfo& field = info.Fields[i];
+    if (!IsDeltaField(field, required_flags)) {
+      continue;
+    }
+
+    const uint8_t* new_value = new_bytes + field.Offset;
+    if (std::memcmp(old_bytes + field.Offset, new_value, field.Size) != 0) {
+      mask |= uint64_t(1) << i;
+      Append(out, new_value, field.Size);
+      ++changed;
+    }
+  }
+
+  if (changed == 0) {
+    out->resize(mask_location);
+    return 0;
+  }
+
+  std::memcpy(out->data() + mask_location, &mask, sizeof(mask));
+  return changed;
+}
+
+size_t ReadDelta(
+    const TypeInfo& info, const uint8_t* data, size_t size, void* target) {
+  uint64_t mask;
+  if (size < sizeof(mask)) {
+    ENGINE_CORE_ERROR("Delta for {0} is truncated.", info.Name);
+    return 0;
+  }
+  std::memcpy(&mask, data, sizeof(mask));
+
+  // The whole delta is validated before any of it is applied, so a malformed
+  // one leaves the target untouched.
+  uint32_t field_count = std::min(info.FieldCount, kMaxDeltaFields);
+  if (field_count < kMaxDeltaFields && (mask >> field_count) != 0) {
+    ENGINE_CORE_ERROR("Delta for {0} has unknown fields.", info.Name);
+    return 0;
+  }
+  size_t delta_size = sizeof(mask);
+  for (uint32_t i = 0; i < field_count; ++i) {
+    if (mask & (uint64_t(1) << i)) {
+      delta_size += info.Fields[i].Size;
+    }
+  }
+  if (size < delta_size) {
+    ENGINE_CORE_ERROR("Delta for {0} is truncated.", info.Name);
+    return 0;
+  }
+
+  uint8_t* target_bytes = static_cast<uint8_t*>(target);
+  size_t offset = sizeof(mask);
+  for (uint32_t i = 0; i < field_count; ++i) {
+    if (mask & (uint64_t(1) << i)) {
+      const FieldInfo& field = info.Fields[i];
+      std::memcpy(target_bytes + field.Offset, data + offset, field.Size);
+      offset += field.Size;
+    }
+  }
+  return offset;
+}
+
+}  // namespace reflection
+}  // namespace engine
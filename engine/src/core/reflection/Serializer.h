@@ -0,0 +1,138 @@
+/**
+ * @file engine/src/core/reflection/Serializer.h
+ * @brief Binary serialization built on top of the reflection tables.
+ *
+ * Trivial components are written as a single memcpy-able block per component
+ * array, while replication uses per field delta encoding against a baseline.
+ * All data is written in the native byte order of the machine.
+ */
+#ifndef ENGINE_SRC_CORE_REFLECTION_SERIALIZER_H_
+#define ENGINE_SRC_CORE_REFLECTION_SERIALIZER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#include "core/Core.h"
+#include "core/reflection/Reflection.h"
+
+namespace engine {
+namespace reflection {
+
+/**
+ * @struct ComponentBlockHeader
+ * @brief Precedes every block of components written by WriteComponentBlock.
+ */
+struct ComponentBlockHeader {
+  uint32_t TypeHash;
+  uint32_t ComponentSize;
+  uint32_t Count;
+};
+
+/**
+ * @fn WriteComponentBlock
+ * @param info The reflected type of the components.
+ * @param components A contiguous array of components.
+ * @param count The number of components in the array.
+ * @param out The buffer that the block is appended to.
+ * @brief Appends a header followed by the raw bytes of all components.
+ *
+ * Only trivial components can be written as a block.
+ */
+ENGINE_API void WriteComponentBlock(
+    const TypeInfo& info,
+    const void* components,
+    uint32_t count,
+    std::vector<uint8_t>* out);
+
+/**
+ * @fn ReadComponentBlock
+ * @param info The reflected type of the components being read.
+ * @param data The start of a block written by WriteComponentBlock.
+ * @param size The number of readable bytes at data.
+ * @param components The array that the components are copied into.
+ * @param capacity The number of components that fit in the array.
+ * @param bytes_read Set to the number of bytes consumed from data.
+ * @brief Copies a block of components back into an array.
+ *
+ * Returns the number of components read, or 0 if the block doesn't belong to
+ * the given type or is malformed.
+ */
+ENGINE_API uint32_t ReadComponentBlock(
+    const TypeInfo& info,
+    const uint8_t* data,
+    size_t size,
+    void* components,
+    uint32_t capacity,
+    size_t* bytes_read);
+
+/**
+ * @fn WriteDelta
+ * @param info The reflected type of the component.
+ * @param baseline The last state of the component known to the reader.
+ * @param current The current state of the component.
+ * @param required_flags Only fields containing all of these flags are encoded.
+ * @param out The buffer that the delta is appended to.
+ * @brief Appends a bitmask of changed fields followed by their new values.
+ *
+ * Nothing is written when no field has changed, which lets callers skip
+ * unchanged components entirely. Transient fields are never encoded. Returns
+ * the number of fields that were encoded.
+ */
+ENGINE_API uint32_t WriteDelta(
+    const TypeInfo& info,
+    const void* baseline,
+    const void* current,
+    uint32_t required_flags,
+    std::vector<uint8_t>* out);
+
+/**
+ * @fn ReadDelta
+ * @param info The reflected type of the component.
+ * @param data The start of a delta written by WriteDelta.
+ * @param size The number of readable bytes at data.
+ * @param target The component that the delta is applied to.
+ * @brief Applies a delta to a component. Returns the number of bytes consumed
+ * or 0 if the delta is malformed.
+ */
+ENGINE_API size_t ReadDelta(
+    const TypeInfo& info, const uint8_t* data, size_t size, void* target);
+
+// --------------------------------- TYPED HELPERS -----------------------------
+
+/**
+ * @fn SerializeComponents
+ * @brief Typed convenience wrapper around WriteComponentBlock.
+ */
+template<typename T>
+inline void SerializeComponents(
+    const T* components, uint32_t count, std::vector<uint8_t>* out) {
+  static_assert(
+      std::is_trivially_copyable<T>::value,
+      "Only trivially copyable components can be serialized as a block.");
+  WriteComponentBlock(GetTypeInfo<T>(), components, count, out);
+}
+
+/**
+ * @fn DeserializeComponents
+ * @brief Typed convenience wrapper around ReadComponentBlock.
+ */
+template<typename T>
+inline uint32_t DeserializeComponents(
+    const uint8_t* data,
+    size_t size,
+    T* components,
+    uint32_t capacity,
+    size_t* bytes_read) {
+  static_assert(
+      std::is_trivially_copyable<T>::value,
+      "Only trivially copyable components can be serialized as a block.");
+  return ReadComponentBlock(
+      GetTypeInfo<T>(), data, size, components, capacity, bytes_read);
+}
+
+}  // namespace reflection
+}  // namespace engine
+
+#endif  // ENGINE_SRC_CORE_REFLECTION_SERIALIZER_H_
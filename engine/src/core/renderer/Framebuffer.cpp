@@ -0,0 +1,27 @@
+#include "core/renderer/Framebuffer.h"
+
+#include "core/Assert.h"
+#include "core/renderer/Renderer.h"
+#include "platform/opengl/OpenGLFramebuffer.h"
+
+namespace engine {
+namespace renderer {
+
+Framebuffer* Framebuffer::Create(uint32_t width, uint32_t height) {
+  switch (Renderer::GetAPI()) {
+    case RendererAPI::None:
+      ENGINE_CORE_ASSERT(
+          false, "There is no rendering API being used/available.");
+      return nullptr;
+    case RendererAPI::OpenGL:
+      return new platform::opengl::OpenGLFramebuffer(width, height);
+    default:
+      ENGINE_CORE_ASSERT(
+          false,
+          "The Renderer has been set to a graphics API that isn't supported.");
+      return nullptr;
+  }
+}
+
+}  // namespace renderer
+}  // namespace engine
@@ -0,0 +1,98 @@
+/**
+ * @file engine/src/core/renderer/Framebuffer.h
+ * @brief Offscreen render targets that can be upscaled to the window.
+ *
+ * A framebuffer allocates its color and depth storage once for its full
+ * size, and renders into a rectangle of any size up to that in the corner of
+ * it. Changing the render size every few frames, as dynamic resolution does,
+ * then only changes the viewport instead of reallocating GPU memory.
+ */
+#ifndef ENGINE_SRC_CORE_RENDERER_FRAMEBUFFER_H_
+#define ENGINE_SRC_CORE_RENDERER_FRAMEBUFFER_H_
+
+#include <cstdint>
+
+namespace engine {
+namespace renderer {
+
+/**
+ * @enum UpscaleFilter
+ * @brief How a framebuffer is stretched to a larger size.
+ */
+enum class UpscaleFilter {
+  // Bilinear filtering, which is the cheapest but softens the image.
+  Bilinear = 0,
+
+  // Bilinear filtering followed by a sharpening pass that restores some of
+  // the contrast lost to the lower resolution.
+  Sharpened = 1,
+};
+
+/**
+ * @class Framebuffer
+ * @brief The base Framebuffer class to be used for creating render targets.
+ *
+ * Platform specific graphics API should extend this class in order to be
+ * supported by the the rendering API.
+ */
+class Framebuffer {
+ public:
+  virtual ~Framebuffer() {}
+
+  /**
+   * @fn Bind
+   * @brief Makes the framebuffer the target of rendering, with the viewport
+   * set to its render size.
+   */
+  virtual void Bind() const = 0;
+
+  /**
+   * @fn Unbind
+   * @brief Makes the window the target of rendering again. The viewport is
+   * left to the caller.
+   */
+  virtual void Unbind() const = 0;
+
+  /**
+   * @fn Resize
+   * @brief Reallocates the framebuffer, which also resets the render size to
+   * the full size.
+   */
+  virtual void Resize(uint32_t width, uint32_t height) = 0;
+
+  /**
+   * @fn SetRenderSize
+   * @brief Sets the size of the rectangle that is rendered into, which is
+   * clamped to the size of the framebuffer.
+   */
+  virtual void SetRenderSize(uint32_t width, uint32_t height) = 0;
+
+  virtual uint32_t GetWidth() const = 0;
+  virtual uint32_t GetHeight() const = 0;
+  virtual uint32_t GetRenderWidth() const = 0;
+  virtual uint32_t GetRenderHeight() const = 0;
+
+  /**
+   * @fn Upscale
+   * @brief Stretches the rendered rectangle over the window, from its bottom
+   * left corner to the given size.
+   * @param sharpness How strongly the Sharpened filter sharpens, from 0 to 1.
+   */
+  virtual void Upscale(
+      uint32_t width,
+      uint32_t height,
+      UpscaleFilter filter,
+      float sharpness) const = 0;
+
+  /**
+   * @fn Create
+   * @brief Creates a Framebuffer through the Graphics API that is being used
+   * at compile time.
+   */
+  static Framebuffer* Create(uint32_t width, uint32_t height);
+};
+
+}  // namespace renderer
+}  // namespace engine
+
+#endif  // ENGINE_SRC_CORE_RENDERER_FRAMEBUFFER_H_
@@ -0,0 +1,27 @@
+#include "core/renderer/GpuTimer.h"
+
+#include "core/Assert.h"
+#include "core/renderer/Renderer.h"
+#include "platform/opengl/OpenGLGpuTimer.h"
+
+namespace engine {
+namespace renderer {
+
+GpuTimer* GpuTimer::Create() {
+  switch (Renderer::GetAPI()) {
+    case RendererAPI::None:
+      ENGINE_CORE_ASSERT(
+          false, "There is no rendering API being used/available.");
+      return nullptr;
+    case RendererAPI::OpenGL:
+      return new platform::opengl::OpenGLGpuTimer();
+    default:
+      ENGINE_CORE_ASSERT(
+          false,
+          "The Renderer has been set to a graphics API that isn't supported.");
+      return nullptr;
+  }
+}
+
+}  // namespace renderer
+}  // namespace engine
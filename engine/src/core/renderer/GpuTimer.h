@@ -0,0 +1,58 @@
+/**
+ * @file engine/src/core/renderer/GpuTimer.h
+ * @brief Measures how long the GPU spends on a span of rendering commands.
+ *
+ * The GPU runs a few frames behind the CPU, so a measurement only becomes
+ * available some frames after it was taken. Timers keep several measurements
+ * in flight and never wait for one, reporting the most recent one that has
+ * arrived instead.
+ */
+#ifndef ENGINE_SRC_CORE_RENDERER_GPUTIMER_H_
+#define ENGINE_SRC_CORE_RENDERER_GPUTIMER_H_
+
+namespace engine {
+namespace renderer {
+
+/**
+ * @class GpuTimer
+ * @brief The base GpuTimer class to be used for creating GPU timers.
+ *
+ * Platform specific graphics API should extend this class in order to be
+ * supported by the the rendering API.
+ */
+class GpuTimer {
+ public:
+  virtual ~GpuTimer() {}
+
+  /**
+   * @fn Begin
+   * @brief Starts measuring the commands issued until End. Spans can't be
+   * nested or overlap with another timer's.
+   */
+  virtual void Begin() = 0;
+
+  /**
+   * @fn End
+   * @brief Stops measuring and picks up the measurements that arrived.
+   */
+  virtual void End() = 0;
+
+  /**
+   * @fn GetElapsedTime
+   * @brief Get the GPU time of the most recently completed span in seconds,
+   * or a negative value if none has completed yet.
+   */
+  virtual double GetElapsedTime() const = 0;
+
+  /**
+   * @fn Create
+   * @brief Creates a GpuTimer through the Graphics API that is being used at
+   * compile time.
+   */
+  static GpuTimer* Create();
+};
+
+}  // namespace renderer
+}  // namespace engine
+
+#endif  // ENGINE_SRC_CORE_RENDERER_GPUTIMER_H_
@@ -0,0 +1,57 @@
+#include "core/renderer/QuadBatch.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include "core/Assert.h"
+
+namespace engine {
+namespace renderer {
+
+QuadBatch::QuadBatch(uint32_t capacity) {
+  Reserve(capacity);
+}
+
+QuadInstance* QuadBatch::Allocate(uint32_t count) {
+  if (count_ + count > capacity_) {
+    Reserve(std::max(count_ + count, capacity_ * 2));
+  }
+  QuadInstance* first = quads_.get() + count_;
+  count_ += count;
+  return first;
+}
+
+void QuadBatch::Truncate(uint32_t count) {
+  ENGINE_CORE_ASSERT(count <= count_, "Can't truncate a batch to grow it.");
+  count_ = count;
+}
+
+// Quads are never constructed, so the batch doesn't pay to zero memory that
+// is about to be overwritten.
+void QuadBatch::Reserve(uint32_t capacity) {
+  if (capacity <= capacity_) {
+    return;
+  }
+  std::unique_ptr<QuadInstance[]> quads(new QuadInstance[capacity]);
+  if (count_ > 0) {
+    std::memcpy(quads.get(), quads_.get(), count_ * sizeof(QuadInstance));
+  }
+  quads_ = std::move(quads);
+  capacity_ = capacity;
+}
+
+void QuadBatch::ForEachRun(
+    const std::function<void(uint32_t, uint32_t, uint32_t)>& function)
+    const {
+  uint32_t first = 0;
+  for (uint32_t i = 1; i <= count_; ++i) {
+    if (i == count_ || quads_[i].Texture != quads_[first].Texture) {
+      function(quads_[first].Texture, first, i - first);
+      first = i;
+    }
+  }
+}
+
+}  // namespace renderer
+}  // namespace engine
@@ -0,0 +1,95 @@
+/**
+ * @file engine/src/core/renderer/QuadBatch.h
+ * @brief Textured quads collected on the CPU and drawn in as few draw calls as
+ * the textures allow.
+ *
+ * Systems that draw many small sprites (projectiles, particles, animated
+ * sprites) write one QuadInstance per sprite into a batch every frame, often
+ * from several jobs at once into ranges they allocated up front. The batch is
+ * uploaded as instance data in one go, and ForEachRun splits it into runs of
+ * quads that share a texture, each of which is a single instanced draw.
+ */
+#ifndef ENGINE_SRC_CORE_RENDERER_QUADBATCH_H_
+#define ENGINE_SRC_CORE_RENDERER_QUADBATCH_H_
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+#include "core/Core.h"
+
+namespace engine {
+namespace renderer {
+
+/**
+ * @struct QuadInstance
+ * @brief A rotated, textured quad.
+ *
+ * The quad spans Axis in both directions along its local x axis, and
+ * HalfHeight along the perpendicular, so a rotation costs nothing to apply
+ * when the direction is already known. Color is RGBA with 8 bits per channel
+ * and red in the lowest byte.
+ */
+struct QuadInstance {
+  float X, Y;
+  float AxisX, AxisY;
+  float HalfHeight;
+  float U0, V0, U1, V1;
+  uint32_t Color;
+  uint32_t Texture;
+};
+
+/**
+ * @class QuadBatch
+ * @brief A growable array of quads that is refilled every frame.
+ */
+class ENGINE_API QuadBatch {
+ public:
+  explicit QuadBatch(uint32_t capacity = 0);
+
+  QuadBatch(const QuadBatch&) = delete;
+  QuadBatch& operator=(const QuadBatch&) = delete;
+
+  /**
+   * @fn Allocate
+   * @brief Appends count uninitialized quads and returns the first.
+   *
+   * The pointer stays valid until the next call that grows the batch, so
+   * callers that fill the quads in parallel should allocate all of them
+   * first.
+   */
+  QuadInstance* Allocate(uint32_t count);
+
+  /**
+   * @fn Truncate
+   * @brief Drops every quad from index count on.
+   */
+  void Truncate(uint32_t count);
+
+  inline void Clear() { count_ = 0; }
+
+  void Reserve(uint32_t capacity);
+
+  /**
+   * @fn ForEachRun
+   * @brief Invokes function(texture, first, count) for every run of
+   * consecutive quads that share a texture.
+   */
+  void ForEachRun(
+      const std::function<void(uint32_t, uint32_t, uint32_t)>& function)
+      const;
+
+  inline QuadInstance* GetQuads() { return quads_.get(); }
+  inline const QuadInstance* GetQuads() const { return quads_.get(); }
+  inline uint32_t GetCount() const { return count_; }
+
+ private:
+  std::unique_ptr<QuadInstance[]> quads_;
+  uint32_t count_ = 0;
+  uint32_t capacity_ = 0;
+};
+
+}  // namespace renderer
+}  // namespace engine
+
+#endif  // ENGINE_SRC_CORE_RENDERER_QUADBATCH_H_
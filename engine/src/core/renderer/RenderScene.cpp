@@ -0,0 +1,139 @@
+#include "core/renderer/RenderScene.h"
+
+#include <thread>
+
+namespace engine {
+namespace renderer {
+
+namespace {
+
+constexpr math::Matrix4 kIdentity = {{
+    {1.0f, 0.0f, 0.0f, 0.0f},
+    {0.0f, 1.0f, 0.0f, 0.0f},
+    {0.0f, 0.0f, 1.0f, 0.0f},
+    {0.0f, 0.0f, 0.0f, 1.0f}}};
+
+constexpr uint8_t kDirtyAll = 0x7;
+
+}  // namespace
+
+RenderScene::RenderScene() {}
+
+// -------------------------------- SIMULATION ---------------------------------
+
+ProxyHandle RenderScene::CreateProxy() {
+  ProxyHandle handle = handles_.Allocate();
+  uint32_t proxy = handle.Index;
+  if (proxy < staging_.GetProxyCount()) {
+    staging_.Transforms[proxy] = kIdentity;
+    staging_.Materials[proxy] = 0;
+    staging_.VisibilityMasks[proxy] = 0;
+  } else {
+    staging_.Transforms.push_back(kIdentity);
+    staging_.Materials.push_back(0);
+    staging_.VisibilityMasks.push_back(0);
+    for (Buffer& buffer : buffers_) {
+      buffer.Dirty.push_back(0);
+    }
+  }
+  MarkDirty(proxy, kDirtyAll);
+  return handle;
+}
+
+void RenderScene::DestroyProxy(ProxyHandle proxy) {
+  SetVisibilityMask(proxy, 0);
+  handles_.Free(proxy);
+}
+
+void RenderScene::SetTransform(
+    ProxyHandle proxy, const math::Matrix4& transform) {
+  if (handles_.IsAlive(proxy)) {
+    staging_.Transforms[proxy.Index] = transform;
+    MarkDirty(proxy.Index, kDirtyTransform);
+  }
+}
+
+void RenderScene::SetMaterial(ProxyHandle proxy, uint32_t material) {
+  if (handles_.IsAlive(proxy)) {
+    staging_.Materials[proxy.Index] = material;
+    MarkDirty(proxy.Index, kDirtyMaterial);
+  }
+}
+
+void RenderScene::SetVisibilityMask(ProxyHandle proxy, uint32_t mask) {
+  if (handles_.IsAlive(proxy)) {
+    staging_.VisibilityMasks[proxy.Index] = mask;
+    MarkDirty(proxy.Index, kDirtyVisibility);
+  }
+}
+
+/**
+ * Readers announce themselves before checking which buffer is published, and
+ * Sync checks for readers after choosing its buffer, so either the reader
+ * sees that its buffer is no longer published and retries, or Sync sees the
+ * reader and waits for it.
+ */
+uint32_t RenderScene::Sync() {
+  uint32_t back = 1 - published_.load(std::memory_order_relaxed);
+  Buffer& buffer = buffers_[back];
+  while (buffer.Readers.load() != 0) {
+    std::this_thread::yield();
+  }
+
+  // New proxies only ever extend the arrays, and are dirty in every field.
+  RenderFrame& frame = buffer.Frame;
+  uint32_t count = staging_.GetProxyCount();
+  frame.Transforms.resize(count);
+  frame.Materials.resize(count);
+  frame.VisibilityMasks.resize(count);
+
+  for (uint32_t proxy : buffer.DirtyProxies) {
+    uint8_t dirty = buffer.Dirty[proxy];
+    if (dirty & kDirtyTransform) {
+      frame.Transforms[proxy] = staging_.Transforms[proxy];
+    }
+    if (dirty & kDirtyMaterial) {
+      frame.Materials[proxy] = staging_.Materials[proxy];
+    }
+    if (dirty & kDirtyVisibility) {
+      frame.VisibilityMasks[proxy] = staging_.VisibilityMasks[proxy];
+    }
+    buffer.Dirty[proxy] = 0;
+  }
+  uint32_t copied = static_cast<uint32_t>(buffer.DirtyProxies.size());
+  buffer.DirtyProxies.clear();
+
+  frame.Version = ++version_;
+  published_.store(back);
+  return copied;
+}
+
+void RenderScene::MarkDirty(uint32_t proxy, uint8_t flags) {
+  for (Buffer& buffer : buffers_) {
+    if (buffer.Dirty[proxy] == 0) {
+      buffer.DirtyProxies.push_back(proxy);
+    }
+    buffer.Dirty[proxy] |= flags;
+  }
+}
+
+// --------------------------------- RENDERING ---------------------------------
+
+const RenderFrame& RenderScene::AcquireFrame() {
+  while (true) {
+    uint32_t index = published_.load();
+    buffers_[index].Readers.fetch_add(1);
+    if (published_.load() == index) {
+      return buffers_[index].Frame;
+    }
+    buffers_[index].Readers.fetch_sub(1);
+  }
+}
+
+void RenderScene::ReleaseFrame(const RenderFrame& frame) {
+  uint32_t index = &frame == &buffers_[0].Frame ? 0 : 1;
+  buffers_[index].Readers.fetch_sub(1);
+}
+
+}  // namespace renderer
+}  // namespace engine
@@ -0,0 +1,146 @@
+/**
+ * @file engine/src/core/renderer/RenderScene.h
+ * @brief The renderer's copy of the simulation, double buffered so that a
+ * render thread can draw one frame while the simulation computes the next.
+ *
+ * The simulation owns one render proxy per drawable thing and writes its
+ * transform, material and visibility into the scene whenever they change,
+ * typically from a system that queries for changed transforms (see
+ * `ecs::Query::ChangedSince`). Those writes go to a staging copy that only
+ * the simulation touches. At the sync point between frames, Sync copies the
+ * entries that changed into the buffer the renderer isn't reading and
+ * publishes it. The render thread only ever reads a published buffer, so it
+ * never takes a lock, and a frame in which nothing moved costs nothing to
+ * sync.
+ */
+#ifndef ENGINE_SRC_CORE_RENDERER_RENDERSCENE_H_
+#define ENGINE_SRC_CORE_RENDERER_RENDERSCENE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "core/Core.h"
+#include "core/math/SimdMath.h"
+#include "core/memory/HandlePool.h"
+
+namespace engine {
+namespace renderer {
+
+/**
+ * @typedef ProxyHandle
+ * @brief Identifies a render proxy. Its index is the proxy's entry in every
+ * array of a RenderFrame.
+ */
+typedef memory::Handle<struct ProxyTag> ProxyHandle;
+
+/**
+ * @struct RenderFrame
+ * @brief A published copy of the render scene, with one entry per proxy in
+ * every array.
+ *
+ * Entries of destroyed proxies have a visibility mask of 0, like hidden ones.
+ */
+struct RenderFrame {
+  std::vector<math::Matrix4> Transforms;
+  std::vector<uint32_t> Materials;
+
+  // The views or passes a proxy is drawn in, one bit each. 0 hides it.
+  std::vector<uint32_t> VisibilityMasks;
+
+  // The number of the sync that published the frame.
+  uint64_t Version = 0;
+
+  inline uint32_t GetProxyCount() const {
+    return static_cast<uint32_t>(Transforms.size());
+  }
+};
+
+/**
+ * @class RenderScene
+ * @brief Render proxies shared between one simulation thread and any number
+ * of render threads.
+ */
+class ENGINE_API RenderScene {
+ public:
+  RenderScene();
+
+  RenderScene(const RenderScene&) = delete;
+  RenderScene& operator=(const RenderScene&) = delete;
+
+  // ------------------------------- SIMULATION --------------------------------
+
+  /**
+   * @fn CreateProxy
+   * @brief Creates a hidden proxy with an identity transform and material 0.
+   */
+  ProxyHandle CreateProxy();
+
+  /**
+   * @fn DestroyProxy
+   * @brief Hides a proxy and frees its entry for reuse. Destroyed proxies are
+   * ignored, here and by the setters.
+   */
+  void DestroyProxy(ProxyHandle proxy);
+
+  void SetTransform(ProxyHandle proxy, const math::Matrix4& transform);
+  void SetMaterial(ProxyHandle proxy, uint32_t material);
+  void SetVisibilityMask(ProxyHandle proxy, uint32_t mask);
+
+  /**
+   * @fn Sync
+   * @brief Copies the proxies that changed into the buffer the renderer isn't
+   * reading and publishes it.
+   *
+   * Must be called from the simulation thread between frames. Only waits if a
+   * render thread is still reading the frame published two syncs ago, i.e. if
+   * rendering has fallen more than a frame behind.
+   *
+   * @return The number of proxies copied.
+   */
+  uint32_t Sync();
+
+  // -------------------------------- RENDERING --------------------------------
+
+  /**
+   * @fn AcquireFrame
+   * @brief Get the most recently published frame, which stays unchanged until
+   * it is released. Never blocks.
+   */
+  const RenderFrame& AcquireFrame();
+
+  /**
+   * @fn ReleaseFrame
+   * @brief Releases a frame returned by AcquireFrame.
+   */
+  void ReleaseFrame(const RenderFrame& frame);
+
+ private:
+  enum DirtyFlags : uint8_t {
+    kDirtyTransform = BIT(0),
+    kDirtyMaterial = BIT(1),
+    kDirtyVisibility = BIT(2)
+  };
+
+  // Each buffer tracks the proxies it is missing on its own: a change has to
+  // reach both buffers, one sync after the other.
+  struct Buffer {
+    RenderFrame Frame;
+    std::atomic<uint32_t> Readers{0};
+    std::vector<uint8_t> Dirty;
+    std::vector<uint32_t> DirtyProxies;
+  };
+
+  void MarkDirty(uint32_t proxy, uint8_t flags);
+
+  RenderFrame staging_;
+  memory::HandlePool<ProxyHandle> handles_;
+  Buffer buffers_[2];
+  std::atomic<uint32_t> published_{0};
+  uint64_t version_ = 0;
+};
+
+}  // namespace renderer
+}  // namespace engine
+
+#endif  // ENGINE_SRC_CORE_RENDERER_RENDERSCENE_H_
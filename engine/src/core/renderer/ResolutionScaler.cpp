@@ -0,0 +1,151 @@
+#include "core/renderer/ResolutionScaler.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "core/Assert.h"
+
+namespace engine {
+namespace renderer {
+
+ResolutionScaler::ResolutionScaler(const ResolutionScalerSettings& settings)
+    : settings_(settings),
+      scale_(settings.MaxScale),
+      desired_scale_(settings.MaxScale) {
+  ENGINE_CORE_ASSERT(
+      settings.MinScale > 0.0f && settings.MinScale <= settings.MaxScale,
+      "Render scales must be positive, with the minimum below the maximum.");
+  std::fill(history_, history_ + kHistorySize, scale_);
+}
+
+void ResolutionScaler::SetSettings(const ResolutionScalerSettings& settings) {
+  ENGINE_CORE_ASSERT(
+      settings.MinScale > 0.0f && settings.MinScale <= settings.MaxScale,
+      "Render scales must be positive, with the minimum below the maximum.");
+  settings_ = settings;
+  desired_scale_ = std::min(
+      std::max(desired_scale_, settings_.MinScale), settings_.MaxScale);
+  float scale = std::min(
+      std::max(scale_, settings_.MinScale), settings_.MaxScale);
+  if (scale != scale_) {
+    SetScale(scale);
+  }
+}
+
+// The controller is in velocity form: it adjusts the scale by the change of
+// a PID controller's output rather than computing the scale outright, which
+// keeps the integral term from winding up while the scale is at a limit.
+void ResolutionScaler::Update(double frame_time, double gpu_time) {
+  double smoothing = settings_.Smoothing;
+  frame_time_ = frame_ == 0
+      ? frame_time
+      : frame_time_ + (frame_time - frame_time_) * smoothing;
+  if (gpu_time < 0.0) {
+    gpu_time_ = -1.0;
+  } else {
+    gpu_time_ = gpu_time_ < 0.0
+        ? gpu_time
+        : gpu_time_ + (gpu_time - gpu_time_) * smoothing;
+  }
+
+  if (!settings_.Enabled) {
+    desired_scale_ = settings_.MaxScale;
+    error_ = previous_error_ = 0.0f;
+    lower_frames_ = raise_frames_ = 0;
+    if (scale_ != settings_.MaxScale) {
+      SetScale(settings_.MaxScale);
+    }
+    history_[frame_++ % kHistorySize] = scale_;
+    return;
+  }
+
+  // Positive errors are headroom.
+  double target = settings_.TargetFrameTime;
+  double measured = gpu_time_ >= 0.0 ? gpu_time_ : frame_time_;
+  float error = static_cast<float>(
+      std::min(std::max((target - measured) / target, -1.0), 1.0));
+  if (std::abs(error) < settings_.Deadband) {
+    error = 0.0f;
+  }
+  bool cpu_bound = frame_time_ > target * (1.0 + settings_.Deadband);
+  if (cpu_bound && error > 0.0f) {
+    error = 0.0f;
+  }
+
+  float change = settings_.Proportional * (error - error_)
+      + settings_.Integral * error
+      + settings_.Derivative * (error - 2.0f * error_ + previous_error_);
+  previous_error_ = error_;
+  error_ = error;
+
+  // The timings still show the old scale for a few frames after a change.
+  if (settle_frames_ > 0) {
+    --settle_frames_;
+    history_[frame_++ % kHistorySize] = scale_;
+    return;
+  }
+
+  desired_scale_ = std::min(
+      std::max(desired_scale_ + change, settings_.MinScale),
+      settings_.MaxScale);
+  float scale = desired_scale_;
+  if (settings_.ScaleStep > 0.0f) {
+    scale = std::round(scale / settings_.ScaleStep) * settings_.ScaleStep;
+    scale = std::min(std::max(scale, settings_.MinScale), settings_.MaxScale);
+  }
+
+  // Dropping frames is worse than a blurrier frame, so the scale is lowered
+  // as far as needed right away but only raised a step at a time, and only
+  // to a scale that is predicted to fit the budget. Without that, a step
+  // larger than the deadband would alternate between a scale just under the
+  // budget and one just over it.
+  if (scale < scale_) {
+    raise_frames_ = 0;
+    if (++lower_frames_ >= settings_.LowerFrames) {
+      SetScale(scale);
+    }
+  } else if (scale > scale_) {
+    lower_frames_ = 0;
+    float step = settings_.ScaleStep > 0.0f ? settings_.ScaleStep : scale;
+    float next = std::min(scale, scale_ + step);
+
+    // The GPU's time grows with the pixels, the square of the scale.
+    double growth = (next * next) / (scale_ * scale_);
+    if (cpu_bound || measured * growth > target) {
+      raise_frames_ = 0;
+      desired_scale_ = scale_;
+    } else if (++raise_frames_ >= settings_.RaiseFrames) {
+      SetScale(next);
+    }
+  } else {
+    lower_frames_ = raise_frames_ = 0;
+  }
+  history_[frame_++ % kHistorySize] = scale_;
+}
+
+void ResolutionScaler::GetRenderSize(
+    uint32_t width,
+    uint32_t height,
+    uint32_t* render_width,
+    uint32_t* render_height) const {
+  *render_width = std::max<uint32_t>(
+      1, static_cast<uint32_t>(std::lround(width * scale_)));
+  *render_height = std::max<uint32_t>(
+      1, static_cast<uint32_t>(std::lround(height * scale_)));
+}
+
+void ResolutionScaler::SetScale(float scale) {
+  last_change_.Frame = frame_;
+  last_change_.From = scale_;
+  last_change_.To = scale;
+  last_change_.FrameTime = frame_time_;
+  last_change_.GpuTime = gpu_time_;
+  ++change_count_;
+
+  scale_ = scale;
+  lower_frames_ = raise_frames_ = 0;
+  settle_frames_ = settings_.SettleFrames;
+}
+
+}  // namespace renderer
+}  // namespace engine
@@ -0,0 +1,188 @@
+/**
+ * @file engine/src/core/renderer/ResolutionScaler.h
+ * @brief Picks the resolution the scene is rendered at from measured frame
+ * times, so that a frame that runs long costs pixels instead of frames.
+ *
+ * The scaler compares the time of the GPU's work on the scene against the
+ * frame budget and feeds the difference to a PID controller whose output is
+ * the render scale, a fraction of the window's width and height. Small
+ * errors are ignored, the scale moves in fixed steps, lowering it takes a
+ * couple of frames that are over budget while raising it takes many frames
+ * with headroom, and the controller waits for a change to show up in the
+ * timings before it reacts again, so the scale doesn't oscillate between two
+ * steps. Without GPU timings the CPU time of the frame is used instead, and
+ * the scale is never raised while the CPU is over budget, since rendering
+ * more pixels can only add to it.
+ *
+ * The scaler only decides. The application renders the scene into a
+ * framebuffer of the chosen size and upscales it to the window before
+ * drawing the UI at native resolution.
+ */
+#ifndef ENGINE_SRC_CORE_RENDERER_RESOLUTIONSCALER_H_
+#define ENGINE_SRC_CORE_RENDERER_RESOLUTIONSCALER_H_
+
+#include <cstdint>
+
+#include "core/Core.h"
+
+namespace engine {
+namespace renderer {
+
+/**
+ * @struct ResolutionScalerSettings
+ * @brief How a ResolutionScaler reacts to frame times.
+ */
+struct ResolutionScalerSettings {
+  // Holds the scale at MaxScale when disabled.
+  bool Enabled = true;
+
+  // The frame time to hold, in seconds.
+  double TargetFrameTime = 1.0 / 60.0;
+
+  float MinScale = 0.5f;
+  float MaxScale = 1.0f;
+
+  // The scale is rounded to multiples of this, so that tiny corrections
+  // don't change the render size every frame.
+  float ScaleStep = 0.05f;
+
+  // Gains on the frame time error as a fraction of the target, where the
+  // output is the scale.
+  float Proportional = 0.3f;
+  float Integral = 0.04f;
+  float Derivative = 0.05f;
+
+  // Frame times within this fraction of the target count as on target.
+  float Deadband = 0.05f;
+
+  // How many frames in a row have to ask for a lower or higher scale before
+  // it changes.
+  uint32_t LowerFrames = 3;
+  uint32_t RaiseFrames = 45;
+
+  // Frames after a change during which timings aren't acted on, because GPU
+  // timings arrive a few frames late.
+  uint32_t SettleFrames = 4;
+
+  // Weight of the newest frame in the smoothed timings.
+  float Smoothing = 0.25f;
+};
+
+/**
+ * @struct ScaleChange
+ * @brief A change of the render scale and the timings that caused it.
+ */
+struct ScaleChange {
+  uint64_t Frame = 0;
+  float From = 1.0f;
+  float To = 1.0f;
+
+  // Smoothed, in seconds. The GPU time is negative if it wasn't measured.
+  double FrameTime = 0.0;
+  double GpuTime = -1.0;
+};
+
+/**
+ * @class ResolutionScaler
+ * @brief Controls the render scale of the scene, updated once per frame.
+ */
+class ENGINE_API ResolutionScaler {
+ public:
+  static constexpr uint32_t kHistorySize = 128;
+
+  explicit ResolutionScaler(
+      const ResolutionScalerSettings& settings = ResolutionScalerSettings());
+
+  /**
+   * @fn SetSettings
+   * @brief Changes the settings, keeping what the controller learned.
+   */
+  void SetSettings(const ResolutionScalerSettings& settings);
+
+  inline const ResolutionScalerSettings& GetSettings() const {
+    return settings_;
+  }
+
+  /**
+   * @fn Update
+   * @brief Feeds the timings of a frame to the controller.
+   * @param frame_time The CPU time of the frame in seconds, excluding waits
+   * for the display.
+   * @param gpu_time The GPU time of the scene in seconds, or a negative
+   * value if it isn't known.
+   */
+  void Update(double frame_time, double gpu_time);
+
+  /**
+   * @fn GetScale
+   * @brief Get the fraction of the window's width and height to render the
+   * scene at.
+   */
+  inline float GetScale() const { return scale_; }
+
+  /**
+   * @fn GetRenderSize
+   * @brief Get the size to render the scene at for a window of the given
+   * size, which is at least one pixel.
+   */
+  void GetRenderSize(
+      uint32_t width,
+      uint32_t height,
+      uint32_t* render_width,
+      uint32_t* render_height) const;
+
+  /**
+   * @fn GetFrameTime
+   * @brief Get the smoothed CPU time of a frame in seconds.
+   */
+  inline double GetFrameTime() const { return frame_time_; }
+
+  /**
+   * @fn GetGpuTime
+   * @brief Get the smoothed GPU time of the scene in seconds, or a negative
+   * value if it isn't measured.
+   */
+  inline double GetGpuTime() const { return gpu_time_; }
+
+  inline const ScaleChange& GetLastChange() const { return last_change_; }
+  inline uint64_t GetChangeCount() const { return change_count_; }
+  inline uint64_t GetFrame() const { return frame_; }
+
+  /**
+   * @fn GetHistory
+   * @brief Get the scales of the last kHistorySize frames, as a ring that
+   * starts with the oldest at GetHistoryOffset.
+   */
+  inline const float* GetHistory() const { return history_; }
+  inline uint32_t GetHistoryOffset() const {
+    return static_cast<uint32_t>(frame_ % kHistorySize);
+  }
+
+ private:
+  ResolutionScalerSettings settings_;
+  float scale_;
+
+  // The unrounded output of the controller.
+  float desired_scale_;
+  float error_ = 0.0f;
+  float previous_error_ = 0.0f;
+
+  double frame_time_ = 0.0;
+  double gpu_time_ = -1.0;
+
+  uint32_t lower_frames_ = 0;
+  uint32_t raise_frames_ = 0;
+  uint32_t settle_frames_ = 0;
+
+  uint64_t frame_ = 0;
+  uint64_t change_count_ = 0;
+  ScaleChange last_change_;
+  float history_[kHistorySize];
+
+  void SetScale(float scale);
+};
+
+}  // namespace renderer
+}  // namespace engine
+
+#endif  // ENGINE_SRC_CORE_RENDERER_RESOLUTIONSCALER_H_
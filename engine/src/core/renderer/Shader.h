@@ -41,6 +41,13 @@ class Shader {
    */
   void Unbind() const;
 
+  /**
+   * @fn GetRendererID
+   * @brief Get the graphics API's handle of the shader program, e.g. to look
+   * up its uniforms.
+   */
+  inline std::uint32_t GetRendererID() const { return renderer_ID_; }
+
  private:
   std::uint32_t renderer_ID_;
 };
@@ -0,0 +1,144 @@
+#include "core/snapshot/ForkSnapshotter.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <utility>
+
+#if defined(__linux__) && !defined(ENGINE_PLATFORM_WINDOWS)
+  #define ENGINE_SNAPSHOT_FORK
+  #include <signal.h>
+  #include <sys/prctl.h>
+  #include <sys/wait.h>
+  #include <unistd.h>
+#endif
+
+#include "core/Log.h"
+#include "core/cvars/ConsoleVariable.h"
+
+namespace engine {
+namespace snapshot {
+
+namespace {
+
+cvars::ConsoleVariable<bool> kForkVariable(
+    "snapshot.fork",
+    true,
+    "Write snapshots from a forked copy of the process where supported, "
+    "instead of stalling the calling thread.");
+
+// Snapshots compete with the simulation for processors, so the child yields
+// to it.
+constexpr int kChildNiceness = 10;
+
+double SecondsSince(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(
+      std::chrono::steady_clock::now() - start).count();
+}
+
+}  // namespace
+
+uint32_t WriteSnapshots(const std::vector<SnapshotRequest>& requests) {
+  uint32_t failures = 0;
+  for (const SnapshotRequest& request : requests) {
+    SnapshotWriter writer;
+    if (!writer.Open(request.Path) || !request.Write(&writer)
+        || !writer.Finish()) {
+      ++failures;
+    }
+  }
+  return failures;
+}
+
+ForkSnapshotter::~ForkSnapshotter() {
+  std::vector<SnapshotResult> results;
+  Wait(&results);
+}
+
+bool ForkSnapshotter::Begin(const std::vector<SnapshotRequest>& requests) {
+  if (IsBusy()) {
+    return false;
+  }
+
+  std::vector<std::string> paths;
+  for (const SnapshotRequest& request : requests) {
+    paths.push_back(request.Path);
+  }
+  std::chrono::steady_clock::time_point start =
+      std::chrono::steady_clock::now();
+
+#if defined(ENGINE_SNAPSHOT_FORK)
+  if (kForkVariable.Get()) {
+    pid_t child = fork();
+    if (child == 0) {
+      // Don't outlive a parent that crashed or was killed.
+      prctl(PR_SET_PDEATHSIG, SIGKILL);
+      if (nice(kChildNiceness) == -1) {
+        // Running at the parent's priority is fine too.
+      }
+      uint32_t failures = WriteSnapshots(requests);
+      _exit(static_cast<int>(std::min<uint32_t>(failures, 255)));
+    }
+
+    if (child > 0) {
+      child_ = child;
+      child_paths_ = paths;
+      child_start_ = start;
+      return true;
+    }
+    ENGINE_CORE_WARN("Couldn't fork to write snapshots, writing them inline.");
+  }
+#endif
+
+  SnapshotResult result;
+  result.Paths = paths;
+  result.Succeeded = WriteSnapshots(requests) == 0;
+  result.Seconds = SecondsSince(start);
+  completed_.push_back(result);
+  return true;
+}
+
+void ForkSnapshotter::Poll(std::vector<SnapshotResult>* results) {
+#if defined(ENGINE_SNAPSHOT_FORK)
+  if (IsBusy()) {
+    int status = 0;
+    pid_t finished = waitpid(child_, &status, WNOHANG);
+    if (finished == child_ || finished < 0) {
+      Collect(finished == child_ ? status : -1, results);
+    }
+  }
+#endif
+  results->insert(results->end(), completed_.begin(), completed_.end());
+  completed_.clear();
+}
+
+void ForkSnapshotter::Wait(std::vector<SnapshotResult>* results) {
+#if defined(ENGINE_SNAPSHOT_FORK)
+  if (IsBusy()) {
+    int status = 0;
+    pid_t finished;
+    do {
+      finished = waitpid(child_, &status, 0);
+    } while (finished < 0 && errno == EINTR);
+    Collect(finished == child_ ? status : -1, results);
+  }
+#endif
+  Poll(results);
+}
+
+void ForkSnapshotter::Collect(
+    int status, std::vector<SnapshotResult>* results) {
+  SnapshotResult result;
+  result.Paths = std::move(child_paths_);
+  result.Forked = true;
+  result.Seconds = SecondsSince(child_start_);
+#if defined(ENGINE_SNAPSHOT_FORK)
+  result.Succeeded = status >= 0 && WIFEXITED(status)
+      && WEXITSTATUS(status) == 0;
+#endif
+  results->push_back(result);
+  child_ = 0;
+  child_paths_.clear();
+}
+
+}  // namespace snapshot
+}  // namespace engine
@@ -0,0 +1,126 @@
+/**
+ * @file engine/src/core/snapshot/ForkSnapshotter.h
+ * @brief Writes snapshots in the background from a copy-on-write fork.
+ *
+ * Serializing and compressing a large world takes far longer than a frame.
+ * On Linux the snapshotter instead forks the process at a frame boundary: the
+ * child gets a frozen copy of the world for the cost of copying page tables,
+ * serializes it at its leisure and exits, while the parent keeps simulating
+ * and only ever pays for the pages it modifies while the child still runs.
+ * Arenas backed by huge pages make the fork itself cheaper, since there are
+ * fewer page table entries to copy.
+ *
+ * Only the forking thread exists in the child. The write functions therefore
+ * run single threaded, and must not queue jobs or log, since a worker or
+ * another thread could have held the locks involved at the moment of the
+ * fork. Failures are reported to the parent through the exit status.
+ *
+ * Elsewhere, or with snapshot.fork disabled, snapshots are written on the
+ * calling thread and their results are reported by the next Poll.
+ */
+#ifndef ENGINE_SRC_CORE_SNAPSHOT_FORKSNAPSHOTTER_H_
+#define ENGINE_SRC_CORE_SNAPSHOT_FORKSNAPSHOTTER_H_
+
+#include <chrono>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "core/Core.h"
+#include "core/snapshot/Snapshot.h"
+
+namespace engine {
+namespace snapshot {
+
+/**
+ * @struct SnapshotRequest
+ * @brief A snapshot file and the function that writes its contents.
+ */
+struct SnapshotRequest {
+  std::string Path;
+  std::function<bool(SnapshotWriter* writer)> Write;
+};
+
+/**
+ * @struct SnapshotResult
+ * @brief The outcome of a call to ForkSnapshotter::Begin.
+ */
+struct SnapshotResult {
+  std::vector<std::string> Paths;
+  bool Succeeded = false;
+
+  // Whether the snapshots were written by a forked process.
+  bool Forked = false;
+
+  // Seconds from the fork until the results were collected.
+  double Seconds = 0.0;
+};
+
+/**
+ * @class ForkSnapshotter
+ * @brief Writes batches of snapshots in forked processes, one batch at a
+ * time.
+ */
+class ENGINE_API ForkSnapshotter {
+ public:
+  ForkSnapshotter() = default;
+
+  /**
+   * @fn ~ForkSnapshotter
+   * @brief Waits for the snapshot in progress, so that it isn't left behind
+   * half written.
+   */
+  ~ForkSnapshotter();
+
+  ForkSnapshotter(const ForkSnapshotter&) = delete;
+  ForkSnapshotter& operator=(const ForkSnapshotter&) = delete;
+
+  /**
+   * @fn Begin
+   * @brief Starts writing a batch of snapshots. Must be called at a frame
+   * boundary, when no other thread is modifying the state being written.
+   * @return false if a batch is still being written, in which case nothing
+   * is started and the caller should try again later.
+   */
+  bool Begin(const std::vector<SnapshotRequest>& requests);
+
+  /**
+   * @fn IsBusy
+   * @brief Returns true while a forked process is writing snapshots.
+   */
+  inline bool IsBusy() const { return child_ > 0; }
+
+  /**
+   * @fn Poll
+   * @brief Collects the results of finished batches without blocking.
+   */
+  void Poll(std::vector<SnapshotResult>* results);
+
+  /**
+   * @fn Wait
+   * @brief Blocks until the batch in progress has finished and collects its
+   * result.
+   */
+  void Wait(std::vector<SnapshotResult>* results);
+
+ private:
+  void Collect(int status, std::vector<SnapshotResult>* results);
+
+  int child_ = 0;
+  std::vector<std::string> child_paths_;
+  std::chrono::steady_clock::time_point child_start_;
+  std::vector<SnapshotResult> completed_;
+};
+
+/**
+ * @fn WriteSnapshots
+ * @brief Writes a batch of snapshots on the calling thread without logging.
+ * @return The number of snapshots that failed.
+ */
+ENGINE_API uint32_t WriteSnapshots(
+    const std::vector<SnapshotRequest>& requests);
+
+}  // namespace snapshot
+}  // namespace engine
+
+#endif  // ENGINE_SRC_CORE_SNAPSHOT_FORKSNAPSHOTTER_H_
@@ -0,0 +1,239 @@
+#include "core/snapshot/Snapshot.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+
+#include "core/Log.h"
+#include "core/compression/Lz.h"
+
+namespace engine {
+namespace snapshot {
+
+namespace {
+
+/**
+ * The header is the magic and the version. Every block starts with its
+ * uncompressed size and its stored size, whose top bit is set when the block
+ * is stored uncompressed because compressing didn't make it smaller. A block
+ * with an uncompressed size of zero ends the stream and is followed by the
+ * hash. All values are little endian.
+ */
+constexpr uint32_t kSnapshotMagic = 0x504e5343;  // "CSNP"
+constexpr uint32_t kSnapshotVersion = 1;
+constexpr size_t kBlockSize = 1024 * 1024;
+constexpr uint32_t kStoredFlag = 0x80000000u;
+
+void AppendU32(uint32_t value, std::vector<uint8_t>* out) {
+  for (int byte = 0; byte < 4; ++byte) {
+    out->push_back(static_cast<uint8_t>(value >> (byte * 8)));
+  }
+}
+
+bool ReadU32(
+    const std::vector<uint8_t>& data, size_t* offset, uint32_t* value) {
+  if (data.size() - *offset < 4) {
+    return false;
+  }
+  *value = 0;
+  for (int byte = 0; byte < 4; ++byte) {
+    *value |= static_cast<uint32_t>(data[*offset + byte]) << (byte * 8);
+  }
+  *offset += 4;
+  return true;
+}
+
+}  // namespace
+
+// ---------------------------------- WRITER -----------------------------------
+
+SnapshotWriter::~SnapshotWriter() {
+  if (file_.is_open()) {
+    file_.close();
+    std::remove(temporary_path_.c_str());
+  }
+}
+
+bool SnapshotWriter::Open(const std::string& path) {
+  path_ = path;
+  temporary_path_ = path + ".partial";
+  file_.open(temporary_path_, std::ios::binary | std::ios::trunc);
+  if (!file_) {
+    return false;
+  }
+
+  std::vector<uint8_t> header;
+  AppendU32(kSnapshotMagic, &header);
+  AppendU32(kSnapshotVersion, &header);
+  file_.write(reinterpret_cast<const char*>(header.data()), header.size());
+
+  block_.clear();
+  block_.reserve(kBlockSize);
+  compressed_.resize(compression::GetMaxCompressedSize(kBlockSize) + 8);
+  hasher_ = assets::ContentHasher();
+  uncompressed_size_ = 0;
+  compressed_size_ = header.size();
+  failed_ = !file_;
+  return !failed_;
+}
+
+void SnapshotWriter::Write(const void* data, size_t size) {
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+  hasher_.Update(bytes, size);
+  uncompressed_size_ += size;
+
+  while (size > 0) {
+    size_t count = std::min(size, kBlockSize - block_.size());
+    block_.insert(block_.end(), bytes, bytes + count);
+    bytes += count;
+    size -= count;
+    if (block_.size() == kBlockSize) {
+      FlushBlock();
+    }
+  }
+}
+
+void SnapshotWriter::WriteBytes(const std::vector<uint8_t>& bytes) {
+  WriteValue(static_cast<uint64_t>(bytes.size()));
+  Write(bytes.data(), bytes.size());
+}
+
+bool SnapshotWriter::Finish() {
+  if (!block_.empty()) {
+    FlushBlock();
+  }
+
+  std::vector<uint8_t> footer;
+  AppendU32(0, &footer);
+  AppendU32(0, &footer);
+  uint64_t hash = hasher_.Finish();
+  AppendU32(static_cast<uint32_t>(hash), &footer);
+  AppendU32(static_cast<uint32_t>(hash >> 32), &footer);
+  file_.write(reinterpret_cast<const char*>(footer.data()), footer.size());
+  compressed_size_ += footer.size();
+
+  file_.close();
+  if (failed_ || file_.fail()
+      || std::rename(temporary_path_.c_str(), path_.c_str()) != 0) {
+    std::remove(temporary_path_.c_str());
+    return false;
+  }
+  return true;
+}
+
+void SnapshotWriter::FlushBlock() {
+  // The block header goes in front of the compressed data so that every
+  // block takes a single write.
+  uint8_t* payload = compressed_.data() + 8;
+  size_t size = compression::CompressLz(block_.data(), block_.size(), payload);
+  uint32_t stored = static_cast<uint32_t>(size);
+  if (size >= block_.size()) {
+    std::memcpy(payload, block_.data(), block_.size());
+    size = block_.size();
+    stored = static_cast<uint32_t>(size) | kStoredFlag;
+  }
+
+  std::vector<uint8_t> header;
+  AppendU32(static_cast<uint32_t>(block_.size()), &header);
+  AppendU32(stored, &header);
+  std::memcpy(compressed_.data(), header.data(), header.size());
+  file_.write(
+      reinterpret_cast<const char*>(compressed_.data()),
+      static_cast<std::streamsize>(size + header.size()));
+  failed_ |= !file_;
+  compressed_size_ += size + header.size();
+  block_.clear();
+}
+
+// ---------------------------------- READER -----------------------------------
+
+bool SnapshotReader::Open(const std::string& path) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    ENGINE_CORE_ERROR("Couldn't open snapshot {}.", path);
+    return false;
+  }
+  std::vector<uint8_t> contents(
+      (std::istreambuf_iterator<char>(file)),
+      std::istreambuf_iterator<char>());
+
+  data_.clear();
+  offset_ = 0;
+
+  size_t offset = 0;
+  uint32_t magic, version;
+  if (!ReadU32(contents, &offset, &magic) || magic != kSnapshotMagic
+      || !ReadU32(contents, &offset, &version)
+      || version != kSnapshotVersion) {
+    ENGINE_CORE_ERROR("{} isn't a snapshot.", path);
+    return false;
+  }
+
+  while (true) {
+    uint32_t size, stored;
+    if (!ReadU32(contents, &offset, &size)
+        || !ReadU32(contents, &offset, &stored)) {
+      ENGINE_CORE_ERROR("Snapshot {} is truncated.", path);
+      return false;
+    }
+    if (size == 0) {
+      break;
+    }
+
+    size_t stored_size = stored & ~kStoredFlag;
+    if (size > kBlockSize || contents.size() - offset < stored_size) {
+      ENGINE_CORE_ERROR("Snapshot {} has a corrupt block.", path);
+      return false;
+    }
+
+    const uint8_t* block = contents.data() + offset;
+    size_t begin = data_.size();
+    data_.resize(begin + size);
+    bool valid = (stored & kStoredFlag)
+        ? stored_size == size
+        : compression::DecompressLz(
+              block, stored_size, data_.data() + begin, size);
+    if (!valid) {
+      ENGINE_CORE_ERROR("Snapshot {} has a corrupt block.", path);
+      return false;
+    }
+    if (stored & kStoredFlag) {
+      std::memcpy(data_.data() + begin, block, size);
+    }
+    offset += stored_size;
+  }
+
+  uint32_t low, high;
+  if (!ReadU32(contents, &offset, &low) || !ReadU32(contents, &offset, &high)
+      || assets::HashBytes(data_.data(), data_.size())
+          != ((static_cast<uint64_t>(high) << 32) | low)) {
+    ENGINE_CORE_ERROR("Snapshot {} doesn't match its hash.", path);
+    data_.clear();
+    return false;
+  }
+  return true;
+}
+
+bool SnapshotReader::Read(void* data, size_t size) {
+  if (GetRemainingSize() < size) {
+    return false;
+  }
+  std::memcpy(data, data_.data() + offset_, size);
+  offset_ += size;
+  return true;
+}
+
+bool SnapshotReader::ReadBytes(std::vector<uint8_t>* bytes) {
+  uint64_t size;
+  if (!ReadValue(&size) || GetRemainingSize() < size) {
+    return false;
+  }
+  bytes->assign(
+      data_.begin() + offset_, data_.begin() + offset_ + size);
+  offset_ += size;
+  return true;
+}
+
+}  // namespace snapshot
+}  // namespace engine
@@ -0,0 +1,148 @@
+/**
+ * @file engine/src/core/snapshot/Snapshot.h
+ * @brief Compressed snapshot files of world state.
+ *
+ * A snapshot is a stream of bytes written by the layers of a world, usually
+ * with the reflection serializer, split into 1 MB blocks that are compressed
+ * independently with CompressLz. The stream ends with the XXH64 hash of its
+ * uncompressed contents, so truncated or corrupt snapshots are detected
+ * before any of their state is applied.
+ */
+#ifndef ENGINE_SRC_CORE_SNAPSHOT_SNAPSHOT_H_
+#define ENGINE_SRC_CORE_SNAPSHOT_SNAPSHOT_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "core/Core.h"
+#include "core/assets/ContentHash.h"
+
+namespace engine {
+namespace snapshot {
+
+/**
+ * @class SnapshotWriter
+ * @brief Streams a snapshot to a file.
+ *
+ * The file is written under a temporary name and only renamed to its final
+ * path by Finish, so an existing snapshot is never replaced by a partial one.
+ * Writers don't log, since they also run in forked processes where the
+ * loggers can't be used (Check `engine/src/core/snapshot/ForkSnapshotter.h`).
+ */
+class ENGINE_API SnapshotWriter {
+ public:
+  SnapshotWriter() = default;
+  ~SnapshotWriter();
+
+  SnapshotWriter(const SnapshotWriter&) = delete;
+  SnapshotWriter& operator=(const SnapshotWriter&) = delete;
+
+  /**
+   * @fn Open
+   * @return false if the temporary file couldn't be created.
+   */
+  bool Open(const std::string& path);
+
+  /**
+   * @fn Write
+   * @brief Appends bytes to the snapshot.
+   */
+  void Write(const void* data, size_t size);
+
+  /**
+   * @fn WriteValue
+   * @brief Appends the bytes of a trivially copyable value.
+   */
+  template<typename T>
+  inline void WriteValue(const T& value) {
+    static_assert(
+        std::is_trivially_copyable<T>::value,
+        "Only trivially copyable values can be written directly.");
+    Write(&value, sizeof(T));
+  }
+
+  /**
+   * @fn WriteBytes
+   * @brief Appends a length prefixed byte array, such as the output of the
+   * reflection serializer.
+   */
+  void WriteBytes(const std::vector<uint8_t>& bytes);
+
+  /**
+   * @fn Finish
+   * @brief Flushes the last block, writes the hash and moves the file into
+   * place.
+   * @return false if anything failed to write, in which case the temporary
+   * file is removed and the previous snapshot at the path is left intact.
+   */
+  bool Finish();
+
+  inline uint64_t GetUncompressedSize() const { return uncompressed_size_; }
+  inline uint64_t GetCompressedSize() const { return compressed_size_; }
+
+ private:
+  void FlushBlock();
+
+  std::ofstream file_;
+  std::string path_;
+  std::string temporary_path_;
+  std::vector<uint8_t> block_;
+  std::vector<uint8_t> compressed_;
+  assets::ContentHasher hasher_;
+  uint64_t uncompressed_size_ = 0;
+  uint64_t compressed_size_ = 0;
+  bool failed_ = false;
+};
+
+/**
+ * @class SnapshotReader
+ * @brief Reads back a snapshot written by SnapshotWriter.
+ */
+class ENGINE_API SnapshotReader {
+ public:
+  /**
+   * @fn Open
+   * @brief Reads, decompresses and verifies a whole snapshot.
+   * @return false and logs an error if the file is missing or corrupt.
+   */
+  bool Open(const std::string& path);
+
+  /**
+   * @fn Read
+   * @return false if fewer than size bytes are left.
+   */
+  bool Read(void* data, size_t size);
+
+  /**
+   * @fn ReadValue
+   * @brief Reads a value written with SnapshotWriter::WriteValue.
+   */
+  template<typename T>
+  inline bool ReadValue(T* value) {
+    static_assert(
+        std::is_trivially_copyable<T>::value,
+        "Only trivially copyable values can be read directly.");
+    return Read(value, sizeof(T));
+  }
+
+  /**
+   * @fn ReadBytes
+   * @brief Reads a byte array written with SnapshotWriter::WriteBytes.
+   */
+  bool ReadBytes(std::vector<uint8_t>* bytes);
+
+  inline size_t GetRemainingSize() const { return data_.size() - offset_; }
+
+ private:
+  std::vector<uint8_t> data_;
+  size_t offset_ = 0;
+};
+
+}  // namespace snapshot
+}  // namespace engine
+
+#endif  // ENGINE_SRC_CORE_SNAPSHOT_SNAPSHOT_H_
@@ -0,0 +1,118 @@
+#include "core/sort/RadixSort.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include "core/jobs/JobSystem.h"
+
+namespace engine {
+namespace sort {
+
+namespace {
+
+constexpr uint32_t kBuckets = 256;
+
+// Blocks smaller than this aren't worth a job of their own.
+constexpr uint32_t kMinKeysPerBlock = 8192;
+
+// Several blocks per worker even out blocks that take longer than others.
+constexpr uint32_t kBlocksPerWorker = 4;
+
+}  // namespace
+
+RadixSorter::RadixSorter() {}
+
+RadixSorter::~RadixSorter() {}
+
+void RadixSorter::Sort(uint32_t* keys, uint32_t* values, uint32_t count) {
+  SortKeys(keys, values, count);
+}
+
+void RadixSorter::Sort(uint64_t* keys, uint32_t* values, uint32_t count) {
+  SortKeys(keys, values, count);
+}
+
+template<typename Key>
+void RadixSorter::SortKeys(Key* keys, uint32_t* values, uint32_t count) {
+  if (count < 2) {
+    return;
+  }
+
+  uint32_t blocks = std::max(1u, std::min(
+      count / kMinKeysPerBlock,
+      (jobs::JobSystem::GetWorkerCount() + 1) * kBlocksPerWorker));
+  uint32_t block_size = (count + blocks - 1) / blocks;
+  blocks = (count + block_size - 1) / block_size;
+
+  // The scratch keys are stored as 64 bit words whatever the key size.
+  key_scratch_.resize((static_cast<size_t>(count) * sizeof(Key) + 7) / 8);
+  if (values != nullptr) {
+    value_scratch_.resize(count);
+  }
+  histograms_.resize(static_cast<size_t>(blocks) * kBuckets);
+
+  Key* source_keys = keys;
+  Key* target_keys = reinterpret_cast<Key*>(key_scratch_.data());
+  uint32_t* source_values = values;
+  uint32_t* target_values = values != nullptr ? value_scratch_.data() : nullptr;
+
+  for (uint32_t shift = 0; shift < sizeof(Key) * 8; shift += 8) {
+    jobs::JobSystem::ParallelFor(
+        blocks, 1, [&](uint32_t first_block, uint32_t end_block) {
+          for (uint32_t block = first_block; block < end_block; ++block) {
+            uint32_t* histogram = &histograms_[block * kBuckets];
+            std::fill(histogram, histogram + kBuckets, 0);
+            uint32_t end = std::min(count, (block + 1) * block_size);
+            for (uint32_t i = block * block_size; i < end; ++i) {
+              ++histogram[(source_keys[i] >> shift) & 0xff];
+            }
+          }
+        });
+
+    // Turn the counts into offsets, ordered by byte and then by block. A
+    // byte that every key shares means the pass wouldn't move anything.
+    uint32_t offset = 0;
+    bool skip = false;
+    for (uint32_t bucket = 0; bucket < kBuckets && !skip; ++bucket) {
+      uint32_t bucket_start = offset;
+      for (uint32_t block = 0; block < blocks; ++block) {
+        uint32_t& entry = histograms_[block * kBuckets + bucket];
+        uint32_t block_count = entry;
+        entry = offset;
+        offset += block_count;
+      }
+      skip = offset - bucket_start == count;
+    }
+    if (skip) {
+      continue;
+    }
+
+    jobs::JobSystem::ParallelFor(
+        blocks, 1, [&](uint32_t first_block, uint32_t end_block) {
+          for (uint32_t block = first_block; block < end_block; ++block) {
+            uint32_t* offsets = &histograms_[block * kBuckets];
+            uint32_t end = std::min(count, (block + 1) * block_size);
+            for (uint32_t i = block * block_size; i < end; ++i) {
+              uint32_t target = offsets[(source_keys[i] >> shift) & 0xff]++;
+              target_keys[target] = source_keys[i];
+              if (source_values != nullptr) {
+                target_values[target] = source_values[i];
+              }
+            }
+          }
+        });
+    std::swap(source_keys, target_keys);
+    std::swap(source_values, target_values);
+  }
+
+  if (source_keys != keys) {
+    std::memcpy(keys, source_keys, count * sizeof(Key));
+    if (values != nullptr) {
+      std::memcpy(values, source_values, count * sizeof(uint32_t));
+    }
+  }
+}
+
+}  // namespace sort
+}  // namespace engine
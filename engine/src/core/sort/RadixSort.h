@@ -0,0 +1,60 @@
+/**
+ * @file engine/src/core/sort/RadixSort.h
+ * @brief Parallel, stable radix sorting of integer keys with a payload.
+ *
+ * Keys are sorted a byte at a time from the least significant byte up. Every
+ * pass splits the keys into one block per job: each job counts the bytes of
+ * its block, the counts are turned into one output offset per block and byte
+ * value, and each job then scatters its block to its own offsets. Blocks keep
+ * their relative order, so every pass is stable. Passes in which every key
+ * has the same byte, like the unused high bytes of small keys, are skipped.
+ */
+#ifndef ENGINE_SRC_CORE_SORT_RADIXSORT_H_
+#define ENGINE_SRC_CORE_SORT_RADIXSORT_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "core/Core.h"
+
+namespace engine {
+namespace sort {
+
+/**
+ * @class RadixSorter
+ * @brief Sorts arrays of keys together with a 32 bit value per key, reusing
+ * its scratch memory from one sort to the next.
+ *
+ * A sorter may only run one sort at a time.
+ */
+class ENGINE_API RadixSorter {
+ public:
+  RadixSorter();
+  ~RadixSorter();
+
+  RadixSorter(const RadixSorter&) = delete;
+  RadixSorter& operator=(const RadixSorter&) = delete;
+
+  /**
+   * @fn Sort
+   * @brief Sorts keys in ascending order and moves values along with them.
+   * @param values May be null to sort only the keys.
+   */
+  void Sort(uint32_t* keys, uint32_t* values, uint32_t count);
+  void Sort(uint64_t* keys, uint32_t* values, uint32_t count);
+
+ private:
+  std::vector<uint64_t> key_scratch_;
+  std::vector<uint32_t> value_scratch_;
+
+  // 256 counts, and later offsets, for every block.
+  std::vector<uint32_t> histograms_;
+
+  template<typename Key>
+  void SortKeys(Key* keys, uint32_t* values, uint32_t count);
+};
+
+}  // namespace sort
+}  // namespace engine
+
+#endif  // ENGINE_SRC_CORE_SORT_RADIXSORT_H_
@@ -0,0 +1,317 @@
+#include "core/sprites/SpriteSystem.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <utility>
+
+#include "core/Assert.h"
+#include "core/jobs/JobSystem.h"
+#include "core/math/Wide.h"
+
+namespace engine {
+namespace sprites {
+
+namespace {
+
+// The number of sprites processed by a single job.
+constexpr uint32_t kSpritesPerJob = 4096;
+
+constexpr uint32_t kNoSprite = 0xffffffff;
+
+// Draw keys, from the most significant bit down: a hidden flag, the layer,
+// the depth and the texture. Hidden sprites sort after everything else.
+constexpr int kLayerShift = 55;
+constexpr int kDepthShift = 23;
+constexpr uint64_t kTextureMask = (uint64_t(1) << kDepthShift) - 1;
+constexpr uint64_t kHiddenKey = ~uint64_t(0);
+
+// Maps a float to an unsigned integer with the same order.
+inline uint32_t OrderedBits(float value) {
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return (bits & 0x80000000u) != 0 ? ~bits : bits | 0x80000000u;
+}
+
+// Advances the animation clocks of [begin, end) in steps of the wide type and
+// returns the index of the first sprite it didn't advance.
+template<typename Wide>
+uint32_t AdvanceRange(
+    float* phase, const float* rate, uint32_t begin, uint32_t end,
+    float delta_time) {
+  const Wide step = Wide::Broadcast(delta_time);
+  uint32_t i = begin;
+  for (; i + Wide::kWidth <= end; i += Wide::kWidth) {
+    math::MulAdd(Wide::Load(rate + i), step, Wide::Load(phase + i))
+        .Store(phase + i);
+  }
+  return i;
+}
+
+}  // namespace
+
+SpriteSystem::SpriteSystem() {}
+
+SpriteSystem::~SpriteSystem() {}
+
+uint32_t SpriteSystem::AddFrame(const SpriteFrame& frame) {
+  ENGINE_CORE_ASSERT(
+      frame.Texture <= kTextureMask, "Sprite textures must fit in 23 bits.");
+  frames_.push_back(frame);
+  return static_cast<uint32_t>(frames_.size() - 1);
+}
+
+uint32_t SpriteSystem::AddClip(const SpriteClip& clip) {
+  ENGINE_CORE_ASSERT(
+      clip.FrameCount > 0 && clip.FirstFrame + clip.FrameCount
+          <= frames_.size(),
+      "A sprite clip must consist of frames that were already added.");
+  clips_.push_back(clip);
+  return static_cast<uint32_t>(clips_.size() - 1);
+}
+
+// ---------------------------------- SPRITES ----------------------------------
+
+SpriteHandle SpriteSystem::Create(const SpriteDesc& desc) {
+  ENGINE_CORE_ASSERT(desc.Clip < clips_.size(), "Unknown sprite clip.");
+
+  SpriteHandle handle = handles_.Allocate();
+  if (handle.Index == sprite_of_slot_.size()) {
+    sprite_of_slot_.emplace_back();
+  }
+
+  uint32_t sprite = GetCount();
+  sprite_of_slot_[handle.Index] = sprite;
+  slot_.push_back(handle.Index);
+  x_.push_back(desc.X);
+  y_.push_back(desc.Y);
+  scale_x_.push_back(desc.ScaleX);
+  scale_y_.push_back(desc.ScaleY);
+  cos_.push_back(std::cos(desc.Rotation));
+  sin_.push_back(std::sin(desc.Rotation));
+  color_.push_back(desc.Color);
+  layer_.push_back(desc.Layer);
+  visible_.push_back(desc.Visible ? 1 : 0);
+  clip_.push_back(desc.Clip);
+  phase_.push_back(0.0f);
+  rate_.push_back(clips_[desc.Clip].FramesPerSecond * desc.Speed);
+  frame_.push_back(clips_[desc.Clip].FirstFrame);
+  visible_count_ += desc.Visible ? 1 : 0;
+  return handle;
+}
+
+void SpriteSystem::Destroy(SpriteHandle handle) {
+  uint32_t sprite = GetSprite(handle);
+  if (sprite == kNoSprite) {
+    return;
+  }
+
+  visible_count_ -= visible_[sprite];
+  uint32_t last = GetCount() - 1;
+  if (sprite != last) {
+    slot_[sprite] = slot_[last];
+    x_[sprite] = x_[last];
+    y_[sprite] = y_[last];
+    scale_x_[sprite] = scale_x_[last];
+    scale_y_[sprite] = scale_y_[last];
+    cos_[sprite] = cos_[last];
+    sin_[sprite] = sin_[last];
+    color_[sprite] = color_[last];
+    layer_[sprite] = layer_[last];
+    visible_[sprite] = visible_[last];
+    clip_[sprite] = clip_[last];
+    phase_[sprite] = phase_[last];
+    rate_[sprite] = rate_[last];
+    frame_[sprite] = frame_[last];
+    sprite_of_slot_[slot_[sprite]] = sprite;
+  }
+  slot_.pop_back();
+  x_.pop_back();
+  y_.pop_back();
+  scale_x_.pop_back();
+  scale_y_.pop_back();
+  cos_.pop_back();
+  sin_.pop_back();
+  color_.pop_back();
+  layer_.pop_back();
+  visible_.pop_back();
+  clip_.pop_back();
+  phase_.pop_back();
+  rate_.pop_back();
+  frame_.pop_back();
+  handles_.Free(handle);
+}
+
+bool SpriteSystem::IsAlive(SpriteHandle sprite) const {
+  return handles_.IsAlive(sprite);
+}
+
+void SpriteSystem::SetPosition(SpriteHandle handle, float x, float y) {
+  uint32_t sprite = GetSprite(handle);
+  if (sprite != kNoSprite) {
+    x_[sprite] = x;
+    y_[sprite] = y;
+  }
+}
+
+void SpriteSystem::SetScale(SpriteHandle handle, float x, float y) {
+  uint32_t sprite = GetSprite(handle);
+  if (sprite != kNoSprite) {
+    scale_x_[sprite] = x;
+    scale_y_[sprite] = y;
+  }
+}
+
+void SpriteSystem::SetRotation(SpriteHandle handle, float rotation) {
+  uint32_t sprite = GetSprite(handle);
+  if (sprite != kNoSprite) {
+    cos_[sprite] = std::cos(rotation);
+    sin_[sprite] = std::sin(rotation);
+  }
+}
+
+void SpriteSystem::SetColor(SpriteHandle handle, uint32_t color) {
+  uint32_t sprite = GetSprite(handle);
+  if (sprite != kNoSprite) {
+    color_[sprite] = color;
+  }
+}
+
+void SpriteSystem::SetLayer(SpriteHandle handle, uint8_t layer) {
+  uint32_t sprite = GetSprite(handle);
+  if (sprite != kNoSprite) {
+    layer_[sprite] = layer;
+  }
+}
+
+void SpriteSystem::SetVisible(SpriteHandle handle, bool visible) {
+  uint32_t sprite = GetSprite(handle);
+  if (sprite != kNoSprite) {
+    visible_count_ += (visible ? 1 : 0) - visible_[sprite];
+    visible_[sprite] = visible ? 1 : 0;
+  }
+}
+
+void SpriteSystem::Play(
+    SpriteHandle handle, uint32_t clip, float speed, bool restart) {
+  ENGINE_CORE_ASSERT(clip < clips_.size(), "Unknown sprite clip.");
+  uint32_t sprite = GetSprite(handle);
+  if (sprite == kNoSprite) {
+    return;
+  }
+
+  rate_[sprite] = clips_[clip].FramesPerSecond * speed;
+  if (restart || clip_[sprite] != clip) {
+    clip_[sprite] = clip;
+    phase_[sprite] = 0.0f;
+    frame_[sprite] = clips_[clip].FirstFrame;
+  }
+}
+
+bool SpriteSystem::IsFinished(SpriteHandle handle) const {
+  uint32_t sprite = GetSprite(handle);
+  if (sprite == kNoSprite) {
+    return true;
+  }
+  const SpriteClip& clip = clips_[clip_[sprite]];
+  return !clip.Loop && phase_[sprite] >= clip.FrameCount;
+}
+
+uint32_t SpriteSystem::GetSprite(SpriteHandle sprite) const {
+  return handles_.IsAlive(sprite) ? sprite_of_slot_[sprite.Index] : kNoSprite;
+}
+
+// --------------------------------- ANIMATION ---------------------------------
+
+void SpriteSystem::Update(float delta_time) {
+  jobs::JobSystem::ParallelFor(
+      GetCount(),
+      kSpritesPerJob,
+      [this, delta_time](uint32_t begin, uint32_t end) {
+        uint32_t i = AdvanceRange<math::float4x>(
+            phase_.data(), rate_.data(), begin, end, delta_time);
+        AdvanceRange<math::float1x>(
+            phase_.data(), rate_.data(), i, end, delta_time);
+        UpdateFrames(begin, end);
+      });
+}
+
+// Looping clocks wrap around in either direction, and the others stop at
+// either end of their clip.
+void SpriteSystem::UpdateFrames(uint32_t begin, uint32_t end) {
+  for (uint32_t i = begin; i < end; ++i) {
+    const SpriteClip& clip = clips_[clip_[i]];
+    float frames = static_cast<float>(clip.FrameCount);
+    float phase = phase_[i];
+    if (phase >= frames || phase < 0.0f) {
+      phase = clip.Loop
+          ? phase - std::floor(phase / frames) * frames
+          : std::min(std::max(phase, 0.0f), frames);
+      phase_[i] = phase;
+    }
+    uint32_t frame = std::min(
+        static_cast<uint32_t>(phase), clip.FrameCount - 1);
+    frame_[i] = clip.FirstFrame + frame;
+  }
+}
+
+// ---------------------------------- DRAWING ----------------------------------
+
+void SpriteSystem::Draw(renderer::QuadBatch* quads) {
+  const uint32_t count = GetCount();
+  keys_.resize(count);
+  order_.resize(count);
+
+  // Within a layer, a lower y is drawn later, so the depth is inverted.
+  jobs::JobSystem::ParallelFor(
+      count, kSpritesPerJob, [this](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; ++i) {
+          order_[i] = i;
+          if (visible_[i] == 0) {
+            keys_[i] = kHiddenKey;
+            continue;
+          }
+          keys_[i] = (uint64_t(layer_[i]) << kLayerShift)
+              | (uint64_t(~OrderedBits(y_[i])) << kDepthShift)
+              | (frames_[frame_[i]].Texture & kTextureMask);
+        }
+      });
+  sorter_.Sort(keys_.data(), order_.data(), count);
+
+  // Only the visible sprites sort before the hidden ones.
+  renderer::QuadInstance* first = quads->Allocate(visible_count_);
+  jobs::JobSystem::ParallelFor(
+      visible_count_,
+      kSpritesPerJob,
+      [this, first](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; ++i) {
+          uint32_t sprite = order_[i];
+          const SpriteFrame& frame = frames_[frame_[sprite]];
+          renderer::QuadInstance& quad = first[i];
+          float half_width = frame.HalfWidth * scale_x_[sprite];
+          float half_height = frame.HalfHeight * scale_y_[sprite];
+          quad.X = x_[sprite];
+          quad.Y = y_[sprite];
+          quad.U0 = frame.U0;
+          quad.V0 = frame.V0;
+          quad.U1 = frame.U1;
+          quad.V1 = frame.V1;
+          if (half_width < 0.0f) {
+            half_width = -half_width;
+            std::swap(quad.U0, quad.U1);
+          }
+          if (half_height < 0.0f) {
+            half_height = -half_height;
+            std::swap(quad.V0, quad.V1);
+          }
+          quad.AxisX = cos_[sprite] * half_width;
+          quad.AxisY = sin_[sprite] * half_width;
+          quad.HalfHeight = half_height;
+          quad.Color = color_[sprite];
+          quad.Texture = frame.Texture;
+        }
+      });
+}
+
+}  // namespace sprites
+}  // namespace engine
@@ -0,0 +1,183 @@
+/**
+ * @file engine/src/core/sprites/SpriteSystem.h
+ * @brief Animated 2D sprites, drawn in layer and depth order with as few
+ * texture changes as the order allows.
+ *
+ * Sprites are stored in parallel arrays and animate through clips of frames
+ * from an atlas table. Each frame, every animation clock is advanced in one
+ * bulk pass and the sprite's current frame is looked up once. Drawing builds
+ * a 64 bit key per visible sprite out of its layer, its depth along y and the
+ * texture of its frame, radix sorts the keys in parallel and writes the quads
+ * in that order, so sprites that tie on layer and depth end up next to the
+ * other sprites with the same texture.
+ */
+#ifndef ENGINE_SRC_CORE_SPRITES_SPRITESYSTEM_H_
+#define ENGINE_SRC_CORE_SPRITES_SPRITESYSTEM_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "core/Core.h"
+#include "core/memory/HandlePool.h"
+#include "core/renderer/QuadBatch.h"
+#include "core/sort/RadixSort.h"
+
+namespace engine {
+namespace sprites {
+
+/**
+ * @struct SpriteFrame
+ * @brief A rectangle of an atlas texture, and the size it is drawn at when
+ * the sprite isn't scaled.
+ */
+struct SpriteFrame {
+  uint32_t Texture = 0;
+  float U0 = 0.0f, V0 = 0.0f, U1 = 1.0f, V1 = 1.0f;
+  float HalfWidth = 8.0f;
+  float HalfHeight = 8.0f;
+};
+
+/**
+ * @struct SpriteClip
+ * @brief An animation of consecutive frames of the atlas table, all shown
+ * for the same amount of time.
+ */
+struct SpriteClip {
+  uint32_t FirstFrame = 0;
+  uint32_t FrameCount = 1;
+  float FramesPerSecond = 12.0f;
+
+  // Clips that don't loop stop on their last frame.
+  bool Loop = true;
+};
+
+/**
+ * @typedef SpriteHandle
+ * @brief Identifies a sprite.
+ */
+typedef memory::Handle<struct SpriteTag> SpriteHandle;
+
+/**
+ * @struct SpriteDesc
+ * @brief The initial state of a sprite.
+ *
+ * Negative scales mirror the sprite. Sprites of higher layers are drawn over
+ * those of lower layers, and within a layer, sprites further down the y axis
+ * are drawn over those above them.
+ */
+struct SpriteDesc {
+  float X = 0.0f, Y = 0.0f;
+  float ScaleX = 1.0f, ScaleY = 1.0f;
+  float Rotation = 0.0f;
+  uint32_t Color = 0xffffffff;
+  uint8_t Layer = 0;
+  uint32_t Clip = 0;
+  float Speed = 1.0f;
+  bool Visible = true;
+};
+
+/**
+ * @class SpriteSystem
+ * @brief The sprites of a scene and the atlas table they animate through.
+ *
+ * Everything but Update and Draw must be called from one thread, and never
+ * while either of them runs.
+ */
+class ENGINE_API SpriteSystem {
+ public:
+  SpriteSystem();
+  ~SpriteSystem();
+
+  /**
+   * @fn AddFrame
+   * @brief Appends a frame to the atlas table and returns its index.
+   */
+  uint32_t AddFrame(const SpriteFrame& frame);
+
+  /**
+   * @fn AddClip
+   * @brief Registers a clip of frames that were already added and returns
+   * its index.
+   */
+  uint32_t AddClip(const SpriteClip& clip);
+
+  SpriteHandle Create(const SpriteDesc& desc);
+  void Destroy(SpriteHandle sprite);
+  bool IsAlive(SpriteHandle sprite) const;
+
+  void SetPosition(SpriteHandle sprite, float x, float y);
+  void SetScale(SpriteHandle sprite, float x, float y);
+  void SetRotation(SpriteHandle sprite, float rotation);
+  void SetColor(SpriteHandle sprite, uint32_t color);
+  void SetLayer(SpriteHandle sprite, uint8_t layer);
+  void SetVisible(SpriteHandle sprite, bool visible);
+
+  /**
+   * @fn Play
+   * @brief Switches a sprite to a clip.
+   * @param restart Starts the clip over even if the sprite is already
+   * playing it.
+   */
+  void Play(
+      SpriteHandle sprite, uint32_t clip, float speed = 1.0f,
+      bool restart = true);
+
+  /**
+   * @fn IsFinished
+   * @brief Whether a sprite has reached the end of a clip that doesn't loop.
+   */
+  bool IsFinished(SpriteHandle sprite) const;
+
+  /**
+   * @fn Update
+   * @brief Advances the animation of every sprite by delta_time seconds.
+   */
+  void Update(float delta_time);
+
+  /**
+   * @fn Draw
+   * @brief Sorts the visible sprites and appends their quads to the batch.
+   */
+  void Draw(renderer::QuadBatch* quads);
+
+  inline uint32_t GetCount() const
+      { return static_cast<uint32_t>(x_.size()); }
+
+ private:
+  std::vector<SpriteFrame> frames_;
+  std::vector<SpriteClip> clips_;
+
+  // Handles map to slots, which point at the sprite's index in the arrays.
+  memory::HandlePool<SpriteHandle> handles_;
+  std::vector<uint32_t> sprite_of_slot_;
+
+  // Sprites, kept dense by swap-removal.
+  std::vector<uint32_t> slot_;
+  std::vector<float> x_, y_;
+  std::vector<float> scale_x_, scale_y_;
+  std::vector<float> cos_, sin_;
+  std::vector<uint32_t> color_;
+  std::vector<uint8_t> layer_;
+  std::vector<uint8_t> visible_;
+  std::vector<uint32_t> clip_;
+
+  // The animation clock in frames of the clip, and the rate it runs at.
+  std::vector<float> phase_, rate_;
+
+  // The atlas frame the sprite currently shows.
+  std::vector<uint32_t> frame_;
+  uint32_t visible_count_ = 0;
+
+  // Scratch for drawing.
+  std::vector<uint64_t> keys_;
+  std::vector<uint32_t> order_;
+  sort::RadixSorter sorter_;
+
+  uint32_t GetSprite(SpriteHandle sprite) const;
+  void UpdateFrames(uint32_t begin, uint32_t end);
+};
+
+}  // namespace sprites
+}  // namespace engine
+
+#endif  // ENGINE_SRC_CORE_SPRITES_SPRITESYSTEM_H_
@@ -0,0 +1,285 @@
+#include "core/timers/TimerWheel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#include "core/Assert.h"
+#include "core/jobs/JobSystem.h"
+
+namespace engine {
+namespace timers {
+
+namespace {
+
+constexpr uint32_t kLevelBits = 8;
+constexpr uint32_t kSlotsPerLevel = 1 << kLevelBits;
+constexpr uint32_t kSlotMask = kSlotsPerLevel - 1;
+constexpr uint32_t kLevelCount = 4;
+
+// Timers further out than the top level reaches are linked at its far end
+// and linked again, closer to their deadline, when that slot cascades.
+constexpr uint64_t kMaxDelta = (uint64_t(1) << (kLevelBits * kLevelCount)) - 1;
+
+constexpr uint32_t kNone = UINT32_MAX;
+constexpr uint16_t kUnlinked = UINT16_MAX;
+
+// Absorbs the rounding error of converting seconds that are a whole number of
+// ticks, so that 0.1 s at 1 ms resolution is 100 ticks rather than 101.
+constexpr double kTickEpsilon = 1e-6;
+
+constexpr uint32_t kJobBatchSize = 16;
+
+}  // namespace
+
+// ---------------------------------- PUBLIC -----------------------------------
+
+TimerWheel::TimerWheel(double resolution, EventCallback event_callback)
+    : resolution_(resolution),
+      event_callback_(std::move(event_callback)),
+      slots_(kSlotsPerLevel * kLevelCount, kNone) {}
+
+TimerHandle TimerWheel::Schedule(
+    double delay, Callback callback, TimerDispatch dispatch, double period) {
+  return Add(delay, period, 0, false, dispatch, std::move(callback));
+}
+
+TimerHandle TimerWheel::ScheduleEvent(
+    double delay, uint64_t tag, double period) {
+  return Add(delay, period, tag, true, TimerDispatch::kImmediate, nullptr);
+}
+
+bool TimerWheel::Cancel(TimerHandle handle) {
+  ENGINE_CORE_ASSERT(
+      !running_jobs_.load(std::memory_order_relaxed),
+      "Job timer callbacks can't cancel timers.");
+  if (!IsPending(handle)) {
+    return false;
+  }
+  // Timers that are firing this tick are already unlinked, and are skipped
+  // once freed.
+  if (timers_[handle.Index].Slot != kUnlinked) {
+    Unlink(handle.Index);
+  }
+  Free(handle);
+  return true;
+}
+
+bool TimerWheel::IsPending(TimerHandle handle) const {
+  return handles_.IsAlive(handle);
+}
+
+double TimerWheel::GetRemainingTime(TimerHandle handle) const {
+  if (!IsPending(handle)) {
+    return 0.0;
+  }
+  uint64_t deadline = timers_[handle.Index].Deadline;
+  uint64_t now = current_tick_ - 1;
+  return deadline > now ? (deadline - now) * resolution_ : 0.0;
+}
+
+void TimerWheel::Advance(double time) {
+  uint64_t target = static_cast<uint64_t>(
+      std::max(0.0, std::floor(time / resolution_ + kTickEpsilon)));
+
+  // An empty wheel has nothing to cascade either.
+  if (pending_count_ == 0) {
+    current_tick_ = std::max(current_tick_, target + 1);
+    return;
+  }
+  while (current_tick_ <= target) {
+    Tick();
+  }
+}
+
+void TimerWheel::Reserve(uint32_t count) {
+  handles_.Reserve(count);
+  timers_.reserve(count);
+  callbacks_.reserve(count);
+}
+
+// --------------------------------- PRIVATE -----------------------------------
+
+TimerHandle TimerWheel::Add(
+    double delay,
+    double period,
+    uint64_t tag,
+    bool sends_event,
+    TimerDispatch dispatch,
+    Callback callback) {
+  ENGINE_CORE_ASSERT(
+      !running_jobs_.load(std::memory_order_relaxed),
+      "Job timer callbacks can't schedule timers.");
+  TimerHandle handle = handles_.Allocate();
+  uint32_t index = handle.Index;
+  if (index == timers_.size()) {
+    timers_.emplace_back();
+    callbacks_.emplace_back();
+  }
+
+  // A delay of up to one tick fires in the next tick, which is also what
+  // keeps timers scheduled by a callback out of the tick that is firing.
+  Timer& timer = timers_[index];
+  timer.Deadline = current_tick_ - 1 + std::max<uint64_t>(ToTicks(delay), 1);
+  timer.Period = period > 0.0 ? std::max<uint64_t>(ToTicks(period), 1) : 0;
+  timer.Tag = tag;
+  timer.SendsEvent = sends_event;
+  timer.Dispatch = dispatch;
+  callbacks_[index] = std::move(callback);
+
+  Link(index);
+  ++pending_count_;
+  return handle;
+}
+
+uint64_t TimerWheel::ToTicks(double seconds) const {
+  return static_cast<uint64_t>(
+      std::max(0.0, std::ceil(seconds / resolution_ - kTickEpsilon)));
+}
+
+// A timer goes into the lowest level whose span still covers its deadline,
+// at the slot its deadline falls in.
+void TimerWheel::Link(uint32_t index) {
+  Timer& timer = timers_[index];
+  uint64_t deadline = std::max(timer.Deadline, current_tick_);
+  uint64_t delta = std::min(deadline - current_tick_, kMaxDelta);
+  deadline = current_tick_ + delta;
+
+  uint32_t level = 0;
+  while (level + 1 < kLevelCount
+         && delta >= (uint64_t(1) << (kLevelBits * (level + 1)))) {
+    ++level;
+  }
+  uint32_t slot = level * kSlotsPerLevel
+      + static_cast<uint32_t>((deadline >> (kLevelBits * level)) & kSlotMask);
+
+  timer.Slot = static_cast<uint16_t>(slot);
+  timer.Previous = kNone;
+  timer.Next = slots_[slot];
+  if (timer.Next != kNone) {
+    timers_[timer.Next].Previous = index;
+  }
+  slots_[slot] = index;
+}
+
+void TimerWheel::Unlink(uint32_t index) {
+  Timer& timer = timers_[index];
+  if (timer.Previous != kNone) {
+    timers_[timer.Previous].Next = timer.Next;
+  } else {
+    slots_[timer.Slot] = timer.Next;
+  }
+  if (timer.Next != kNone) {
+    timers_[timer.Next].Previous = timer.Previous;
+  }
+  timer.Slot = kUnlinked;
+}
+
+void TimerWheel::Free(TimerHandle handle) {
+  handles_.Free(handle);
+  timers_[handle.Index].Slot = kUnlinked;
+  callbacks_[handle.Index] = nullptr;
+  --pending_count_;
+}
+
+uint32_t TimerWheel::DetachSlot(uint32_t slot) {
+  uint32_t head = slots_[slot];
+  slots_[slot] = kNone;
+  for (uint32_t index = head; index != kNone; index = timers_[index].Next) {
+    timers_[index].Slot = kUnlinked;
+  }
+  return head;
+}
+
+void TimerWheel::Cascade(uint32_t level) {
+  uint32_t slot = level * kSlotsPerLevel + static_cast<uint32_t>(
+      (current_tick_ >> (kLevelBits * level)) & kSlotMask);
+  uint32_t index = DetachSlot(slot);
+  while (index != kNone) {
+    uint32_t next = timers_[index].Next;
+    Link(index);
+    index = next;
+  }
+}
+
+void TimerWheel::Tick() {
+  // When a level wraps around, the next slot of the level above it is due to
+  // be spread over the levels below.
+  for (uint32_t level = 1; level < kLevelCount; ++level) {
+    if ((current_tick_ >> (kLevelBits * (level - 1))) & kSlotMask) {
+      break;
+    }
+    Cascade(level);
+  }
+
+  uint32_t index = DetachSlot(current_tick_ & kSlotMask);
+  ++current_tick_;
+  if (index == kNone) {
+    return;
+  }
+
+  // Repeating timers are linked again before any callback runs, so that the
+  // callbacks can cancel them like any other pending timer.
+  fired_.clear();
+  for (; index != kNone; index = timers_[index].Next) {
+    fired_.push_back(handles_.GetHandle(index));
+  }
+  for (TimerHandle handle : fired_) {
+    Timer& timer = timers_[handle.Index];
+    if (timer.Period != 0) {
+      timer.Deadline += timer.Period;
+      Link(handle.Index);
+    }
+  }
+
+  // Immediate callbacks may schedule timers, which can move both vectors, so
+  // nothing is held across a call.
+  for (TimerHandle handle : fired_) {
+    if (!handles_.IsAlive(handle)) {
+      continue;  // Cancelled by an earlier callback of this tick.
+    }
+
+    const Timer& timer = timers_[handle.Index];
+    bool repeats = timer.Period != 0;
+    if (timer.SendsEvent) {
+      TimerEvent event(handle, timer.Tag);
+      if (!repeats) {
+        Free(handle);
+      }
+      if (event_callback_) {
+        event_callback_(&event);
+      }
+      continue;
+    }
+
+    Callback callback = repeats ? callbacks_[handle.Index]
+                                : std::move(callbacks_[handle.Index]);
+    TimerDispatch dispatch = timer.Dispatch;
+    if (!repeats) {
+      Free(handle);
+    }
+    if (dispatch == TimerDispatch::kJob) {
+      jobs_.push_back(std::move(callback));
+    } else if (callback) {
+      callback();
+    }
+  }
+
+  if (!jobs_.empty()) {
+    running_jobs_.store(true, std::memory_order_relaxed);
+    jobs::JobSystem::ParallelFor(
+        static_cast<uint32_t>(jobs_.size()), kJobBatchSize,
+        [this](uint32_t begin, uint32_t end) {
+          for (uint32_t job = begin; job < end; ++job) {
+            if (jobs_[job]) {
+              jobs_[job]();
+            }
+          }
+        });
+    running_jobs_.store(false, std::memory_order_relaxed);
+    jobs_.clear();
+  }
+}
+
+}  // namespace timers
+}  // namespace engine
@@ -0,0 +1,227 @@
+/**
+ * @file engine/src/core/timers/TimerWheel.h
+ * @brief Scheduled callbacks and delayed events driven by a world's clock.
+ *
+ * Timers are kept in a hierarchical timing wheel: four levels of 256 slots,
+ * where every slot of a level covers 256 times the span of a slot of the
+ * level below it. A timer is linked into the slot its deadline falls in, and
+ * whenever the lowest level wraps around, the next slot of the level above it
+ * is redistributed into the levels below. Scheduling and cancelling are a
+ * constant time list insertion and removal, and advancing the wheel only
+ * touches the timers that fire or move down a level, so a million pending
+ * cooldowns cost nothing until they're due.
+ *
+ * Deadlines are rounded up to whole ticks of the wheel's resolution. Timers
+ * due in the same tick fire together, in no particular order.
+ */
+#ifndef ENGINE_SRC_CORE_TIMERS_TIMERWHEEL_H_
+#define ENGINE_SRC_CORE_TIMERS_TIMERWHEEL_H_
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "core/Core.h"
+#include "core/events/Event.h"
+#include "core/memory/HandlePool.h"
+
+namespace engine {
+namespace timers {
+
+/**
+ * @typedef TimerHandle
+ * @brief Identifies a scheduled timer.
+ */
+typedef memory::Handle<struct TimerTag> TimerHandle;
+
+/**
+ * @enum TimerDispatch
+ * @brief Where the callback of a timer runs when it fires.
+ */
+enum class TimerDispatch : uint8_t {
+  // On the thread advancing the wheel, in the middle of the tick. Callbacks
+  // may schedule and cancel timers.
+  kImmediate,
+
+  // As a job, in parallel with the other job timers that fire in the same
+  // tick. The tick waits for them to finish. Job callbacks must not touch the
+  // wheel.
+  kJob
+};
+
+/**
+ * @class TimerEvent
+ * @brief Sent to the layers of a world when a timer scheduled with
+ * TimerWheel::ScheduleEvent fires.
+ */
+class ENGINE_API TimerEvent : public events::Event {
+ public:
+  TimerEvent(TimerHandle handle, uint64_t tag)
+      : handle_(handle), tag_(tag) {}
+
+  inline TimerHandle GetHandle() const { return handle_; }
+
+  /**
+   * @fn GetTag
+   * @brief Get the value the timer was scheduled with, which tells the layers
+   * what the timer was for.
+   */
+  inline uint64_t GetTag() const { return tag_; }
+
+  std::string ToString() const override {
+    std::stringstream event_string;
+    event_string << "TimerEvent: " << tag_;
+    return event_string.str();
+  }
+
+  EVENT_CLASS_TYPE(kTimer)
+  EVENT_CLASS_CATEGORY(events::kEventCategoryApplication)
+
+ private:
+  TimerHandle handle_;
+  uint64_t tag_;
+};
+
+/**
+ * @class TimerWheel
+ * @brief A hierarchical timing wheel.
+ *
+ * Every world owns one, advanced by the world's clock before its layers
+ * update (Check `World::GetTimers`), so timers pause and scale with the
+ * world. A wheel isn't thread safe: only the thread advancing it and the
+ * immediate callbacks it runs may schedule and cancel timers. Job callbacks
+ * run on worker threads while the wheel is mid tick, so they must not touch
+ * it at all; a job timer that needs to repeat is scheduled with a period.
+ */
+class ENGINE_API TimerWheel {
+ public:
+  typedef std::function<void()> Callback;
+  typedef std::function<void(events::Event* event)> EventCallback;
+
+  /**
+   * @param resolution Seconds per tick of the wheel. With 1 ms ticks the
+   * wheel reaches 49 days ahead; timers further out are parked in its top
+   * level until they come into range.
+   * @param event_callback Receives the events of timers scheduled with
+   * ScheduleEvent.
+   */
+  explicit TimerWheel(
+      double resolution = 0.001, EventCallback event_callback = nullptr);
+
+  TimerWheel(const TimerWheel&) = delete;
+  TimerWheel& operator=(const TimerWheel&) = delete;
+
+  /**
+   * @fn Schedule
+   * @param delay Seconds from the last time the wheel was advanced to.
+   * @param period Seconds between repeats, or 0 to fire once.
+   * @brief Schedules a callback. Must not be called from a job callback.
+   */
+  TimerHandle Schedule(
+      double delay,
+      Callback callback,
+      TimerDispatch dispatch = TimerDispatch::kImmediate,
+      double period = 0.0);
+
+  /**
+   * @fn ScheduleEvent
+   * @brief Schedules a TimerEvent with the given tag to be sent to the event
+   * callback.
+   */
+  TimerHandle ScheduleEvent(double delay, uint64_t tag, double period = 0.0);
+
+  /**
+   * @fn Cancel
+   * @brief Cancels a pending timer, or stops a repeating one. Must not be
+   * called from a job callback.
+   * @return false if the timer had already fired or been cancelled.
+   */
+  bool Cancel(TimerHandle handle);
+
+  /**
+   * @fn IsPending
+   * @brief Returns true if the timer is still going to fire.
+   */
+  bool IsPending(TimerHandle handle) const;
+
+  /**
+   * @fn GetRemainingTime
+   * @brief Get the seconds until a pending timer fires, rounded up to whole
+   * ticks, or 0 if it isn't pending.
+   */
+  double GetRemainingTime(TimerHandle handle) const;
+
+  /**
+   * @fn Advance
+   * @param time Seconds since the wheel was created, e.g. WorldClock::Time.
+   * @brief Fires every timer that is due by the given time, tick by tick.
+   */
+  void Advance(double time);
+
+  /**
+   * @fn Reserve
+   * @brief Preallocates room for a number of pending timers, so scheduling
+   * doesn't allocate until there are more.
+   */
+  void Reserve(uint32_t count);
+
+  inline uint32_t GetPendingCount() const { return pending_count_; }
+  inline double GetResolution() const { return resolution_; }
+
+ private:
+  struct Timer {
+    uint64_t Deadline = 0;
+    uint64_t Period = 0;
+    uint64_t Tag = 0;
+    uint32_t Next = 0;
+    uint32_t Previous = 0;
+    uint16_t Slot = 0;
+    bool SendsEvent = false;
+    TimerDispatch Dispatch = TimerDispatch::kImmediate;
+  };
+
+  TimerHandle Add(
+      double delay,
+      double period,
+      uint64_t tag,
+      bool sends_event,
+      TimerDispatch dispatch,
+      Callback callback);
+  uint64_t ToTicks(double seconds) const;
+  void Link(uint32_t index);
+  void Unlink(uint32_t index);
+  void Free(TimerHandle handle);
+  uint32_t DetachSlot(uint32_t slot);
+  void Cascade(uint32_t level);
+  void Tick();
+
+  double resolution_;
+  EventCallback event_callback_;
+
+  // The next tick to process. Tick 0 is the moment the wheel was created.
+  uint64_t current_tick_ = 1;
+
+  // Timers are referenced by index, so cancelling one is an unlink from its
+  // slot's doubly linked list. Callbacks live apart from the links that
+  // advancing the wheel walks.
+  memory::HandlePool<TimerHandle> handles_;
+  std::vector<Timer> timers_;
+  std::vector<Callback> callbacks_;
+  std::vector<uint32_t> slots_;
+  uint32_t pending_count_ = 0;
+
+  // The timers firing in the current tick.
+  std::vector<TimerHandle> fired_;
+  std::vector<Callback> jobs_;
+
+  // Set while job callbacks run, to catch the ones that touch the wheel.
+  std::atomic<bool> running_jobs_{false};
+};
+
+}  // namespace timers
+}  // namespace engine
+
+#endif  // ENGINE_SRC_CORE_TIMERS_TIMERWHEEL_H_
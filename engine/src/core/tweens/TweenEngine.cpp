@@ -0,0 +1,394 @@
+#include "core/tweens/TweenEngine.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "core/Assert.h"
+#include "core/math/Wide.h"
+
+namespace engine {
+namespace tweens {
+
+namespace {
+
+// Used for tweens without a duration, which finish on the first advance
+// after their delay.
+constexpr float kInstantInverseDuration = 1e30f;
+
+constexpr float kBackOvershoot = 1.70158f;
+
+// ---------------------------------- CURVES -----------------------------------
+
+// The in-out curves combine both halves without branching: with
+// a = min(t, 1/2) and b = max(t, 1/2), each half is constant outside its own
+// range, so their sum minus the value where they meet is the curve.
+
+struct LinearCurve {
+  template<typename Wide>
+  static inline Wide Apply(Wide t) { return t; }
+};
+
+struct QuadInCurve {
+  template<typename Wide>
+  static inline Wide Apply(Wide t) { return t * t; }
+};
+
+struct QuadOutCurve {
+  template<typename Wide>
+  static inline Wide Apply(Wide t) { return t * (Wide::Broadcast(2.0f) - t); }
+};
+
+struct QuadInOutCurve {
+  template<typename Wide>
+  static inline Wide Apply(Wide t) {
+    const Wide half = Wide::Broadcast(0.5f);
+    const Wide two = Wide::Broadcast(2.0f);
+    Wide a = math::Min(t, half);
+    Wide b = Wide::Broadcast(1.0f) - math::Max(t, half);
+    return math::NegMulAdd(two * b, b, math::MulAdd(two * a, a, half));
+  }
+};
+
+struct CubicInCurve {
+  template<typename Wide>
+  static inline Wide Apply(Wide t) { return t * t * t; }
+};
+
+struct CubicOutCurve {
+  template<typename Wide>
+  static inline Wide Apply(Wide t) {
+    Wide u = Wide::Broadcast(1.0f) - t;
+    return math::NegMulAdd(u * u, u, Wide::Broadcast(1.0f));
+  }
+};
+
+struct CubicInOutCurve {
+  template<typename Wide>
+  static inline Wide Apply(Wide t) {
+    const Wide half = Wide::Broadcast(0.5f);
+    const Wide four = Wide::Broadcast(4.0f);
+    Wide a = math::Min(t, half);
+    Wide b = Wide::Broadcast(1.0f) - math::Max(t, half);
+    return math::NegMulAdd(
+        four * b * b, b, math::MulAdd(four * a * a, a, half));
+  }
+};
+
+struct SmoothstepCurve {
+  template<typename Wide>
+  static inline Wide Apply(Wide t) {
+    return t * t * math::NegMulAdd(
+        Wide::Broadcast(2.0f), t, Wide::Broadcast(3.0f));
+  }
+};
+
+struct BackInCurve {
+  template<typename Wide>
+  static inline Wide Apply(Wide t) {
+    Wide t2 = t * t;
+    return math::NegMulAdd(
+        Wide::Broadcast(kBackOvershoot), t2,
+        Wide::Broadcast(kBackOvershoot + 1.0f) * t2 * t);
+  }
+};
+
+struct BackOutCurve {
+  template<typename Wide>
+  static inline Wide Apply(Wide t) {
+    Wide u = t - Wide::Broadcast(1.0f);
+    Wide u2 = u * u;
+    return math::MulAdd(
+        Wide::Broadcast(kBackOvershoot), u2,
+        math::MulAdd(
+            Wide::Broadcast(kBackOvershoot + 1.0f) * u2, u,
+            Wide::Broadcast(1.0f)));
+  }
+};
+
+// Advances and evaluates [begin, end) in steps of the wide type and returns
+// the index of the first tween it didn't process.
+template<typename Wide, typename Curve>
+uint32_t EvaluateRange(
+    const float* from,
+    const float* to,
+    float* elapsed,
+    const float* inverse_duration,
+    float* value,
+    uint32_t begin,
+    uint32_t end,
+    float delta_time) {
+  const Wide step = Wide::Broadcast(delta_time);
+  const Wide zero = Wide::Broadcast(0.0f);
+  const Wide one = Wide::Broadcast(1.0f);
+  uint32_t i = begin;
+  for (; i + Wide::kWidth <= end; i += Wide::kWidth) {
+    Wide time = Wide::Load(elapsed + i) + step;
+    time.Store(elapsed + i);
+    Wide t = math::Min(
+        math::Max(time * Wide::Load(inverse_duration + i), zero), one);
+    Wide start = Wide::Load(from + i);
+    math::MulAdd(Wide::Load(to + i) - start, Curve::Apply(t), start)
+        .Store(value + i);
+  }
+  return i;
+}
+
+template<typename Curve>
+void Evaluate(
+    const float* from,
+    const float* to,
+    float* elapsed,
+    const float* inverse_duration,
+    float* value,
+    uint32_t count,
+    float delta_time) {
+  uint32_t i = EvaluateRange<math::float4x, Curve>(
+      from, to, elapsed, inverse_duration, value, 0, count, delta_time);
+  EvaluateRange<math::float1x, Curve>(
+      from, to, elapsed, inverse_duration, value, i, count, delta_time);
+}
+
+}  // namespace
+
+TweenEngine::TweenEngine(EventCallback event_callback)
+    : event_callback_(std::move(event_callback)) {}
+
+TweenHandle TweenEngine::Start(const TweenDesc& desc) {
+  ENGINE_CORE_ASSERT(
+      desc.Ease < Easing::Count, "Tweens need a valid easing function.");
+
+  TweenHandle handle = handles_.Allocate();
+  uint32_t slot_index = handle.Index;
+  if (slot_index == slots_.size()) {
+    slots_.emplace_back();
+  }
+
+  Pool& pool = pools_[static_cast<int>(desc.Ease)];
+  Slot& slot = slots_[slot_index];
+  slot.Ease = desc.Ease;
+  slot.Index = static_cast<uint32_t>(pool.Slot.size());
+  slot.Next = TweenHandle();
+  slot.Tag = desc.Tag;
+  slot.Sequence = next_sequence_++;
+
+  pool.From.push_back(desc.From);
+  pool.To.push_back(desc.To);
+  pool.Elapsed.push_back(-desc.Delay);
+  pool.InverseDuration.push_back(
+      desc.Duration > 0.0f ? 1.0f / desc.Duration : kInstantInverseDuration);
+  pool.Value.push_back(desc.From);
+  pool.Target.push_back(desc.Target);
+  pool.Slot.push_back(slot_index);
+  ++active_count_;
+  return handle;
+}
+
+// Sequencing is only a delay, so a sequenced tween waits in its pool like
+// any other delayed tween.
+TweenHandle TweenEngine::Then(TweenHandle previous, const TweenDesc& desc) {
+  const Slot* previous_slot = FindSlot(previous);
+  if (previous_slot == nullptr) {
+    return Start(desc);
+  }
+
+  // The chain is cancelled with its first tween, so only a tween that
+  // nothing is sequenced after yet can take a successor.
+  ENGINE_CORE_ASSERT(
+      FindSlot(previous_slot->Next) == nullptr,
+      "A tween can only have one tween sequenced after it.");
+
+  TweenDesc delayed = desc;
+  delayed.Delay += GetRemainingTime(*previous_slot);
+  TweenHandle handle = Start(delayed);
+  slots_[previous.Index].Next = handle;
+  return handle;
+}
+
+bool TweenEngine::Cancel(TweenHandle handle) {
+  if (FindSlot(handle) == nullptr) {
+    return false;
+  }
+  while (FindSlot(handle) != nullptr) {
+    TweenHandle next = slots_[handle.Index].Next;
+    Remove(handle.Index);
+    handle = next;
+  }
+  return true;
+}
+
+bool TweenEngine::IsActive(TweenHandle handle) const {
+  return FindSlot(handle) != nullptr;
+}
+
+float TweenEngine::GetValue(TweenHandle handle) const {
+  const Slot* slot = FindSlot(handle);
+  if (slot == nullptr) {
+    return 0.0f;
+  }
+  return pools_[static_cast<int>(slot->Ease)].Value[slot->Index];
+}
+
+void TweenEngine::Reserve(uint32_t count) {
+  for (Pool& pool : pools_) {
+    pool.From.reserve(count);
+    pool.To.reserve(count);
+    pool.Elapsed.reserve(count);
+    pool.InverseDuration.reserve(count);
+    pool.Value.reserve(count);
+    pool.Target.reserve(count);
+    pool.Slot.reserve(count);
+  }
+  handles_.Reserve(count);
+  slots_.reserve(count);
+  finished_.reserve(count);
+  completions_.reserve(count);
+}
+
+// --------------------------------- ADVANCING ---------------------------------
+
+void TweenEngine::Advance(float delta_time) {
+  finished_.clear();
+  for (int ease = 0; ease < static_cast<int>(Easing::Count); ++ease) {
+    if (!pools_[ease].Slot.empty()) {
+      EvaluatePool(static_cast<Easing>(ease), delta_time);
+    }
+  }
+  if (finished_.empty()) {
+    return;
+  }
+
+  // Finished tweens are removed only after every pool was evaluated, since
+  // removing swaps tweens around within their pool.
+  std::sort(
+      finished_.begin(), finished_.end(), [this](uint32_t a, uint32_t b) {
+        return slots_[a].Sequence < slots_[b].Sequence;
+      });
+  completions_.clear();
+  for (uint32_t slot_index : finished_) {
+    completions_.push_back(
+        {handles_.GetHandle(slot_index), slots_[slot_index].Tag});
+    Remove(slot_index);
+  }
+
+  // The event borrows the scratch buffer for the callback and hands it back
+  // afterwards, so reporting completions doesn't allocate. Handlers that keep
+  // the event copy it.
+  if (event_callback_) {
+    TweensCompletedEvent event(std::move(completions_));
+    event_callback_(&event);
+    completions_ = std::move(event.completions_);
+  }
+}
+
+void TweenEngine::EvaluatePool(Easing ease, float delta_time) {
+  Pool& pool = pools_[static_cast<int>(ease)];
+  const uint32_t count = static_cast<uint32_t>(pool.Slot.size());
+  const float* from = pool.From.data();
+  const float* to = pool.To.data();
+  float* elapsed = pool.Elapsed.data();
+  const float* inverse_duration = pool.InverseDuration.data();
+  float* value = pool.Value.data();
+
+  switch (ease) {
+    case Easing::Linear:
+      Evaluate<LinearCurve>(
+          from, to, elapsed, inverse_duration, value, count, delta_time);
+      break;
+    case Easing::QuadIn:
+      Evaluate<QuadInCurve>(
+          from, to, elapsed, inverse_duration, value, count, delta_time);
+      break;
+    case Easing::QuadOut:
+      Evaluate<QuadOutCurve>(
+          from, to, elapsed, inverse_duration, value, count, delta_time);
+      break;
+    case Easing::QuadInOut:
+      Evaluate<QuadInOutCurve>(
+          from, to, elapsed, inverse_duration, value, count, delta_time);
+      break;
+    case Easing::CubicIn:
+      Evaluate<CubicInCurve>(
+          from, to, elapsed, inverse_duration, value, count, delta_time);
+      break;
+    case Easing::CubicOut:
+      Evaluate<CubicOutCurve>(
+          from, to, elapsed, inverse_duration, value, count, delta_time);
+      break;
+    case Easing::CubicInOut:
+      Evaluate<CubicInOutCurve>(
+          from, to, elapsed, inverse_duration, value, count, delta_time);
+      break;
+    case Easing::Smoothstep:
+      Evaluate<SmoothstepCurve>(
+          from, to, elapsed, inverse_duration, value, count, delta_time);
+      break;
+    case Easing::BackIn:
+      Evaluate<BackInCurve>(
+          from, to, elapsed, inverse_duration, value, count, delta_time);
+      break;
+    case Easing::BackOut:
+      Evaluate<BackOutCurve>(
+          from, to, elapsed, inverse_duration, value, count, delta_time);
+      break;
+    default:
+      break;
+  }
+
+  // Finished tweens land exactly on their end value, whatever the rounding
+  // of the curve.
+  for (uint32_t i = 0; i < count; ++i) {
+    bool instant = inverse_duration[i] == kInstantInverseDuration;
+    if (elapsed[i] * inverse_duration[i] >= 1.0f
+        || (instant && elapsed[i] >= 0.0f)) {
+      value[i] = to[i];
+      finished_.push_back(pool.Slot[i]);
+    }
+    if (elapsed[i] >= 0.0f && pool.Target[i] != nullptr) {
+      *pool.Target[i] = value[i];
+    }
+  }
+}
+
+const TweenEngine::Slot* TweenEngine::FindSlot(TweenHandle handle) const {
+  return handles_.IsAlive(handle) ? &slots_[handle.Index] : nullptr;
+}
+
+// Includes the delay of tweens that haven't started yet.
+float TweenEngine::GetRemainingTime(const Slot& slot) const {
+  const Pool& pool = pools_[static_cast<int>(slot.Ease)];
+  float inverse_duration = pool.InverseDuration[slot.Index];
+  float duration = inverse_duration == kInstantInverseDuration
+      ? 0.0f
+      : 1.0f / inverse_duration;
+  return std::max(0.0f, duration - pool.Elapsed[slot.Index]);
+}
+
+void TweenEngine::Remove(uint32_t slot_index) {
+  Slot& slot = slots_[slot_index];
+  Pool& pool = pools_[static_cast<int>(slot.Ease)];
+  uint32_t index = slot.Index;
+  uint32_t last = static_cast<uint32_t>(pool.Slot.size() - 1);
+  if (index != last) {
+    pool.From[index] = pool.From[last];
+    pool.To[index] = pool.To[last];
+    pool.Elapsed[index] = pool.Elapsed[last];
+    pool.InverseDuration[index] = pool.InverseDuration[last];
+    pool.Value[index] = pool.Value[last];
+    pool.Target[index] = pool.Target[last];
+    pool.Slot[index] = pool.Slot[last];
+    slots_[pool.Slot[index]].Index = index;
+  }
+  pool.From.pop_back();
+  pool.To.pop_back();
+  pool.Elapsed.pop_back();
+  pool.InverseDuration.pop_back();
+  pool.Value.pop_back();
+  pool.Target.pop_back();
+  pool.Slot.pop_back();
+
+  handles_.Free(handles_.GetHandle(slot_index));
+  --active_count_;
+}
+
+}  // namespace tweens
+}  // namespace engine
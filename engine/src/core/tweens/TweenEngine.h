@@ -0,0 +1,230 @@
+/**
+ * @file engine/src/core/tweens/TweenEngine.h
+ * @brief Eased animations of float values, evaluated in bulk.
+ *
+ * Active tweens live in one pool per easing function, each pool a set of
+ * parallel arrays, so that advancing them is a tight SIMD loop per easing
+ * with no virtual calls. Tweens are swap-removed from their pool when they
+ * finish or are cancelled, which keeps every frame proportional to the
+ * number of active tweens, and pools and handles are recycled, so starting a
+ * tween doesn't allocate once the engine has seen as many at a time before.
+ * Everything that finished during a frame is reported in a single event.
+ *
+ * A tween animates one float. Vectors and colors are animated with a tween
+ * per component, which share a pool when they share an easing.
+ */
+#ifndef ENGINE_SRC_CORE_TWEENS_TWEENENGINE_H_
+#define ENGINE_SRC_CORE_TWEENS_TWEENENGINE_H_
+
+#include <cstdint>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "core/Core.h"
+#include "core/events/Event.h"
+#include "core/memory/HandlePool.h"
+
+namespace engine {
+namespace tweens {
+
+/**
+ * @enum Easing
+ * @brief How a tween moves from its start to its end value over time.
+ *
+ * The back curves overshoot by about 10 percent.
+ */
+enum class Easing : uint8_t {
+  Linear = 0,
+  QuadIn,
+  QuadOut,
+  QuadInOut,
+  CubicIn,
+  CubicOut,
+  CubicInOut,
+  Smoothstep,
+  BackIn,
+  BackOut,
+  Count
+};
+
+/**
+ * @typedef TweenHandle
+ * @brief Identifies a tween.
+ */
+typedef memory::Handle<struct TweenTag> TweenHandle;
+
+/**
+ * @struct TweenDesc
+ * @brief A tween to start.
+ */
+struct TweenDesc {
+  float From = 0.0f;
+  float To = 1.0f;
+  float Duration = 1.0f;
+
+  // Seconds to wait before starting, during which the target isn't written.
+  float Delay = 0.0f;
+  Easing Ease = Easing::Linear;
+
+  // Written with the value every frame if not null. Must stay valid until
+  // the tween finishes or is cancelled.
+  float* Target = nullptr;
+
+  // Passed through to the completion, e.g. to tell what finished.
+  uint64_t Tag = 0;
+};
+
+/**
+ * @struct TweenCompletion
+ * @brief A tween that finished.
+ */
+struct TweenCompletion {
+  TweenHandle Handle;
+  uint64_t Tag;
+};
+
+/**
+ * @class TweensCompletedEvent
+ * @brief Sent once per advance in which any tweens finished, listing all of
+ * them in the order they were started.
+ *
+ * The event owns its completions, so it can be copied or queued to be
+ * handled later.
+ */
+class ENGINE_API TweensCompletedEvent : public events::Event {
+ public:
+  explicit TweensCompletedEvent(std::vector<TweenCompletion> completions)
+      : completions_(std::move(completions)) {}
+
+  inline const std::vector<TweenCompletion>& GetCompletions() const {
+    return completions_;
+  }
+
+  std::string ToString() const override {
+    std::stringstream event_string;
+    event_string << "TweensCompletedEvent: " << completions_.size();
+    return event_string.str();
+  }
+
+  EVENT_CLASS_TYPE(kTweensCompleted)
+  EVENT_CLASS_CATEGORY(events::kEventCategoryApplication)
+
+ private:
+  // Takes the event's buffer back after sending it.
+  friend class TweenEngine;
+
+  std::vector<TweenCompletion> completions_;
+};
+
+/**
+ * @class TweenEngine
+ * @brief All the active tweens of a world.
+ *
+ * Every world owns one, advanced by the world's clock after its timers
+ * (Check `World::GetTweens`). An engine isn't thread safe.
+ */
+class ENGINE_API TweenEngine {
+ public:
+  typedef std::function<void(events::Event* event)> EventCallback;
+
+  /**
+   * @param event_callback Receives a TweensCompletedEvent whenever tweens
+   * finish.
+   */
+  explicit TweenEngine(EventCallback event_callback = nullptr);
+
+  TweenEngine(const TweenEngine&) = delete;
+  TweenEngine& operator=(const TweenEngine&) = delete;
+
+  /**
+   * @fn Start
+   * @brief Starts a tween, which first writes its target on the next advance.
+   */
+  TweenHandle Start(const TweenDesc& desc);
+
+  /**
+   * @fn Then
+   * @brief Starts a tween once another one finishes, plus the new tween's
+   * delay. Cancelling the earlier tween cancels this one as well.
+   *
+   * Starts right away if previous isn't active anymore.
+   */
+  TweenHandle Then(TweenHandle previous, const TweenDesc& desc);
+
+  /**
+   * @fn Cancel
+   * @brief Stops a tween where it is, along with the tweens sequenced after
+   * it. Cancelled tweens aren't reported as completed.
+   * @return false if the tween had already finished or been cancelled.
+   */
+  bool Cancel(TweenHandle handle);
+
+  bool IsActive(TweenHandle handle) const;
+
+  /**
+   * @fn GetValue
+   * @brief Get the value of an active tween as of the last advance, or 0.
+   */
+  float GetValue(TweenHandle handle) const;
+
+  /**
+   * @fn Advance
+   * @brief Moves every tween delta_time seconds forward, writes their
+   * targets and reports the ones that finished.
+   */
+  void Advance(float delta_time);
+
+  /**
+   * @fn Reserve
+   * @brief Preallocates room for a number of active tweens of each easing.
+   */
+  void Reserve(uint32_t count);
+
+  inline uint32_t GetActiveCount() const { return active_count_; }
+
+ private:
+  // The tweens of one easing.
+  struct Pool {
+    std::vector<float> From, To;
+    std::vector<float> Elapsed, InverseDuration;
+    std::vector<float> Value;
+    std::vector<float*> Target;
+    std::vector<uint32_t> Slot;
+  };
+
+  struct Slot {
+    Easing Ease = Easing::Linear;
+    uint32_t Index = 0;
+
+    // The tween sequenced after this one, if any.
+    TweenHandle Next;
+    uint64_t Tag = 0;
+
+    // Orders the completions of a frame.
+    uint64_t Sequence = 0;
+  };
+
+  Pool pools_[static_cast<int>(Easing::Count)];
+  memory::HandlePool<TweenHandle> handles_;
+  std::vector<Slot> slots_;
+  uint32_t active_count_ = 0;
+  uint64_t next_sequence_ = 0;
+  EventCallback event_callback_;
+
+  // Scratch for one advance.
+  std::vector<uint32_t> finished_;
+  std::vector<TweenCompletion> completions_;
+
+  const Slot* FindSlot(TweenHandle handle) const;
+  float GetRemainingTime(const Slot& slot) const;
+  void Remove(uint32_t slot);
+  void EvaluatePool(Easing ease, float delta_time);
+};
+
+}  // namespace tweens
+}  // namespace engine
+
+#endif  // ENGINE_SRC_CORE_TWEENS_TWEENENGINE_H_
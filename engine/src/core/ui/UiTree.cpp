@@ -0,0 +1,579 @@
+#include "core/ui/UiTree.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "core/Log.h"
+
+namespace engine {
+namespace ui {
+
+namespace {
+
+// The size of a cell of the hit test grid in pixels.
+constexpr float kHitCellSize = 64.0f;
+
+const UiStyle kNoStyle;
+const UiVisual kNoVisual;
+const std::string kNoText;
+
+inline bool IsTransparent(uint32_t color) { return (color >> 24) == 0; }
+
+}  // namespace
+
+float UiFont::Measure(const std::string& text) const {
+  float width = 0.0f;
+  for (char character : text) {
+    if (character >= kFirstCharacter && character <= kLastCharacter
+        && static_cast<size_t>(character - kFirstCharacter) < Glyphs.size()) {
+      width += Glyphs[character - kFirstCharacter].Advance;
+    }
+  }
+  return width;
+}
+
+UiTree::UiTree(float width, float height, const UiFont* font)
+    : font_(font), width_(width), height_(height) {
+  handles_.Allocate();
+  nodes_.emplace_back();
+  nodes_[0].Flags = kAlive | kLayoutDirty | kGeometryDirty;
+  geometry_dirty_.push_back(0);
+}
+
+UiTree::~UiTree() {}
+
+// ---------------------------------- WIDGETS ----------------------------------
+
+UiNode UiTree::Create(UiNode parent) {
+  if (FindNode(parent) == nullptr) {
+    ENGINE_CORE_ERROR("Can't create a widget under a destroyed widget.");
+    return UiNode();
+  }
+
+  UiNode handle = handles_.Allocate();
+  uint32_t index = handle.Index;
+  if (index == nodes_.size()) {
+    nodes_.emplace_back();
+  }
+
+  Node& node = nodes_[index];
+  Node& parent_node = nodes_[parent.Index];
+  node.Flags = kAlive;
+  node.Parent = parent.Index;
+  node.PreviousSibling = parent_node.LastChild;
+  if (parent_node.LastChild != kNone) {
+    nodes_[parent_node.LastChild].NextSibling = index;
+  } else {
+    parent_node.FirstChild = index;
+  }
+  parent_node.LastChild = index;
+
+  MarkLayoutDirty(index);
+  MarkGeometryDirty(index);
+  hit_dirty_ = true;
+  return handle;
+}
+
+void UiTree::Destroy(UiNode handle) {
+  if (FindNode(handle) == nullptr || handle.Index == 0) {
+    return;
+  }
+
+  Node& node = nodes_[handle.Index];
+  Node& parent = nodes_[node.Parent];
+  if (node.PreviousSibling != kNone) {
+    nodes_[node.PreviousSibling].NextSibling = node.NextSibling;
+  } else {
+    parent.FirstChild = node.NextSibling;
+  }
+  if (node.NextSibling != kNone) {
+    nodes_[node.NextSibling].PreviousSibling = node.PreviousSibling;
+  } else {
+    parent.LastChild = node.PreviousSibling;
+  }
+
+  MarkLayoutDirty(node.Parent);
+  FreeSubtree(handle.Index);
+  paint_dirty_ = true;
+  hit_dirty_ = true;
+}
+
+bool UiTree::IsAlive(UiNode node) const {
+  return FindNode(node) != nullptr;
+}
+
+void UiTree::SetStyle(UiNode handle, const UiStyle& style) {
+  Node* node = FindNode(handle);
+  if (node == nullptr) {
+    return;
+  }
+  if (style.Visible != node->Style.Visible
+      || style.Interactive != node->Style.Interactive) {
+    paint_dirty_ = true;
+    hit_dirty_ = true;
+  }
+  node->Style = style;
+  MarkLayoutDirty(handle.Index);
+  MarkGeometryDirty(handle.Index);
+}
+
+void UiTree::SetVisual(UiNode handle, const UiVisual& visual) {
+  if (FindNode(handle) != nullptr) {
+    nodes_[handle.Index].Visual = visual;
+    MarkGeometryDirty(handle.Index);
+  }
+}
+
+void UiTree::SetText(UiNode handle, const std::string& text) {
+  Node* node = FindNode(handle);
+  if (node == nullptr || node->Text == text) {
+    return;
+  }
+  node->Text = text;
+  MarkLayoutDirty(handle.Index);
+  MarkGeometryDirty(handle.Index);
+}
+
+const UiStyle& UiTree::GetStyle(UiNode handle) const {
+  const Node* node = FindNode(handle);
+  return node != nullptr ? node->Style : kNoStyle;
+}
+
+const UiVisual& UiTree::GetVisual(UiNode handle) const {
+  const Node* node = FindNode(handle);
+  return node != nullptr ? node->Visual : kNoVisual;
+}
+
+const std::string& UiTree::GetText(UiNode handle) const {
+  const Node* node = FindNode(handle);
+  return node != nullptr ? node->Text : kNoText;
+}
+
+UiRect UiTree::GetRect(UiNode handle) const {
+  const Node* node = FindNode(handle);
+  return node != nullptr ? node->Rect : UiRect();
+}
+
+void UiTree::SetViewport(float width, float height) {
+  width_ = width;
+  height_ = height;
+  hit_dirty_ = true;
+}
+
+// Every widget's text and size depends on the font.
+void UiTree::SetFont(const UiFont* font) {
+  font_ = font;
+  for (uint32_t i = 0; i < nodes_.size(); ++i) {
+    if (nodes_[i].Flags & kAlive) {
+      MarkLayoutDirty(i);
+      MarkGeometryDirty(i);
+    }
+  }
+}
+
+UiTree::Node* UiTree::FindNode(UiNode handle) {
+  return const_cast<Node*>(
+      static_cast<const UiTree*>(this)->FindNode(handle));
+}
+
+const UiTree::Node* UiTree::FindNode(UiNode handle) const {
+  return handles_.IsAlive(handle) ? &nodes_[handle.Index] : nullptr;
+}
+
+// Invisible widgets are never arranged and keep their flag, so the walk
+// can't stop at the first flagged ancestor.
+void UiTree::MarkLayoutDirty(uint32_t node) {
+  for (; node != kNone; node = nodes_[node].Parent) {
+    nodes_[node].Flags |= kLayoutDirty;
+  }
+}
+
+void UiTree::MarkGeometryDirty(uint32_t node) {
+  if (!(nodes_[node].Flags & kGeometryDirty)) {
+    nodes_[node].Flags |= kGeometryDirty;
+    geometry_dirty_.push_back(node);
+  }
+}
+
+void UiTree::FreeSubtree(uint32_t index) {
+  uint32_t child = nodes_[index].FirstChild;
+  while (child != kNone) {
+    uint32_t next = nodes_[child].NextSibling;
+    FreeSubtree(child);
+    child = next;
+  }
+
+  nodes_[index] = Node();
+  handles_.Free(handles_.GetHandle(index));
+}
+
+// ---------------------------------- UPDATE -----------------------------------
+
+void UiTree::Update() {
+  UiRect viewport = {0.0f, 0.0f, width_, height_};
+  if ((nodes_[0].Flags & kLayoutDirty) || nodes_[0].Rect != viewport) {
+    Measure(0);
+    Arrange(0, viewport);
+  }
+
+  // Widgets destroyed since they were flagged are simply skipped.
+  for (uint32_t index : geometry_dirty_) {
+    Node& node = nodes_[index];
+    if ((node.Flags & kAlive) && (node.Flags & kGeometryDirty)) {
+      BuildGeometry(&node);
+      node.Flags &= ~kGeometryDirty;
+      paint_dirty_ = true;
+    }
+  }
+  geometry_dirty_.clear();
+
+  if (paint_dirty_) {
+    MergeGeometry();
+    paint_dirty_ = false;
+  }
+  if (hit_dirty_) {
+    BuildHitGrid();
+    hit_dirty_ = false;
+  }
+}
+
+void UiTree::Draw(renderer::QuadBatch* quads) const {
+  uint32_t count = static_cast<uint32_t>(merged_.size());
+  if (count > 0) {
+    std::memcpy(
+        quads->Allocate(count), merged_.data(),
+        count * sizeof(renderer::QuadInstance));
+  }
+}
+
+UiNode UiTree::HitTest(float x, float y) const {
+  if (!(x >= 0.0f && y >= 0.0f && x < width_ && y < height_)
+      || cell_start_.empty()) {
+    return UiNode();
+  }
+  uint32_t cell_x = std::min(
+      static_cast<uint32_t>(x / kHitCellSize), cells_x_ - 1);
+  uint32_t cell_y = std::min(
+      static_cast<uint32_t>(y / kHitCellSize), cells_y_ - 1);
+  uint32_t cell = cell_y * cells_x_ + cell_x;
+
+  // Cells list their widgets in paint order, so the last match is on top.
+  for (uint32_t entry = cell_start_[cell + 1]; entry > cell_start_[cell];
+       --entry) {
+    uint32_t index = cell_nodes_[entry - 1];
+    if (nodes_[index].Rect.Contains(x, y)) {
+      return handles_.GetHandle(index);
+    }
+  }
+  return UiNode();
+}
+
+// ---------------------------------- LAYOUT -----------------------------------
+
+/**
+ * Computes the size a widget wants, which is either its fixed size or what
+ * its text and visible children need along each axis. Sizes of widgets that
+ * aren't flagged are still valid from the last update.
+ */
+void UiTree::Measure(uint32_t index) {
+  Node& node = nodes_[index];
+  if (!(node.Flags & kLayoutDirty)) {
+    return;
+  }
+
+  float content_width = 0.0f;
+  float content_height = 0.0f;
+  if (font_ != nullptr && !node.Text.empty()) {
+    content_width = font_->Measure(node.Text);
+    content_height = font_->LineHeight;
+  }
+
+  const bool row = node.Style.Direction == UiDirection::Row;
+  float main = 0.0f;
+  float cross = 0.0f;
+  uint32_t count = 0;
+  for (uint32_t child = node.FirstChild; child != kNone;
+       child = nodes_[child].NextSibling) {
+    if (!nodes_[child].Style.Visible) {
+      continue;
+    }
+    Measure(child);
+    const Node& measured = nodes_[child];
+    main += row ? measured.MeasuredWidth : measured.MeasuredHeight;
+    cross = std::max(
+        cross, row ? measured.MeasuredHeight : measured.MeasuredWidth);
+    ++count;
+  }
+  if (count > 1) {
+    main += node.Style.Gap * (count - 1);
+  }
+  content_width = std::max(content_width, row ? main : cross);
+  content_height = std::max(content_height, row ? cross : main);
+
+  const float padding = 2.0f * node.Style.Padding;
+  node.MeasuredWidth = node.Style.Width >= 0.0f
+      ? node.Style.Width
+      : content_width + padding;
+  node.MeasuredHeight = node.Style.Height >= 0.0f
+      ? node.Style.Height
+      : content_height + padding;
+}
+
+/**
+ * Places a widget and then its visible children inside its padding. Widgets
+ * that land where they already were and aren't flagged keep their whole
+ * subtree as is.
+ */
+void UiTree::Arrange(uint32_t index, const UiRect& rect) {
+  Node& node = nodes_[index];
+  const bool moved = node.Rect != rect;
+  if (!moved && !(node.Flags & kLayoutDirty)) {
+    return;
+  }
+  if (moved) {
+    node.Rect = rect;
+    MarkGeometryDirty(index);
+    hit_dirty_ = true;
+  }
+  node.Flags &= ~kLayoutDirty;
+
+  const UiStyle& style = node.Style;
+  const bool row = style.Direction == UiDirection::Row;
+  const float padding = style.Padding;
+  const float content_x = rect.X + padding;
+  const float content_y = rect.Y + padding;
+  const float content_main =
+      std::max(0.0f, (row ? rect.Width : rect.Height) - 2.0f * padding);
+  const float content_cross =
+      std::max(0.0f, (row ? rect.Height : rect.Width) - 2.0f * padding);
+
+  uint32_t count = 0;
+  float used = 0.0f;
+  float grow = 0.0f;
+  for (uint32_t child = node.FirstChild; child != kNone;
+       child = nodes_[child].NextSibling) {
+    const Node& measured = nodes_[child];
+    if (measured.Style.Visible) {
+      used += row ? measured.MeasuredWidth : measured.MeasuredHeight;
+      grow += std::max(0.0f, measured.Style.Grow);
+      ++count;
+    }
+  }
+  if (count == 0) {
+    return;
+  }
+
+  float free = content_main - used - style.Gap * (count - 1);
+  float position = 0.0f;
+  float spacing = style.Gap;
+  if (grow > 0.0f || free <= 0.0f) {
+    free = std::max(free, 0.0f);
+  } else if (style.Justify == UiJustify::Center) {
+    position = 0.5f * free;
+  } else if (style.Justify == UiJustify::End) {
+    position = free;
+  } else if (style.Justify == UiJustify::SpaceBetween && count > 1) {
+    spacing += free / (count - 1);
+  }
+
+  for (uint32_t child = node.FirstChild; child != kNone;
+       child = nodes_[child].NextSibling) {
+    const Node& measured = nodes_[child];
+    const UiStyle& child_style = measured.Style;
+    if (!child_style.Visible) {
+      continue;
+    }
+
+    float main = row ? measured.MeasuredWidth : measured.MeasuredHeight;
+    if (grow > 0.0f) {
+      main += free * std::max(0.0f, child_style.Grow) / grow;
+    }
+
+    float cross = row ? measured.MeasuredHeight : measured.MeasuredWidth;
+    float fixed_cross = row ? child_style.Height : child_style.Width;
+    float cross_position = 0.0f;
+    if (style.Align == UiAlign::Stretch && fixed_cross < 0.0f) {
+      cross = content_cross;
+    } else if (style.Align == UiAlign::Center) {
+      cross_position = 0.5f * (content_cross - cross);
+    } else if (style.Align == UiAlign::End) {
+      cross_position = content_cross - cross;
+    }
+
+    UiRect child_rect;
+    if (row) {
+      child_rect = {
+          content_x + position, content_y + cross_position, main, cross};
+    } else {
+      child_rect = {
+          content_x + cross_position, content_y + position, cross, main};
+    }
+    Arrange(child, child_rect);
+    position += main + spacing;
+  }
+}
+
+// --------------------------------- GEOMETRY ----------------------------------
+
+void UiTree::BuildGeometry(Node* node) const {
+  node->Quads.clear();
+  const UiRect& rect = node->Rect;
+  const UiVisual& visual = node->Visual;
+  const uint32_t atlas = font_ != nullptr ? font_->Texture : 0;
+
+  if (!IsTransparent(visual.Color) && rect.Width > 0.0f
+      && rect.Height > 0.0f) {
+    renderer::QuadInstance quad;
+    quad.X = rect.X + 0.5f * rect.Width;
+    quad.Y = rect.Y + 0.5f * rect.Height;
+    quad.AxisX = 0.5f * rect.Width;
+    quad.AxisY = 0.0f;
+    quad.HalfHeight = 0.5f * rect.Height;
+    quad.Color = visual.Color;
+    if (visual.Image) {
+      quad.U0 = visual.U0;
+      quad.V0 = visual.V0;
+      quad.U1 = visual.U1;
+      quad.V1 = visual.V1;
+      quad.Texture = visual.Texture;
+    } else {
+      float u = font_ != nullptr ? font_->WhiteU : 0.0f;
+      float v = font_ != nullptr ? font_->WhiteV : 0.0f;
+      quad.U0 = quad.U1 = u;
+      quad.V0 = quad.V1 = v;
+      quad.Texture = atlas;
+    }
+    node->Quads.push_back(quad);
+  }
+
+  if (font_ == nullptr || node->Text.empty()
+      || IsTransparent(visual.TextColor)) {
+    return;
+  }
+
+  // The line starts inside the padding and is centered vertically.
+  float pen = rect.X + node->Style.Padding;
+  float top = rect.Y + 0.5f * (rect.Height - font_->LineHeight);
+  for (char character : node->Text) {
+    size_t glyph_index = static_cast<size_t>(
+        character - UiFont::kFirstCharacter);
+    if (character < UiFont::kFirstCharacter
+        || character > UiFont::kLastCharacter
+        || glyph_index >= font_->Glyphs.size()) {
+      continue;
+    }
+
+    const UiGlyph& glyph = font_->Glyphs[glyph_index];
+    if (glyph.Width > 0.0f && glyph.Height > 0.0f) {
+      renderer::QuadInstance quad;
+      quad.X = std::round(pen + glyph.OffsetX) + 0.5f * glyph.Width;
+      quad.Y = std::round(top + glyph.OffsetY) + 0.5f * glyph.Height;
+      quad.AxisX = 0.5f * glyph.Width;
+      quad.AxisY = 0.0f;
+      quad.HalfHeight = 0.5f * glyph.Height;
+      quad.U0 = glyph.U0;
+      quad.V0 = glyph.V0;
+      quad.U1 = glyph.U1;
+      quad.V1 = glyph.V1;
+      quad.Color = visual.TextColor;
+      quad.Texture = atlas;
+      node->Quads.push_back(quad);
+    }
+    pen += glyph.Advance;
+  }
+}
+
+void UiTree::MergeGeometry() {
+  merged_.clear();
+  uint32_t index = 0;
+  while (index != kNone) {
+    const Node& node = nodes_[index];
+    if (!node.Style.Visible) {
+      index = NextInPaintOrder(index, true);
+      continue;
+    }
+    merged_.insert(merged_.end(), node.Quads.begin(), node.Quads.end());
+    index = NextInPaintOrder(index, false);
+  }
+  ++version_;
+}
+
+// Interactive widgets are counting sorted into every cell they overlap, in
+// paint order.
+void UiTree::BuildHitGrid() {
+  cells_x_ = std::max(1u, static_cast<uint32_t>(
+      std::ceil(width_ / kHitCellSize)));
+  cells_y_ = std::max(1u, static_cast<uint32_t>(
+      std::ceil(height_ / kHitCellSize)));
+  cell_start_.assign(cells_x_ * cells_y_ + 1, 0);
+
+  auto for_each_cell = [this](const UiRect& rect, auto function) {
+    if (rect.Width <= 0.0f || rect.Height <= 0.0f || rect.X >= width_
+        || rect.Y >= height_ || rect.X + rect.Width <= 0.0f
+        || rect.Y + rect.Height <= 0.0f) {
+      return;
+    }
+    auto cell = [](float value, uint32_t cells) {
+      return std::min(
+          static_cast<uint32_t>(std::max(value, 0.0f) / kHitCellSize),
+          cells - 1);
+    };
+    uint32_t x0 = cell(rect.X, cells_x_);
+    uint32_t y0 = cell(rect.Y, cells_y_);
+    uint32_t x1 = cell(rect.X + rect.Width, cells_x_);
+    uint32_t y1 = cell(rect.Y + rect.Height, cells_y_);
+    for (uint32_t y = y0; y <= y1; ++y) {
+      for (uint32_t x = x0; x <= x1; ++x) {
+        function(y * cells_x_ + x);
+      }
+    }
+  };
+
+  auto for_each_interactive = [this](auto function) {
+    uint32_t index = 0;
+    while (index != kNone) {
+      const Node& node = nodes_[index];
+      if (!node.Style.Visible) {
+        index = NextInPaintOrder(index, true);
+        continue;
+      }
+      if (node.Style.Interactive) {
+        function(index);
+      }
+      index = NextInPaintOrder(index, false);
+    }
+  };
+
+  for_each_interactive([&](uint32_t index) {
+    for_each_cell(nodes_[index].Rect, [this](uint32_t cell) {
+      ++cell_start_[cell + 1];
+    });
+  });
+  for (size_t cell = 1; cell < cell_start_.size(); ++cell) {
+    cell_start_[cell] += cell_start_[cell - 1];
+  }
+
+  cell_nodes_.resize(cell_start_.back());
+  std::vector<uint32_t> next(cell_start_.begin(), cell_start_.end() - 1);
+  for_each_interactive([&](uint32_t index) {
+    for_each_cell(nodes_[index].Rect, [&](uint32_t cell) {
+      cell_nodes_[next[cell]++] = index;
+    });
+  });
+}
+
+uint32_t UiTree::NextInPaintOrder(uint32_t index, bool skip_children) const {
+  if (!skip_children && nodes_[index].FirstChild != kNone) {
+    return nodes_[index].FirstChild;
+  }
+  for (; index != kNone; index = nodes_[index].Parent) {
+    if (nodes_[index].NextSibling != kNone) {
+      return nodes_[index].NextSibling;
+    }
+  }
+  return kNone;
+}
+
+}  // namespace ui
+}  // namespace engine
@@ -0,0 +1,298 @@
+/**
+ * @file engine/src/core/ui/UiTree.h
+ * @brief Retained mode UI for menus and HUDs shipped with a game.
+ *
+ * Unlike the ImGui tools, which rebuild everything every frame, the tree
+ * keeps its widgets, their layout and their geometry between frames and only
+ * redoes the work for what changed. Changing a widget flags it and its
+ * ancestors, and the flexbox style layout then measures and arranges only
+ * along those flagged paths, skipping every subtree whose rectangle came out
+ * the same. Each widget caches the quads of its background and text, the
+ * quads of all widgets are merged in paint order into one array, and solid
+ * backgrounds sample a white texel of the font atlas so that a whole UI
+ * drawn from one atlas is a single draw call. Interactive widgets are binned
+ * into a grid for hit testing. A tree in which nothing changed costs a copy
+ * of its merged quads per frame.
+ *
+ * Coordinates are in pixels from the top left corner of the viewport, with y
+ * pointing down. Text is a single line.
+ */
+#ifndef ENGINE_SRC_CORE_UI_UITREE_H_
+#define ENGINE_SRC_CORE_UI_UITREE_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "core/Core.h"
+#include "core/memory/HandlePool.h"
+#include "core/renderer/QuadBatch.h"
+
+namespace engine {
+namespace ui {
+
+/**
+ * @var kUiAuto
+ * @brief A width or height that fits the content of a widget.
+ */
+constexpr float kUiAuto = -1.0f;
+
+enum class UiDirection : uint8_t { Row, Column };
+enum class UiJustify : uint8_t { Start, Center, End, SpaceBetween };
+enum class UiAlign : uint8_t { Start, Center, End, Stretch };
+
+/**
+ * @struct UiStyle
+ * @brief How a widget is sized and how it lays out its children.
+ *
+ * Children are placed one after the other along the direction and aligned
+ * across it. Space left over along the direction goes to the children with
+ * a Grow above 0, in proportion to it, or is distributed by Justify if none
+ * of them grow. Invisible widgets take up no space.
+ */
+struct UiStyle {
+  UiDirection Direction = UiDirection::Column;
+  UiJustify Justify = UiJustify::Start;
+  UiAlign Align = UiAlign::Stretch;
+  float Width = kUiAuto;
+  float Height = kUiAuto;
+  float Grow = 0.0f;
+  float Padding = 0.0f;
+  float Gap = 0.0f;
+  bool Visible = true;
+
+  // Whether HitTest can return the widget.
+  bool Interactive = false;
+};
+
+/**
+ * @struct UiVisual
+ * @brief What a widget draws. Colors are RGBA with red in the lowest byte.
+ */
+struct UiVisual {
+  // The background, which isn't drawn if it is fully transparent.
+  uint32_t Color = 0;
+
+  // Draws the background with a rectangle of a texture instead of solid.
+  bool Image = false;
+  uint32_t Texture = 0;
+  float U0 = 0.0f, V0 = 0.0f, U1 = 1.0f, V1 = 1.0f;
+
+  uint32_t TextColor = 0xffffffff;
+};
+
+/**
+ * @struct UiGlyph
+ * @brief A character of a bitmap font, in pixels.
+ */
+struct UiGlyph {
+  float U0 = 0.0f, V0 = 0.0f, U1 = 0.0f, V1 = 0.0f;
+  float Width = 0.0f, Height = 0.0f;
+
+  // From the pen position on the top of the line to the top left corner.
+  float OffsetX = 0.0f, OffsetY = 0.0f;
+  float Advance = 0.0f;
+};
+
+/**
+ * @struct UiFont
+ * @brief A bitmap font for the printable ASCII characters, stored in an
+ * atlas that also holds a white texel for solid quads.
+ */
+struct UiFont {
+  static constexpr char kFirstCharacter = ' ';
+  static constexpr char kLastCharacter = '~';
+
+  uint32_t Texture = 0;
+  float LineHeight = 16.0f;
+  float WhiteU = 0.0f, WhiteV = 0.0f;
+
+  // One glyph per character from kFirstCharacter to kLastCharacter.
+  std::vector<UiGlyph> Glyphs;
+
+  /**
+   * @fn Measure
+   * @brief Get the width of a line of text.
+   */
+  float Measure(const std::string& text) const;
+};
+
+/**
+ * @struct UiRect
+ * @brief A rectangle of the viewport.
+ */
+struct UiRect {
+  float X = 0.0f, Y = 0.0f, Width = 0.0f, Height = 0.0f;
+
+  inline bool Contains(float x, float y) const {
+    return x >= X && y >= Y && x < X + Width && y < Y + Height;
+  }
+
+  inline bool operator==(const UiRect& other) const {
+    return X == other.X && Y == other.Y && Width == other.Width
+        && Height == other.Height;
+  }
+  inline bool operator!=(const UiRect& other) const
+      { return !(*this == other); }
+};
+
+/**
+ * @typedef UiNode
+ * @brief Identifies a widget.
+ */
+typedef memory::Handle<struct UiNodeTag> UiNode;
+
+/**
+ * @class UiTree
+ * @brief A tree of widgets filling a viewport.
+ *
+ * Widgets are painted in tree order, so children are drawn over their parent
+ * and later siblings over earlier ones. Changes take effect on the next
+ * Update.
+ */
+class ENGINE_API UiTree {
+ public:
+  UiTree(float width, float height, const UiFont* font = nullptr);
+  ~UiTree();
+
+  UiTree(const UiTree&) = delete;
+  UiTree& operator=(const UiTree&) = delete;
+
+  /**
+   * @fn GetRoot
+   * @brief Get the widget that always fills the viewport.
+   */
+  inline UiNode GetRoot() const { return handles_.GetHandle(0); }
+
+  /**
+   * @fn Create
+   * @brief Creates a widget as the last child of parent.
+   */
+  UiNode Create(UiNode parent);
+
+  /**
+   * @fn Destroy
+   * @brief Destroys a widget and all of its descendants. The root can't be
+   * destroyed.
+   */
+  void Destroy(UiNode node);
+  bool IsAlive(UiNode node) const;
+
+  void SetStyle(UiNode node, const UiStyle& style);
+  void SetVisual(UiNode node, const UiVisual& visual);
+  void SetText(UiNode node, const std::string& text);
+
+  const UiStyle& GetStyle(UiNode node) const;
+  const UiVisual& GetVisual(UiNode node) const;
+  const std::string& GetText(UiNode node) const;
+
+  /**
+   * @fn GetRect
+   * @brief Get where the last Update placed a widget.
+   */
+  UiRect GetRect(UiNode node) const;
+
+  void SetViewport(float width, float height);
+
+  /**
+   * @fn SetFont
+   * @brief Sets the font of all text, which must outlive the tree or be
+   * replaced before it is destroyed.
+   */
+  void SetFont(const UiFont* font);
+
+  /**
+   * @fn Update
+   * @brief Lays out the widgets that changed and rebuilds their geometry.
+   */
+  void Update();
+
+  /**
+   * @fn Draw
+   * @brief Appends the quads of every visible widget to the batch.
+   */
+  void Draw(renderer::QuadBatch* quads) const;
+
+  /**
+   * @fn HitTest
+   * @brief Get the topmost visible, interactive widget at a point, or an
+   * invalid node if there is none.
+   */
+  UiNode HitTest(float x, float y) const;
+
+  /**
+   * @fn GetVersion
+   * @brief Get a number that changes whenever the drawn quads do, so that a
+   * renderer can keep them on the GPU until it does.
+   */
+  inline uint64_t GetVersion() const { return version_; }
+
+ private:
+  static constexpr uint32_t kNone = 0xffffffff;
+
+  enum NodeFlags : uint8_t {
+    kAlive = BIT(0),
+
+    // The widget or one of its descendants changed size or content, so it
+    // has to be measured and arranged again.
+    kLayoutDirty = BIT(1),
+
+    // The widget's own quads are out of date.
+    kGeometryDirty = BIT(2)
+  };
+
+  struct Node {
+    uint8_t Flags = 0;
+    uint32_t Parent = kNone;
+    uint32_t FirstChild = kNone, LastChild = kNone;
+    uint32_t PreviousSibling = kNone, NextSibling = kNone;
+    UiStyle Style;
+    UiVisual Visual;
+    std::string Text;
+    float MeasuredWidth = 0.0f, MeasuredHeight = 0.0f;
+    UiRect Rect;
+    std::vector<renderer::QuadInstance> Quads;
+  };
+
+  memory::HandlePool<UiNode> handles_;
+  std::vector<Node> nodes_;
+  const UiFont* font_;
+  float width_, height_;
+
+  // Set when something has to be merged or binned again.
+  std::vector<uint32_t> geometry_dirty_;
+  bool paint_dirty_ = true;
+  bool hit_dirty_ = true;
+
+  std::vector<renderer::QuadInstance> merged_;
+  uint64_t version_ = 0;
+
+  // Hit test grid of the interactive widgets in paint order.
+  uint32_t cells_x_ = 0, cells_y_ = 0;
+  std::vector<uint32_t> cell_start_;
+  std::vector<uint32_t> cell_nodes_;
+
+  Node* FindNode(UiNode node);
+  const Node* FindNode(UiNode node) const;
+  void MarkLayoutDirty(uint32_t node);
+  void MarkGeometryDirty(uint32_t node);
+  void FreeSubtree(uint32_t node);
+
+  void Measure(uint32_t node);
+  void Arrange(uint32_t node, const UiRect& rect);
+  void BuildGeometry(Node* node) const;
+  void MergeGeometry();
+  void BuildHitGrid();
+
+  /**
+   * @fn NextInPaintOrder
+   * @brief Get the widget painted after node, skipping the descendants of
+   * node if skip_children is set.
+   */
+  uint32_t NextInPaintOrder(uint32_t node, bool skip_children) const;
+};
+
+}  // namespace ui
+}  // namespace engine
+
+#endif  // ENGINE_SRC_CORE_UI_UITREE_H_
@@ -7,7 +7,6 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 
-#include "core/Application.h"
 #include "core/Input.h"
 
 namespace engine {
@@ -15,6 +14,7 @@ namespace engine {
 #ifdef ENGINE_PLATFORM_LINUX
 
 Input* Input::kInput_ = new platform::linux::InputImplementation();
+const Window* Input::kWindow_ = nullptr;
 
 #endif  // ENGINE_PLATFORM_LINUX
 
@@ -22,8 +22,7 @@ namespace platform {
 namespace linux {
 
 bool InputImplementation::IsKeyPressedImpl(int key_code) {
-  GLFWwindow* window = static_cast<GLFWwindow*>(
-      Application::GetApplication().GetWindow().GetNativeWindow());
+  GLFWwindow* window = static_cast<GLFWwindow*>(GetNativeWindow());
 
   int state = glfwGetKey(window, key_code);
   return state == GLFW_PRESS || state == GLFW_REPEAT;
@@ -40,8 +39,7 @@ float InputImplementation::GetMouseYImpl() {
 }
 
 std::pair<float, float> InputImplementation::GetMousePositionImpl() {
-  GLFWwindow* window = static_cast<GLFWwindow*>(
-      Application::GetApplication().GetWindow().GetNativeWindow());
+  GLFWwindow* window = static_cast<GLFWwindow*>(GetNativeWindow());
 
   double x_pos, y_pos;
   glfwGetCursorPos(window, &x_pos, &y_pos);
@@ -50,8 +48,7 @@ std::pair<float, float> InputImplementation::GetMousePositionImpl() {
 }
 
 bool InputImplementation::IsMouseButtonPressedImpl(int button) {
-  GLFWwindow* window = static_cast<GLFWwindow*>(
-      Application::GetApplication().GetWindow().GetNativeWindow());
+  GLFWwindow* window = static_cast<GLFWwindow*>(GetNativeWindow());
 
   int state = glfwGetMouseButton(window, button);
   return state == GLFW_PRESS;
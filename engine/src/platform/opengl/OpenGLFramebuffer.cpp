@@ -0,0 +1,206 @@
+#include "platform/opengl/OpenGLFramebuffer.h"
+
+#include <algorithm>
+#include <string>
+
+#include <glad/glad.h>
+
+#include "core/Assert.h"
+
+namespace engine {
+namespace platform {
+namespace opengl {
+
+namespace {
+
+// A triangle covering the viewport, generated from the vertex index.
+const char* kUpscaleVertexSource = R"(
+    #version 410 core
+
+    out vec2 v_TexCoord;
+
+    void main() {
+      v_TexCoord = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+      gl_Position = vec4(v_TexCoord * 2.0 - 1.0, 0.0, 1.0);
+    }
+)";
+
+// Unsharp masking over the bilinear samples of a pixel and its neighbours
+// one source texel away, clamped to the range of those samples so that it
+// doesn't ring around edges. Samples are kept within the rendered rectangle
+// so that nothing outside of it bleeds in.
+const char* kSharpenFragmentSource = R"(
+    #version 410 core
+
+    layout(location = 0) out vec4 color;
+
+    uniform sampler2D u_Scene;
+    uniform vec2 u_UvScale;
+    uniform vec2 u_TexelSize;
+    uniform float u_Sharpness;
+
+    in vec2 v_TexCoord;
+
+    vec3 Sample(vec2 uv) {
+      vec2 low = 0.5 * u_TexelSize;
+      vec2 high = u_UvScale - 0.5 * u_TexelSize;
+      return texture(u_Scene, clamp(uv, low, high)).rgb;
+    }
+
+    void main() {
+      vec2 uv = v_TexCoord * u_UvScale;
+      vec3 center = Sample(uv);
+      vec3 north = Sample(uv + vec2(0.0, u_TexelSize.y));
+      vec3 south = Sample(uv - vec2(0.0, u_TexelSize.y));
+      vec3 east = Sample(uv + vec2(u_TexelSize.x, 0.0));
+      vec3 west = Sample(uv - vec2(u_TexelSize.x, 0.0));
+
+      vec3 low = min(center, min(min(north, south), min(east, west)));
+      vec3 high = max(center, max(max(north, south), max(east, west)));
+      vec3 detail = 4.0 * center - north - south - east - west;
+      color = vec4(clamp(center + detail * 0.5 * u_Sharpness, low, high), 1.0);
+    }
+)";
+
+}  // namespace
+
+OpenGLFramebuffer::OpenGLFramebuffer(uint32_t width, uint32_t height)
+    : width_(width),
+      height_(height),
+      render_width_(width),
+      render_height_(height) {
+  Allocate();
+
+  // The upscale triangle has no attributes, but core profiles still need a
+  // vertex array bound to draw.
+  glGenVertexArrays(1, &vertex_array_);
+  sharpen_shader_.reset(new renderer::Shader(
+      kUpscaleVertexSource, kSharpenFragmentSource));
+
+  uint32_t program = sharpen_shader_->GetRendererID();
+  uv_scale_location_ = glGetUniformLocation(program, "u_UvScale");
+  texel_size_location_ = glGetUniformLocation(program, "u_TexelSize");
+  sharpness_location_ = glGetUniformLocation(program, "u_Sharpness");
+  sharpen_shader_->Bind();
+  glUniform1i(glGetUniformLocation(program, "u_Scene"), 0);
+  sharpen_shader_->Unbind();
+}
+
+OpenGLFramebuffer::~OpenGLFramebuffer() {
+  Release();
+  glDeleteVertexArrays(1, &vertex_array_);
+}
+
+void OpenGLFramebuffer::Bind() const {
+  glBindFramebuffer(GL_FRAMEBUFFER, renderer_ID_);
+  glViewport(0, 0, render_width_, render_height_);
+}
+
+void OpenGLFramebuffer::Unbind() const {
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void OpenGLFramebuffer::Resize(uint32_t width, uint32_t height) {
+  if (width == width_ && height == height_) {
+    return;
+  }
+  Release();
+  width_ = width;
+  height_ = height;
+  render_width_ = width;
+  render_height_ = height;
+  Allocate();
+}
+
+void OpenGLFramebuffer::SetRenderSize(uint32_t width, uint32_t height) {
+  render_width_ = std::max<uint32_t>(1, std::min(width, width_));
+  render_height_ = std::max<uint32_t>(1, std::min(height, height_));
+}
+
+void OpenGLFramebuffer::Upscale(
+    uint32_t width,
+    uint32_t height,
+    renderer::UpscaleFilter filter,
+    float sharpness) const {
+  bool same_size = width == render_width_ && height == render_height_;
+  if (filter == renderer::UpscaleFilter::Bilinear || same_size) {
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, renderer_ID_);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    glBlitFramebuffer(
+        0, 0, render_width_, render_height_,
+        0, 0, width, height,
+        GL_COLOR_BUFFER_BIT,
+        same_size ? GL_NEAREST : GL_LINEAR);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    return;
+  }
+
+  glViewport(0, 0, width, height);
+  glDisable(GL_BLEND);
+  glDisable(GL_DEPTH_TEST);
+  glDisable(GL_SCISSOR_TEST);
+
+  sharpen_shader_->Bind();
+  glActiveTexture(GL_TEXTURE0);
+  glBindTexture(GL_TEXTURE_2D, color_attachment_);
+  glUniform2f(
+      uv_scale_location_,
+      static_cast<float>(render_width_) / width_,
+      static_cast<float>(render_height_) / height_);
+  glUniform2f(texel_size_location_, 1.0f / width_, 1.0f / height_);
+  glUniform1f(
+      sharpness_location_, std::min(std::max(sharpness, 0.0f), 1.0f));
+
+  glBindVertexArray(vertex_array_);
+  glDrawArrays(GL_TRIANGLES, 0, 3);
+  glBindVertexArray(0);
+  sharpen_shader_->Unbind();
+}
+
+void OpenGLFramebuffer::Allocate() {
+  ENGINE_CORE_ASSERT(
+      width_ > 0 && height_ > 0, "Framebuffers can't be empty.");
+
+  glGenFramebuffers(1, &renderer_ID_);
+  glBindFramebuffer(GL_FRAMEBUFFER, renderer_ID_);
+
+  glGenTextures(1, &color_attachment_);
+  glBindTexture(GL_TEXTURE_2D, color_attachment_);
+  glTexImage2D(
+      GL_TEXTURE_2D, 0, GL_RGBA8, width_, height_, 0, GL_RGBA,
+      GL_UNSIGNED_BYTE, nullptr);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+  glBindTexture(GL_TEXTURE_2D, 0);
+  glFramebufferTexture2D(
+      GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, color_attachment_,
+      0);
+
+  glGenRenderbuffers(1, &depth_attachment_);
+  glBindRenderbuffer(GL_RENDERBUFFER, depth_attachment_);
+  glRenderbufferStorage(
+      GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width_, height_);
+  glBindRenderbuffer(GL_RENDERBUFFER, 0);
+  glFramebufferRenderbuffer(
+      GL_FRAMEBUFFER,
+      GL_DEPTH_STENCIL_ATTACHMENT,
+      GL_RENDERBUFFER,
+      depth_attachment_);
+
+  ENGINE_CORE_ASSERT(
+      glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE,
+      "The framebuffer is incomplete.");
+  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void OpenGLFramebuffer::Release() {
+  glDeleteFramebuffers(1, &renderer_ID_);
+  glDeleteTextures(1, &color_attachment_);
+  glDeleteRenderbuffers(1, &depth_attachment_);
+}
+
+}  // namespace opengl
+}  // namespace platform
+}  // namespace engine
@@ -0,0 +1,66 @@
+#ifndef ENGINE_SRC_PLATFORM_OPENGL_OPENGLFRAMEBUFFER_H_
+#define ENGINE_SRC_PLATFORM_OPENGL_OPENGLFRAMEBUFFER_H_
+
+#include <cstdint>
+#include <memory>
+
+#include "core/renderer/Framebuffer.h"
+#include "core/renderer/Shader.h"
+
+namespace engine {
+namespace platform {
+namespace opengl {
+
+/**
+ * The OpenGL Framebuffer implementation based off the generic Framebuffer
+ * base class provided by the engines renderer. Renders into an RGBA8 color
+ * texture with a 24 bit depth and 8 bit stencil renderbuffer. Only uses
+ * OpenGL 4.1 entry points, like the rest of the renderer's context.
+ */
+class OpenGLFramebuffer : public renderer::Framebuffer {
+ public:
+  OpenGLFramebuffer(uint32_t width, uint32_t height);
+  ~OpenGLFramebuffer();
+
+  void Bind() const override;
+  void Unbind() const override;
+  void Resize(uint32_t width, uint32_t height) override;
+  void SetRenderSize(uint32_t width, uint32_t height) override;
+
+  inline uint32_t GetWidth() const override { return width_; }
+  inline uint32_t GetHeight() const override { return height_; }
+  inline uint32_t GetRenderWidth() const override { return render_width_; }
+  inline uint32_t GetRenderHeight() const override { return render_height_; }
+
+  /**
+   * Bilinear upscaling is a framebuffer blit. Sharpened upscaling draws a
+   * fullscreen triangle that samples the color texture.
+   */
+  void Upscale(
+      uint32_t width,
+      uint32_t height,
+      renderer::UpscaleFilter filter,
+      float sharpness) const override;
+
+ private:
+  uint32_t renderer_ID_ = 0;
+  uint32_t color_attachment_ = 0;
+  uint32_t depth_attachment_ = 0;
+  uint32_t width_, height_;
+  uint32_t render_width_, render_height_;
+
+  std::unique_ptr<renderer::Shader> sharpen_shader_;
+  int uv_scale_location_ = -1;
+  int texel_size_location_ = -1;
+  int sharpness_location_ = -1;
+  uint32_t vertex_array_ = 0;
+
+  void Allocate();
+  void Release();
+};
+
+}  // namespace opengl
+}  // namespace platform
+}  // namespace engine
+
+#endif  // ENGINE_SRC_PLATFORM_OPENGL_OPENGLFRAMEBUFFER_H_
@@ -0,0 +1,52 @@
+#include "platform/opengl/OpenGLGpuTimer.h"
+
+#include <glad/glad.h>
+
+#include "core/Assert.h"
+
+namespace engine {
+namespace platform {
+namespace opengl {
+
+OpenGLGpuTimer::OpenGLGpuTimer() {
+  glGenQueries(kQueryCount, queries_);
+}
+
+OpenGLGpuTimer::~OpenGLGpuTimer() {
+  glDeleteQueries(kQueryCount, queries_);
+}
+
+void OpenGLGpuTimer::Begin() {
+  ENGINE_CORE_ASSERT(!measuring_, "The GPU timer is already measuring.");
+  if (issued_ - completed_ == kQueryCount) {
+    return;
+  }
+  glBeginQuery(GL_TIME_ELAPSED, queries_[issued_ % kQueryCount]);
+  measuring_ = true;
+}
+
+void OpenGLGpuTimer::End() {
+  if (measuring_) {
+    glEndQuery(GL_TIME_ELAPSED);
+    ++issued_;
+    measuring_ = false;
+  }
+
+  // Results arrive in the order the queries were issued.
+  while (completed_ < issued_) {
+    uint32_t query = queries_[completed_ % kQueryCount];
+    GLint available = GL_FALSE;
+    glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+    if (available == GL_FALSE) {
+      break;
+    }
+    GLuint64 nanoseconds = 0;
+    glGetQueryObjectui64v(query, GL_QUERY_RESULT, &nanoseconds);
+    elapsed_time_ = static_cast<double>(nanoseconds) * 1e-9;
+    ++completed_;
+  }
+}
+
+}  // namespace opengl
+}  // namespace platform
+}  // namespace engine
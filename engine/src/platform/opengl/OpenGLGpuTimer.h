@@ -0,0 +1,44 @@
+#ifndef ENGINE_SRC_PLATFORM_OPENGL_OPENGLGPUTIMER_H_
+#define ENGINE_SRC_PLATFORM_OPENGL_OPENGLGPUTIMER_H_
+
+#include <cstdint>
+
+#include "core/renderer/GpuTimer.h"
+
+namespace engine {
+namespace platform {
+namespace opengl {
+
+/**
+ * The OpenGL GpuTimer implementation based off the generic GpuTimer base
+ * class provided by the engines renderer, using a ring of GL_TIME_ELAPSED
+ * queries. A span is skipped rather than waited for when all of them are
+ * still in flight.
+ */
+class OpenGLGpuTimer : public renderer::GpuTimer {
+ public:
+  OpenGLGpuTimer();
+  ~OpenGLGpuTimer();
+
+  void Begin() override;
+  void End() override;
+
+  inline double GetElapsedTime() const override { return elapsed_time_; }
+
+ private:
+  static constexpr uint32_t kQueryCount = 4;
+
+  uint32_t queries_[kQueryCount];
+
+  // Queries are issued and read in order, so these index the ring.
+  uint64_t issued_ = 0;
+  uint64_t completed_ = 0;
+  bool measuring_ = false;
+  double elapsed_time_ = -1.0;
+};
+
+}  // namespace opengl
+}  // namespace platform
+}  // namespace engine
+
+#endif  // ENGINE_SRC_PLATFORM_OPENGL_OPENGLGPUTIMER_H_
@@ -7,7 +7,6 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 
-#include "core/Application.h"
 #include "core/Input.h"
 
 namespace engine {
@@ -15,6 +14,7 @@ namespace engine {
 #ifdef ENGINE_PLATFORM_WINDOWS
 
 Input* Input::kInput_ = new platform::windows::InputImplementation();
+const Window* Input::kWindow_ = nullptr;
 
 #endif  // ENGINE_PLATFORM_WINDOWS
 
@@ -23,8 +23,7 @@ namespace windows {
 
 
 bool InputImplementation::IsKeyPressedImpl(int key_code) {
-  GLFWwindow* window = static_cast<GLFWwindow*>(
-      Application::GetApplication().GetWindow().GetNativeWindow());
+  GLFWwindow* window = static_cast<GLFWwindow*>(GetNativeWindow());
 
   int state = glfwGetKey(window, key_code);
   return state == GLFW_PRESS || state == GLFW_REPEAT;
@@ -41,8 +40,7 @@ float InputImplementation::GetMouseYImpl() {
 }
 
 std::pair<float, float> InputImplementation::GetMousePositionImpl() {
-  GLFWwindow* window = static_cast<GLFWwindow*>(
-      Application::GetApplication().GetWindow().GetNativeWindow());
+  GLFWwindow* window = static_cast<GLFWwindow*>(GetNativeWindow());
 
   double x_pos, y_pos;
   glfwGetCursorPos(window, &x_pos, &y_pos);
@@ -51,8 +49,7 @@ std::pair<float, float> InputImplementation::GetMousePositionImpl() {
 }
 
 bool InputImplementation::IsMouseButtonPressedImpl(int button) {
-  GLFWwindow* window = static_cast<GLFWwindow*>(
-      Application::GetApplication().GetWindow().GetNativeWindow());
+  GLFWwindow* window = static_cast<GLFWwindow*>(GetNativeWindow());
 
 
   int state = glfwGetMouseButton(window, button);
@@ -0,0 +1,65 @@
+// Checks that emitters keep firing on schedule, and in the right direction,
+// after running for a long time.
+
+#include <cmath>
+#include <cstdio>
+
+#include "core/Log.h"
+#include "core/projectiles/ProjectileEmitter.h"
+#include "core/projectiles/ProjectileSystem.h"
+
+using engine::projectiles::EmitterPattern;
+using engine::projectiles::ProjectileEmitter;
+using engine::projectiles::ProjectileSystem;
+
+namespace {
+
+// Four months of uptime, where a float clock no longer has room for a tenth
+// of a second.
+constexpr float kStartTime = 1e7f;
+
+bool Check(bool condition, const char* message) {
+  if (!condition) {
+    std::fprintf(stderr, "FAILED: %s\n", message);
+  }
+  return condition;
+}
+
+}  // namespace
+
+int main() {
+  engine::logging::Log::Init();
+
+  EmitterPattern pattern;
+  pattern.Interval = 0.1f;
+  pattern.BurstCount = 1;
+  pattern.Spin = 1.0f;
+  pattern.Speed = 0.0f;
+  pattern.Projectile.Lifetime = 1.0f;
+
+  ProjectileSystem system;
+  ProjectileEmitter emitter(pattern);
+  emitter.SetPosition(960.0f, 540.0f);
+
+  // Only the bursts of the last lifetime still have projectiles to fire.
+  uint32_t fired = emitter.Update(kStartTime, &system);
+  bool passed = Check(fired <= 11, "Expired bursts were fired.");
+
+  fired = 0;
+  for (int frame = 0; frame < 60; ++frame) {
+    fired += emitter.Update(1.0f / 60.0f, &system);
+  }
+  passed &= Check(
+      fired >= 9 && fired <= 11, "A second didn't fire ten bursts.");
+  passed &= Check(
+      std::abs(emitter.GetTime() - (kStartTime + 1.0)) < 1e-6,
+      "The emitter's clock drifted.");
+
+  double time = kStartTime + 0.05;
+  double expected = std::remainder(time, 6.283185307179586);
+  double error = std::remainder(
+      emitter.GetDirection(time) - expected, 6.283185307179586);
+  passed &= Check(std::abs(error) < 1e-4, "The spin lost precision.");
+
+  return passed ? 0 : 1;
+}